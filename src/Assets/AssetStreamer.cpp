@@ -0,0 +1,283 @@
+﻿// src/Assets/AssetStreamer.cpp
+#include "AssetStreamer.h"
+
+#include <utility>
+
+#include "Common/Profiler.h"
+
+// One request, shared by its handles, the queue, the I/O thread loading it and the cache.
+struct AssetRequestState {
+    std::filesystem::path Path;
+    std::string Key;
+    AssetLoader Loader;
+    std::atomic<float> Priority{0.0f};
+    bool HasPosition = false;
+    Vector3 Position;
+    std::atomic<AssetStatus> Status{AssetStatus::Queued};
+    std::atomic<bool> Cancelled{false};
+
+    // Written by the I/O thread before it queues the completion; read on the Update thread.
+    bool Succeeded = false;
+    LoadedAsset Result;
+
+    // Update thread only.
+    std::vector<AssetCallback> Callbacks;
+    std::list<AssetRequestState*>::iterator LruEntry;
+    bool IsResident = false;
+};
+
+AssetStatus AssetHandle::GetStatus() const {
+    return mState->Status.load(std::memory_order_acquire);
+}
+
+const std::filesystem::path& AssetHandle::GetPath() const {
+    return mState->Path;
+}
+
+std::shared_ptr<const void> AssetHandle::GetData() const {
+    // Ready is published after the result is final, and the result never changes again.
+    return GetStatus() == AssetStatus::Ready ? mState->Result.Data : nullptr;
+}
+
+void AssetHandle::Cancel() {
+    const AssetStatus status = GetStatus();
+    if (status == AssetStatus::Queued || status == AssetStatus::Loading) {
+        mState->Cancelled.store(true, std::memory_order_relaxed);
+    }
+}
+
+void AssetHandle::SetPriority(float Priority) {
+    mState->Priority.store(Priority, std::memory_order_relaxed);
+}
+
+AssetStreamer::AssetStreamer(uint32_t ThreadCount, uint64_t BudgetBytes)
+    : mBudgetBytes(BudgetBytes) {
+    ThreadCount = ThreadCount > 0 ? ThreadCount : 1;
+    mWorkers.reserve(ThreadCount);
+    for (uint32_t i = 0; i < ThreadCount; ++i) {
+        mWorkers.emplace_back(&AssetStreamer::WorkerMain, this);
+    }
+}
+
+AssetStreamer::~AssetStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(mQueueMutex);
+        mStopping = true;
+        for (const auto& state : mQueue) {
+            state->Cancelled.store(true, std::memory_order_relaxed);
+        }
+    }
+    for (auto& entry : mAssets) {
+        entry.second->Cancelled.store(true, std::memory_order_relaxed);
+    }
+    mQueueCondition.notify_all();
+    for (std::thread& worker : mWorkers) {
+        worker.join();
+    }
+}
+
+AssetHandle AssetStreamer::Request(AssetRequest Request) {
+    std::string key = Request.Path.lexically_normal().string();
+
+    auto existing = mAssets.find(key);
+    if (existing != mAssets.end() &&
+        !existing->second->Cancelled.load(std::memory_order_relaxed)) {
+        const std::shared_ptr<AssetRequestState>& state = existing->second;
+        if (Request.OnComplete) {
+            state->Callbacks.push_back(std::move(Request.OnComplete));
+        }
+        if (state->IsResident) {
+            mLru.splice(mLru.begin(), mLru, state->LruEntry);
+            if (!state->Callbacks.empty()) {
+                mCachedHits.push_back(state);
+            }
+        } else if (Request.Priority > state->Priority.load(std::memory_order_relaxed)) {
+            state->Priority.store(Request.Priority, std::memory_order_relaxed);
+        }
+        return AssetHandle(state);
+    }
+
+    // New request. A cancelled one still loading keeps running, detached from the cache.
+    auto state = std::make_shared<AssetRequestState>();
+    state->Path = std::move(Request.Path);
+    state->Key = key;
+    state->Loader = std::move(Request.Loader);
+    state->Priority.store(Request.Priority, std::memory_order_relaxed);
+    state->HasPosition = Request.HasPosition;
+    state->Position = Request.Position;
+    if (Request.OnComplete) {
+        state->Callbacks.push_back(std::move(Request.OnComplete));
+    }
+    mAssets[std::move(key)] = state;
+    {
+        std::lock_guard<std::mutex> lock(mQueueMutex);
+        mQueue.push_back(state);
+    }
+    mQueueCondition.notify_one();
+    return AssetHandle(state);
+}
+
+void AssetStreamer::Update() {
+    // Callbacks may make new requests, so the hit list is swapped out first.
+    std::vector<std::shared_ptr<AssetRequestState>> hits;
+    hits.swap(mCachedHits);
+    for (const auto& state : hits) {
+        Complete(state);
+    }
+
+    mCompleted.ConsumeAll([this](std::shared_ptr<AssetRequestState> State) {
+        ++mCompletedCount;
+        auto entry = mAssets.find(State->Key);
+        const bool isCached = entry != mAssets.end() && entry->second == State;
+
+        if (State->Cancelled.load(std::memory_order_relaxed) || !State->Succeeded) {
+            const bool cancelled = State->Cancelled.load(std::memory_order_relaxed);
+            State->Result = LoadedAsset{};
+            State->Status.store(cancelled ? AssetStatus::Cancelled : AssetStatus::Failed,
+                                std::memory_order_release);
+            if (isCached) {
+                mAssets.erase(entry);
+            }
+        } else if (!isCached) {
+            // Invalidated while loading: the callbacks get it, the cache does not.
+            State->Status.store(AssetStatus::Ready, std::memory_order_release);
+        } else {
+            mLru.push_front(State.get());
+            State->LruEntry = mLru.begin();
+            State->IsResident = true;
+            mResidentBytes += State->Result.Bytes;
+            State->Status.store(AssetStatus::Ready, std::memory_order_release);
+        }
+        Complete(State);
+    });
+
+    EvictToBudget();
+}
+
+void AssetStreamer::Invalidate(const std::filesystem::path& Path) {
+    auto entry = mAssets.find(Path.lexically_normal().string());
+    if (entry == mAssets.end()) {
+        return;
+    }
+    AssetRequestState& state = *entry->second;
+    if (state.IsResident) {
+        mResidentBytes -= state.Result.Bytes;
+        state.IsResident = false;
+        mLru.erase(state.LruEntry);
+    }
+    mAssets.erase(entry);
+}
+
+void AssetStreamer::SetBudget(uint64_t BudgetBytes) {
+    mBudgetBytes = BudgetBytes;
+    EvictToBudget();
+}
+
+void AssetStreamer::SetViewerPosition(const Vector3& Position) {
+    std::lock_guard<std::mutex> lock(mQueueMutex);
+    mViewerPosition = Position;
+}
+
+AssetStreamerStats AssetStreamer::GetStats() const {
+    AssetStreamerStats stats;
+    {
+        std::lock_guard<std::mutex> lock(mQueueMutex);
+        stats.Queued = static_cast<uint32_t>(mQueue.size());
+    }
+    stats.Loading = mLoadingCount.load(std::memory_order_acquire);
+    stats.Resident = static_cast<uint32_t>(mLru.size());
+    stats.ResidentBytes = mResidentBytes;
+    stats.Completed = mCompletedCount;
+    stats.Evicted = mEvictedCount;
+    return stats;
+}
+
+void AssetStreamer::WorkerMain() {
+    PROFILE_THREAD("Asset I/O");
+    for (;;) {
+        std::shared_ptr<AssetRequestState> state;
+        {
+            std::unique_lock<std::mutex> lock(mQueueMutex);
+            mQueueCondition.wait(lock, [this] { return mStopping || !mQueue.empty(); });
+            if (mStopping) {
+                return;
+            }
+            state = TakeBestRequest();
+            if (state == nullptr) {
+                continue;
+            }
+            mLoadingCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        state->Status.store(AssetStatus::Loading, std::memory_order_release);
+        state->Succeeded = state->Loader(state->Path, state->Cancelled, state->Result);
+        // Queued before the count drops, so a caller that reads Loading before Update and sees
+        // zero knows the Update hands over every finished load.
+        mCompleted.Push(std::move(state));
+        mLoadingCount.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+std::shared_ptr<AssetRequestState> AssetStreamer::TakeBestRequest() {
+    // Cancelled requests finish without loading; Update reports them.
+    for (size_t i = 0; i < mQueue.size();) {
+        if (mQueue[i]->Cancelled.load(std::memory_order_relaxed)) {
+            mCompleted.Push(std::move(mQueue[i]));
+            mQueue[i] = std::move(mQueue.back());
+            mQueue.pop_back();
+        } else {
+            ++i;
+        }
+    }
+    if (mQueue.empty()) {
+        return nullptr;
+    }
+
+    // A linear scan: priorities change while requests wait, which would invalidate a heap, and
+    // the queue holds files, not thousands of small items.
+    size_t best = 0;
+    float bestPriority = 0.0f;
+    for (size_t i = 0; i < mQueue.size(); ++i) {
+        const AssetRequestState& state = *mQueue[i];
+        float priority = state.Priority.load(std::memory_order_relaxed);
+        if (state.HasPosition) {
+            priority -= Length(state.Position - mViewerPosition);
+        }
+        if (i == 0 || priority > bestPriority) {
+            best = i;
+            bestPriority = priority;
+        }
+    }
+    std::shared_ptr<AssetRequestState> state = std::move(mQueue[best]);
+    mQueue[best] = std::move(mQueue.back());
+    mQueue.pop_back();
+    return state;
+}
+
+void AssetStreamer::Complete(const std::shared_ptr<AssetRequestState>& State) {
+    std::vector<AssetCallback> callbacks;
+    callbacks.swap(State->Callbacks);
+    const AssetHandle handle(State);
+    for (const AssetCallback& callback : callbacks) {
+        callback(handle);
+    }
+}
+
+void AssetStreamer::EvictToBudget() {
+    // Oldest first, skipping assets still referenced outside the cache: dropping those would
+    // free nothing.
+    auto it = mLru.end();
+    while (mResidentBytes > mBudgetBytes && it != mLru.begin()) {
+        --it;
+        AssetRequestState* state = *it;
+        auto entry = mAssets.find(state->Key);
+        if (entry->second.use_count() > 1 || state->Result.Data.use_count() > 1) {
+            continue;
+        }
+        mResidentBytes -= state->Result.Bytes;
+        state->IsResident = false;
+        it = mLru.erase(it);
+        mAssets.erase(entry);
+        ++mEvictedCount;
+    }
+}
@@ -0,0 +1,151 @@
+﻿// src/Assets/AssetStreamer.h
+// Loads asset files on dedicated I/O threads so the main loop never waits on the disk or a
+// parser. Requests are served highest priority first, can be cancelled, and finished assets
+// stay cached under a memory budget until they are the least recently used ones.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/MpscQueue.h"
+#include "Math/Vector.h"
+
+enum class AssetStatus : uint8_t { Queued, Loading, Ready, Failed, Cancelled };
+
+// What a loader produces: the asset, type-erased, and the memory it keeps resident.
+struct LoadedAsset {
+    std::shared_ptr<const void> Data;
+    uint64_t Bytes = 0;
+};
+
+// Runs on an I/O thread. Long loaders should give up early once Cancelled is set.
+using AssetLoader = std::function<bool(const std::filesystem::path& Path,
+                                       const std::atomic<bool>& Cancelled,
+                                       LoadedAsset& Out)>;
+
+struct AssetRequestState;
+
+// Shared view of one request. Any copy can poll it; the asset stays cached while a handle or
+// the asset itself is referenced outside the streamer.
+class AssetHandle {
+  public:
+    AssetHandle() = default;
+
+    bool IsValid() const {
+        return mState != nullptr;
+    }
+    AssetStatus GetStatus() const;
+    const std::filesystem::path& GetPath() const;
+
+    // The loaded asset once the status is Ready, else null. T is the loader's type.
+    template <typename T>
+    std::shared_ptr<const T> Get() const {
+        return std::static_pointer_cast<const T>(GetData());
+    }
+    std::shared_ptr<const void> GetData() const;
+
+    // Cancels the request for every handle sharing it. Queued requests never start; requests
+    // that are loading finish as Cancelled and their result is dropped. No-op once finished.
+    void Cancel();
+    // Higher values load first.
+    void SetPriority(float Priority);
+
+  private:
+    friend class AssetStreamer;
+    explicit AssetHandle(std::shared_ptr<AssetRequestState> State) : mState(std::move(State)) {
+    }
+
+    std::shared_ptr<AssetRequestState> mState;
+};
+
+// Runs on the thread calling AssetStreamer::Update, for Ready, Failed and Cancelled requests.
+using AssetCallback = std::function<void(const AssetHandle& Handle)>;
+
+struct AssetRequest {
+    std::filesystem::path Path;
+    AssetLoader Loader;
+    AssetCallback OnComplete; // Optional
+    float Priority = 0.0f;    // Higher loads first
+    // With a position, the distance to the viewer is subtracted from Priority, so nearby
+    // assets load first as the camera moves.
+    bool HasPosition = false;
+    Vector3 Position;
+};
+
+struct AssetStreamerStats {
+    uint32_t Queued = 0;
+    uint32_t Loading = 0;
+    uint32_t Resident = 0; // Ready assets held by the cache
+    uint64_t ResidentBytes = 0;
+    uint64_t Completed = 0;
+    uint64_t Evicted = 0;
+};
+
+class AssetStreamer {
+  public:
+    // ThreadCount I/O threads, 0 for one. Ready assets beyond BudgetBytes are evicted.
+    AssetStreamer(uint32_t ThreadCount, uint64_t BudgetBytes);
+    // Cancels everything and waits for running loaders to return.
+    ~AssetStreamer();
+
+    AssetStreamer(const AssetStreamer&) = delete;
+    AssetStreamer& operator=(const AssetStreamer&) = delete;
+
+    // Request, Update and SetBudget belong to one thread, normally the main loop.
+
+    // Queues Request.Path, or joins the request already made for it: a queued or loading path
+    // keeps the higher priority and gains the callback, and a cached one completes on the next
+    // Update without touching the disk.
+    AssetHandle Request(AssetRequest Request);
+
+    // Hands finished loads to their callbacks, then evicts down to the budget. Never blocks.
+    void Update();
+
+    // Forgets the cached asset of Path, e.g. after the file changed on disk, so the next Request
+    // reads it again. Handles and data already handed out stay valid; a load still running for
+    // Path finishes for the requests made so far without being cached.
+    void Invalidate(const std::filesystem::path& Path);
+
+    void SetBudget(uint64_t BudgetBytes);
+    // Any thread. Used for requests with a position.
+    void SetViewerPosition(const Vector3& Position);
+
+    AssetStreamerStats GetStats() const;
+
+  private:
+    void WorkerMain();
+    // Removes and returns the best queued request, or null. Needs mQueueMutex.
+    std::shared_ptr<AssetRequestState> TakeBestRequest();
+    void Complete(const std::shared_ptr<AssetRequestState>& State);
+    void EvictToBudget();
+
+    std::vector<std::thread> mWorkers;
+
+    // Shared with the I/O threads.
+    mutable std::mutex mQueueMutex;
+    std::condition_variable mQueueCondition;
+    std::vector<std::shared_ptr<AssetRequestState>> mQueue;
+    Vector3 mViewerPosition;
+    bool mStopping = false;
+    std::atomic<uint32_t> mLoadingCount{0};
+    MpscQueue<std::shared_ptr<AssetRequestState>> mCompleted;
+
+    // Owned by the Update thread.
+    std::unordered_map<std::string, std::shared_ptr<AssetRequestState>> mAssets;
+    std::list<AssetRequestState*> mLru; // Ready assets, most recent first
+    std::vector<std::shared_ptr<AssetRequestState>> mCachedHits; // Complete on next Update
+    uint64_t mBudgetBytes = 0;
+    uint64_t mResidentBytes = 0;
+    uint64_t mCompletedCount = 0;
+    uint64_t mEvictedCount = 0;
+};
@@ -0,0 +1,830 @@
+﻿// src/Assets/GltfAsset.cpp
+#include "GltfAsset.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+#include "Assets/Mesh.h"
+#include "Common/Json.h"
+#include "Common/Profiler.h"
+#include "Math/Matrix.h"
+#include "Scene/Scene.h"
+
+namespace {
+
+constexpr uint32_t GLB_MAGIC = 0x46546C67;      // "glTF"
+constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;  // "BIN\0"
+constexpr size_t GLB_HEADER_SIZE = 12;
+constexpr size_t GLB_CHUNK_HEADER_SIZE = 8;
+// glTF node graphs are trees; anything deeper than this is treated as a cycle.
+constexpr uint32_t GLTF_MAX_NODE_DEPTH = 256;
+constexpr uint32_t GLTF_DEFAULT_COLOR = 0xFFC0C0C0;
+
+uint32_t ReadLittleEndian32(const uint8_t* Data) {
+    return static_cast<uint32_t>(Data[0]) | static_cast<uint32_t>(Data[1]) << 8 |
+           static_cast<uint32_t>(Data[2]) << 16 | static_cast<uint32_t>(Data[3]) << 24;
+}
+
+// Index stored under Key, GLTF_NONE if it is missing, and false if it is not a valid index.
+bool ReadIndex(const JsonValue& Object, std::string_view Key, uint32_t& OutIndex) {
+    OutIndex = GLTF_NONE;
+    const JsonValue* value = Object.Find(Key);
+    if (value == nullptr) {
+        return true;
+    }
+    const int64_t index = value->GetInteger(-1);
+    if (index < 0 || index >= GLTF_NONE) {
+        return false;
+    }
+    OutIndex = static_cast<uint32_t>(index);
+    return true;
+}
+
+uint64_t ReadSize(const JsonValue& Object, std::string_view Key, uint64_t Default) {
+    const JsonValue* value = Object.Find(Key);
+    const int64_t size = value != nullptr ? value->GetInteger(-1) : static_cast<int64_t>(Default);
+    return size >= 0 ? static_cast<uint64_t>(size) : UINT64_MAX;
+}
+
+// Elements of an optional array member, without copying them.
+const std::vector<JsonValue>& GetElements(const JsonValue* Array) {
+    static const std::vector<JsonValue> empty;
+    return Array != nullptr ? Array->GetElements() : empty;
+}
+
+std::string ReadName(const JsonValue& Object) {
+    const JsonValue* name = Object.Find("name");
+    return name != nullptr ? name->GetString() : std::string();
+}
+
+// Reads up to Count numbers of an array member into Out; returns how many were present.
+uint32_t ReadFloatArray(const JsonValue& Object, std::string_view Key, float* Out, uint32_t Count) {
+    const JsonValue* array = Object.Find(Key);
+    if (array == nullptr || !array->IsArray()) {
+        return 0;
+    }
+    const uint32_t available = static_cast<uint32_t>(std::min<size_t>(array->GetSize(), Count));
+    for (uint32_t i = 0; i < available; ++i) {
+        Out[i] = (*array)[i].GetFloat();
+    }
+    return available;
+}
+
+uint32_t GetComponentSize(GltfComponentType Component) {
+    switch (Component) {
+    case GltfComponentType::Byte:
+    case GltfComponentType::UnsignedByte:
+        return 1;
+    case GltfComponentType::Short:
+    case GltfComponentType::UnsignedShort:
+        return 2;
+    case GltfComponentType::UnsignedInt:
+    case GltfComponentType::Float:
+        return 4;
+    }
+    return 0;
+}
+
+uint32_t GetComponentCount(GltfAccessorType Type) {
+    static const uint32_t counts[] = {1, 2, 3, 4, 4, 9, 16};
+    return counts[static_cast<uint32_t>(Type)];
+}
+
+bool ParseAccessorType(const std::string& Text, GltfAccessorType& OutType) {
+    static const char* const names[] = {"SCALAR", "VEC2", "VEC3", "VEC4", "MAT2", "MAT3", "MAT4"};
+    for (uint32_t i = 0; i < 7; ++i) {
+        if (Text == names[i]) {
+            OutType = static_cast<GltfAccessorType>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DecodeBase64(std::string_view Text, std::vector<uint8_t>& Out) {
+    auto decode = [](char C) -> int {
+        if (C >= 'A' && C <= 'Z') {
+            return C - 'A';
+        }
+        if (C >= 'a' && C <= 'z') {
+            return C - 'a' + 26;
+        }
+        if (C >= '0' && C <= '9') {
+            return C - '0' + 52;
+        }
+        return C == '+' ? 62 : (C == '/' ? 63 : -1);
+    };
+    Out.clear();
+    Out.reserve(Text.size() / 4 * 3);
+    uint32_t accumulator = 0;
+    int bits = 0;
+    for (char c : Text) {
+        if (c == '=') {
+            break;
+        }
+        const int value = decode(c);
+        if (value < 0) {
+            return false;
+        }
+        accumulator = (accumulator << 6) | static_cast<uint32_t>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            Out.push_back(static_cast<uint8_t>(accumulator >> bits));
+        }
+    }
+    return true;
+}
+
+// Relative buffer URIs are percent-encoded UTF-8.
+std::filesystem::path DecodeUriPath(const std::string& Uri) {
+    std::string decoded;
+    decoded.reserve(Uri.size());
+    for (size_t i = 0; i < Uri.size(); ++i) {
+        if (Uri[i] == '%' && i + 2 < Uri.size()) {
+            const std::string hex = Uri.substr(i + 1, 2);
+            char* end = nullptr;
+            const long value = std::strtol(hex.c_str(), &end, 16);
+            if (end == hex.c_str() + 2) {
+                decoded.push_back(static_cast<char>(value));
+                i += 2;
+                continue;
+            }
+        }
+        decoded.push_back(Uri[i]);
+    }
+    return std::filesystem::u8path(decoded);
+}
+
+float ReadComponent(const uint8_t* Data, GltfComponentType Component, bool Normalized) {
+    switch (Component) {
+    case GltfComponentType::Float: {
+        float value;
+        std::memcpy(&value, Data, sizeof(value));
+        return value;
+    }
+    case GltfComponentType::Byte: {
+        const float value = static_cast<float>(static_cast<int8_t>(Data[0]));
+        return Normalized ? std::max(value / 127.0f, -1.0f) : value;
+    }
+    case GltfComponentType::UnsignedByte:
+        return Normalized ? Data[0] / 255.0f : static_cast<float>(Data[0]);
+    case GltfComponentType::Short: {
+        int16_t raw;
+        std::memcpy(&raw, Data, sizeof(raw));
+        return Normalized ? std::max(raw / 32767.0f, -1.0f) : static_cast<float>(raw);
+    }
+    case GltfComponentType::UnsignedShort: {
+        uint16_t raw;
+        std::memcpy(&raw, Data, sizeof(raw));
+        return Normalized ? raw / 65535.0f : static_cast<float>(raw);
+    }
+    case GltfComponentType::UnsignedInt: {
+        uint32_t raw;
+        std::memcpy(&raw, Data, sizeof(raw));
+        return Normalized ? static_cast<float>(raw / 4294967295.0) : static_cast<float>(raw);
+    }
+    }
+    return 0.0f;
+}
+
+uint32_t ToColor(const Vector4& Color) {
+    auto channel = [](float Value) {
+        return static_cast<uint32_t>(std::min(std::max(Value, 0.0f), 1.0f) * 255.0f + 0.5f);
+    };
+    return channel(Color.W) << 24 | channel(Color.X) << 16 | channel(Color.Y) << 8 |
+           channel(Color.Z);
+}
+
+// Copies made for a primitive whose streams could not be used in place. It also holds the
+// asset, so the mapped streams of the same view stay valid.
+struct GltfPrimitiveStorage {
+    std::shared_ptr<const GltfAsset> Asset;
+    std::vector<Vector3> Positions;
+    std::vector<Vector3> Normals;
+    std::vector<Vector2> TexCoords;
+    std::vector<uint32_t> Indices;
+};
+
+// Builds the scene's view of one primitive, in place wherever the layout allows.
+class GltfSceneBuilder {
+  public:
+    GltfSceneBuilder(const std::shared_ptr<const GltfAsset>& Asset,
+                     Scene& Target,
+                     GltfImportStats& Stats)
+        : mAsset(Asset), mTarget(Target), mStats(Stats) {
+        for (const GltfMesh& mesh : Asset->GetMeshes()) {
+            mPrimitiveMeshes.emplace_back(mesh.Primitives.size(), UNBUILT);
+        }
+        mOnPath.assign(Asset->GetNodes().size(), false);
+    }
+
+    void AddNode(uint32_t NodeIndex, SceneNodeId Parent, uint32_t Depth) {
+        if (NodeIndex >= mOnPath.size() || mOnPath[NodeIndex] || Depth > GLTF_MAX_NODE_DEPTH) {
+            return;
+        }
+        mOnPath[NodeIndex] = true;
+
+        const GltfNode& node = mAsset->GetNodes()[NodeIndex];
+        SceneHierarchy& hierarchy = mTarget.GetHierarchy();
+        const std::string name =
+            node.Name.empty() ? "Node " + std::to_string(NodeIndex) : node.Name;
+        const SceneNodeId id = hierarchy.CreateNode(name, Parent, node.Local);
+        ++mStats.NodeCount;
+
+        if (node.Mesh != GLTF_NONE) {
+            AddMeshInstances(node.Mesh, id);
+        }
+        for (uint32_t child : node.Children) {
+            AddNode(child, id, Depth + 1);
+        }
+        mOnPath[NodeIndex] = false;
+    }
+
+  private:
+    static constexpr uint32_t UNBUILT = GLTF_NONE - 1;
+
+    void AddMeshInstances(uint32_t MeshIndex, SceneNodeId Node) {
+        const GltfMesh& mesh = mAsset->GetMeshes()[MeshIndex];
+        const std::string meshName =
+            mesh.Name.empty() ? "Mesh " + std::to_string(MeshIndex) : mesh.Name;
+        for (uint32_t p = 0; p < mesh.Primitives.size(); ++p) {
+            uint32_t& sceneMesh = mPrimitiveMeshes[MeshIndex][p];
+            if (sceneMesh == UNBUILT) {
+                sceneMesh = BuildPrimitive(mesh.Primitives[p]);
+            }
+            if (sceneMesh == GLTF_NONE) {
+                continue;
+            }
+
+            // The tree shows which mesh and material every drawn primitive uses.
+            const uint32_t materialIndex = mesh.Primitives[p].Material;
+            const GltfMaterial* material =
+                materialIndex != GLTF_NONE ? &mAsset->GetMaterials()[materialIndex] : nullptr;
+            std::string label = meshName;
+            if (mesh.Primitives.size() > 1) {
+                label += " #" + std::to_string(p);
+            }
+            if (material != nullptr) {
+                label += " [" +
+                         (material->Name.empty() ? "Material " + std::to_string(materialIndex)
+                                                 : material->Name) +
+                         "]";
+            }
+            const SceneNodeId child = mTarget.GetHierarchy().CreateNode(label, Node);
+            ++mStats.NodeCount;
+            mTarget.AddInstance(child, sceneMesh,
+                                material != nullptr ? ToColor(material->BaseColor)
+                                                    : GLTF_DEFAULT_COLOR);
+        }
+    }
+
+    // Returns the scene mesh index, or GLTF_NONE for primitives that are not triangles.
+    uint32_t BuildPrimitive(const GltfPrimitive& Primitive) {
+        const GltfAsset& asset = *mAsset;
+        if (Primitive.Position == GLTF_NONE || Primitive.Mode < GltfPrimitiveMode::Triangles) {
+            return GLTF_NONE;
+        }
+        auto storage = std::make_shared<GltfPrimitiveStorage>();
+        storage->Asset = mAsset;
+        MeshView view;
+
+        const GltfAccessor& positions = asset.GetAccessors()[Primitive.Position];
+        const uint32_t vertexCount = positions.Count;
+        if (!GetStream(Primitive.Position, vertexCount, view.Positions, storage->Positions)) {
+            return GLTF_NONE;
+        }
+        // Optional streams that do not match the positions are dropped rather than failing.
+        if (Primitive.Normal != GLTF_NONE &&
+            !GetStream(Primitive.Normal, vertexCount, view.Normals, storage->Normals)) {
+            view.Normals = {};
+        }
+        if (Primitive.TexCoord0 != GLTF_NONE &&
+            !GetStream(Primitive.TexCoord0, vertexCount, view.TexCoords, storage->TexCoords)) {
+            view.TexCoords = {};
+        }
+
+        if (Primitive.Indices == GLTF_NONE) {
+            storage->Indices.resize(vertexCount);
+            for (uint32_t i = 0; i < vertexCount; ++i) {
+                storage->Indices[i] = i;
+            }
+            view.Indices = storage->Indices;
+        } else if (Primitive.Mode == GltfPrimitiveMode::Triangles &&
+                   asset.GetAccessorSpan(Primitive.Indices, view.Indices)) {
+            CountStream(true, view.Indices.GetSize() * sizeof(uint32_t));
+        } else if (asset.ReadIndices(Primitive.Indices, storage->Indices)) {
+            view.Indices = storage->Indices;
+            CountStream(false, storage->Indices.size() * sizeof(uint32_t));
+        } else {
+            return GLTF_NONE;
+        }
+        if (Primitive.Mode != GltfPrimitiveMode::Triangles) {
+            TriangulateStripOrFan(Primitive.Mode, view.Indices, storage->Indices);
+            view.Indices = storage->Indices;
+        }
+
+        if (positions.HasBounds) {
+            view.Bounds.Min = Vector3{positions.Min[0], positions.Min[1], positions.Min[2]};
+            view.Bounds.Max = Vector3{positions.Max[0], positions.Max[1], positions.Max[2]};
+        } else {
+            for (const Vector3& position : view.Positions) {
+                Grow(view.Bounds, position);
+            }
+        }
+        view.Owner = std::move(storage);
+        ++mStats.PrimitiveCount;
+        return mTarget.AddMesh(std::move(view));
+    }
+
+    // Uses the accessor in place when it already is an array of T, else converts it into Copy.
+    template <typename T>
+    bool GetStream(uint32_t Accessor,
+                   uint32_t Count,
+                   Span<const T>& OutSpan,
+                   std::vector<T>& Copy) {
+        const GltfAsset& asset = *mAsset;
+        if (asset.GetAccessors()[Accessor].Count != Count) {
+            return false;
+        }
+        if (asset.GetAccessorSpan(Accessor, OutSpan)) {
+            CountStream(true, OutSpan.GetSize() * sizeof(T));
+            return true;
+        }
+        Copy.resize(Count);
+        if (!asset.ReadFloats(Accessor, sizeof(T) / sizeof(float),
+                              reinterpret_cast<float*>(Copy.data()))) {
+            return false;
+        }
+        OutSpan = Copy;
+        CountStream(false, Copy.size() * sizeof(T));
+        return true;
+    }
+
+    static void TriangulateStripOrFan(GltfPrimitiveMode Mode,
+                                      Span<const uint32_t> Source,
+                                      std::vector<uint32_t>& Out) {
+        std::vector<uint32_t> list;
+        for (size_t i = 2; i < Source.GetSize(); ++i) {
+            if (Mode == GltfPrimitiveMode::TriangleFan) {
+                list.insert(list.end(), {Source[0], Source[i - 1], Source[i]});
+            } else if (i % 2 == 0) {
+                list.insert(list.end(), {Source[i - 2], Source[i - 1], Source[i]});
+            } else {
+                // Every other strip triangle is reversed to keep one winding.
+                list.insert(list.end(), {Source[i - 1], Source[i - 2], Source[i]});
+            }
+        }
+        Out = std::move(list);
+    }
+
+    void CountStream(bool Mapped, uint64_t Bytes) {
+        (Mapped ? mStats.MappedStreams : mStats.CopiedStreams) += 1;
+        (Mapped ? mStats.MappedBytes : mStats.CopiedBytes) += Bytes;
+    }
+
+    std::shared_ptr<const GltfAsset> mAsset;
+    Scene& mTarget;
+    GltfImportStats& mStats;
+    // Scene mesh index per [mesh][primitive], UNBUILT until first used.
+    std::vector<std::vector<uint32_t>> mPrimitiveMeshes;
+    std::vector<bool> mOnPath; // Nodes on the current path, to stop at cycles
+};
+
+} // anonymous namespace
+
+GltfAsset::GltfAsset() = default;
+
+GltfAsset::~GltfAsset() = default;
+
+bool GltfAsset::Load(const std::filesystem::path& Path) {
+    PROFILE_ZONE("GltfAsset::Load");
+    mDirectory = Path.parent_path();
+    if (!mFile.Open(Path)) {
+        return false;
+    }
+    const uint8_t* data = mFile.GetData();
+    const size_t size = mFile.GetSize();
+
+    if (size < GLB_HEADER_SIZE || ReadLittleEndian32(data) != GLB_MAGIC) {
+        return Parse(reinterpret_cast<const char*>(data), size, {});
+    }
+
+    // GLB: header, a JSON chunk, then an optional binary chunk that buffer 0 refers to.
+    const uint32_t version = ReadLittleEndian32(data + 4);
+    const uint64_t length = std::min<uint64_t>(ReadLittleEndian32(data + 8), size);
+    if (version != 2) {
+        return false;
+    }
+    Span<const uint8_t> json;
+    Span<const uint8_t> binary;
+    uint64_t offset = GLB_HEADER_SIZE;
+    while (offset + GLB_CHUNK_HEADER_SIZE <= length) {
+        const uint64_t chunkLength = ReadLittleEndian32(data + offset);
+        const uint32_t chunkType = ReadLittleEndian32(data + offset + 4);
+        offset += GLB_CHUNK_HEADER_SIZE;
+        if (offset + chunkLength > length) {
+            return false;
+        }
+        if (chunkType == GLB_CHUNK_JSON && json.IsEmpty()) {
+            json = Span<const uint8_t>(data + offset, chunkLength);
+        } else if (chunkType == GLB_CHUNK_BIN && binary.IsEmpty()) {
+            binary = Span<const uint8_t>(data + offset, chunkLength);
+        }
+        offset += (chunkLength + 3) & ~uint64_t(3);
+    }
+    if (json.IsEmpty()) {
+        return false;
+    }
+    return Parse(reinterpret_cast<const char*>(json.GetData()), json.GetSize(), binary);
+}
+
+bool GltfAsset::LoadBuffers(const JsonValue& Buffers, Span<const uint8_t> BinaryChunk) {
+    for (size_t i = 0; i < Buffers.GetSize(); ++i) {
+        const JsonValue& buffer = Buffers[i];
+        const uint64_t byteLength = ReadSize(buffer, "byteLength", UINT64_MAX);
+        const JsonValue* uri = buffer.Find("uri");
+
+        Span<const uint8_t> bytes;
+        if (uri == nullptr) {
+            // Only the first buffer of a GLB may omit its URI: it is the binary chunk.
+            if (i != 0 || BinaryChunk.GetData() == nullptr) {
+                return false;
+            }
+            bytes = BinaryChunk;
+        } else if (uri->GetString().compare(0, 5, "data:") == 0) {
+            const std::string& text = uri->GetString();
+            const size_t comma = text.find(',');
+            if (comma == std::string::npos || text.rfind(";base64", comma) == std::string::npos) {
+                return false;
+            }
+            mDecodedBuffers.emplace_back();
+            if (!DecodeBase64(std::string_view(text).substr(comma + 1), mDecodedBuffers.back())) {
+                return false;
+            }
+            bytes = mDecodedBuffers.back();
+        } else {
+            auto file = std::make_unique<MappedFile>();
+            if (!file->Open(mDirectory / DecodeUriPath(uri->GetString()))) {
+                return false;
+            }
+            bytes = Span<const uint8_t>(file->GetData(), file->GetSize());
+            mBufferFiles.push_back(std::move(file));
+        }
+
+        // GLB chunks are padded, so a buffer may be shorter than its bytes, never longer.
+        if (byteLength > bytes.GetSize()) {
+            return false;
+        }
+        mBuffers.emplace_back(bytes.GetData(), static_cast<size_t>(byteLength));
+    }
+    return true;
+}
+
+bool GltfAsset::Parse(const char* Json, size_t JsonSize, Span<const uint8_t> BinaryChunk) {
+    JsonValue root;
+    if (!ParseJson(Json, JsonSize, root) || !root.IsObject()) {
+        return false;
+    }
+    const JsonValue* assetInfo = root.Find("asset");
+    const JsonValue* version = assetInfo != nullptr ? assetInfo->Find("version") : nullptr;
+    if (version == nullptr || version->GetString().compare(0, 2, "2.") != 0) {
+        return false;
+    }
+
+    const JsonValue* buffers = root.Find("buffers");
+    if (buffers != nullptr && !LoadBuffers(*buffers, BinaryChunk)) {
+        return false;
+    }
+
+    const JsonValue* bufferViews = root.Find("bufferViews");
+    for (const JsonValue& item : GetElements(bufferViews)) {
+        GltfBufferView view;
+        uint32_t buffer = GLTF_NONE;
+        if (!ReadIndex(item, "buffer", buffer) || buffer >= mBuffers.size()) {
+            return false;
+        }
+        view.Buffer = buffer;
+        view.ByteOffset = ReadSize(item, "byteOffset", 0);
+        view.ByteLength = ReadSize(item, "byteLength", UINT64_MAX);
+        const uint64_t stride = ReadSize(item, "byteStride", 0);
+        if (view.ByteOffset > mBuffers[buffer].GetSize() ||
+            view.ByteLength > mBuffers[buffer].GetSize() - view.ByteOffset || stride > 252) {
+            return false;
+        }
+        view.ByteStride = static_cast<uint32_t>(stride);
+        mBufferViews.push_back(view);
+    }
+
+    const JsonValue* accessors = root.Find("accessors");
+    for (const JsonValue& item : GetElements(accessors)) {
+        GltfAccessor accessor;
+        const JsonValue* type = item.Find("type");
+        const int64_t component = item.Find("componentType") != nullptr
+                                      ? item.Find("componentType")->GetInteger(0)
+                                      : 0;
+        const uint64_t count = ReadSize(item, "count", UINT64_MAX);
+        if (!ReadIndex(item, "bufferView", accessor.BufferView) ||
+            (accessor.BufferView != GLTF_NONE && accessor.BufferView >= mBufferViews.size()) ||
+            type == nullptr || !ParseAccessorType(type->GetString(), accessor.Type) ||
+            count >= GLTF_NONE) {
+            return false;
+        }
+        accessor.ComponentType = static_cast<GltfComponentType>(component);
+        if (GetComponentSize(accessor.ComponentType) == 0) {
+            return false;
+        }
+        accessor.ByteOffset = ReadSize(item, "byteOffset", 0);
+        accessor.Count = static_cast<uint32_t>(count);
+        accessor.Normalized = item.Find("normalized") != nullptr &&
+                              item.Find("normalized")->GetBool();
+        accessor.Sparse = item.Find("sparse") != nullptr;
+        accessor.HasBounds = ReadFloatArray(item, "min", accessor.Min, 3) > 0 &&
+                             ReadFloatArray(item, "max", accessor.Max, 3) > 0;
+        mAccessors.push_back(accessor);
+        const uint8_t* data = nullptr;
+        size_t stride = 0;
+        if (accessor.BufferView != GLTF_NONE &&
+            !LocateAccessor(static_cast<uint32_t>(mAccessors.size() - 1), data, stride)) {
+            return false;
+        }
+    }
+
+    auto isAccessor = [&](uint32_t Index) {
+        return Index == GLTF_NONE || Index < mAccessors.size();
+    };
+    const JsonValue* materials = root.Find("materials");
+    const size_t materialCount = materials != nullptr ? materials->GetSize() : 0;
+    const JsonValue* meshes = root.Find("meshes");
+    for (const JsonValue& item : GetElements(meshes)) {
+        GltfMesh mesh;
+        mesh.Name = ReadName(item);
+        const JsonValue* primitives = item.Find("primitives");
+        for (const JsonValue& source : GetElements(primitives)) {
+            GltfPrimitive primitive;
+            const JsonValue* attributes = source.Find("attributes");
+            if (attributes == nullptr ||
+                !ReadIndex(*attributes, "POSITION", primitive.Position) ||
+                !ReadIndex(*attributes, "NORMAL", primitive.Normal) ||
+                !ReadIndex(*attributes, "TEXCOORD_0", primitive.TexCoord0) ||
+                !ReadIndex(source, "indices", primitive.Indices) ||
+                !ReadIndex(source, "material", primitive.Material)) {
+                return false;
+            }
+            const int64_t mode = source.Find("mode") != nullptr
+                                     ? source.Find("mode")->GetInteger(-1)
+                                     : static_cast<int64_t>(GltfPrimitiveMode::Triangles);
+            if (!isAccessor(primitive.Position) || !isAccessor(primitive.Normal) ||
+                !isAccessor(primitive.TexCoord0) || !isAccessor(primitive.Indices) ||
+                (primitive.Material != GLTF_NONE && primitive.Material >= materialCount) ||
+                mode < 0 || mode > static_cast<int64_t>(GltfPrimitiveMode::TriangleFan)) {
+                return false;
+            }
+            primitive.Mode = static_cast<GltfPrimitiveMode>(mode);
+            mesh.Primitives.push_back(primitive);
+        }
+        mMeshes.push_back(std::move(mesh));
+    }
+
+    for (size_t i = 0; i < materialCount; ++i) {
+        const JsonValue& item = (*materials)[i];
+        GltfMaterial material;
+        material.Name = ReadName(item);
+        material.DoubleSided = item.Find("doubleSided") != nullptr &&
+                               item.Find("doubleSided")->GetBool();
+        if (const JsonValue* pbr = item.Find("pbrMetallicRoughness")) {
+            ReadFloatArray(*pbr, "baseColorFactor", &material.BaseColor.X, 4);
+            material.Metallic = pbr->Find("metallicFactor") != nullptr
+                                    ? pbr->Find("metallicFactor")->GetFloat(1.0f)
+                                    : 1.0f;
+            material.Roughness = pbr->Find("roughnessFactor") != nullptr
+                                     ? pbr->Find("roughnessFactor")->GetFloat(1.0f)
+                                     : 1.0f;
+            const JsonValue* texture = pbr->Find("baseColorTexture");
+            if (texture != nullptr && !ReadIndex(*texture, "index", material.BaseColorTexture)) {
+                return false;
+            }
+        }
+        mMaterials.push_back(std::move(material));
+    }
+
+    const JsonValue* nodes = root.Find("nodes");
+    const size_t nodeCount = nodes != nullptr ? nodes->GetSize() : 0;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        const JsonValue& item = (*nodes)[i];
+        GltfNode node;
+        node.Name = ReadName(item);
+        if (!ReadIndex(item, "mesh", node.Mesh) ||
+            (node.Mesh != GLTF_NONE && node.Mesh >= mMeshes.size())) {
+            return false;
+        }
+        const JsonValue* children = item.Find("children");
+        for (const JsonValue& child : GetElements(children)) {
+            const int64_t index = child.GetInteger(-1);
+            if (index < 0 || static_cast<uint64_t>(index) >= nodeCount) {
+                return false;
+            }
+            node.Children.push_back(static_cast<uint32_t>(index));
+        }
+
+        // glTF matrices are column-major for column vectors, which is exactly the row-major
+        // layout of the same transform for row vectors.
+        Matrix4 matrix;
+        if (ReadFloatArray(item, "matrix", &matrix.M[0][0], 16) == 16) {
+            if (!MatrixDecompose(matrix, node.Local.Translation, node.Local.Rotation,
+                                 node.Local.Scale)) {
+                node.Local.Scale = Vector3{0.0f, 0.0f, 0.0f}; // Degenerate: collapse it
+            }
+        } else {
+            ReadFloatArray(item, "translation", &node.Local.Translation.X, 3);
+            ReadFloatArray(item, "rotation", &node.Local.Rotation.X, 4);
+            ReadFloatArray(item, "scale", &node.Local.Scale.X, 3);
+        }
+        mNodes.push_back(std::move(node));
+    }
+
+    const JsonValue* scenes = root.Find("scenes");
+    for (const JsonValue& item : GetElements(scenes)) {
+        GltfScene scene;
+        scene.Name = ReadName(item);
+        const JsonValue* sceneNodes = item.Find("nodes");
+        for (const JsonValue& node : GetElements(sceneNodes)) {
+            const int64_t index = node.GetInteger(-1);
+            if (index < 0 || static_cast<uint64_t>(index) >= nodeCount) {
+                return false;
+            }
+            scene.Nodes.push_back(static_cast<uint32_t>(index));
+        }
+        mScenes.push_back(std::move(scene));
+    }
+    if (!ReadIndex(root, "scene", mDefaultScene) ||
+        (mDefaultScene != GLTF_NONE && mDefaultScene >= mScenes.size())) {
+        return false;
+    }
+    if (mDefaultScene == GLTF_NONE && !mScenes.empty()) {
+        mDefaultScene = 0;
+    }
+    return true;
+}
+
+Span<const uint8_t> GltfAsset::GetBufferBytes(uint32_t Buffer) const {
+    return Buffer < mBuffers.size() ? mBuffers[Buffer] : Span<const uint8_t>();
+}
+
+Span<const uint8_t> GltfAsset::GetBufferViewBytes(uint32_t View) const {
+    if (View >= mBufferViews.size()) {
+        return {};
+    }
+    const GltfBufferView& view = mBufferViews[View];
+    return Span<const uint8_t>(mBuffers[view.Buffer].GetData() + view.ByteOffset,
+                               static_cast<size_t>(view.ByteLength));
+}
+
+bool GltfAsset::LocateAccessor(uint32_t Accessor,
+                               const uint8_t*& OutData,
+                               size_t& OutStride) const {
+    if (Accessor >= mAccessors.size() || mAccessors[Accessor].BufferView == GLTF_NONE) {
+        return false;
+    }
+    const GltfAccessor& accessor = mAccessors[Accessor];
+    const GltfBufferView& view = mBufferViews[accessor.BufferView];
+    const uint64_t elementSize =
+        GetComponentSize(accessor.ComponentType) * GetComponentCount(accessor.Type);
+    const uint64_t stride = view.ByteStride != 0 ? view.ByteStride : elementSize;
+    const uint64_t span = accessor.Count > 0 ? stride * (accessor.Count - 1) + elementSize : 0;
+    if (accessor.ByteOffset > view.ByteLength || span > view.ByteLength - accessor.ByteOffset) {
+        return false;
+    }
+    OutData = mBuffers[view.Buffer].GetData() + view.ByteOffset + accessor.ByteOffset;
+    OutStride = static_cast<size_t>(stride);
+    return true;
+}
+
+bool GltfAsset::GetAccessorData(uint32_t Accessor,
+                                GltfComponentType Component,
+                                GltfAccessorType Type,
+                                size_t ElementSize,
+                                size_t Alignment,
+                                const uint8_t*& OutData) const {
+    const uint8_t* data = nullptr;
+    size_t stride = 0;
+    if (!LocateAccessor(Accessor, data, stride)) {
+        return false;
+    }
+    const GltfAccessor& accessor = mAccessors[Accessor];
+    if (accessor.ComponentType != Component || accessor.Type != Type || accessor.Sparse ||
+        accessor.Normalized || stride != ElementSize ||
+        reinterpret_cast<uintptr_t>(data) % Alignment != 0) {
+        return false;
+    }
+    OutData = data;
+    return true;
+}
+
+bool GltfAsset::ReadFloats(uint32_t Accessor, uint32_t ComponentsPerElement, float* Out) const {
+    if (Accessor >= mAccessors.size()) {
+        return false;
+    }
+    const GltfAccessor& accessor = mAccessors[Accessor];
+    if (GetComponentCount(accessor.Type) != ComponentsPerElement || accessor.Sparse) {
+        return false;
+    }
+    const size_t valueCount = static_cast<size_t>(accessor.Count) * ComponentsPerElement;
+    if (accessor.BufferView == GLTF_NONE) {
+        std::fill(Out, Out + valueCount, 0.0f);
+        return true;
+    }
+
+    const uint8_t* data = nullptr;
+    size_t stride = 0;
+    if (!LocateAccessor(Accessor, data, stride)) {
+        return false;
+    }
+    const uint32_t componentSize = GetComponentSize(accessor.ComponentType);
+    for (uint32_t element = 0; element < accessor.Count; ++element) {
+        const uint8_t* source = data + element * stride;
+        for (uint32_t c = 0; c < ComponentsPerElement; ++c) {
+            *Out++ = ReadComponent(source + c * componentSize, accessor.ComponentType,
+                                   accessor.Normalized);
+        }
+    }
+    return true;
+}
+
+bool GltfAsset::ReadIndices(uint32_t Accessor, std::vector<uint32_t>& Out) const {
+    const uint8_t* data = nullptr;
+    size_t stride = 0;
+    if (!LocateAccessor(Accessor, data, stride)) {
+        return false;
+    }
+    const GltfAccessor& accessor = mAccessors[Accessor];
+    if (accessor.Type != GltfAccessorType::Scalar || accessor.Sparse) {
+        return false;
+    }
+    Out.resize(accessor.Count);
+    for (uint32_t i = 0; i < accessor.Count; ++i) {
+        const uint8_t* source = data + i * stride;
+        switch (accessor.ComponentType) {
+        case GltfComponentType::UnsignedByte:
+            Out[i] = source[0];
+            break;
+        case GltfComponentType::UnsignedShort: {
+            uint16_t value;
+            std::memcpy(&value, source, sizeof(value));
+            Out[i] = value;
+            break;
+        }
+        case GltfComponentType::UnsignedInt:
+            std::memcpy(&Out[i], source, sizeof(uint32_t));
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+SceneNodeId AddGltfToScene(const std::shared_ptr<const GltfAsset>& Asset,
+                           const std::string& Name,
+                           Scene& Target,
+                           SceneNodeId Parent,
+                           GltfImportStats* OutStats) {
+    const GltfAsset& asset = *Asset;
+    std::vector<uint32_t> roots;
+    if (asset.GetDefaultScene() != GLTF_NONE) {
+        roots = asset.GetScenes()[asset.GetDefaultScene()].Nodes;
+    } else {
+        // No scenes: show every node that is nobody's child.
+        std::vector<bool> isChild(asset.GetNodes().size(), false);
+        for (const GltfNode& node : asset.GetNodes()) {
+            for (uint32_t child : node.Children) {
+                isChild[child] = true;
+            }
+        }
+        for (uint32_t i = 0; i < isChild.size(); ++i) {
+            if (!isChild[i]) {
+                roots.push_back(i);
+            }
+        }
+    }
+    if (roots.empty()) {
+        return INVALID_SCENE_NODE;
+    }
+
+    GltfImportStats stats;
+    Transform mirror;
+    mirror.Scale = Vector3{1.0f, 1.0f, -1.0f};
+    const SceneNodeId root = Target.GetHierarchy().CreateNode(Name, Parent, mirror);
+    ++stats.NodeCount;
+
+    GltfSceneBuilder builder(Asset, Target, stats);
+    for (uint32_t node : roots) {
+        builder.AddNode(node, root, 0);
+    }
+    if (OutStats != nullptr) {
+        *OutStats = stats;
+    }
+    return root;
+}
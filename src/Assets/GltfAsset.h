@@ -0,0 +1,248 @@
+﻿// src/Assets/GltfAsset.h
+// glTF 2.0 import for .gltf and .glb files. The JSON scene description is parsed into plain
+// structs; binary buffers stay in their memory-mapped files and accessors are read as typed spans
+// that point straight into those mappings.
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common/Span.h"
+#include "Files/MappedFile.h"
+#include "Math/Vector.h"
+#include "Scene/SceneHierarchy.h"
+
+class JsonValue;
+class Scene;
+
+// Marks an optional glTF index (material, indices accessor, ...) that is not present.
+constexpr uint32_t GLTF_NONE = 0xFFFFFFFFu;
+
+enum class GltfComponentType : uint32_t {
+    Byte = 5120,
+    UnsignedByte = 5121,
+    Short = 5122,
+    UnsignedShort = 5123,
+    UnsignedInt = 5125,
+    Float = 5126,
+};
+
+enum class GltfAccessorType : uint8_t { Scalar, Vec2, Vec3, Vec4, Mat2, Mat3, Mat4 };
+
+enum class GltfPrimitiveMode : uint32_t {
+    Points = 0,
+    Lines = 1,
+    LineLoop = 2,
+    LineStrip = 3,
+    Triangles = 4,
+    TriangleStrip = 5,
+    TriangleFan = 6,
+};
+
+struct GltfBufferView {
+    uint32_t Buffer = 0;
+    uint64_t ByteOffset = 0;
+    uint64_t ByteLength = 0;
+    uint32_t ByteStride = 0; // 0: tightly packed
+};
+
+struct GltfAccessor {
+    uint32_t BufferView = GLTF_NONE; // GLTF_NONE: all zeros
+    uint64_t ByteOffset = 0;
+    GltfComponentType ComponentType = GltfComponentType::Float;
+    GltfAccessorType Type = GltfAccessorType::Scalar;
+    uint32_t Count = 0;
+    bool Normalized = false;
+    bool Sparse = false; // Sparse substitutions are not applied
+    bool HasBounds = false;
+    float Min[3] = {0.0f, 0.0f, 0.0f}; // First three components of "min" and "max"
+    float Max[3] = {0.0f, 0.0f, 0.0f};
+};
+
+struct GltfPrimitive {
+    uint32_t Position = GLTF_NONE; // Accessor indices
+    uint32_t Normal = GLTF_NONE;
+    uint32_t TexCoord0 = GLTF_NONE;
+    uint32_t Indices = GLTF_NONE;
+    uint32_t Material = GLTF_NONE;
+    GltfPrimitiveMode Mode = GltfPrimitiveMode::Triangles;
+};
+
+struct GltfMesh {
+    std::string Name;
+    std::vector<GltfPrimitive> Primitives;
+};
+
+struct GltfMaterial {
+    std::string Name;
+    Vector4 BaseColor{1.0f, 1.0f, 1.0f, 1.0f};
+    float Metallic = 1.0f;
+    float Roughness = 1.0f;
+    uint32_t BaseColorTexture = GLTF_NONE;
+    bool DoubleSided = false;
+};
+
+struct GltfNode {
+    std::string Name;
+    uint32_t Mesh = GLTF_NONE;
+    std::vector<uint32_t> Children;
+    Transform Local; // From "matrix" or "translation"/"rotation"/"scale"
+};
+
+struct GltfScene {
+    std::string Name;
+    std::vector<uint32_t> Nodes;
+};
+
+// Element types GltfAsset::GetAccessorSpan can hand out without converting.
+template <typename T>
+struct GltfElementTraits;
+template <>
+struct GltfElementTraits<float> {
+    static constexpr GltfComponentType Component = GltfComponentType::Float;
+    static constexpr GltfAccessorType Type = GltfAccessorType::Scalar;
+};
+template <>
+struct GltfElementTraits<Vector2> {
+    static constexpr GltfComponentType Component = GltfComponentType::Float;
+    static constexpr GltfAccessorType Type = GltfAccessorType::Vec2;
+};
+template <>
+struct GltfElementTraits<Vector3> {
+    static constexpr GltfComponentType Component = GltfComponentType::Float;
+    static constexpr GltfAccessorType Type = GltfAccessorType::Vec3;
+};
+template <>
+struct GltfElementTraits<Vector4> {
+    static constexpr GltfComponentType Component = GltfComponentType::Float;
+    static constexpr GltfAccessorType Type = GltfAccessorType::Vec4;
+};
+template <>
+struct GltfElementTraits<uint8_t> {
+    static constexpr GltfComponentType Component = GltfComponentType::UnsignedByte;
+    static constexpr GltfAccessorType Type = GltfAccessorType::Scalar;
+};
+template <>
+struct GltfElementTraits<uint16_t> {
+    static constexpr GltfComponentType Component = GltfComponentType::UnsignedShort;
+    static constexpr GltfAccessorType Type = GltfAccessorType::Scalar;
+};
+template <>
+struct GltfElementTraits<uint32_t> {
+    static constexpr GltfComponentType Component = GltfComponentType::UnsignedInt;
+    static constexpr GltfAccessorType Type = GltfAccessorType::Scalar;
+};
+
+class GltfAsset {
+  public:
+    GltfAsset();
+    ~GltfAsset();
+
+    GltfAsset(const GltfAsset&) = delete;
+    GltfAsset& operator=(const GltfAsset&) = delete;
+
+    // Loads a .gltf (JSON with external or embedded buffers) or .glb (binary container) file.
+    // Buffer files are mapped, not read; only base64 "data:" buffers are decoded into memory.
+    // Returns false on I/O errors, malformed JSON or references outside the buffers.
+    bool Load(const std::filesystem::path& Path);
+
+    const std::vector<GltfBufferView>& GetBufferViews() const {
+        return mBufferViews;
+    }
+    const std::vector<GltfAccessor>& GetAccessors() const {
+        return mAccessors;
+    }
+    const std::vector<GltfMesh>& GetMeshes() const {
+        return mMeshes;
+    }
+    const std::vector<GltfMaterial>& GetMaterials() const {
+        return mMaterials;
+    }
+    const std::vector<GltfNode>& GetNodes() const {
+        return mNodes;
+    }
+    const std::vector<GltfScene>& GetScenes() const {
+        return mScenes;
+    }
+    // The scene to show on load: "scene" if present, else the first one, else GLTF_NONE.
+    uint32_t GetDefaultScene() const {
+        return mDefaultScene;
+    }
+
+    uint32_t GetBufferCount() const {
+        return static_cast<uint32_t>(mBuffers.size());
+    }
+    // Bytes of a buffer, or of a buffer view, inside the mapping.
+    Span<const uint8_t> GetBufferBytes(uint32_t Buffer) const;
+    Span<const uint8_t> GetBufferViewBytes(uint32_t View) const;
+
+    // Elements of an accessor as T, pointing into the mapping. Only succeeds when the stored
+    // layout already is an array of T: matching component and element type, no byte stride
+    // padding, suitable alignment and no sparse substitution. Otherwise use the Read* copies.
+    template <typename T>
+    bool GetAccessorSpan(uint32_t Accessor, Span<const T>& OutSpan) const {
+        const uint8_t* data = nullptr;
+        if (!GetAccessorData(Accessor, GltfElementTraits<T>::Component,
+                             GltfElementTraits<T>::Type, sizeof(T), alignof(T), data)) {
+            return false;
+        }
+        OutSpan = Span<const T>(reinterpret_cast<const T*>(data), mAccessors[Accessor].Count);
+        return true;
+    }
+
+    // Copies an accessor with ComponentsPerElement components per element into Out, which must
+    // hold Count * ComponentsPerElement floats. Follows byte strides and converts (normalized)
+    // integer components; accessors without a buffer view read as zeros.
+    bool ReadFloats(uint32_t Accessor, uint32_t ComponentsPerElement, float* Out) const;
+    // Copies an unsigned integer scalar accessor into Out, widening 8- and 16-bit indices.
+    bool ReadIndices(uint32_t Accessor, std::vector<uint32_t>& Out) const;
+
+  private:
+    bool Parse(const char* Json, size_t JsonSize, Span<const uint8_t> BinaryChunk);
+    bool LoadBuffers(const JsonValue& Buffers, Span<const uint8_t> BinaryChunk);
+    bool GetAccessorData(uint32_t Accessor,
+                         GltfComponentType Component,
+                         GltfAccessorType Type,
+                         size_t ElementSize,
+                         size_t Alignment,
+                         const uint8_t*& OutData) const;
+    // Start of element 0 and the distance between elements; false if it does not fit its view.
+    bool LocateAccessor(uint32_t Accessor, const uint8_t*& OutData, size_t& OutStride) const;
+
+    std::filesystem::path mDirectory;
+    MappedFile mFile;
+    std::vector<std::unique_ptr<MappedFile>> mBufferFiles;
+    std::vector<std::vector<uint8_t>> mDecodedBuffers;
+    std::vector<Span<const uint8_t>> mBuffers;
+
+    std::vector<GltfBufferView> mBufferViews;
+    std::vector<GltfAccessor> mAccessors;
+    std::vector<GltfMesh> mMeshes;
+    std::vector<GltfMaterial> mMaterials;
+    std::vector<GltfNode> mNodes;
+    std::vector<GltfScene> mScenes;
+    uint32_t mDefaultScene = GLTF_NONE;
+};
+
+struct GltfImportStats {
+    uint32_t NodeCount = 0;      // Scene nodes created, including the root and primitives
+    uint32_t PrimitiveCount = 0; // Distinct mesh primitives added to the scene
+    uint32_t MappedStreams = 0;  // Vertex and index streams used straight from the mapping
+    uint32_t CopiedStreams = 0;  // Streams that had to be converted
+    uint64_t MappedBytes = 0;
+    uint64_t CopiedBytes = 0;
+};
+
+// Adds the default scene of Asset to Target as a new node named Name under Parent. That root
+// mirrors Z, turning glTF's right-handed space into the renderer's left-handed one without
+// touching vertex data. glTF nodes become hierarchy nodes; each primitive of a node's mesh gets
+// a child named after its mesh and material, holding the instance. Mesh views keep Asset alive.
+// Returns the new root, or INVALID_SCENE_NODE if the asset has nothing to show.
+SceneNodeId AddGltfToScene(const std::shared_ptr<const GltfAsset>& Asset,
+                           const std::string& Name,
+                           Scene& Target,
+                           SceneNodeId Parent,
+                           GltfImportStats* OutStats = nullptr);
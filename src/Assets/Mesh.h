@@ -0,0 +1,98 @@
+﻿// src/Assets/Mesh.h
+// Indexed triangle mesh in the layout the renderer consumes: one array per vertex attribute.
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common/Span.h"
+#include "Math/Bounds.h"
+#include "Math/Vector.h"
+
+// A named range of the index list, e.g. an OBJ group or a glTF primitive.
+struct MeshPart {
+    std::string Name;
+    uint32_t FirstIndex = 0;
+    uint32_t IndexCount = 0;
+};
+
+// A short run of the index list with its own bounds, so it can be culled on its own. Meshlets
+// cover Indices in order and never straddle a part.
+struct Meshlet {
+    uint32_t FirstIndex;
+    uint16_t TriangleCount;
+    uint16_t VertexCount; // Distinct vertices the triangles use
+    Vector3 Center;       // Bounding sphere
+    float Radius;
+    // Every front face's normal is within the cone around ConeAxis whose angle has the sine
+    // ConeCutoff. A cutoff of 1 or more means the normals spread too far to cull the meshlet.
+    Vector3 ConeAxis;
+    float ConeCutoff;
+};
+
+// Coarser versions of a mesh kept at most.
+constexpr uint32_t MAX_MESH_LOD_COUNT = 8;
+
+// A coarser version of a mesh: its own triangle list over the same vertices.
+struct MeshLod {
+    uint32_t FirstIndex; // Into LodIndices
+    uint32_t IndexCount;
+    // How far, in object space, the surface may have moved from the full mesh's.
+    float Error;
+};
+
+struct Mesh {
+    std::vector<Vector3> Positions;
+    std::vector<Vector3> Normals;   // Empty, or one per position
+    std::vector<Vector2> TexCoords; // Empty, or one per position
+    std::vector<uint32_t> Indices;  // Triangle list, clockwise front faces
+    std::vector<MeshPart> Parts;    // Cover Indices in order, without gaps
+    std::vector<Meshlet> Meshlets;  // Empty, or cover Indices in order, without gaps
+    std::vector<uint32_t> LodIndices;
+    std::vector<MeshLod> Lods; // Coarsest last, errors growing; the full mesh is not listed
+    BoundingBox Bounds;
+
+    uint32_t GetVertexCount() const {
+        return static_cast<uint32_t>(Positions.size());
+    }
+    uint32_t GetTriangleCount() const {
+        return static_cast<uint32_t>(Indices.size() / 3);
+    }
+};
+
+// Renderable geometry wherever it lives: in a Mesh, or straight in a mapped file. Owner keeps
+// the memory behind the spans alive for as long as the view is used.
+struct MeshView {
+    Span<const Vector3> Positions;
+    Span<const Vector3> Normals;
+    Span<const Vector2> TexCoords;
+    Span<const uint32_t> Indices;
+    Span<const Meshlet> Meshlets;
+    Span<const uint32_t> LodIndices;
+    Span<const MeshLod> Lods;
+    BoundingBox Bounds;
+    std::shared_ptr<const void> Owner;
+
+    uint32_t GetVertexCount() const {
+        return static_cast<uint32_t>(Positions.GetSize());
+    }
+    uint32_t GetIndexCount() const {
+        return static_cast<uint32_t>(Indices.GetSize());
+    }
+};
+
+inline MeshView MakeMeshView(std::shared_ptr<const Mesh> Source) {
+    MeshView view;
+    view.Positions = Source->Positions;
+    view.Normals = Source->Normals;
+    view.TexCoords = Source->TexCoords;
+    view.Indices = Source->Indices;
+    view.Meshlets = Source->Meshlets;
+    view.LodIndices = Source->LodIndices;
+    view.Lods = Source->Lods;
+    view.Bounds = Source->Bounds;
+    view.Owner = std::move(Source);
+    return view;
+}
@@ -0,0 +1,333 @@
+﻿// src/Assets/MeshCache.cpp
+#include "MeshCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <system_error>
+
+#include "Common/Profiler.h"
+#include "Files/MappedFile.h"
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t COOKED_MESH_MAGIC = 0x48534D44; // "DMSH"
+constexpr uint32_t COOKED_MESH_VERSION = 3;
+constexpr uint32_t COOKED_MESH_HAS_NORMALS = 1u << 0;
+constexpr uint32_t COOKED_MESH_HAS_TEXCOORDS = 1u << 1;
+constexpr const char* COOKED_MESH_EXTENSION = ".dxmesh";
+
+// The file starts with this header; the streams follow at aligned offsets in the order
+// positions, normals, texcoords, indices, meshlets, LOD indices, LODs. All values are
+// little-endian, as on every target.
+struct CookedMeshHeader {
+    uint32_t Magic;
+    uint32_t Version;
+    uint64_t SourceKey;
+    uint64_t FileSize;
+    uint32_t VertexCount;
+    uint32_t IndexCount;
+    uint32_t Flags;
+    uint32_t MeshletCount;
+    uint32_t LodIndexCount;
+    uint32_t LodCount;
+    BoundingBox Bounds;
+    uint64_t PositionsOffset;
+    uint64_t NormalsOffset;
+    uint64_t TexCoordsOffset;
+    uint64_t IndicesOffset;
+    uint64_t MeshletsOffset;
+    uint64_t LodIndicesOffset;
+    uint64_t LodsOffset;
+};
+static_assert(sizeof(CookedMeshHeader) == 128, "The cooked header is part of the file format");
+static_assert(sizeof(Meshlet) == 40, "Meshlets are stored as they are laid out in memory");
+static_assert(sizeof(MeshLod) == 12, "LODs are stored as they are laid out in memory");
+
+uint64_t AlignUp(uint64_t Value) {
+    return (Value + COOKED_MESH_ALIGNMENT - 1) & ~(COOKED_MESH_ALIGNMENT - 1);
+}
+
+// FNV-1a, 64-bit.
+uint64_t HashBytes(const void* Data, size_t Size, uint64_t Hash = 0xCBF29CE484222325ull) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(Data);
+    for (size_t i = 0; i < Size; ++i) {
+        Hash = (Hash ^ bytes[i]) * 0x100000001B3ull;
+    }
+    return Hash;
+}
+
+double MillisecondsSince(Clock::time_point Start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+}
+
+// A temporary file name next to Path that no other writer, in this process or another, uses.
+std::filesystem::path MakeTemporaryPath(const std::filesystem::path& Path) {
+    static std::atomic<uint32_t> sNextTemporary{0};
+#ifdef _WIN32
+    const long long process = _getpid();
+#else
+    const long long process = getpid();
+#endif
+    std::filesystem::path temporary = Path;
+    temporary += "." + std::to_string(process) + "-" +
+                 std::to_string(sNextTemporary.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+    return temporary;
+}
+
+// Whether every value in Indices names one of VertexCount vertices.
+bool AreIndicesInRange(Span<const uint32_t> Indices, uint32_t VertexCount) {
+    uint32_t largest = 0;
+    for (uint32_t index : Indices) {
+        largest = std::max(largest, index);
+    }
+    return Indices.IsEmpty() || largest < VertexCount;
+}
+
+// Checks that a stream of Count elements of ElementSize bytes lies inside the file.
+bool IsStreamInFile(uint64_t Offset, uint64_t Count, uint64_t ElementSize, uint64_t FileSize) {
+    return Offset % COOKED_MESH_ALIGNMENT == 0 && Offset <= FileSize &&
+           Count <= (FileSize - Offset) / ElementSize;
+}
+
+} // anonymous namespace
+
+uint64_t ComputeCookedMeshKey(const std::filesystem::path& Source,
+                              const ObjImportSettings& Settings) {
+    std::error_code ec;
+    const uint64_t size = std::filesystem::file_size(Source, ec);
+    if (ec) {
+        return 0;
+    }
+    const int64_t writeTime =
+        std::filesystem::last_write_time(Source, ec).time_since_epoch().count();
+    if (ec) {
+        return 0;
+    }
+    const uint8_t settings[3] = {Settings.ConvertToLeftHanded, Settings.FlipTexCoordV,
+                                 Settings.Optimize.Enabled && Settings.Optimize.CacheSize > 0};
+    // Cooked copies hold the optimized order, so they are made again when it would differ.
+    const uint32_t optimize[2] = {Settings.Optimize.CacheSize,
+                                  Settings.Optimize.OptimizeVertexFetch ? 1u : 0u};
+
+    uint64_t key = HashBytes(&COOKED_MESH_VERSION, sizeof(COOKED_MESH_VERSION));
+    key = HashBytes(&size, sizeof(size), key);
+    key = HashBytes(&writeTime, sizeof(writeTime), key);
+    key = HashBytes(settings, sizeof(settings), key);
+    if (settings[2] != 0) {
+        key = HashBytes(optimize, sizeof(optimize), key);
+        key = HashBytes(&Settings.Optimize.OverdrawThreshold,
+                        sizeof(Settings.Optimize.OverdrawThreshold), key);
+    }
+    if (Settings.Meshlets.Enabled) {
+        const uint32_t meshlets[2] = {Settings.Meshlets.MaxVertices,
+                                      Settings.Meshlets.MaxTriangles};
+        key = HashBytes(meshlets, sizeof(meshlets), key);
+    }
+    if (Settings.Lods.Enabled) {
+        const uint32_t lods[2] = {Settings.Lods.MaxLodCount, Settings.Lods.MinTriangles};
+        const float reduction[2] = {Settings.Lods.Reduction, Settings.Lods.MaxRelativeError};
+        key = HashBytes(lods, sizeof(lods), key);
+        key = HashBytes(reduction, sizeof(reduction), key);
+    }
+    return key != 0 ? key : 1;
+}
+
+std::filesystem::path GetCookedMeshPath(const std::filesystem::path& Source) {
+    std::filesystem::path name = Source.filename();
+    name += COOKED_MESH_EXTENSION;
+    return Source.parent_path() / COOKED_MESH_FOLDER / name;
+}
+
+bool WriteCookedMesh(const std::filesystem::path& Path, const Mesh& Source, uint64_t SourceKey) {
+    const bool hasNormals = !Source.Normals.empty();
+    const bool hasTexCoords = !Source.TexCoords.empty();
+    if ((hasNormals && Source.Normals.size() != Source.Positions.size()) ||
+        (hasTexCoords && Source.TexCoords.size() != Source.Positions.size())) {
+        return false;
+    }
+
+    CookedMeshHeader header{};
+    header.Magic = COOKED_MESH_MAGIC;
+    header.Version = COOKED_MESH_VERSION;
+    header.SourceKey = SourceKey;
+    header.VertexCount = Source.GetVertexCount();
+    header.IndexCount = static_cast<uint32_t>(Source.Indices.size());
+    header.MeshletCount = static_cast<uint32_t>(Source.Meshlets.size());
+    header.LodIndexCount = static_cast<uint32_t>(Source.LodIndices.size());
+    header.LodCount = static_cast<uint32_t>(Source.Lods.size());
+    header.Flags = (hasNormals ? COOKED_MESH_HAS_NORMALS : 0) |
+                   (hasTexCoords ? COOKED_MESH_HAS_TEXCOORDS : 0);
+    header.Bounds = Source.Bounds;
+    header.PositionsOffset = AlignUp(sizeof(CookedMeshHeader));
+    header.NormalsOffset =
+        AlignUp(header.PositionsOffset + Source.Positions.size() * sizeof(Vector3));
+    header.TexCoordsOffset =
+        AlignUp(header.NormalsOffset + Source.Normals.size() * sizeof(Vector3));
+    header.IndicesOffset =
+        AlignUp(header.TexCoordsOffset + Source.TexCoords.size() * sizeof(Vector2));
+    header.MeshletsOffset =
+        AlignUp(header.IndicesOffset + Source.Indices.size() * sizeof(uint32_t));
+    header.LodIndicesOffset =
+        AlignUp(header.MeshletsOffset + Source.Meshlets.size() * sizeof(Meshlet));
+    header.LodsOffset =
+        AlignUp(header.LodIndicesOffset + Source.LodIndices.size() * sizeof(uint32_t));
+    header.FileSize = header.LodsOffset + Source.Lods.size() * sizeof(MeshLod);
+
+    std::error_code ec;
+    std::filesystem::create_directories(Path.parent_path(), ec);
+    // Two cooks of the same source may run at once; each renames its own complete file.
+    const std::filesystem::path temporary = MakeTemporaryPath(Path);
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        // Streams are written back to back, each preceded by zeros up to its offset.
+        static const char padding[COOKED_MESH_ALIGNMENT] = {};
+        uint64_t written = 0;
+        auto writeAt = [&](uint64_t Offset, const void* Data, size_t Size) {
+            file.write(padding, static_cast<std::streamsize>(Offset - written));
+            file.write(static_cast<const char*>(Data), static_cast<std::streamsize>(Size));
+            written = Offset + Size;
+        };
+        writeAt(0, &header, sizeof(header));
+        writeAt(header.PositionsOffset, Source.Positions.data(),
+                Source.Positions.size() * sizeof(Vector3));
+        writeAt(header.NormalsOffset, Source.Normals.data(),
+                Source.Normals.size() * sizeof(Vector3));
+        writeAt(header.TexCoordsOffset, Source.TexCoords.data(),
+                Source.TexCoords.size() * sizeof(Vector2));
+        writeAt(header.IndicesOffset, Source.Indices.data(),
+                Source.Indices.size() * sizeof(uint32_t));
+        writeAt(header.MeshletsOffset, Source.Meshlets.data(),
+                Source.Meshlets.size() * sizeof(Meshlet));
+        writeAt(header.LodIndicesOffset, Source.LodIndices.data(),
+                Source.LodIndices.size() * sizeof(uint32_t));
+        writeAt(header.LodsOffset, Source.Lods.data(), Source.Lods.size() * sizeof(MeshLod));
+        if (!file.flush()) {
+            file.close();
+            std::filesystem::remove(temporary, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temporary, Path, ec);
+    if (ec) {
+        std::filesystem::remove(temporary, ec);
+        return false;
+    }
+    return true;
+}
+
+bool LoadCookedMesh(const std::filesystem::path& Path, uint64_t ExpectedKey, MeshView& OutView) {
+    auto file = std::make_shared<MappedFile>();
+    if (!file->Open(Path) || file->GetSize() < sizeof(CookedMeshHeader)) {
+        return false;
+    }
+
+    CookedMeshHeader header;
+    std::memcpy(&header, file->GetData(), sizeof(header));
+    const uint64_t size = file->GetSize();
+    if (header.Magic != COOKED_MESH_MAGIC || header.Version != COOKED_MESH_VERSION ||
+        (ExpectedKey != 0 && header.SourceKey != ExpectedKey) || header.FileSize != size) {
+        return false;
+    }
+    const uint32_t vertexCount = header.VertexCount;
+    const uint32_t normalCount = header.Flags & COOKED_MESH_HAS_NORMALS ? vertexCount : 0;
+    const uint32_t texCoordCount = header.Flags & COOKED_MESH_HAS_TEXCOORDS ? vertexCount : 0;
+    if (!IsStreamInFile(header.PositionsOffset, vertexCount, sizeof(Vector3), size) ||
+        !IsStreamInFile(header.NormalsOffset, normalCount, sizeof(Vector3), size) ||
+        !IsStreamInFile(header.TexCoordsOffset, texCoordCount, sizeof(Vector2), size) ||
+        !IsStreamInFile(header.IndicesOffset, header.IndexCount, sizeof(uint32_t), size) ||
+        !IsStreamInFile(header.MeshletsOffset, header.MeshletCount, sizeof(Meshlet), size) ||
+        !IsStreamInFile(header.LodIndicesOffset, header.LodIndexCount, sizeof(uint32_t), size) ||
+        !IsStreamInFile(header.LodsOffset, header.LodCount, sizeof(MeshLod), size) ||
+        header.LodCount > MAX_MESH_LOD_COUNT || header.IndexCount % 3 != 0) {
+        return false;
+    }
+
+    const uint8_t* base = file->GetData();
+    MeshView view;
+    view.Positions = Span<const Vector3>(
+        reinterpret_cast<const Vector3*>(base + header.PositionsOffset), vertexCount);
+    view.Normals = Span<const Vector3>(
+        reinterpret_cast<const Vector3*>(base + header.NormalsOffset), normalCount);
+    view.TexCoords = Span<const Vector2>(
+        reinterpret_cast<const Vector2*>(base + header.TexCoordsOffset), texCoordCount);
+    view.Indices = Span<const uint32_t>(
+        reinterpret_cast<const uint32_t*>(base + header.IndicesOffset), header.IndexCount);
+    view.Meshlets = Span<const Meshlet>(
+        reinterpret_cast<const Meshlet*>(base + header.MeshletsOffset), header.MeshletCount);
+    view.LodIndices = Span<const uint32_t>(
+        reinterpret_cast<const uint32_t*>(base + header.LodIndicesOffset), header.LodIndexCount);
+    view.Lods = Span<const MeshLod>(reinterpret_cast<const MeshLod*>(base + header.LodsOffset),
+                                    header.LodCount);
+    // Everything is drawn straight from the file, so a damaged one must not get further than
+    // this: every index names a vertex, and every meshlet and LOD range lies in its indices.
+    if (!AreIndicesInRange(view.Indices, vertexCount) ||
+        !AreIndicesInRange(view.LodIndices, vertexCount)) {
+        return false;
+    }
+    for (const Meshlet& meshlet : view.Meshlets) {
+        if (meshlet.FirstIndex > header.IndexCount ||
+            meshlet.TriangleCount * 3u > header.IndexCount - meshlet.FirstIndex) {
+            return false;
+        }
+    }
+    for (const MeshLod& lod : view.Lods) {
+        if (lod.FirstIndex > header.LodIndexCount ||
+            lod.IndexCount > header.LodIndexCount - lod.FirstIndex || lod.IndexCount % 3 != 0) {
+            return false;
+        }
+    }
+    view.Bounds = header.Bounds;
+    view.Owner = std::move(file);
+    OutView = std::move(view);
+    return true;
+}
+
+bool LoadObjCached(const std::filesystem::path& Source,
+                   const ObjImportSettings& Settings,
+                   ThreadPool* Pool,
+                   MeshView& OutView,
+                   MeshCacheStats* OutStats) {
+    PROFILE_ZONE("LoadObjCached");
+    const Clock::time_point start = Clock::now();
+    MeshCacheStats stats;
+    const uint64_t key = ComputeCookedMeshKey(Source, Settings);
+    if (key == 0) {
+        return false;
+    }
+    const std::filesystem::path cookedPath = GetCookedMeshPath(Source);
+
+    stats.Hit = LoadCookedMesh(cookedPath, key, OutView);
+    if (!stats.Hit) {
+        auto mesh = std::make_shared<Mesh>();
+        if (!LoadObj(Source, Settings, Pool, *mesh, &stats.Import)) {
+            return false;
+        }
+        const Clock::time_point cookStart = Clock::now();
+        WriteCookedMesh(cookedPath, *mesh, key);
+        stats.CookMs = MillisecondsSince(cookStart);
+        OutView = MakeMeshView(std::move(mesh));
+    }
+
+    stats.LoadMs = MillisecondsSince(start);
+    if (OutStats != nullptr) {
+        *OutStats = stats;
+    }
+    return true;
+}
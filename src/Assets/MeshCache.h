@@ -0,0 +1,53 @@
+﻿// src/Assets/MeshCache.h
+// Cooked .dxmesh files: a mesh's vertex and index streams stored in the exact layout MeshView
+// reads, so loading one is a memory mapping and a header check with no parsing at all.
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include "Mesh.h"
+#include "ObjLoader.h"
+
+class ThreadPool;
+
+// Every stream in a cooked file starts at a multiple of this many bytes from the file start.
+// Mappings are page-aligned, so the streams are too.
+constexpr uint64_t COOKED_MESH_ALIGNMENT = 64;
+
+// Identifies the source a cooked file was made from: a hash of the source file's size and
+// last write time, the import settings and the cooked format version. 0 if the source cannot
+// be inspected.
+uint64_t ComputeCookedMeshKey(const std::filesystem::path& Source,
+                              const ObjImportSettings& Settings);
+
+// Folder next to a source file that holds its cooked copy.
+constexpr const char* COOKED_MESH_FOLDER = ".cooked";
+
+// Where Source's cooked copy lives: a COOKED_MESH_FOLDER next to it.
+std::filesystem::path GetCookedMeshPath(const std::filesystem::path& Source);
+
+// Writes Source to Path, through a temporary file of its own so readers never see a partial
+// one, even with other writers of the same Path.
+bool WriteCookedMesh(const std::filesystem::path& Path, const Mesh& Source, uint64_t SourceKey);
+
+// Maps a cooked file and points OutView into it; the view owns the mapping. Fails on I/O
+// errors, damaged headers, indices, meshlet or LOD ranges outside the mesh, or when
+// ExpectedKey is not 0 and differs from the recorded key.
+bool LoadCookedMesh(const std::filesystem::path& Path, uint64_t ExpectedKey, MeshView& OutView);
+
+struct MeshCacheStats {
+    bool Hit = false; // The cooked copy was current; Import is empty then
+    double LoadMs = 0.0;
+    double CookMs = 0.0; // Writing the cooked copy after an import
+    ObjLoadStats Import;
+};
+
+// Loads an OBJ through its cooked copy, importing and cooking it first when the copy is
+// missing or was made from another version of the file or with other settings. Failing to
+// write the copy is not an error; the imported mesh is used as is.
+bool LoadObjCached(const std::filesystem::path& Source,
+                   const ObjImportSettings& Settings,
+                   ThreadPool* Pool,
+                   MeshView& OutView,
+                   MeshCacheStats* OutStats = nullptr);
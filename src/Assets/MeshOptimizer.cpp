@@ -0,0 +1,395 @@
+﻿// src/Assets/MeshOptimizer.cpp
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "Common/Profiler.h"
+#include "Common/ThreadPool.h"
+
+namespace {
+
+constexpr uint32_t NO_VERTEX = ~0u;
+// Ranges with at least 1/DENSE_RANGE_RATIO as many indices as the mesh has vertices.
+constexpr uint32_t DENSE_RANGE_RATIO = 4;
+
+// A slice of one mesh's index list that is reordered on its own: a part, or the whole list of a
+// mesh without parts.
+struct IndexRange {
+    uint32_t Mesh;
+    uint32_t FirstIndex;
+    uint32_t IndexCount;
+    uint32_t ClusterCount;
+};
+
+// FIFO post-transform cache. A vertex is cached while fewer than Size vertices have been
+// transformed since it was; stamps count transforms, so nothing is ever evicted explicitly.
+class FifoCache {
+  public:
+    FifoCache(uint32_t VertexCount, uint32_t Size)
+        : mStamps(VertexCount, 0), mTime(Size + 1), mSize(Size) {
+    }
+
+    // Returns 1 if Vertex had to be transformed.
+    uint32_t Touch(uint32_t Vertex) {
+        if (mTime - mStamps[Vertex] <= mSize) {
+            return 0;
+        }
+        mStamps[Vertex] = mTime++;
+        return 1;
+    }
+    uint32_t TouchTriangle(const uint32_t* Corners) {
+        return Touch(Corners[0]) + Touch(Corners[1]) + Touch(Corners[2]);
+    }
+    void Flush() {
+        mTime += mSize + 1;
+    }
+    bool WasTouched(uint32_t Vertex) const {
+        return mStamps[Vertex] != 0;
+    }
+
+  private:
+    std::vector<uint32_t> mStamps;
+    uint32_t mTime;
+    uint32_t mSize;
+};
+
+// Tipsify (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced
+// Overdraw"): fans around one vertex at a time, moving on to the candidate that will still be
+// cached once its remaining triangles are emitted. Indices are local, every vertex in
+// [0, VertexCount) used. Appends the triangle order to OutOrder and the start of every run
+// that had to jump to a far vertex to OutClusters.
+void OrderForVertexCache(const std::vector<uint32_t>& Indices,
+                         uint32_t VertexCount,
+                         uint32_t CacheSize,
+                         std::vector<uint32_t>& OutOrder,
+                         std::vector<uint32_t>& OutClusters) {
+    const uint32_t triangleCount = static_cast<uint32_t>(Indices.size() / 3);
+    std::vector<uint32_t> offsets(VertexCount + 1, 0);
+    for (uint32_t index : Indices) {
+        ++offsets[index + 1];
+    }
+    for (uint32_t v = 0; v < VertexCount; ++v) {
+        offsets[v + 1] += offsets[v];
+    }
+    std::vector<uint32_t> live(VertexCount); // Triangles of the vertex not emitted yet
+    std::vector<uint32_t> adjacency(Indices.size());
+    for (uint32_t v = 0; v < VertexCount; ++v) {
+        live[v] = offsets[v + 1] - offsets[v];
+    }
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < Indices.size(); ++i) {
+            adjacency[fill[Indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<uint32_t> stamps(VertexCount, 0);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEnds;
+    std::vector<uint32_t> candidates;
+    OutOrder.reserve(triangleCount);
+    OutClusters.push_back(0);
+    uint32_t time = CacheSize + 1;
+    uint32_t cursor = 0;
+    uint32_t fan = VertexCount > 0 ? 0 : NO_VERTEX;
+    while (fan != NO_VERTEX) {
+        candidates.clear();
+        for (uint32_t a = offsets[fan]; a < offsets[fan + 1]; ++a) {
+            const uint32_t triangle = adjacency[a];
+            if (emitted[triangle]) {
+                continue;
+            }
+            emitted[triangle] = 1;
+            OutOrder.push_back(triangle);
+            for (uint32_t c = 0; c < 3; ++c) {
+                const uint32_t v = Indices[triangle * 3 + c];
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (time - stamps[v] > CacheSize) {
+                    stamps[v] = time++;
+                }
+            }
+        }
+
+        // The oldest candidate that survives its own fan, else any with triangles left.
+        uint32_t next = NO_VERTEX;
+        uint32_t best = 0;
+        for (uint32_t v : candidates) {
+            if (live[v] == 0) {
+                continue;
+            }
+            const uint32_t age = time - stamps[v];
+            const uint32_t priority = age + 2 * live[v] <= CacheSize ? age : 0;
+            if (next == NO_VERTEX || priority > best) {
+                next = v;
+                best = priority;
+            }
+        }
+        if (next == NO_VERTEX) {
+            while (!deadEnds.empty() && next == NO_VERTEX) {
+                const uint32_t v = deadEnds.back();
+                deadEnds.pop_back();
+                next = live[v] > 0 ? v : NO_VERTEX;
+            }
+            for (; next == NO_VERTEX && cursor < VertexCount; ++cursor) {
+                next = live[cursor] > 0 ? cursor : NO_VERTEX;
+            }
+            if (next != NO_VERTEX && OutOrder.size() > OutClusters.back()) {
+                OutClusters.push_back(static_cast<uint32_t>(OutOrder.size()));
+            }
+        }
+        fan = next;
+    }
+}
+
+// Cuts the clusters of Order further, wherever the triangles since the last cut have reached
+// Threshold times the ACMR of their whole cluster with a flushed cache. Small clusters sort
+// better against overdraw, and cutting only there bounds what they cost the vertex cache.
+void SplitClusters(const std::vector<uint32_t>& Indices,
+                   uint32_t VertexCount,
+                   const std::vector<uint32_t>& Order,
+                   uint32_t CacheSize,
+                   float Threshold,
+                   std::vector<uint32_t>& Clusters) {
+    FifoCache cache(VertexCount, CacheSize);
+    std::vector<uint32_t> split;
+    split.reserve(Clusters.size());
+    for (size_t k = 0; k < Clusters.size(); ++k) {
+        const uint32_t begin = Clusters[k];
+        const uint32_t end = k + 1 < Clusters.size() ? Clusters[k + 1]
+                                                     : static_cast<uint32_t>(Order.size());
+        cache.Flush();
+        uint32_t misses = 0;
+        for (uint32_t i = begin; i < end; ++i) {
+            misses += cache.TouchTriangle(&Indices[Order[i] * 3]);
+        }
+        const float limit = Threshold * static_cast<float>(misses) / (end - begin);
+
+        cache.Flush();
+        split.push_back(begin);
+        uint32_t start = begin;
+        misses = 0;
+        for (uint32_t i = begin; i + 1 < end; ++i) {
+            misses += cache.TouchTriangle(&Indices[Order[i] * 3]);
+            if (static_cast<float>(misses) <= limit * (i + 1 - start)) {
+                split.push_back(i + 1);
+                start = i + 1;
+                misses = 0;
+                cache.Flush();
+            }
+        }
+    }
+    Clusters.swap(split);
+}
+
+// Sorts the clusters of Order so the ones facing away from the center of the part, which
+// tend to hide the rest, come first (the view-independent sort of the Tipsify paper).
+void SortClustersForOverdraw(const std::vector<uint32_t>& Indices,
+                             const std::vector<uint32_t>& Vertices,
+                             const std::vector<Vector3>& Positions,
+                             const std::vector<uint32_t>& Clusters,
+                             std::vector<uint32_t>& Order) {
+    Vector3 center{};
+    for (uint32_t v : Vertices) {
+        center = center + Positions[v];
+    }
+    center = center * (1.0f / static_cast<float>(Vertices.size()));
+
+    const uint32_t clusterCount = static_cast<uint32_t>(Clusters.size());
+    std::vector<float> keys(clusterCount);
+    for (uint32_t k = 0; k < clusterCount; ++k) {
+        const uint32_t end =
+            k + 1 < clusterCount ? Clusters[k + 1] : static_cast<uint32_t>(Order.size());
+        Vector3 centroid{};
+        Vector3 normal{};
+        for (uint32_t i = Clusters[k]; i < end; ++i) {
+            const uint32_t* corners = &Indices[Order[i] * 3];
+            const Vector3& a = Positions[Vertices[corners[0]]];
+            const Vector3& b = Positions[Vertices[corners[1]]];
+            const Vector3& c = Positions[Vertices[corners[2]]];
+            centroid = centroid + a + b + c;
+            normal = normal + Cross(b - a, c - a); // Area-weighted, clockwise front faces
+        }
+        centroid = centroid * (1.0f / (3.0f * (end - Clusters[k])));
+        keys[k] = Length(normal) > 0.0f ? Dot(centroid - center, Normalize(normal)) : 0.0f;
+    }
+
+    std::vector<uint32_t> sorted(clusterCount);
+    for (uint32_t k = 0; k < clusterCount; ++k) {
+        sorted[k] = k;
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [&](uint32_t A, uint32_t B) { return keys[A] > keys[B]; });
+    std::vector<uint32_t> order;
+    order.reserve(Order.size());
+    for (uint32_t k : sorted) {
+        const uint32_t end =
+            k + 1 < clusterCount ? Clusters[k + 1] : static_cast<uint32_t>(Order.size());
+        order.insert(order.end(), Order.begin() + Clusters[k], Order.begin() + end);
+    }
+    Order.swap(order);
+}
+
+// Reorders the triangles of Range in place. Returns the number of clusters sorted.
+uint32_t OptimizeRange(Mesh& Target,
+                       const IndexRange& Range,
+                       const MeshOptimizeSettings& Settings) {
+    uint32_t* indices = Target.Indices.data() + Range.FirstIndex;
+    const uint32_t indexCount = Range.IndexCount - Range.IndexCount % 3;
+    if (indexCount < 6) {
+        return 0;
+    }
+
+    // The vertices the range uses, so the work is sized by the range rather than the mesh. A
+    // range using a fair share of the mesh numbers them through a table over the whole mesh;
+    // smaller ones search a sorted list.
+    std::vector<uint32_t> vertices;
+    std::vector<uint32_t> local(indices, indices + indexCount);
+    if (indexCount >= Target.GetVertexCount() / DENSE_RANGE_RATIO) {
+        std::vector<uint32_t> localOf(Target.GetVertexCount(), NO_VERTEX);
+        for (uint32_t& index : local) {
+            if (localOf[index] == NO_VERTEX) {
+                localOf[index] = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(index);
+            }
+            index = localOf[index];
+        }
+    } else {
+        vertices = local;
+        std::sort(vertices.begin(), vertices.end());
+        vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+        for (uint32_t& index : local) {
+            index = static_cast<uint32_t>(
+                std::lower_bound(vertices.begin(), vertices.end(), index) - vertices.begin());
+        }
+    }
+    const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> clusters;
+    OrderForVertexCache(local, vertexCount, Settings.CacheSize, order, clusters);
+    if (Settings.OverdrawThreshold > 0.0f) {
+        SplitClusters(local, vertexCount, order, Settings.CacheSize, Settings.OverdrawThreshold,
+                      clusters);
+        SortClustersForOverdraw(local, vertices, Target.Positions, clusters, order);
+    }
+
+    for (uint32_t t = 0; t < order.size(); ++t) {
+        for (uint32_t c = 0; c < 3; ++c) {
+            indices[t * 3 + c] = vertices[local[order[t] * 3 + c]];
+        }
+    }
+    return Settings.OverdrawThreshold > 0.0f ? static_cast<uint32_t>(clusters.size()) : 0;
+}
+
+template <typename T>
+void Scatter(std::vector<T>& Values, const std::vector<uint32_t>& NewIndex) {
+    if (Values.empty()) {
+        return;
+    }
+    std::vector<T> scattered(Values.size());
+    for (size_t i = 0; i < Values.size(); ++i) {
+        scattered[NewIndex[i]] = Values[i];
+    }
+    Values.swap(scattered);
+}
+
+// Renumbers the vertices in the order the indices first use them, so fetching them walks the
+// vertex streams front to back. Unused vertices move to the end.
+void OrderForVertexFetch(Mesh& Target) {
+    const uint32_t vertexCount = Target.GetVertexCount();
+    std::vector<uint32_t> newIndex(vertexCount, NO_VERTEX);
+    uint32_t next = 0;
+    for (uint32_t& index : Target.Indices) {
+        if (newIndex[index] == NO_VERTEX) {
+            newIndex[index] = next++;
+        }
+        index = newIndex[index];
+    }
+    for (uint32_t& v : newIndex) {
+        if (v == NO_VERTEX) {
+            v = next++;
+        }
+    }
+    Scatter(Target.Positions, newIndex);
+    Scatter(Target.Normals, newIndex);
+    Scatter(Target.TexCoords, newIndex);
+}
+
+} // anonymous namespace
+
+VertexCacheStats AnalyzeVertexCache(Span<const uint32_t> Indices,
+                                    uint32_t VertexCount,
+                                    uint32_t CacheSize) {
+    VertexCacheStats stats;
+    const size_t triangleCount = Indices.GetSize() / 3;
+    if (triangleCount == 0 || VertexCount == 0) {
+        return stats;
+    }
+    FifoCache cache(VertexCount, CacheSize);
+    uint64_t misses = 0;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        misses += cache.TouchTriangle(&Indices[t * 3]);
+    }
+    uint32_t usedCount = 0;
+    for (uint32_t v = 0; v < VertexCount; ++v) {
+        usedCount += cache.WasTouched(v) ? 1 : 0;
+    }
+    stats.Acmr = static_cast<float>(static_cast<double>(misses) / triangleCount);
+    stats.Atvr = static_cast<float>(static_cast<double>(misses) / usedCount);
+    return stats;
+}
+
+void OptimizeMeshes(Span<Mesh* const> Meshes,
+                    const MeshOptimizeSettings& Settings,
+                    ThreadPool* Pool,
+                    MeshOptimizeStats* OutStats) {
+    PROFILE_ZONE("OptimizeMeshes");
+    const uint32_t meshCount = static_cast<uint32_t>(Meshes.GetSize());
+    if (!Settings.Enabled || Settings.CacheSize == 0) {
+        return;
+    }
+
+    std::vector<MeshOptimizeStats> stats(meshCount);
+    std::vector<IndexRange> ranges;
+    for (uint32_t m = 0; m < meshCount; ++m) {
+        const Mesh& mesh = *Meshes[m];
+        if (mesh.Parts.empty()) {
+            ranges.push_back({m, 0, static_cast<uint32_t>(mesh.Indices.size()), 0});
+        }
+        for (const MeshPart& part : mesh.Parts) {
+            ranges.push_back({m, part.FirstIndex, part.IndexCount, 0});
+        }
+    }
+    // Largest first, so one big part does not start last and hold up the rest.
+    std::sort(ranges.begin(), ranges.end(), [](const IndexRange& A, const IndexRange& B) {
+        return A.IndexCount > B.IndexCount;
+    });
+
+    ParallelFor(Pool, meshCount, [&](uint32_t Index, uint32_t) {
+        const Mesh& mesh = *Meshes[Index];
+        stats[Index].Before =
+            AnalyzeVertexCache(mesh.Indices, mesh.GetVertexCount(), Settings.CacheSize);
+    });
+    ParallelFor(Pool, static_cast<uint32_t>(ranges.size()), [&](uint32_t Index, uint32_t) {
+        ranges[Index].ClusterCount = OptimizeRange(*Meshes[ranges[Index].Mesh], ranges[Index],
+                                                   Settings);
+    });
+    ParallelFor(Pool, meshCount, [&](uint32_t Index, uint32_t) {
+        Mesh& mesh = *Meshes[Index];
+        if (Settings.OptimizeVertexFetch) {
+            OrderForVertexFetch(mesh);
+        }
+        stats[Index].After =
+            AnalyzeVertexCache(mesh.Indices, mesh.GetVertexCount(), Settings.CacheSize);
+    });
+
+    for (const IndexRange& range : ranges) {
+        stats[range.Mesh].ClusterCount += range.ClusterCount;
+    }
+    if (OutStats != nullptr) {
+        std::copy(stats.begin(), stats.end(), OutStats);
+    }
+}
@@ -0,0 +1,53 @@
+﻿// src/Assets/MeshOptimizer.h
+// Import-time reordering of a mesh for the GPU: triangles for the post-transform vertex cache
+// (Tipsify), clusters of them against overdraw, then vertices in the order the indices fetch
+// them. Only the order changes; every part keeps its triangles and their winding.
+#pragma once
+
+#include <cstdint>
+
+#include "Common/Span.h"
+#include "Mesh.h"
+
+class ThreadPool;
+
+struct MeshOptimizeSettings {
+    bool Enabled = true;
+    // Post-transform cache entries the triangle order is tuned and measured for.
+    uint32_t CacheSize = 16;
+    // Clusters are cut finer for overdraw sorting as long as their ACMR stays within this factor
+    // of the cache-optimized order. 0 keeps the cache order as is.
+    float OverdrawThreshold = 1.05f;
+    bool OptimizeVertexFetch = true;
+};
+
+// Post-transform cache efficiency of an index list, simulated with a FIFO cache.
+struct VertexCacheStats {
+    float Acmr = 0.0f; // Average cache misses per triangle: 0.5 is ideal, 3 is none hit
+    float Atvr = 0.0f; // Average transforms per vertex: 1 is ideal
+};
+
+struct MeshOptimizeStats {
+    VertexCacheStats Before;
+    VertexCacheStats After;
+    uint32_t ClusterCount = 0; // Sorted for overdraw, over all parts
+};
+
+VertexCacheStats AnalyzeVertexCache(Span<const uint32_t> Indices,
+                                    uint32_t VertexCount,
+                                    uint32_t CacheSize);
+
+// Optimizes every mesh in Meshes. The parts of all meshes are reordered in parallel on Pool,
+// which may be null. OutStats is null or holds one entry per mesh.
+void OptimizeMeshes(Span<Mesh* const> Meshes,
+                    const MeshOptimizeSettings& Settings,
+                    ThreadPool* Pool,
+                    MeshOptimizeStats* OutStats = nullptr);
+
+inline void OptimizeMesh(Mesh& Target,
+                         const MeshOptimizeSettings& Settings,
+                         ThreadPool* Pool,
+                         MeshOptimizeStats* OutStats = nullptr) {
+    Mesh* meshes[1] = {&Target};
+    OptimizeMeshes(Span<Mesh* const>(meshes, 1), Settings, Pool, OutStats);
+}
@@ -0,0 +1,434 @@
+﻿// src/Assets/MeshSimplifier.cpp
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "Common/Profiler.h"
+#include "Common/ThreadPool.h"
+
+namespace {
+
+constexpr uint32_t NO_VERTEX = ~0u;
+// Passes of independent collapses before giving up on reaching a target.
+constexpr uint32_t SIMPLIFY_MAX_PASSES = 64;
+// Candidates sorted per pass, as a multiple of the collapses still needed. Collapses sharing a
+// vertex with one made earlier in the pass are skipped, so more are needed than are made. Near a
+// target few are needed, and the cheapest may all turn triangles over, so at least a fraction of
+// all candidates is always sorted.
+constexpr uint32_t SIMPLIFY_CANDIDATE_FACTOR = 3;
+constexpr uint32_t SIMPLIFY_CANDIDATE_FRACTION = 8;
+
+// Sum of squared distances to a set of planes, as a symmetric 4x4 matrix.
+struct Quadric {
+    double XX = 0.0, XY = 0.0, XZ = 0.0, XW = 0.0;
+    double YY = 0.0, YZ = 0.0, YW = 0.0;
+    double ZZ = 0.0, ZW = 0.0;
+    double WW = 0.0;
+
+    void AddPlane(const Vector3& Normal, double D) {
+        const double x = Normal.X;
+        const double y = Normal.Y;
+        const double z = Normal.Z;
+        XX += x * x;
+        XY += x * y;
+        XZ += x * z;
+        XW += x * D;
+        YY += y * y;
+        YZ += y * z;
+        YW += y * D;
+        ZZ += z * z;
+        ZW += z * D;
+        WW += D * D;
+    }
+    void Add(const Quadric& Other) {
+        XX += Other.XX;
+        XY += Other.XY;
+        XZ += Other.XZ;
+        XW += Other.XW;
+        YY += Other.YY;
+        YZ += Other.YZ;
+        YW += Other.YW;
+        ZZ += Other.ZZ;
+        ZW += Other.ZW;
+        WW += Other.WW;
+    }
+    double Evaluate(const Vector3& P) const {
+        const double x = P.X;
+        const double y = P.Y;
+        const double z = P.Z;
+        const double error = x * (XX * x + 2.0 * (XY * y + XZ * z + XW)) +
+                             y * (YY * y + 2.0 * (YZ * z + YW)) + z * (ZZ * z + 2.0 * ZW) + WW;
+        return std::max(error, 0.0);
+    }
+};
+
+struct EdgeCollapse {
+    uint32_t From;
+    uint32_t To;
+    double Cost;
+};
+
+// Collapses the vertices of one mesh pass by pass, keeping the triangle list current so LODs
+// can be taken from it on the way down. Collapses work on the first vertex at each position;
+// a vertex sharing its position with others is on a seam and stays.
+class LodSimplifier {
+  public:
+    LodSimplifier(const Mesh& Source, double MaxError)
+        : mPositions(Source.Positions), mIndices(Source.Indices),
+          mMaxCost(MaxError * MaxError) {
+        const uint32_t vertexCount = Source.GetVertexCount();
+        FindCanonicalVertices(vertexCount);
+        LockBorders();
+        mQuadrics.resize(vertexCount);
+        for (size_t i = 0; i + 2 < mIndices.size(); i += 3) {
+            const uint32_t a = mCanonical[mIndices[i]];
+            const uint32_t b = mCanonical[mIndices[i + 1]];
+            const uint32_t c = mCanonical[mIndices[i + 2]];
+            const Vector3 normal =
+                Cross(mPositions[b] - mPositions[a], mPositions[c] - mPositions[a]);
+            const float length = Length(normal);
+            if (length <= 0.0f) {
+                continue;
+            }
+            const Vector3 unit = normal * (1.0f / length);
+            Quadric plane;
+            plane.AddPlane(unit, -Dot(unit, mPositions[a]));
+            mQuadrics[a].Add(plane);
+            mQuadrics[b].Add(plane);
+            mQuadrics[c].Add(plane);
+        }
+        mCollapsedTo.assign(vertexCount, NO_VERTEX);
+    }
+
+    uint32_t GetTriangleCount() const {
+        return static_cast<uint32_t>(mIndices.size() / 3);
+    }
+    const std::vector<uint32_t>& GetIndices() const {
+        return mIndices;
+    }
+    // The largest error of any collapse so far, as a distance.
+    float GetError() const {
+        return static_cast<float>(std::sqrt(mError));
+    }
+
+    // Collapses edges until at most TargetTriangles are left. Returns false if it got stuck on
+    // the way, at the error limit or with nothing left that may collapse.
+    bool Simplify(uint32_t TargetTriangles) {
+        for (uint32_t pass = 0; pass < SIMPLIFY_MAX_PASSES; ++pass) {
+            if (GetTriangleCount() <= TargetTriangles) {
+                return true;
+            }
+            // A collapse inside the surface removes two triangles.
+            const uint32_t needed = (GetTriangleCount() - TargetTriangles + 1) / 2;
+            if (RunPass(needed) == 0) {
+                return false;
+            }
+        }
+        return GetTriangleCount() <= TargetTriangles;
+    }
+
+  private:
+    void FindCanonicalVertices(uint32_t VertexCount) {
+        std::vector<uint32_t> order(VertexCount);
+        for (uint32_t v = 0; v < VertexCount; ++v) {
+            order[v] = v;
+        }
+        auto bits = [this](uint32_t V, uint32_t Out[3]) {
+            std::memcpy(Out, &mPositions[V], sizeof(uint32_t) * 3);
+        };
+        // Equal positions end up together, lowest vertex first.
+        std::sort(order.begin(), order.end(), [&](uint32_t A, uint32_t B) {
+            uint32_t a[4];
+            uint32_t b[4];
+            bits(A, a);
+            bits(B, b);
+            a[3] = A;
+            b[3] = B;
+            return std::lexicographical_compare(a, a + 4, b, b + 4);
+        });
+        mCanonical.resize(VertexCount);
+        mLocked.assign(VertexCount, 0);
+        for (uint32_t i = 0; i < VertexCount;) {
+            uint32_t end = i + 1;
+            uint32_t first[3];
+            bits(order[i], first);
+            for (; end < VertexCount; ++end) {
+                uint32_t next[3];
+                bits(order[end], next);
+                if (!std::equal(first, first + 3, next)) {
+                    break;
+                }
+            }
+            for (uint32_t k = i; k < end; ++k) {
+                mCanonical[order[k]] = order[i];
+            }
+            mLocked[order[i]] = end - i > 1 ? 1 : 0;
+            i = end;
+        }
+    }
+
+    // Locks the vertices of edges that do not have exactly two triangles: open borders and
+    // non-manifold fans.
+    void LockBorders() {
+        std::vector<uint64_t> edges;
+        edges.reserve(mIndices.size());
+        for (size_t i = 0; i + 2 < mIndices.size(); i += 3) {
+            for (uint32_t c = 0; c < 3; ++c) {
+                const uint32_t a = mCanonical[mIndices[i + c]];
+                const uint32_t b = mCanonical[mIndices[i + (c + 1) % 3]];
+                edges.push_back(static_cast<uint64_t>(std::min(a, b)) << 32 | std::max(a, b));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        for (size_t i = 0; i < edges.size();) {
+            size_t end = i + 1;
+            while (end < edges.size() && edges[end] == edges[i]) {
+                ++end;
+            }
+            if (end - i != 2) {
+                mLocked[static_cast<uint32_t>(edges[i] >> 32)] = 1;
+                mLocked[static_cast<uint32_t>(edges[i])] = 1;
+            }
+            i = end;
+        }
+    }
+
+    // Whether moving From onto To turns any of From's other triangles over.
+    bool FlipsTriangle(uint32_t From, uint32_t To) const {
+        const Vector3& target = mPositions[To];
+        for (uint32_t a = mAdjacencyOffsets[From]; a < mAdjacencyOffsets[From + 1]; ++a) {
+            const uint32_t* corners = &mIndices[mAdjacency[a] * 3];
+            Vector3 p[3];
+            uint32_t moved = 3;
+            bool hasTo = false;
+            for (uint32_t c = 0; c < 3; ++c) {
+                const uint32_t v = mCanonical[corners[c]];
+                p[c] = mPositions[v];
+                moved = v == From ? c : moved;
+                hasTo = hasTo || v == To;
+            }
+            if (hasTo || moved == 3) {
+                continue; // Collapses away
+            }
+            const Vector3 before = Cross(p[1] - p[0], p[2] - p[0]);
+            p[moved] = target;
+            const Vector3 after = Cross(p[1] - p[0], p[2] - p[0]);
+            if (Dot(before, after) <= 0.0f) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // The copy of To that From's triangles go on with: the one the triangles collapsing along
+    // the edge use. From shares its position with nothing, so its triangles all lie on one
+    // side of any seam through To; copies across the seam carry other normals or UVs.
+    uint32_t FindTargetCopy(uint32_t From, uint32_t To) const {
+        for (uint32_t a = mAdjacencyOffsets[From]; a < mAdjacencyOffsets[From + 1]; ++a) {
+            const uint32_t* corners = &mIndices[mAdjacency[a] * 3];
+            for (uint32_t c = 0; c < 3; ++c) {
+                if (mCanonical[corners[c]] == To) {
+                    return corners[c];
+                }
+            }
+        }
+        return To;
+    }
+
+    // Marks V and every vertex of its triangles, which no later collapse of the pass may move.
+    void TouchOneRing(uint32_t V) {
+        mTouched[V] = 1;
+        for (uint32_t a = mAdjacencyOffsets[V]; a < mAdjacencyOffsets[V + 1]; ++a) {
+            const uint32_t* corners = &mIndices[mAdjacency[a] * 3];
+            for (uint32_t c = 0; c < 3; ++c) {
+                mTouched[mCanonical[corners[c]]] = 1;
+            }
+        }
+    }
+
+    // Makes up to Needed collapses, cheapest first. Each keeps the vertices around its edge in
+    // place for the rest of the pass, so its flip test still holds. Returns how many.
+    uint32_t RunPass(uint32_t Needed) {
+        const uint32_t vertexCount = static_cast<uint32_t>(mPositions.size());
+        const uint32_t triangleCount = GetTriangleCount();
+
+        // Vertex to triangle lists, for the flip test.
+        mAdjacencyOffsets.assign(vertexCount + 1, 0);
+        for (uint32_t index : mIndices) {
+            ++mAdjacencyOffsets[mCanonical[index] + 1];
+        }
+        for (uint32_t v = 0; v < vertexCount; ++v) {
+            mAdjacencyOffsets[v + 1] += mAdjacencyOffsets[v];
+        }
+        mAdjacency.resize(mIndices.size());
+        {
+            std::vector<uint32_t> fill(mAdjacencyOffsets.begin(), mAdjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < mIndices.size(); ++i) {
+                mAdjacency[fill[mCanonical[mIndices[i]]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        // One candidate per edge, in the cheaper direction that may collapse. Inner edges show
+        // up in both of their triangles; the one with the lower vertex first stands for both.
+        mCandidates.clear();
+        for (uint32_t t = 0; t < triangleCount; ++t) {
+            for (uint32_t c = 0; c < 3; ++c) {
+                const uint32_t a = mCanonical[mIndices[t * 3 + c]];
+                const uint32_t b = mCanonical[mIndices[t * 3 + (c + 1) % 3]];
+                if (a > b || (mLocked[a] && mLocked[b])) {
+                    continue;
+                }
+                const double toB = mLocked[a] ? -1.0 : GetCost(a, b);
+                const double toA = mLocked[b] ? -1.0 : GetCost(b, a);
+                if (toA < 0.0 || (toB >= 0.0 && toB <= toA)) {
+                    mCandidates.push_back({a, b, toB});
+                } else {
+                    mCandidates.push_back({b, a, toA});
+                }
+            }
+        }
+        const size_t considered = std::min(
+            mCandidates.size(), std::max(static_cast<size_t>(Needed) * SIMPLIFY_CANDIDATE_FACTOR,
+                                         mCandidates.size() / SIMPLIFY_CANDIDATE_FRACTION));
+        auto cheaper = [](const EdgeCollapse& A, const EdgeCollapse& B) {
+            return A.Cost < B.Cost;
+        };
+        if (considered < mCandidates.size()) {
+            std::nth_element(mCandidates.begin(), mCandidates.begin() + considered,
+                             mCandidates.end(), cheaper);
+        }
+        std::sort(mCandidates.begin(), mCandidates.begin() + considered, cheaper);
+
+        mTouched.assign(vertexCount, 0);
+        uint32_t collapsed = 0;
+        for (size_t i = 0; i < considered && collapsed < Needed; ++i) {
+            const EdgeCollapse& collapse = mCandidates[i];
+            if (collapse.Cost > mMaxCost) {
+                break;
+            }
+            if (mTouched[collapse.From] || mTouched[collapse.To] ||
+                FlipsTriangle(collapse.From, collapse.To)) {
+                continue;
+            }
+            TouchOneRing(collapse.From);
+            TouchOneRing(collapse.To);
+            mLocked[collapse.From] = 1; // Gone; nothing refers to it any more
+            mCollapsedTo[collapse.From] = FindTargetCopy(collapse.From, collapse.To);
+            mQuadrics[collapse.To].Add(mQuadrics[collapse.From]);
+            mError = std::max(mError, collapse.Cost);
+            ++collapsed;
+        }
+        if (collapsed == 0) {
+            return 0;
+        }
+
+        // Points the triangles at the surviving vertices and drops the ones that collapsed.
+        size_t written = 0;
+        for (size_t i = 0; i < mIndices.size(); i += 3) {
+            uint32_t corners[3];
+            uint32_t canonical[3];
+            for (uint32_t c = 0; c < 3; ++c) {
+                corners[c] = mIndices[i + c];
+                const uint32_t to = mCollapsedTo[mCanonical[corners[c]]];
+                corners[c] = to != NO_VERTEX ? to : corners[c];
+                canonical[c] = mCanonical[corners[c]];
+            }
+            if (canonical[0] == canonical[1] || canonical[1] == canonical[2] ||
+                canonical[0] == canonical[2]) {
+                continue;
+            }
+            mIndices[written++] = corners[0];
+            mIndices[written++] = corners[1];
+            mIndices[written++] = corners[2];
+        }
+        mIndices.resize(written);
+        return collapsed;
+    }
+
+    // Error of moving From onto To, over the planes around both.
+    double GetCost(uint32_t From, uint32_t To) const {
+        return mQuadrics[From].Evaluate(mPositions[To]) + mQuadrics[To].Evaluate(mPositions[To]);
+    }
+
+    const std::vector<Vector3>& mPositions;
+    std::vector<uint32_t> mIndices;
+    std::vector<uint32_t> mCanonical;   // First vertex at the same position
+    std::vector<uint8_t> mLocked;       // Canonical vertices that may not be collapsed
+    std::vector<uint32_t> mCollapsedTo; // Copy of the vertex a collapsed one went to
+    std::vector<Quadric> mQuadrics;     // Canonical vertices
+    double mMaxCost;
+    double mError = 0.0;
+
+    // RunPass scratch.
+    std::vector<uint32_t> mAdjacencyOffsets;
+    std::vector<uint32_t> mAdjacency;
+    std::vector<EdgeCollapse> mCandidates;
+    std::vector<uint8_t> mTouched;
+};
+
+void BuildChain(Mesh& Target, const MeshLodSettings& Settings, MeshLodStats& OutStats) {
+    Target.LodIndices.clear();
+    Target.Lods.clear();
+    const uint32_t maxLodCount = std::min(Settings.MaxLodCount, MAX_MESH_LOD_COUNT);
+    const float reduction = std::min(std::max(Settings.Reduction, 0.01f), 0.99f);
+    if (maxLodCount == 0 || Target.GetTriangleCount() < Settings.MinTriangles ||
+        IsEmpty(Target.Bounds)) {
+        return;
+    }
+
+    const float diagonal = Length(Target.Bounds.Max - Target.Bounds.Min);
+    LodSimplifier simplifier(Target, static_cast<double>(diagonal * Settings.MaxRelativeError));
+    uint32_t previous = Target.GetTriangleCount();
+    while (Target.Lods.size() < maxLodCount && previous >= Settings.MinTriangles) {
+        const uint32_t target = static_cast<uint32_t>(previous * reduction);
+        const bool reached = simplifier.Simplify(target);
+        const uint32_t triangles = simplifier.GetTriangleCount();
+        // Short of the target, a LOD is still kept if it got at least halfway there.
+        if (previous - triangles < (previous - target) / 2 || triangles == 0) {
+            break;
+        }
+        MeshLod lod;
+        lod.FirstIndex = static_cast<uint32_t>(Target.LodIndices.size());
+        lod.IndexCount = triangles * 3;
+        lod.Error = simplifier.GetError();
+        Target.LodIndices.insert(Target.LodIndices.end(), simplifier.GetIndices().begin(),
+                                 simplifier.GetIndices().end());
+        Target.Lods.push_back(lod);
+        previous = triangles;
+        if (!reached) {
+            break;
+        }
+    }
+
+    OutStats.LodCount = static_cast<uint32_t>(Target.Lods.size());
+    if (!Target.Lods.empty()) {
+        OutStats.CoarsestTriangles = Target.Lods.back().IndexCount / 3;
+        OutStats.CoarsestError = Target.Lods.back().Error;
+    }
+}
+
+} // anonymous namespace
+
+void BuildLodChains(Span<Mesh* const> Meshes,
+                    const MeshLodSettings& Settings,
+                    ThreadPool* Pool,
+                    MeshLodStats* OutStats) {
+    PROFILE_ZONE("BuildLodChains");
+    const uint32_t meshCount = static_cast<uint32_t>(Meshes.GetSize());
+    std::vector<MeshLodStats> stats(meshCount);
+    ParallelFor(Pool, meshCount, [&](uint32_t Index, uint32_t) {
+        Mesh& mesh = *Meshes[Index];
+        if (Settings.Enabled) {
+            BuildChain(mesh, Settings, stats[Index]);
+        } else {
+            mesh.LodIndices.clear();
+            mesh.Lods.clear();
+        }
+    });
+    if (OutStats != nullptr) {
+        std::copy(stats.begin(), stats.end(), OutStats);
+    }
+}
@@ -0,0 +1,49 @@
+﻿// src/Assets/MeshSimplifier.h
+// Quadric error metric simplification (Garland and Heckbert) into a chain of LODs. Vertices are
+// collapsed onto their neighbors, never moved or created, so every LOD is just another index
+// list over the mesh's own vertex streams.
+#pragma once
+
+#include <cstdint>
+
+#include "Common/Span.h"
+#include "Mesh.h"
+
+class ThreadPool;
+
+struct MeshLodSettings {
+    bool Enabled = true;
+    uint32_t MaxLodCount = 4; // At most MAX_MESH_LOD_COUNT
+    // Each LOD aims for this fraction of the previous one's triangles.
+    float Reduction = 0.5f;
+    // Meshes, and LODs, below this many triangles are not simplified further.
+    uint32_t MinTriangles = 256;
+    // Simplification stops once the error would exceed this fraction of the diagonal of the
+    // mesh's bounds.
+    float MaxRelativeError = 0.05f;
+};
+
+struct MeshLodStats {
+    uint32_t LodCount = 0;
+    uint32_t CoarsestTriangles = 0;
+    float CoarsestError = 0.0f;
+};
+
+// Replaces the LODs of every mesh in Meshes, one mesh per job on Pool, which may be null.
+// OutStats is null or holds one entry per mesh.
+//
+// Only vertices inside the surface move. Vertices on open borders and attribute seams, where
+// vertices share a position, stay in place so no LOD opens cracks; collapses that would turn a
+// triangle over are skipped.
+void BuildLodChains(Span<Mesh* const> Meshes,
+                    const MeshLodSettings& Settings,
+                    ThreadPool* Pool,
+                    MeshLodStats* OutStats = nullptr);
+
+inline void BuildLodChain(Mesh& Target,
+                          const MeshLodSettings& Settings,
+                          ThreadPool* Pool,
+                          MeshLodStats* OutStats = nullptr) {
+    Mesh* meshes[1] = {&Target};
+    BuildLodChains(Span<Mesh* const>(meshes, 1), Settings, Pool, OutStats);
+}
@@ -0,0 +1,153 @@
+﻿// src/Assets/MeshletBuilder.cpp
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Common/Profiler.h"
+#include "Common/ThreadPool.h"
+
+namespace {
+
+constexpr uint32_t NO_MESHLET = ~0u;
+constexpr uint32_t MESHLET_MAX_LIMIT = 0xFFFF;
+
+// Cuts the triangles of [FirstIndex, FirstIndex + IndexCount) into meshlets appended to Out.
+// Owner holds, per vertex, the meshlet that last used it.
+void ScanRange(const std::vector<uint32_t>& Indices,
+               uint32_t FirstIndex,
+               uint32_t IndexCount,
+               uint32_t MaxVertices,
+               uint32_t MaxTriangles,
+               std::vector<uint32_t>& Owner,
+               std::vector<Meshlet>& Out) {
+    const uint32_t end = FirstIndex + IndexCount - IndexCount % 3;
+    uint32_t current = NO_MESHLET;
+    for (uint32_t i = FirstIndex; i < end; i += 3) {
+        const uint32_t a = Indices[i];
+        const uint32_t b = Indices[i + 1];
+        const uint32_t c = Indices[i + 2];
+        uint32_t added = 0;
+        if (current != NO_MESHLET) {
+            added = (Owner[a] != current ? 1 : 0) + (Owner[b] != current && b != a ? 1 : 0) +
+                    (Owner[c] != current && c != a && c != b ? 1 : 0);
+        }
+        if (current == NO_MESHLET || Out.back().VertexCount + added > MaxVertices ||
+            Out.back().TriangleCount == MaxTriangles) {
+            current = static_cast<uint32_t>(Out.size());
+            Out.push_back(Meshlet{});
+            Out.back().FirstIndex = i;
+            added = 1 + (b != a ? 1 : 0) + (c != a && c != b ? 1 : 0);
+        }
+        Owner[a] = current;
+        Owner[b] = current;
+        Owner[c] = current;
+        Meshlet& meshlet = Out.back();
+        meshlet.VertexCount = static_cast<uint16_t>(meshlet.VertexCount + added);
+        ++meshlet.TriangleCount;
+    }
+}
+
+} // anonymous namespace
+
+void ComputeMeshletBounds(Span<const Vector3> Positions,
+                          Span<const uint32_t> Indices,
+                          Meshlet& Out) {
+    const uint32_t first = Out.FirstIndex;
+    const uint32_t end = first + Out.TriangleCount * 3u;
+
+    // Sphere around the box of the corners: not minimal, but tight enough for meshlets, which
+    // are small and close to flat.
+    BoundingBox box;
+    for (uint32_t i = first; i < end; ++i) {
+        Grow(box, Positions[Indices[i]]);
+    }
+    const Vector3 center = (box.Min + box.Max) * 0.5f;
+    float radiusSquared = 0.0f;
+    for (uint32_t i = first; i < end; ++i) {
+        const Vector3 offset = Positions[Indices[i]] - center;
+        radiusSquared = std::max(radiusSquared, Dot(offset, offset));
+    }
+    Out.Center = center;
+    Out.Radius = std::sqrt(radiusSquared);
+
+    // Cone around the average front-face normal, clockwise winding facing the viewer.
+    Vector3 axis{};
+    for (uint32_t i = first; i < end; i += 3) {
+        const Vector3& a = Positions[Indices[i]];
+        const Vector3 normal =
+            Cross(Positions[Indices[i + 1]] - a, Positions[Indices[i + 2]] - a);
+        const float length = Length(normal);
+        if (length > 0.0f) {
+            axis = axis + normal * (1.0f / length);
+        }
+    }
+    const float axisLength = Length(axis);
+    Out.ConeAxis = axisLength > 0.0f ? axis * (1.0f / axisLength) : Vector3{};
+    Out.ConeCutoff = 1.0f;
+    if (axisLength <= 0.0f) {
+        return;
+    }
+    float minDot = 1.0f;
+    for (uint32_t i = first; i < end; i += 3) {
+        const Vector3& a = Positions[Indices[i]];
+        const Vector3 normal =
+            Cross(Positions[Indices[i + 1]] - a, Positions[Indices[i + 2]] - a);
+        const float length = Length(normal);
+        if (length > 0.0f) {
+            minDot = std::min(minDot, Dot(normal, Out.ConeAxis) / length);
+        }
+    }
+    if (minDot > 0.0f) {
+        Out.ConeCutoff = std::sqrt(std::max(0.0f, 1.0f - minDot * minDot));
+    }
+}
+
+void BuildMeshlets(Mesh& Target,
+                   const MeshletSettings& Settings,
+                   ThreadPool* Pool,
+                   MeshletStats* OutStats) {
+    PROFILE_ZONE("BuildMeshlets");
+    Target.Meshlets.clear();
+    if (!Settings.Enabled || Target.Indices.size() < 3) {
+        if (OutStats != nullptr) {
+            *OutStats = MeshletStats{};
+        }
+        return;
+    }
+    const uint32_t maxVertices = std::min(std::max(Settings.MaxVertices, 3u), MESHLET_MAX_LIMIT);
+    const uint32_t maxTriangles =
+        std::min(std::max(Settings.MaxTriangles, 1u), MESHLET_MAX_LIMIT);
+
+    std::vector<uint32_t> owner(Target.GetVertexCount(), NO_MESHLET);
+    if (Target.Parts.empty()) {
+        ScanRange(Target.Indices, 0, static_cast<uint32_t>(Target.Indices.size()), maxVertices,
+                  maxTriangles, owner, Target.Meshlets);
+    }
+    for (const MeshPart& part : Target.Parts) {
+        ScanRange(Target.Indices, part.FirstIndex, part.IndexCount, maxVertices, maxTriangles,
+                  owner, Target.Meshlets);
+    }
+
+    const uint32_t meshletCount = static_cast<uint32_t>(Target.Meshlets.size());
+    ParallelFor(Pool, meshletCount, [&](uint32_t Index, uint32_t) {
+        ComputeMeshletBounds(Target.Positions, Target.Indices, Target.Meshlets[Index]);
+    });
+
+    if (OutStats != nullptr) {
+        MeshletStats stats;
+        uint64_t vertices = 0;
+        uint64_t triangles = 0;
+        for (const Meshlet& meshlet : Target.Meshlets) {
+            stats.ConeCount += meshlet.ConeCutoff < 1.0f ? 1 : 0;
+            vertices += meshlet.VertexCount;
+            triangles += meshlet.TriangleCount;
+        }
+        stats.MeshletCount = meshletCount;
+        stats.AverageVertices = meshletCount > 0 ? static_cast<float>(vertices) / meshletCount : 0;
+        stats.AverageTriangles =
+            meshletCount > 0 ? static_cast<float>(triangles) / meshletCount : 0;
+        *OutStats = stats;
+    }
+}
@@ -0,0 +1,39 @@
+﻿// src/Assets/MeshletBuilder.h
+// Splits a mesh's index list into meshlets: runs of triangles with bounded vertex and triangle
+// counts, each with a bounding sphere and a normal cone for culling it against the view.
+#pragma once
+
+#include <cstdint>
+
+#include "Common/Span.h"
+#include "Mesh.h"
+
+class ThreadPool;
+
+struct MeshletSettings {
+    bool Enabled = true;
+    // Limits per meshlet, the common mesh shader sizes. Both are capped at 65535, as stored, and
+    // one triangle always fits.
+    uint32_t MaxVertices = 64;
+    uint32_t MaxTriangles = 124;
+};
+
+struct MeshletStats {
+    uint32_t MeshletCount = 0;
+    uint32_t ConeCount = 0; // Meshlets whose normals are close enough to cull by their cone
+    float AverageVertices = 0.0f;
+    float AverageTriangles = 0.0f;
+};
+
+// Replaces Target.Meshlets. The triangles are taken in index order, which after MeshOptimizer
+// is already local, so every meshlet is a contiguous run and the index list is left as is.
+// Bounds are computed in parallel on Pool, which may be null.
+void BuildMeshlets(Mesh& Target,
+                   const MeshletSettings& Settings,
+                   ThreadPool* Pool,
+                   MeshletStats* OutStats = nullptr);
+
+// Fills in the bounding sphere and normal cone of Out from the triangles it covers.
+void ComputeMeshletBounds(Span<const Vector3> Positions,
+                          Span<const uint32_t> Indices,
+                          Meshlet& Out);
@@ -0,0 +1,691 @@
+﻿// src/Assets/ObjLoader.cpp
+#include "ObjLoader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "Common/Profiler.h"
+#include "Common/ThreadPool.h"
+#include "Files/MappedFile.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Big enough that per-chunk bookkeeping vanishes, small enough to balance a file of a few
+// megabytes across every core.
+constexpr size_t OBJ_CHUNK_BYTES = 1u << 20;
+// Vertex ranges handed to one thread while merging and gathering.
+constexpr uint32_t OBJ_GATHER_BATCH = 1u << 16;
+// Slot value of a corner that has no texture coordinate or normal.
+constexpr int32_t OBJ_MISSING_INDEX = std::numeric_limits<int32_t>::min();
+constexpr uint32_t OBJ_EMPTY_BUCKET = 0xFFFFFFFFu;
+
+const double POWERS_OF_TEN[23] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                  1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                  1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+double Milliseconds(Clock::time_point Start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+}
+
+// A part boundary inside a chunk, FirstCorner counting the chunk's own triangle corners.
+struct ObjGroupStart {
+    std::string Name;
+    uint32_t FirstCorner = 0;
+};
+
+// Everything parsed from one line-aligned slice of the file. Attribute indices are 0-based and
+// global, except for relative ones, which count from the chunk's own attributes until the chunk
+// bases are known.
+struct ObjChunk {
+    const char* Begin = nullptr;
+    const char* End = nullptr;
+
+    std::vector<Vector3> Positions;
+    std::vector<Vector2> TexCoords;
+    std::vector<Vector3> Normals;
+    // Position, texcoord and normal slot of every triangle corner, three per corner.
+    std::vector<int32_t> Corners;
+    // Entries of Corners that still need the chunk base added.
+    std::vector<uint32_t> RelativeSlots;
+    std::vector<ObjGroupStart> Groups;
+
+    uint32_t PositionBase = 0;
+    uint32_t TexCoordBase = 0;
+    uint32_t NormalBase = 0;
+    uint32_t CornerBase = 0;
+    bool HasTexCoords = false;
+    bool HasNormals = false;
+    bool Failed = false;
+};
+
+// One face corner as written in the file, already made 0-based.
+struct ObjCorner {
+    int32_t Slots[3];
+    uint32_t RelativeMask; // Bit per slot that is relative to the chunk
+};
+
+inline bool IsBlank(char C) {
+    return C == ' ' || C == '\t' || C == '\r';
+}
+
+inline bool IsDigit(char C) {
+    return C >= '0' && C <= '9';
+}
+
+inline const char* SkipBlanks(const char* P, const char* End) {
+    while (P < End && IsBlank(*P)) {
+        ++P;
+    }
+    return P;
+}
+
+inline const char* SkipLine(const char* P, const char* End) {
+    const void* newline = std::memchr(P, '\n', static_cast<size_t>(End - P));
+    return newline != nullptr ? static_cast<const char*>(newline) + 1 : End;
+}
+
+// Rare spellings (inf, nan, hex floats) go through the C library on a terminated copy.
+bool ParseFloatFallback(const char*& P, const char* End, float& OutValue) {
+    char buffer[64];
+    size_t length = 0;
+    while (P + length < End && length + 1 < sizeof(buffer) && !IsBlank(P[length]) &&
+           P[length] != '\n') {
+        buffer[length] = P[length];
+        ++length;
+    }
+    buffer[length] = '\0';
+    char* parsedEnd = nullptr;
+    OutValue = std::strtof(buffer, &parsedEnd);
+    if (parsedEnd == buffer) {
+        return false;
+    }
+    P += parsedEnd - buffer;
+    return true;
+}
+
+// Parses the decimal floats OBJ exporters write: sign, digits, fraction and exponent. Up to 19
+// significant digits are accumulated exactly and scaled once in double precision, which rounds
+// to the same float as strtof in all but pathological cases, with no locale or allocation.
+bool ParseFloat(const char*& P, const char* End, float& OutValue) {
+    const char* s = P;
+    bool negative = false;
+    if (s < End && (*s == '-' || *s == '+')) {
+        negative = *s == '-';
+        ++s;
+    }
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int significant = 0;
+    bool anyDigits = false;
+    for (; s < End && IsDigit(*s); ++s) {
+        anyDigits = true;
+        if (significant < 19) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*s - '0');
+            significant += mantissa != 0 ? 1 : 0;
+        } else {
+            ++exponent;
+        }
+    }
+    if (s < End && *s == '.') {
+        ++s;
+        for (; s < End && IsDigit(*s); ++s) {
+            anyDigits = true;
+            if (significant < 19) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*s - '0');
+                significant += mantissa != 0 ? 1 : 0;
+                --exponent;
+            }
+        }
+    }
+    if (!anyDigits) {
+        return ParseFloatFallback(P, End, OutValue);
+    }
+
+    if (s < End && (*s == 'e' || *s == 'E')) {
+        const char* e = s + 1;
+        bool negativeExponent = false;
+        if (e < End && (*e == '-' || *e == '+')) {
+            negativeExponent = *e == '-';
+            ++e;
+        }
+        int value = 0;
+        bool exponentDigits = false;
+        for (; e < End && IsDigit(*e); ++e) {
+            value = value < 10000 ? value * 10 + (*e - '0') : value;
+            exponentDigits = true;
+        }
+        if (exponentDigits) {
+            exponent += negativeExponent ? -value : value;
+            s = e;
+        }
+    }
+
+    double value = static_cast<double>(mantissa);
+    if (mantissa != 0 && exponent >= -22 && exponent < 0) {
+        value /= POWERS_OF_TEN[-exponent];
+    } else if (mantissa != 0 && exponent > 0 && exponent <= 22) {
+        value *= POWERS_OF_TEN[exponent];
+    } else if (mantissa != 0 && exponent != 0) {
+        value *= std::pow(10.0, exponent);
+    }
+    OutValue = static_cast<float>(negative ? -value : value);
+    P = s;
+    return true;
+}
+
+bool ParseIndex(const char*& P, const char* End, int32_t& OutValue) {
+    const char* s = P;
+    bool negative = false;
+    if (s < End && (*s == '-' || *s == '+')) {
+        negative = *s == '-';
+        ++s;
+    }
+    if (s >= End || !IsDigit(*s)) {
+        return false;
+    }
+    int64_t value = 0;
+    for (; s < End && IsDigit(*s); ++s) {
+        value = value * 10 + (*s - '0');
+        if (value > std::numeric_limits<int32_t>::max()) {
+            return false;
+        }
+    }
+    OutValue = static_cast<int32_t>(negative ? -value : value);
+    P = s;
+    return true;
+}
+
+// Reads up to Count floats into Out, leaving the rest untouched. Returns how many were read.
+uint32_t ParseFloats(const char*& P, const char* End, float* Out, uint32_t Count) {
+    uint32_t parsed = 0;
+    for (; parsed < Count; ++parsed) {
+        P = SkipBlanks(P, End);
+        if (P >= End || *P == '\n' || !ParseFloat(P, End, Out[parsed])) {
+            break;
+        }
+    }
+    return parsed;
+}
+
+// Turns a 1-based (or negative, relative) OBJ index into a 0-based slot. Relative slots are
+// resolved against LocalCount, the chunk's own attribute count so far.
+inline bool ToSlot(int32_t Raw, size_t LocalCount, int32_t& OutSlot, bool& OutRelative) {
+    if (Raw > 0) {
+        OutSlot = Raw - 1;
+        OutRelative = false;
+        return true;
+    }
+    if (Raw < 0) {
+        OutSlot = static_cast<int32_t>(static_cast<int64_t>(LocalCount) + Raw);
+        OutRelative = true;
+        return true;
+    }
+    return false;
+}
+
+bool ParseCorner(const char*& P, const char* End, const ObjChunk& Chunk, ObjCorner& OutCorner) {
+    int32_t raw[3] = {0, 0, 0};
+    if (!ParseIndex(P, End, raw[0])) {
+        return false;
+    }
+    if (P < End && *P == '/') {
+        ++P;
+        if (P < End && *P != '/' && !ParseIndex(P, End, raw[1])) {
+            return false;
+        }
+        if (P < End && *P == '/') {
+            ++P;
+            if (!ParseIndex(P, End, raw[2])) {
+                return false;
+            }
+        }
+    }
+
+    const size_t counts[3] = {Chunk.Positions.size(), Chunk.TexCoords.size(),
+                              Chunk.Normals.size()};
+    OutCorner.RelativeMask = 0;
+    for (uint32_t slot = 0; slot < 3; ++slot) {
+        bool relative = false;
+        if (slot > 0 && raw[slot] == 0) {
+            OutCorner.Slots[slot] = OBJ_MISSING_INDEX;
+        } else if (!ToSlot(raw[slot], counts[slot], OutCorner.Slots[slot], relative)) {
+            return false;
+        }
+        OutCorner.RelativeMask |= relative ? 1u << slot : 0u;
+    }
+    return true;
+}
+
+void EmitCorner(ObjChunk& Chunk, const ObjCorner& Corner) {
+    const uint32_t first = static_cast<uint32_t>(Chunk.Corners.size());
+    for (uint32_t slot = 0; slot < 3; ++slot) {
+        Chunk.Corners.push_back(Corner.Slots[slot]);
+        if (Corner.RelativeMask & (1u << slot)) {
+            Chunk.RelativeSlots.push_back(first + slot);
+        }
+    }
+    Chunk.HasTexCoords |= Corner.Slots[1] != OBJ_MISSING_INDEX;
+    Chunk.HasNormals |= Corner.Slots[2] != OBJ_MISSING_INDEX;
+}
+
+// Fan-triangulates the polygon as its corners are read, so no polygon is ever buffered.
+bool ParseFace(const char*& P,
+               const char* End,
+               const ObjImportSettings& Settings,
+               ObjChunk& Chunk) {
+    ObjCorner first{};
+    ObjCorner previous{};
+    uint32_t cornerCount = 0;
+    for (;;) {
+        P = SkipBlanks(P, End);
+        if (P >= End || *P == '\n') {
+            break;
+        }
+        ObjCorner corner{};
+        if (!ParseCorner(P, End, Chunk, corner)) {
+            return false;
+        }
+        if (cornerCount == 0) {
+            first = corner;
+        } else if (cornerCount >= 2) {
+            EmitCorner(Chunk, first);
+            EmitCorner(Chunk, Settings.ConvertToLeftHanded ? corner : previous);
+            EmitCorner(Chunk, Settings.ConvertToLeftHanded ? previous : corner);
+        }
+        previous = corner;
+        ++cornerCount;
+    }
+    return true;
+}
+
+void BeginGroup(const char* P, const char* End, ObjChunk& Chunk) {
+    P = SkipBlanks(P, End);
+    const char* nameEnd = P;
+    while (nameEnd < End && *nameEnd != '\n') {
+        ++nameEnd;
+    }
+    while (nameEnd > P && IsBlank(nameEnd[-1])) {
+        --nameEnd;
+    }
+    Chunk.Groups.push_back(
+        {std::string(P, nameEnd), static_cast<uint32_t>(Chunk.Corners.size() / 3)});
+}
+
+void ParseChunk(ObjChunk& Chunk, const ObjImportSettings& Settings) {
+    PROFILE_ZONE("Parse OBJ chunk");
+    const float zSign = Settings.ConvertToLeftHanded ? -1.0f : 1.0f;
+    const char* end = Chunk.End;
+    const char* p = Chunk.Begin;
+    while (p < end) {
+        p = SkipBlanks(p, end);
+        if (p >= end) {
+            break;
+        }
+
+        const char* next = p + 1;
+        const bool blankAfter1 = next < end && IsBlank(p[1]);
+        const bool blankAfter2 = p + 2 < end && IsBlank(p[2]);
+        if (p[0] == 'v' && blankAfter1) {
+            p = next;
+            float xyz[3] = {0.0f, 0.0f, 0.0f};
+            if (ParseFloats(p, end, xyz, 3) != 3) {
+                Chunk.Failed = true;
+                return;
+            }
+            Chunk.Positions.push_back({xyz[0], xyz[1], xyz[2] * zSign});
+        } else if (p[0] == 'v' && next < end && p[1] == 't' && blankAfter2) {
+            p += 2;
+            float uv[2] = {0.0f, 0.0f};
+            if (ParseFloats(p, end, uv, 2) == 0) {
+                Chunk.Failed = true;
+                return;
+            }
+            Chunk.TexCoords.push_back({uv[0], Settings.FlipTexCoordV ? 1.0f - uv[1] : uv[1]});
+        } else if (p[0] == 'v' && next < end && p[1] == 'n' && blankAfter2) {
+            p += 2;
+            float xyz[3] = {0.0f, 0.0f, 0.0f};
+            if (ParseFloats(p, end, xyz, 3) != 3) {
+                Chunk.Failed = true;
+                return;
+            }
+            Chunk.Normals.push_back({xyz[0], xyz[1], xyz[2] * zSign});
+        } else if (p[0] == 'f' && blankAfter1) {
+            p = next;
+            if (!ParseFace(p, end, Settings, Chunk)) {
+                Chunk.Failed = true;
+                return;
+            }
+        } else if ((p[0] == 'o' || p[0] == 'g') && blankAfter1) {
+            BeginGroup(next, end, Chunk);
+        } else if (end - p > 6 && std::memcmp(p, "usemtl", 6) == 0 && IsBlank(p[6])) {
+            BeginGroup(p + 6, end, Chunk);
+        }
+        // Comments, smoothing groups, lines, points and material libraries are skipped.
+        p = SkipLine(p, end);
+    }
+}
+
+// Adds the chunk bases to relative slots and checks every slot against the attribute totals.
+bool ResolveChunk(ObjChunk& Chunk, const uint32_t Totals[3]) {
+    const uint32_t bases[3] = {Chunk.PositionBase, Chunk.TexCoordBase, Chunk.NormalBase};
+    for (uint32_t slot : Chunk.RelativeSlots) {
+        Chunk.Corners[slot] += static_cast<int32_t>(bases[slot % 3]);
+    }
+    const size_t count = Chunk.Corners.size();
+    for (size_t i = 0; i < count; i += 3) {
+        for (uint32_t slot = 0; slot < 3; ++slot) {
+            const int32_t value = Chunk.Corners[i + slot];
+            const bool missing = slot > 0 && value == OBJ_MISSING_INDEX;
+            if (!missing && (value < 0 || static_cast<uint32_t>(value) >= Totals[slot])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+inline uint32_t HashCorner(const int32_t* Slots) {
+    uint32_t h = static_cast<uint32_t>(Slots[0]) * 0x9E3779B1u;
+    h ^= static_cast<uint32_t>(Slots[1]) * 0x85EBCA77u;
+    h ^= static_cast<uint32_t>(Slots[2]) * 0xC2B2AE3Du;
+    return h ^ (h >> 15);
+}
+
+// Open-addressing map from (position, texcoord, normal) to a vertex index. Keys live in one flat
+// array in first-seen order, which is also the output vertex order.
+class CornerMap {
+  public:
+    explicit CornerMap(uint32_t ExpectedVertices) {
+        uint32_t capacity = 16;
+        while (capacity < ExpectedVertices * 2u && capacity < (1u << 31)) {
+            capacity <<= 1;
+        }
+        mBuckets.assign(capacity, OBJ_EMPTY_BUCKET);
+        mKeys.reserve(static_cast<size_t>(ExpectedVertices) * 3);
+    }
+
+    uint32_t Insert(const int32_t* Slots) {
+        if ((GetVertexCount() + 1) * 2 > mBuckets.size()) {
+            Grow();
+        }
+        const uint32_t mask = static_cast<uint32_t>(mBuckets.size()) - 1;
+        for (uint32_t bucket = HashCorner(Slots) & mask;; bucket = (bucket + 1) & mask) {
+            const uint32_t vertex = mBuckets[bucket];
+            if (vertex == OBJ_EMPTY_BUCKET) {
+                mBuckets[bucket] = GetVertexCount();
+                mKeys.insert(mKeys.end(), Slots, Slots + 3);
+                return mBuckets[bucket];
+            }
+            if (std::memcmp(&mKeys[static_cast<size_t>(vertex) * 3], Slots, 3 * sizeof(int32_t)) ==
+                0) {
+                return vertex;
+            }
+        }
+    }
+
+    uint32_t GetVertexCount() const {
+        return static_cast<uint32_t>(mKeys.size() / 3);
+    }
+    const int32_t* GetKeys() const {
+        return mKeys.data();
+    }
+
+  private:
+    void Grow() {
+        mBuckets.assign(mBuckets.size() * 2, OBJ_EMPTY_BUCKET);
+        const uint32_t mask = static_cast<uint32_t>(mBuckets.size()) - 1;
+        for (uint32_t vertex = 0; vertex < GetVertexCount(); ++vertex) {
+            uint32_t bucket = HashCorner(&mKeys[static_cast<size_t>(vertex) * 3]) & mask;
+            while (mBuckets[bucket] != OBJ_EMPTY_BUCKET) {
+                bucket = (bucket + 1) & mask;
+            }
+            mBuckets[bucket] = vertex;
+        }
+    }
+
+    std::vector<uint32_t> mBuckets;
+    std::vector<int32_t> mKeys;
+};
+
+BoundingBox ComputeBounds(const std::vector<Vector3>& Positions, ThreadPool* Pool) {
+    const uint32_t count = static_cast<uint32_t>(Positions.size());
+    const uint32_t batches = (count + OBJ_GATHER_BATCH - 1) / OBJ_GATHER_BATCH;
+    std::vector<BoundingBox> partial(batches);
+    ParallelFor(Pool, batches, [&](uint32_t Batch, uint32_t) {
+        const uint32_t last = std::min(count, (Batch + 1) * OBJ_GATHER_BATCH);
+        for (uint32_t i = Batch * OBJ_GATHER_BATCH; i < last; ++i) {
+            Grow(partial[Batch], Positions[i]);
+        }
+    });
+    BoundingBox bounds;
+    for (const BoundingBox& box : partial) {
+        Grow(bounds, box);
+    }
+    return bounds;
+}
+
+// Turns the chunk group markers into parts covering the whole index list.
+void BuildParts(const std::vector<ObjChunk>& Chunks, uint32_t IndexCount, Mesh& OutMesh) {
+    std::vector<MeshPart> parts;
+    for (const ObjChunk& chunk : Chunks) {
+        for (const ObjGroupStart& group : chunk.Groups) {
+            parts.push_back({group.Name, chunk.CornerBase + group.FirstCorner, 0});
+        }
+    }
+    if (parts.empty() || parts[0].FirstIndex > 0) {
+        parts.insert(parts.begin(), MeshPart{});
+    }
+    for (size_t i = 0; i < parts.size(); ++i) {
+        const uint32_t next = i + 1 < parts.size() ? parts[i + 1].FirstIndex : IndexCount;
+        parts[i].IndexCount = next - parts[i].FirstIndex;
+    }
+    // Back-to-back "g" and "usemtl" lines leave empty parts behind.
+    parts.erase(std::remove_if(parts.begin(), parts.end(),
+                               [](const MeshPart& Part) { return Part.IndexCount == 0; }),
+                parts.end());
+    OutMesh.Parts = std::move(parts);
+}
+
+} // anonymous namespace
+
+bool ParseObj(const char* Data,
+              size_t Size,
+              const ObjImportSettings& Settings,
+              ThreadPool* Pool,
+              Mesh& OutMesh,
+              ObjLoadStats* OutStats) {
+    const Clock::time_point start = Clock::now();
+    OutMesh = Mesh{};
+
+    // Slice the text at line starts so every chunk parses on its own.
+    const size_t chunkCount = std::max<size_t>(1, (Size + OBJ_CHUNK_BYTES - 1) / OBJ_CHUNK_BYTES);
+    if (chunkCount > std::numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+    std::vector<ObjChunk> chunks(chunkCount);
+    const char* end = Data + Size;
+    const char* begin = Data;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        const char* split = i + 1 < chunkCount ? Data + Size / chunkCount * (i + 1) : end;
+        split = std::max(split, begin);
+        chunks[i].Begin = begin;
+        chunks[i].End = split < end ? SkipLine(split, end) : end;
+        begin = chunks[i].End;
+    }
+
+    ParallelFor(Pool, static_cast<uint32_t>(chunkCount),
+                [&](uint32_t Chunk, uint32_t) { ParseChunk(chunks[Chunk], Settings); });
+    const double parseMs = Milliseconds(start);
+    const Clock::time_point mergeStart = Clock::now();
+
+    // Chunk bases come from prefix sums; 32-bit indices cap the totals.
+    uint64_t totals[4] = {0, 0, 0, 0};
+    bool hasTexCoords = false;
+    bool hasNormals = false;
+    for (ObjChunk& chunk : chunks) {
+        if (chunk.Failed) {
+            return false;
+        }
+        chunk.PositionBase = static_cast<uint32_t>(totals[0]);
+        chunk.TexCoordBase = static_cast<uint32_t>(totals[1]);
+        chunk.NormalBase = static_cast<uint32_t>(totals[2]);
+        chunk.CornerBase = static_cast<uint32_t>(totals[3]);
+        totals[0] += chunk.Positions.size();
+        totals[1] += chunk.TexCoords.size();
+        totals[2] += chunk.Normals.size();
+        totals[3] += chunk.Corners.size() / 3;
+        hasTexCoords |= chunk.HasTexCoords;
+        hasNormals |= chunk.HasNormals;
+        if (totals[0] >= std::numeric_limits<int32_t>::max() ||
+            totals[1] >= std::numeric_limits<int32_t>::max() ||
+            totals[2] >= std::numeric_limits<int32_t>::max() ||
+            totals[3] >= std::numeric_limits<uint32_t>::max()) {
+            return false;
+        }
+    }
+    const uint32_t attributeTotals[3] = {static_cast<uint32_t>(totals[0]),
+                                         static_cast<uint32_t>(totals[1]),
+                                         static_cast<uint32_t>(totals[2])};
+    const uint32_t cornerTotal = static_cast<uint32_t>(totals[3]);
+
+    std::atomic<bool> valid{true};
+    std::vector<Vector3> positions(attributeTotals[0]);
+    std::vector<Vector2> texCoords(hasTexCoords ? attributeTotals[1] : 0);
+    std::vector<Vector3> normals(hasNormals ? attributeTotals[2] : 0);
+    ParallelFor(Pool, static_cast<uint32_t>(chunkCount), [&](uint32_t Index, uint32_t) {
+        ObjChunk& chunk = chunks[Index];
+        if (!ResolveChunk(chunk, attributeTotals)) {
+            valid = false;
+        }
+        std::copy(chunk.Positions.begin(), chunk.Positions.end(),
+                  positions.begin() + chunk.PositionBase);
+        if (hasTexCoords) {
+            std::copy(chunk.TexCoords.begin(), chunk.TexCoords.end(),
+                      texCoords.begin() + chunk.TexCoordBase);
+        }
+        if (hasNormals) {
+            std::copy(chunk.Normals.begin(), chunk.Normals.end(),
+                      normals.begin() + chunk.NormalBase);
+        }
+        chunk.Positions = {};
+        chunk.TexCoords = {};
+        chunk.Normals = {};
+    });
+    if (!valid) {
+        return false;
+    }
+    const double mergeMs = Milliseconds(mergeStart);
+    const Clock::time_point dedupStart = Clock::now();
+
+    OutMesh.Indices.resize(static_cast<size_t>(cornerTotal));
+    if (!hasTexCoords && !hasNormals) {
+        // Position-only meshes are indexed already; the position slot is the vertex.
+        ParallelFor(Pool, static_cast<uint32_t>(chunkCount), [&](uint32_t Index, uint32_t) {
+            const ObjChunk& chunk = chunks[Index];
+            uint32_t* out = OutMesh.Indices.data() + chunk.CornerBase;
+            for (size_t i = 0; i < chunk.Corners.size(); i += 3) {
+                *out++ = static_cast<uint32_t>(chunk.Corners[i]);
+            }
+        });
+        OutMesh.Positions = std::move(positions);
+    } else {
+        CornerMap map(attributeTotals[0]);
+        uint32_t* out = OutMesh.Indices.data();
+        for (const ObjChunk& chunk : chunks) {
+            for (size_t i = 0; i < chunk.Corners.size(); i += 3) {
+                *out++ = map.Insert(&chunk.Corners[i]);
+            }
+        }
+
+        const uint32_t vertexCount = map.GetVertexCount();
+        const int32_t* keys = map.GetKeys();
+        OutMesh.Positions.resize(vertexCount);
+        OutMesh.TexCoords.resize(hasTexCoords ? vertexCount : 0);
+        OutMesh.Normals.resize(hasNormals ? vertexCount : 0);
+        const uint32_t batches = (vertexCount + OBJ_GATHER_BATCH - 1) / OBJ_GATHER_BATCH;
+        ParallelFor(Pool, batches, [&](uint32_t Batch, uint32_t) {
+            const uint32_t last = std::min(vertexCount, (Batch + 1) * OBJ_GATHER_BATCH);
+            for (uint32_t v = Batch * OBJ_GATHER_BATCH; v < last; ++v) {
+                const int32_t* key = keys + static_cast<size_t>(v) * 3;
+                OutMesh.Positions[v] = positions[key[0]];
+                if (hasTexCoords) {
+                    OutMesh.TexCoords[v] =
+                        key[1] != OBJ_MISSING_INDEX ? texCoords[key[1]] : Vector2{};
+                }
+                if (hasNormals) {
+                    OutMesh.Normals[v] = key[2] != OBJ_MISSING_INDEX ? normals[key[2]] : Vector3{};
+                }
+            }
+        });
+    }
+    BuildParts(chunks, cornerTotal, OutMesh);
+    OutMesh.Bounds = ComputeBounds(OutMesh.Positions, Pool);
+    const double dedupMs = Milliseconds(dedupStart);
+
+    const Clock::time_point optimizeStart = Clock::now();
+    MeshOptimizeStats optimizeStats;
+    OptimizeMesh(OutMesh, Settings.Optimize, Pool, &optimizeStats);
+    const double optimizeMs = Milliseconds(optimizeStart);
+
+    const Clock::time_point meshletStart = Clock::now();
+    MeshletStats meshletStats;
+    BuildMeshlets(OutMesh, Settings.Meshlets, Pool, &meshletStats);
+    const double meshletMs = Milliseconds(meshletStart);
+
+    const Clock::time_point lodStart = Clock::now();
+    MeshLodStats lodStats;
+    BuildLodChain(OutMesh, Settings.Lods, Pool, &lodStats);
+
+    if (OutStats != nullptr) {
+        OutStats->FileBytes = Size;
+        OutStats->ChunkCount = static_cast<uint32_t>(chunkCount);
+        OutStats->ThreadCount = Pool != nullptr ? Pool->GetThreadCount() : 1;
+        OutStats->VertexCount = OutMesh.GetVertexCount();
+        OutStats->TriangleCount = OutMesh.GetTriangleCount();
+        OutStats->ParseMs = parseMs;
+        OutStats->MergeMs = mergeMs;
+        OutStats->DedupMs = dedupMs;
+        OutStats->OptimizeMs = optimizeMs;
+        OutStats->MeshletMs = meshletMs;
+        OutStats->LodMs = Milliseconds(lodStart);
+        OutStats->TotalMs = Milliseconds(start);
+        OutStats->Optimize = optimizeStats;
+        OutStats->Meshlets = meshletStats;
+        OutStats->Lods = lodStats;
+    }
+    return true;
+}
+
+bool LoadObj(const std::filesystem::path& Path,
+             const ObjImportSettings& Settings,
+             ThreadPool* Pool,
+             Mesh& OutMesh,
+             ObjLoadStats* OutStats) {
+    PROFILE_ZONE("LoadObj");
+    const Clock::time_point start = Clock::now();
+    MappedFile file;
+    if (!file.Open(Path)) {
+        return false;
+    }
+    const double mapMs = Milliseconds(start);
+
+    if (!ParseObj(reinterpret_cast<const char*>(file.GetData()), file.GetSize(), Settings, Pool,
+                  OutMesh, OutStats)) {
+        return false;
+    }
+    if (OutStats != nullptr) {
+        OutStats->MapMs = mapMs;
+        OutStats->TotalMs = Milliseconds(start);
+    }
+    return true;
+}
@@ -0,0 +1,66 @@
+﻿// src/Assets/ObjLoader.h
+// Wavefront OBJ import. The file is memory-mapped, cut into line-aligned chunks that are parsed
+// in parallel, and the per-chunk results are stitched into one indexed Mesh.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+#include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "MeshletBuilder.h"
+
+class ThreadPool;
+
+struct ObjImportSettings {
+    // OBJ is right-handed with counter-clockwise front faces; the renderer is left-handed with
+    // clockwise ones. Converting mirrors Z and flips the winding.
+    bool ConvertToLeftHanded = true;
+    // OBJ texture coordinates start at the bottom of the image, D3D ones at the top.
+    bool FlipTexCoordV = true;
+    // Applied to the mesh once it is parsed, in this order; see MeshOptimizer.h,
+    // MeshletBuilder.h and MeshSimplifier.h.
+    MeshOptimizeSettings Optimize;
+    MeshletSettings Meshlets;
+    MeshLodSettings Lods;
+};
+
+struct ObjLoadStats {
+    uint64_t FileBytes = 0;
+    uint32_t ChunkCount = 0;
+    uint32_t ThreadCount = 0;
+    uint32_t VertexCount = 0;   // After deduplication
+    uint32_t TriangleCount = 0; // After triangulating polygons
+    double MapMs = 0.0;
+    double ParseMs = 0.0;
+    double MergeMs = 0.0;
+    double DedupMs = 0.0;
+    double OptimizeMs = 0.0;
+    double MeshletMs = 0.0;
+    double LodMs = 0.0;
+    double TotalMs = 0.0;
+    MeshOptimizeStats Optimize;
+    MeshletStats Meshlets;
+    MeshLodStats Lods;
+};
+
+// Loads the OBJ file at Path into OutMesh. Polygons are fan-triangulated and every distinct
+// position/texcoord/normal combination becomes one vertex. Materials are ignored; "o", "g" and
+// "usemtl" lines start new mesh parts. Returns false if the file cannot be read, is malformed or
+// references attributes that do not exist. The mesh is then optimized, split into meshlets and
+// given LODs as Settings asks. Pool may be null to parse on the calling thread.
+bool LoadObj(const std::filesystem::path& Path,
+             const ObjImportSettings& Settings,
+             ThreadPool* Pool,
+             Mesh& OutMesh,
+             ObjLoadStats* OutStats = nullptr);
+
+// Same as LoadObj, for OBJ text that is already in memory. Data need not be null-terminated.
+bool ParseObj(const char* Data,
+              size_t Size,
+              const ObjImportSettings& Settings,
+              ThreadPool* Pool,
+              Mesh& OutMesh,
+              ObjLoadStats* OutStats = nullptr);
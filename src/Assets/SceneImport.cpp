@@ -0,0 +1,133 @@
+﻿// src/Assets/SceneImport.cpp
+#include "SceneImport.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+
+#include "Common/Profiler.h"
+#include "Scene/Scene.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class SceneFileType { Unknown, Obj, CookedMesh, Gltf };
+
+SceneFileType GetSceneFileType(const std::filesystem::path& Path) {
+    std::string extension = Path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char C) { return static_cast<char>(std::tolower(C)); });
+    if (extension == ".obj") {
+        return SceneFileType::Obj;
+    }
+    if (extension == ".dxmesh") {
+        return SceneFileType::CookedMesh;
+    }
+    if (extension == ".gltf" || extension == ".glb") {
+        return SceneFileType::Gltf;
+    }
+    return SceneFileType::Unknown;
+}
+
+} // anonymous namespace
+
+bool IsSceneImportFile(const std::filesystem::path& Path) {
+    return GetSceneFileType(Path) != SceneFileType::Unknown;
+}
+
+const std::vector<std::string>& GetSceneImportExtensions() {
+    static const std::vector<std::string> extensions = {".obj", ".dxmesh", ".gltf", ".glb"};
+    return extensions;
+}
+
+const std::vector<std::string>& GetSceneImportExcludedDirectories() {
+    static const std::vector<std::string> directories = {COOKED_MESH_FOLDER};
+    return directories;
+}
+
+bool LoadSceneImport(const std::filesystem::path& Path,
+                     const SceneImportSettings& Settings,
+                     ThreadPool* Pool,
+                     SceneImport& Out) {
+    PROFILE_ZONE("LoadSceneImport");
+    const Clock::time_point start = Clock::now();
+    bool loaded = false;
+    switch (GetSceneFileType(Path)) {
+    case SceneFileType::Obj:
+        if (Settings.UseMeshCache) {
+            loaded = LoadObjCached(Path, Settings.Obj, Pool, Out.Mesh, &Out.MeshStats);
+        } else {
+            auto mesh = std::make_shared<Mesh>();
+            loaded = LoadObj(Path, Settings.Obj, Pool, *mesh, &Out.MeshStats.Import);
+            Out.Mesh = MakeMeshView(std::move(mesh));
+        }
+        break;
+    case SceneFileType::CookedMesh:
+        loaded = LoadCookedMesh(Path, 0, Out.Mesh);
+        Out.MeshStats.Hit = loaded;
+        break;
+    case SceneFileType::Gltf:
+        Out.Gltf = std::make_shared<GltfAsset>();
+        loaded = Out.Gltf->Load(Path);
+        break;
+    case SceneFileType::Unknown:
+        break;
+    }
+    Out.LoadMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    Out.MeshStats.LoadMs = Out.LoadMs;
+    return loaded;
+}
+
+uint64_t GetSceneImportBytes(const SceneImport& Import) {
+    const MeshView& mesh = Import.Mesh;
+    uint64_t bytes = mesh.Positions.GetSize() * sizeof(Vector3) +
+                     mesh.Normals.GetSize() * sizeof(Vector3) +
+                     mesh.TexCoords.GetSize() * sizeof(Vector2) +
+                     mesh.Indices.GetSize() * sizeof(uint32_t) +
+                     mesh.Meshlets.GetSize() * sizeof(Meshlet) +
+                     mesh.LodIndices.GetSize() * sizeof(uint32_t) +
+                     mesh.Lods.GetSize() * sizeof(MeshLod);
+    if (Import.Gltf) {
+        for (uint32_t i = 0; i < Import.Gltf->GetBufferCount(); ++i) {
+            bytes += Import.Gltf->GetBufferBytes(i).GetSize();
+        }
+    }
+    return bytes;
+}
+
+AssetLoader MakeSceneImportLoader(const SceneImportSettings& Settings, ThreadPool* Pool) {
+    return [Settings, Pool](const std::filesystem::path& Path, const std::atomic<bool>& Cancelled,
+                            LoadedAsset& Out) {
+        if (Cancelled.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        auto import = std::make_shared<SceneImport>();
+        if (!LoadSceneImport(Path, Settings, Pool, *import)) {
+            return false;
+        }
+        Out.Bytes = GetSceneImportBytes(*import);
+        Out.Data = std::move(import);
+        return true;
+    };
+}
+
+SceneNodeId AddSceneImport(const std::shared_ptr<const SceneImport>& Import,
+                           const std::string& Name,
+                           Scene& Target,
+                           SceneNodeId Parent,
+                           uint32_t Color,
+                           GltfImportStats* OutGltfStats) {
+    if (Import->Gltf) {
+        // Aliased, so the scene's references count against the import itself.
+        return AddGltfToScene(std::shared_ptr<const GltfAsset>(Import, Import->Gltf.get()), Name,
+                              Target, Parent, OutGltfStats);
+    }
+    MeshView view = Import->Mesh;
+    view.Owner = Import;
+    const SceneNodeId node = Target.GetHierarchy().CreateNode(Name, Parent);
+    if (view.GetIndexCount() > 0) {
+        Target.AddInstance(node, Target.AddMesh(std::move(view)), Color);
+    }
+    return node;
+}
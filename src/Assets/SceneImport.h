@@ -0,0 +1,62 @@
+﻿// src/Assets/SceneImport.h
+// Files that can be opened into a Scene: .obj (through its cooked copy), .dxmesh, .gltf and
+// .glb. Loading has no side effects on the scene, so it can run on an AssetStreamer I/O thread;
+// adding the result runs on the thread that owns the scene.
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AssetStreamer.h"
+#include "GltfAsset.h"
+#include "MeshCache.h"
+
+class Scene;
+class ThreadPool;
+
+struct SceneImportSettings {
+    ObjImportSettings Obj;
+    bool UseMeshCache = true; // Load OBJ files through their cooked .dxmesh copy
+};
+
+// A loaded file: either one mesh or a glTF asset.
+struct SceneImport {
+    MeshView Mesh;                   // .obj and .dxmesh
+    std::shared_ptr<GltfAsset> Gltf; // .gltf and .glb
+    MeshCacheStats MeshStats;        // .obj and .dxmesh
+    double LoadMs = 0.0;
+};
+
+bool IsSceneImportFile(const std::filesystem::path& Path);
+// The extensions IsSceneImportFile accepts, lower-case with the dot, e.g. to filter a file list.
+const std::vector<std::string>& GetSceneImportExtensions();
+// Directories such a file list should skip: the cooked copies, which the .dxmesh extension would
+// otherwise list next to their sources.
+const std::vector<std::string>& GetSceneImportExcludedDirectories();
+
+// Loads Path into Out. Pool parses OBJ files in parallel and may be null. The thread that
+// created Pool runs its queued jobs while it waits, so from an I/O thread pass a pool that
+// thread does not wait on every frame.
+bool LoadSceneImport(const std::filesystem::path& Path,
+                     const SceneImportSettings& Settings,
+                     ThreadPool* Pool,
+                     SceneImport& Out);
+
+// Memory an import keeps resident, as counted against an AssetStreamer budget.
+uint64_t GetSceneImportBytes(const SceneImport& Import);
+
+// Loader for AssetStreamer requests; the asset is a SceneImport.
+AssetLoader MakeSceneImportLoader(const SceneImportSettings& Settings, ThreadPool* Pool);
+
+// Adds Import under Parent as a node named Name; a mesh is drawn there with Color, a glTF
+// asset brings its own node graph and colors. The scene's references keep Import alive, which
+// also keeps it from being evicted from a streamer's cache while it is shown.
+SceneNodeId AddSceneImport(const std::shared_ptr<const SceneImport>& Import,
+                           const std::string& Name,
+                           Scene& Target,
+                           SceneNodeId Parent,
+                           uint32_t Color,
+                           GltfImportStats* OutGltfStats = nullptr);
@@ -0,0 +1,97 @@
+﻿// src/Common/FrameArena.cpp
+#include "FrameArena.h"
+
+#include <algorithm>
+
+LinearArena::LinearArena(size_t BlockBytes) : mBlockBytes(BlockBytes > 0 ? BlockBytes : 1) {
+}
+
+LinearArena::~LinearArena() = default;
+
+void* LinearArena::Allocate(size_t Bytes, size_t Alignment) {
+    if (!mBlocks.empty()) {
+        Block& block = mBlocks.back();
+        const uintptr_t base = reinterpret_cast<uintptr_t>(block.Memory.get());
+        const uintptr_t aligned = (base + mOffset + Alignment - 1) & ~(Alignment - 1);
+        const size_t offset = aligned - base;
+        if (offset + Bytes <= block.Size) {
+            mOffset = offset + Bytes;
+            mPeakBytes = std::max(mPeakBytes, mUsedBefore + mOffset);
+            return block.Memory.get() + offset;
+        }
+    }
+
+    // Worst-case padding fits in the new block, which is at least twice the last one so a
+    // growing frame needs few of them.
+    AddBlock(Bytes + Alignment);
+    return Allocate(Bytes, Alignment);
+}
+
+void LinearArena::Reset() {
+    if (mBlocks.size() > 1) {
+        size_t total = 0;
+        for (const Block& block : mBlocks) {
+            total += block.Size;
+        }
+        mBlocks.clear();
+        mBlockBytes = total;
+        AddBlock(total);
+    }
+    mOffset = 0;
+    mUsedBefore = 0;
+}
+
+LinearArenaStats LinearArena::GetStats() const {
+    LinearArenaStats stats;
+    stats.UsedBytes = mUsedBefore + mOffset;
+    stats.PeakBytes = mPeakBytes;
+    for (const Block& block : mBlocks) {
+        stats.CapacityBytes += block.Size;
+    }
+    stats.BlockCount = static_cast<uint32_t>(mBlocks.size());
+    return stats;
+}
+
+void LinearArena::AddBlock(size_t MinBytes) {
+    size_t size = mBlockBytes;
+    if (!mBlocks.empty()) {
+        mUsedBefore += mOffset;
+        size = mBlocks.back().Size * 2;
+    }
+    size = std::max(size, MinBytes);
+
+    Block block;
+    block.Memory.reset(new std::byte[size]);
+    block.Size = size;
+    mBlocks.push_back(std::move(block));
+    mOffset = 0;
+}
+
+ThreadArenas::ThreadArenas(size_t BlockBytes) : mBlockBytes(BlockBytes) {
+}
+
+ThreadArenas::~ThreadArenas() = default;
+
+void ThreadArenas::Resize(uint32_t ThreadCount) {
+    while (mArenas.size() < ThreadCount) {
+        mArenas.push_back(std::make_unique<LinearArena>(mBlockBytes));
+    }
+}
+
+void ThreadArenas::Reset() {
+    for (const auto& arena : mArenas) {
+        arena->Reset();
+    }
+}
+
+LinearArenaStats ThreadArenas::GetStats() const {
+    LinearArenaStats total;
+    for (const auto& arena : mArenas) {
+        const LinearArenaStats stats = arena->GetStats();
+        total.UsedBytes += stats.UsedBytes;
+        total.PeakBytes = std::max(total.PeakBytes, stats.PeakBytes);
+        total.CapacityBytes += stats.CapacityBytes;
+        total.BlockCount += stats.BlockCount;
+    }
+    return total;
+}
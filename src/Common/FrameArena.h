@@ -0,0 +1,129 @@
+﻿// src/Common/FrameArena.h
+// Bump allocation for data that lives for one frame. An arena hands out memory by moving a
+// pointer and frees everything at once when it is reset, so per-frame lists never go through
+// the global heap or contend on its locks.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct LinearArenaStats {
+    size_t UsedBytes = 0;     // Since the last Reset
+    size_t PeakBytes = 0;     // Highest UsedBytes ever reached
+    size_t CapacityBytes = 0; // Reserved from the heap
+    uint32_t BlockCount = 0;
+};
+
+// Not thread-safe: give each thread its own arena.
+class LinearArena {
+  public:
+    // BlockBytes is the first block's size; the arena grows by further blocks when it runs out.
+    explicit LinearArena(size_t BlockBytes = 64 * 1024);
+    ~LinearArena();
+
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    // Alignment must be a power of two. Never returns null.
+    void* Allocate(size_t Bytes, size_t Alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T* AllocateArray(size_t Count) {
+        return static_cast<T*>(Allocate(Count * sizeof(T), alignof(T)));
+    }
+
+    // Frees everything allocated so far; destructors are not run. A frame that needed more than
+    // one block leaves a single block big enough for all of it, so steady state is one block.
+    void Reset();
+
+    LinearArenaStats GetStats() const;
+
+  private:
+    struct Block {
+        std::unique_ptr<std::byte[]> Memory;
+        size_t Size = 0;
+    };
+
+    void AddBlock(size_t MinBytes);
+
+    std::vector<Block> mBlocks;
+    size_t mBlockBytes;
+    size_t mOffset = 0;     // Into the last block
+    size_t mUsedBefore = 0; // Bytes handed out from the blocks before the last
+    size_t mPeakBytes = 0;
+};
+
+// Standard allocator drawing from a LinearArena. Deallocation is a no-op; the memory comes back
+// when the arena is reset, so containers using it must be destroyed or emptied before that.
+template <typename T>
+class ArenaAllocator {
+  public:
+    using value_type = T;
+
+    explicit ArenaAllocator(LinearArena& Arena) : mArena(&Arena) {
+    }
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& Other) : mArena(Other.GetArena()) {
+    }
+
+    T* allocate(size_t Count) {
+        return mArena->AllocateArray<T>(Count);
+    }
+    void deallocate(T*, size_t) {
+    }
+
+    LinearArena* GetArena() const {
+        return mArena;
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& Other) const {
+        return mArena == Other.GetArena();
+    }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& Other) const {
+        return mArena != Other.GetArena();
+    }
+
+  private:
+    LinearArena* mArena;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// One LinearArena per thread of a ThreadPool, indexed by ParallelFor's ThreadIndex, so parallel
+// work can allocate without sharing an arena or going to the heap. Whoever owns the set decides
+// when a frame's memory may go, as with a single arena.
+class ThreadArenas {
+  public:
+    explicit ThreadArenas(size_t BlockBytes = 64 * 1024);
+    ~ThreadArenas();
+
+    ThreadArenas(const ThreadArenas&) = delete;
+    ThreadArenas& operator=(const ThreadArenas&) = delete;
+
+    // Adds arenas until there is one for every ThreadIndex below ThreadCount. Arenas are never
+    // removed. Not while any of them are in use.
+    void Resize(uint32_t ThreadCount);
+    uint32_t GetThreadCount() const {
+        return static_cast<uint32_t>(mArenas.size());
+    }
+
+    // Only the thread running with ThreadIndex may use it until the work is done.
+    LinearArena& Get(uint32_t ThreadIndex) {
+        return *mArenas[ThreadIndex];
+    }
+
+    // Resets every arena. Not while any of them are in use.
+    void Reset();
+
+    // All arenas together; PeakBytes is the largest any one of them reached.
+    LinearArenaStats GetStats() const;
+
+  private:
+    std::vector<std::unique_ptr<LinearArena>> mArenas;
+    size_t mBlockBytes;
+};
@@ -0,0 +1,159 @@
+﻿// src/Common/FramePacer.cpp
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002 // Windows 10 1803 SDK and later
+#endif
+#endif
+
+namespace {
+
+constexpr double NANOSECONDS_PER_SECOND = 1e9;
+
+uint64_t ToNanoseconds(double Seconds) {
+    return Seconds > 0.0 ? static_cast<uint64_t>(Seconds * NANOSECONDS_PER_SECOND) : 0;
+}
+
+double ToMilliseconds(uint64_t Nanoseconds) {
+    return Nanoseconds / 1e6;
+}
+
+} // anonymous namespace
+
+SystemFrameClock::SystemFrameClock() {
+#ifdef _WIN32
+    // Plain waitable timers and Sleep round up to the scheduler tick, often 15.6 ms.
+    mTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                    TIMER_ALL_ACCESS);
+    if (mTimer == nullptr) {
+        mTimer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+    }
+#endif
+}
+
+SystemFrameClock::~SystemFrameClock() {
+#ifdef _WIN32
+    if (mTimer != nullptr) {
+        CloseHandle(mTimer);
+    }
+#endif
+}
+
+uint64_t SystemFrameClock::Now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+void SystemFrameClock::Sleep(uint64_t Nanoseconds) {
+#ifdef _WIN32
+    if (mTimer != nullptr) {
+        // Negative due times are relative, in 100 ns units.
+        LARGE_INTEGER dueTime;
+        dueTime.QuadPart = -static_cast<LONGLONG>(Nanoseconds / 100);
+        if (SetWaitableTimerEx(mTimer, &dueTime, 0, nullptr, nullptr, nullptr, 0)) {
+            WaitForSingleObject(mTimer, INFINITE);
+            return;
+        }
+    }
+#endif
+    std::this_thread::sleep_for(std::chrono::nanoseconds(Nanoseconds));
+}
+
+void SystemFrameClock::Pause() {
+    std::this_thread::yield();
+}
+
+FramePacer::FramePacer(FrameClock& Clock, const FramePacingSettings& Settings)
+    : mClock(Clock), mSettings(Settings),
+      mPeriod(Settings.Mode != FramePacingMode::Unlimited && Settings.TargetFps > 0.0
+                  ? ToNanoseconds(1.0 / Settings.TargetFps)
+                  : 0) {
+}
+
+FrameTiming FramePacer::BeginFrame() {
+    const uint64_t now = mClock.Now();
+    uint64_t delta = mStarted ? now - mFrameStart : 0;
+    if (mIdled) {
+        // Nothing changed while the loop was blocked, so there is nothing to catch up on.
+        delta = std::min(delta, mPeriod);
+        mIdled = false;
+    }
+    delta = std::min(delta, ToNanoseconds(mSettings.MaxFrameSeconds));
+    mFrameStart = now;
+    if (!mStarted) {
+        mNextDeadline = now;
+        mStarted = true;
+    }
+    mFrameRequested = false;
+
+    FrameTiming timing;
+    timing.FrameIndex = mStats.FrameCount++;
+    timing.DeltaSeconds = delta / NANOSECONDS_PER_SECOND;
+
+    const uint64_t step = ToNanoseconds(mSettings.FixedStepSeconds);
+    if (step == 0) {
+        timing.StepCount = delta > 0 ? 1 : 0;
+        timing.StepSeconds = timing.DeltaSeconds;
+        timing.Alpha = 1.0;
+        return timing;
+    }
+
+    mAccumulator += delta;
+    uint64_t steps = mAccumulator / step;
+    mAccumulator -= steps * step;
+    if (steps > mSettings.MaxStepsPerFrame) {
+        mStats.DroppedSteps += steps - mSettings.MaxStepsPerFrame;
+        steps = mSettings.MaxStepsPerFrame;
+    }
+    timing.StepCount = static_cast<uint32_t>(steps);
+    timing.StepSeconds = mSettings.FixedStepSeconds;
+    timing.Alpha = static_cast<double>(mAccumulator) / step;
+    return timing;
+}
+
+void FramePacer::EndFrame() {
+    if (mPeriod == 0) {
+        return;
+    }
+
+    // Deadlines advance by whole periods, so oversleeping one frame shortens the next wait and
+    // the average rate holds. A frame that overran starts the schedule again from now.
+    mNextDeadline += mPeriod;
+    uint64_t now = mClock.Now();
+    if (now >= mNextDeadline) {
+        if (now - mFrameStart > mPeriod) {
+            ++mStats.LateFrames;
+        }
+        mNextDeadline = now;
+        return;
+    }
+
+    if (mNextDeadline - now > mSettings.SpinNanoseconds) {
+        const uint64_t sleepStart = now;
+        mClock.Sleep(mNextDeadline - now - mSettings.SpinNanoseconds);
+        now = mClock.Now();
+        mStats.SleptMs += ToMilliseconds(now - sleepStart);
+    }
+    const uint64_t spinStart = now;
+    while (now < mNextDeadline) {
+        mClock.Pause();
+        now = mClock.Now();
+    }
+    mStats.SpunMs += ToMilliseconds(now - spinStart);
+}
+
+bool FramePacer::ShouldIdle() {
+    if (mSettings.Mode != FramePacingMode::OnDemand || mFrameRequested) {
+        return false;
+    }
+    ++mStats.IdleCount;
+    mIdled = true;
+    return true;
+}
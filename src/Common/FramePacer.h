@@ -0,0 +1,112 @@
+﻿// src/Common/FramePacer.h
+// Decides when the main loop runs its next frame: caps the frame rate by sleeping most of the
+// remaining time and spinning the rest, splits elapsed time into fixed simulation steps, and lets
+// the loop block on input while nothing on screen would change. Time comes from a FrameClock, so
+// a fake clock makes the pacing deterministic.
+#pragma once
+
+#include <cstdint>
+
+// Nanoseconds from an arbitrary, monotonic origin.
+class FrameClock {
+  public:
+    virtual ~FrameClock() = default;
+
+    virtual uint64_t Now() = 0;
+    // Blocks for about Nanoseconds; it may wake a little late, never early by much.
+    virtual void Sleep(uint64_t Nanoseconds) = 0;
+    // One iteration of a busy wait.
+    virtual void Pause() = 0;
+};
+
+// steady_clock, with a high-resolution waitable timer for Sleep on Windows.
+class SystemFrameClock : public FrameClock {
+  public:
+    SystemFrameClock();
+    ~SystemFrameClock() override;
+
+    SystemFrameClock(const SystemFrameClock&) = delete;
+    SystemFrameClock& operator=(const SystemFrameClock&) = delete;
+
+    uint64_t Now() override;
+    void Sleep(uint64_t Nanoseconds) override;
+    void Pause() override;
+
+  private:
+    void* mTimer = nullptr; // Waitable timer HANDLE on Windows
+};
+
+enum class FramePacingMode {
+    Unlimited, // Frames run back to back
+    Limited,   // At most TargetFps frames per second
+    OnDemand,  // Limited, and ShouldIdle says when to block until something changes
+};
+
+struct FramePacingSettings {
+    FramePacingMode Mode = FramePacingMode::OnDemand;
+    double TargetFps = 60.0;
+    // The last part of each wait is spun rather than slept, since sleeps overshoot.
+    uint64_t SpinNanoseconds = 1000000;
+    // Simulation step length; 0 makes one step per frame of the frame's length.
+    double FixedStepSeconds = 1.0 / 60.0;
+    // Steps a frame may run before the accumulator drops the rest, so a slow frame does not
+    // make the next one slower still.
+    uint32_t MaxStepsPerFrame = 5;
+    // Longer gaps, such as a debugger break, count as this long.
+    double MaxFrameSeconds = 0.25;
+};
+
+struct FrameTiming {
+    uint64_t FrameIndex = 0;
+    double DeltaSeconds = 0.0; // Since the previous frame began, clamped
+    uint32_t StepCount = 0;    // Simulation steps to run this frame
+    double StepSeconds = 0.0;
+    // How far the time left in the accumulator is into the next step, for interpolation.
+    double Alpha = 0.0;
+};
+
+struct FramePacerStats {
+    uint64_t FrameCount = 0;
+    uint64_t LateFrames = 0; // Frames whose work alone took longer than the target period
+    uint64_t IdleCount = 0;  // Times ShouldIdle let the loop block
+    uint64_t DroppedSteps = 0;
+    double SleptMs = 0.0;
+    double SpunMs = 0.0;
+};
+
+class FramePacer {
+  public:
+    FramePacer(FrameClock& Clock, const FramePacingSettings& Settings);
+
+    // Starts a frame: measures the time since the last one and advances the simulation clock.
+    FrameTiming BeginFrame();
+    // Ends a frame, waiting out the rest of the target period when the rate is limited.
+    void EndFrame();
+
+    // Something visible changed, such as input or a finished load: the next frames must run.
+    void RequestFrame() {
+        mFrameRequested = true;
+    }
+    // In OnDemand mode, true when no frame was requested since the last BeginFrame; the loop
+    // may then block until its next event. The time spent blocked is not simulated.
+    bool ShouldIdle();
+
+    const FramePacingSettings& GetSettings() const {
+        return mSettings;
+    }
+    const FramePacerStats& GetStats() const {
+        return mStats;
+    }
+
+  private:
+    FrameClock& mClock;
+    FramePacingSettings mSettings;
+    uint64_t mPeriod;           // Target frame length in nanoseconds; 0 when unlimited
+    uint64_t mFrameStart = 0;   // When the current frame began
+    uint64_t mNextDeadline = 0; // When the next frame may begin
+    uint64_t mAccumulator = 0;  // Nanoseconds not yet simulated
+    bool mStarted = false;
+    bool mFrameRequested = true;
+    bool mIdled = false;
+    FramePacerStats mStats;
+};
@@ -0,0 +1,352 @@
+﻿// src/Common/Json.cpp
+#include "Json.h"
+
+#include <charconv>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr uint32_t JSON_MAX_DEPTH = 256;
+
+const std::string EMPTY_STRING;
+const std::vector<JsonValue> EMPTY_ELEMENTS;
+const std::vector<std::pair<std::string, JsonValue>> EMPTY_MEMBERS;
+const JsonValue NULL_VALUE;
+
+void AppendUtf8(uint32_t CodePoint, std::string& Out) {
+    if (CodePoint < 0x80) {
+        Out.push_back(static_cast<char>(CodePoint));
+    } else if (CodePoint < 0x800) {
+        Out.push_back(static_cast<char>(0xC0 | (CodePoint >> 6)));
+        Out.push_back(static_cast<char>(0x80 | (CodePoint & 0x3F)));
+    } else if (CodePoint < 0x10000) {
+        Out.push_back(static_cast<char>(0xE0 | (CodePoint >> 12)));
+        Out.push_back(static_cast<char>(0x80 | ((CodePoint >> 6) & 0x3F)));
+        Out.push_back(static_cast<char>(0x80 | (CodePoint & 0x3F)));
+    } else {
+        Out.push_back(static_cast<char>(0xF0 | (CodePoint >> 18)));
+        Out.push_back(static_cast<char>(0x80 | ((CodePoint >> 12) & 0x3F)));
+        Out.push_back(static_cast<char>(0x80 | ((CodePoint >> 6) & 0x3F)));
+        Out.push_back(static_cast<char>(0x80 | (CodePoint & 0x3F)));
+    }
+}
+
+} // anonymous namespace
+
+// Recursive descent over the text; every read is bounds-checked against mEnd.
+class JsonParser {
+  public:
+    JsonParser(const char* Data, size_t Size) : mCursor(Data), mEnd(Data + Size) {
+    }
+
+    bool ParseDocument(JsonValue& OutRoot) {
+        // A UTF-8 byte order mark is tolerated, as some exporters write one.
+        if (mEnd - mCursor >= 3 && static_cast<uint8_t>(mCursor[0]) == 0xEF &&
+            static_cast<uint8_t>(mCursor[1]) == 0xBB && static_cast<uint8_t>(mCursor[2]) == 0xBF) {
+            mCursor += 3;
+        }
+        if (!ParseValue(OutRoot, 0)) {
+            return false;
+        }
+        SkipWhitespace();
+        return mCursor == mEnd;
+    }
+
+  private:
+    void SkipWhitespace() {
+        while (mCursor < mEnd &&
+               (*mCursor == ' ' || *mCursor == '\t' || *mCursor == '\n' || *mCursor == '\r')) {
+            ++mCursor;
+        }
+    }
+
+    bool Consume(char Expected) {
+        SkipWhitespace();
+        if (mCursor < mEnd && *mCursor == Expected) {
+            ++mCursor;
+            return true;
+        }
+        return false;
+    }
+
+    bool ConsumeLiteral(std::string_view Literal) {
+        if (static_cast<size_t>(mEnd - mCursor) < Literal.size() ||
+            std::string_view(mCursor, Literal.size()) != Literal) {
+            return false;
+        }
+        mCursor += Literal.size();
+        return true;
+    }
+
+    bool ParseValue(JsonValue& Out, uint32_t Depth) {
+        if (Depth > JSON_MAX_DEPTH) {
+            return false;
+        }
+        SkipWhitespace();
+        if (mCursor >= mEnd) {
+            return false;
+        }
+        switch (*mCursor) {
+        case '{':
+            return ParseObject(Out, Depth);
+        case '[':
+            return ParseArray(Out, Depth);
+        case '"':
+            Out.mType = JsonType::String;
+            return ParseString(Out.mString);
+        case 't':
+            Out.mType = JsonType::Bool;
+            Out.mBool = true;
+            return ConsumeLiteral("true");
+        case 'f':
+            Out.mType = JsonType::Bool;
+            Out.mBool = false;
+            return ConsumeLiteral("false");
+        case 'n':
+            Out.mType = JsonType::Null;
+            return ConsumeLiteral("null");
+        default:
+            return ParseNumber(Out);
+        }
+    }
+
+    bool ParseObject(JsonValue& Out, uint32_t Depth) {
+        Out.mType = JsonType::Object;
+        ++mCursor; // '{'
+        if (Consume('}')) {
+            return true;
+        }
+        do {
+            SkipWhitespace();
+            std::string key;
+            if (!ParseString(key) || !Consume(':')) {
+                return false;
+            }
+            Out.mMembers.emplace_back(std::move(key), JsonValue{});
+            if (!ParseValue(Out.mMembers.back().second, Depth + 1)) {
+                return false;
+            }
+        } while (Consume(','));
+        return Consume('}');
+    }
+
+    bool ParseArray(JsonValue& Out, uint32_t Depth) {
+        Out.mType = JsonType::Array;
+        ++mCursor; // '['
+        if (Consume(']')) {
+            return true;
+        }
+        do {
+            Out.mElements.emplace_back();
+            if (!ParseValue(Out.mElements.back(), Depth + 1)) {
+                return false;
+            }
+        } while (Consume(','));
+        return Consume(']');
+    }
+
+    bool ParseHex4(uint32_t& OutValue) {
+        if (mEnd - mCursor < 4) {
+            return false;
+        }
+        OutValue = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char c = *mCursor++;
+            uint32_t digit;
+            if (c >= '0' && c <= '9') {
+                digit = c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                digit = c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                digit = c - 'A' + 10;
+            } else {
+                return false;
+            }
+            OutValue = OutValue * 16 + digit;
+        }
+        return true;
+    }
+
+    bool ParseString(std::string& Out) {
+        if (mCursor >= mEnd || *mCursor != '"') {
+            return false;
+        }
+        ++mCursor;
+        Out.clear();
+        while (mCursor < mEnd) {
+            // Copy runs without escapes in one go.
+            const char* run = mCursor;
+            while (mCursor < mEnd && *mCursor != '"' && *mCursor != '\\' &&
+                   static_cast<uint8_t>(*mCursor) >= 0x20) {
+                ++mCursor;
+            }
+            Out.append(run, mCursor);
+            if (mCursor >= mEnd || static_cast<uint8_t>(*mCursor) < 0x20) {
+                return false;
+            }
+            if (*mCursor++ == '"') {
+                return true;
+            }
+            if (mCursor >= mEnd) {
+                return false;
+            }
+            const char escape = *mCursor++;
+            switch (escape) {
+            case '"':
+            case '\\':
+            case '/':
+                Out.push_back(escape);
+                break;
+            case 'b':
+                Out.push_back('\b');
+                break;
+            case 'f':
+                Out.push_back('\f');
+                break;
+            case 'n':
+                Out.push_back('\n');
+                break;
+            case 'r':
+                Out.push_back('\r');
+                break;
+            case 't':
+                Out.push_back('\t');
+                break;
+            case 'u': {
+                uint32_t codePoint = 0;
+                if (!ParseHex4(codePoint)) {
+                    return false;
+                }
+                // A high surrogate must be followed by an escaped low one.
+                if (codePoint >= 0xD800 && codePoint < 0xDC00) {
+                    uint32_t low = 0;
+                    if (!ConsumeLiteral("\\u") || !ParseHex4(low) || low < 0xDC00 ||
+                        low >= 0xE000) {
+                        return false;
+                    }
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                } else if (codePoint >= 0xDC00 && codePoint < 0xE000) {
+                    return false;
+                }
+                AppendUtf8(codePoint, Out);
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        return false;
+    }
+
+    bool ParseNumber(JsonValue& Out) {
+        // Validate the JSON grammar first; from_chars is more permissive.
+        const char* start = mCursor;
+        const char* p = mCursor;
+        auto isDigit = [&](const char* At) { return At < mEnd && *At >= '0' && *At <= '9'; };
+        if (p < mEnd && *p == '-') {
+            ++p;
+        }
+        if (!isDigit(p)) {
+            return false;
+        }
+        if (*p == '0') {
+            ++p;
+        } else {
+            while (isDigit(p)) {
+                ++p;
+            }
+        }
+        if (p < mEnd && *p == '.') {
+            ++p;
+            if (!isDigit(p)) {
+                return false;
+            }
+            while (isDigit(p)) {
+                ++p;
+            }
+        }
+        if (p < mEnd && (*p == 'e' || *p == 'E')) {
+            ++p;
+            if (p < mEnd && (*p == '+' || *p == '-')) {
+                ++p;
+            }
+            if (!isDigit(p)) {
+                return false;
+            }
+            while (isDigit(p)) {
+                ++p;
+            }
+        }
+
+        double value = 0.0;
+        const std::from_chars_result result = std::from_chars(start, p, value);
+        if (result.ec != std::errc() && result.ec != std::errc::result_out_of_range) {
+            return false;
+        }
+        Out.mType = JsonType::Number;
+        Out.mNumber = value;
+        mCursor = p;
+        return true;
+    }
+
+    const char* mCursor;
+    const char* mEnd;
+};
+
+bool JsonValue::GetBool(bool Default) const {
+    return mType == JsonType::Bool ? mBool : Default;
+}
+
+double JsonValue::GetNumber(double Default) const {
+    return mType == JsonType::Number ? mNumber : Default;
+}
+
+float JsonValue::GetFloat(float Default) const {
+    return mType == JsonType::Number ? static_cast<float>(mNumber) : Default;
+}
+
+int64_t JsonValue::GetInteger(int64_t Default) const {
+    // 2^63 is exactly representable, so the range test has no rounding slack.
+    if (mType != JsonType::Number || mNumber != std::floor(mNumber) ||
+        mNumber < -9.2233720368547758e18 || mNumber >= 9.2233720368547758e18) {
+        return Default;
+    }
+    return static_cast<int64_t>(mNumber);
+}
+
+const std::string& JsonValue::GetString() const {
+    return mType == JsonType::String ? mString : EMPTY_STRING;
+}
+
+const std::vector<JsonValue>& JsonValue::GetElements() const {
+    return mType == JsonType::Array ? mElements : EMPTY_ELEMENTS;
+}
+
+size_t JsonValue::GetSize() const {
+    return GetElements().size();
+}
+
+const JsonValue& JsonValue::operator[](size_t Index) const {
+    const std::vector<JsonValue>& elements = GetElements();
+    return Index < elements.size() ? elements[Index] : NULL_VALUE;
+}
+
+const std::vector<std::pair<std::string, JsonValue>>& JsonValue::GetMembers() const {
+    return mType == JsonType::Object ? mMembers : EMPTY_MEMBERS;
+}
+
+const JsonValue* JsonValue::Find(std::string_view Key) const {
+    for (const auto& member : GetMembers()) {
+        if (member.first == Key) {
+            return &member.second;
+        }
+    }
+    return nullptr;
+}
+
+bool ParseJson(const char* Data, size_t Size, JsonValue& OutRoot) {
+    OutRoot = JsonValue{};
+    JsonParser parser(Data, Size);
+    return parser.ParseDocument(OutRoot);
+}
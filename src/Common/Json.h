@@ -0,0 +1,68 @@
+﻿// src/Common/Json.h
+// Small JSON document model for asset metadata such as glTF. Documents are parsed once into a
+// tree and then only read, so the tree favours simple lookups over editing.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+enum class JsonType : uint8_t { Null, Bool, Number, String, Array, Object };
+
+class JsonValue {
+  public:
+    JsonType GetType() const {
+        return mType;
+    }
+    bool IsNull() const {
+        return mType == JsonType::Null;
+    }
+    bool IsNumber() const {
+        return mType == JsonType::Number;
+    }
+    bool IsString() const {
+        return mType == JsonType::String;
+    }
+    bool IsArray() const {
+        return mType == JsonType::Array;
+    }
+    bool IsObject() const {
+        return mType == JsonType::Object;
+    }
+
+    // Typed reads fall back to Default when the value has another type.
+    bool GetBool(bool Default = false) const;
+    double GetNumber(double Default = 0.0) const;
+    float GetFloat(float Default = 0.0f) const;
+    // Integral numbers in range; anything else yields Default.
+    int64_t GetInteger(int64_t Default = 0) const;
+    // Empty for non-strings.
+    const std::string& GetString() const;
+
+    // Array elements; empty for non-arrays.
+    const std::vector<JsonValue>& GetElements() const;
+    size_t GetSize() const;
+    const JsonValue& operator[](size_t Index) const;
+
+    // Object members in document order; empty for non-objects.
+    const std::vector<std::pair<std::string, JsonValue>>& GetMembers() const;
+    // Member named Key, or nullptr if there is none or this is not an object.
+    const JsonValue* Find(std::string_view Key) const;
+
+  private:
+    friend class JsonParser;
+
+    JsonType mType = JsonType::Null;
+    bool mBool = false;
+    double mNumber = 0.0;
+    std::string mString;
+    std::vector<JsonValue> mElements;
+    std::vector<std::pair<std::string, JsonValue>> mMembers;
+};
+
+// Parses UTF-8 JSON text (RFC 8259) into OutRoot. Data need not be null-terminated. Returns
+// false on malformed input or nesting deeper than 256 levels.
+bool ParseJson(const char* Data, size_t Size, JsonValue& OutRoot);
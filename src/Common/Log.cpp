@@ -0,0 +1,508 @@
+﻿// src/Common/Log.cpp
+#include "Log.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace {
+
+// How long the logging thread sleeps between looks at the rings when nobody wakes it.
+constexpr std::chrono::milliseconds LOG_POLL_INTERVAL{10};
+
+const char* const LEVEL_NAMES[] = {"DEBUG", "INFO", "WARNING", "ERROR"};
+const char* const CATEGORY_NAMES[] = {"General", "Window", "Files", "Assets", "Scene", "Graphics"};
+
+struct PackedArg {
+    LogPacking::ArgType Type;
+    uint64_t Bits;           // Numbers and pointers
+    const std::byte* Data;   // Strings
+    uint32_t Size;
+};
+
+class ArgReader {
+  public:
+    ArgReader(const std::byte* Data, uint32_t Count) : mData(Data), mRemaining(Count) {
+    }
+
+    bool Next(PackedArg& Out) {
+        if (mRemaining == 0) {
+            return false;
+        }
+        --mRemaining;
+        uint8_t tag;
+        std::memcpy(&tag, mData, 1);
+        mData += 1;
+        Out.Type = static_cast<LogPacking::ArgType>(tag);
+        if (Out.Type == LogPacking::ArgType::String ||
+            Out.Type == LogPacking::ArgType::WideString) {
+            std::memcpy(&Out.Size, mData, sizeof(Out.Size));
+            Out.Data = mData + sizeof(Out.Size);
+            mData += sizeof(Out.Size) + Out.Size;
+        } else {
+            std::memcpy(&Out.Bits, mData, sizeof(Out.Bits));
+            mData += sizeof(Out.Bits);
+        }
+        return true;
+    }
+
+  private:
+    const std::byte* mData;
+    uint32_t mRemaining;
+};
+
+void AppendUtf8(std::string& Out, uint32_t CodePoint) {
+    if (CodePoint < 0x80) {
+        Out += static_cast<char>(CodePoint);
+    } else if (CodePoint < 0x800) {
+        Out += static_cast<char>(0xC0 | (CodePoint >> 6));
+        Out += static_cast<char>(0x80 | (CodePoint & 0x3F));
+    } else if (CodePoint < 0x10000) {
+        Out += static_cast<char>(0xE0 | (CodePoint >> 12));
+        Out += static_cast<char>(0x80 | ((CodePoint >> 6) & 0x3F));
+        Out += static_cast<char>(0x80 | (CodePoint & 0x3F));
+    } else {
+        Out += static_cast<char>(0xF0 | (CodePoint >> 18));
+        Out += static_cast<char>(0x80 | ((CodePoint >> 12) & 0x3F));
+        Out += static_cast<char>(0x80 | ((CodePoint >> 6) & 0x3F));
+        Out += static_cast<char>(0x80 | (CodePoint & 0x3F));
+    }
+}
+
+// Wide strings are UTF-16 on Windows and UTF-32 elsewhere.
+void AppendWide(std::string& Out, const std::byte* Data, uint32_t Size) {
+    const size_t count = Size / sizeof(wchar_t);
+    for (size_t i = 0; i < count; ++i) {
+        wchar_t c;
+        std::memcpy(&c, Data + i * sizeof(wchar_t), sizeof(c));
+        uint32_t codePoint = static_cast<uint32_t>(c);
+        if (sizeof(wchar_t) == 2 && codePoint >= 0xD800 && codePoint < 0xDC00 && i + 1 < count) {
+            wchar_t low;
+            std::memcpy(&low, Data + (i + 1) * sizeof(wchar_t), sizeof(low));
+            if (static_cast<uint32_t>(low) >= 0xDC00 && static_cast<uint32_t>(low) < 0xE000) {
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) +
+                            (static_cast<uint32_t>(low) - 0xDC00);
+                ++i;
+            }
+        }
+        AppendUtf8(Out, codePoint);
+    }
+}
+
+template <typename T>
+void AppendFormatted(std::string& Out, const std::string& Spec, T Value) {
+    char buffer[128];
+    const int length = std::snprintf(buffer, sizeof(buffer), Spec.c_str(), Value);
+    if (length < 0) {
+        return;
+    }
+    if (static_cast<size_t>(length) < sizeof(buffer)) {
+        Out.append(buffer, static_cast<size_t>(length));
+        return;
+    }
+    // A wide field: format again into the output itself.
+    const size_t start = Out.size();
+    Out.resize(start + length + 1);
+    std::snprintf(&Out[start], length + 1, Spec.c_str(), Value);
+    Out.resize(start + length);
+}
+
+// Formats one argument for a printf conversion. The packed type decides the C type passed to
+// snprintf, so length modifiers in the format string do not matter and mismatches stay safe.
+void AppendArg(std::string& Out, std::string Spec, char Conversion, const PackedArg& Arg) {
+    if (Arg.Type == LogPacking::ArgType::String || Arg.Type == LogPacking::ArgType::WideString) {
+        std::string text;
+        if (Arg.Type == LogPacking::ArgType::String) {
+            text.assign(reinterpret_cast<const char*>(Arg.Data), Arg.Size);
+        } else {
+            AppendWide(text, Arg.Data, Arg.Size);
+        }
+        if (Arg.Size == LogPacking::MAX_STRING_BYTES) {
+            text += "...";
+        }
+        if (Spec.size() == 1) {
+            Out += text;
+        } else {
+            AppendFormatted(Out, Spec + "s", text.c_str());
+        }
+        return;
+    }
+
+    // Only numbers and pointers carry Bits.
+    double floatValue;
+    std::memcpy(&floatValue, &Arg.Bits, sizeof(floatValue));
+    const int64_t signedValue = static_cast<int64_t>(Arg.Bits);
+
+    switch (Conversion) {
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A': {
+        double value = static_cast<double>(signedValue);
+        if (Arg.Type == LogPacking::ArgType::Float) {
+            value = floatValue;
+        } else if (Arg.Type == LogPacking::ArgType::Unsigned) {
+            value = static_cast<double>(Arg.Bits);
+        }
+        AppendFormatted(Out, Spec + Conversion, value);
+        return;
+    }
+    case 'p':
+        AppendFormatted(Out, Spec + 'p', reinterpret_cast<void*>(static_cast<uintptr_t>(Arg.Bits)));
+        return;
+    case 'c':
+        AppendFormatted(Out, Spec + 'c', static_cast<int>(signedValue));
+        return;
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'o': {
+        const unsigned long long value =
+            Arg.Type == LogPacking::ArgType::Float ? static_cast<unsigned long long>(floatValue)
+                                                   : static_cast<unsigned long long>(Arg.Bits);
+        AppendFormatted(Out, Spec + "ll" + Conversion, value);
+        return;
+    }
+    default:
+        // d, i, and numbers given to %s.
+        if (Arg.Type == LogPacking::ArgType::Float) {
+            AppendFormatted(Out, Spec + 'g', floatValue);
+        } else if (Arg.Type == LogPacking::ArgType::Unsigned) {
+            AppendFormatted(Out, Spec + "llu", static_cast<unsigned long long>(Arg.Bits));
+        } else {
+            AppendFormatted(Out, Spec + "lld", static_cast<long long>(signedValue));
+        }
+        return;
+    }
+}
+
+void FormatRecord(const char* Format, const std::byte* Args, uint32_t ArgCount, std::string& Out) {
+    Out.clear();
+    ArgReader reader(Args, ArgCount);
+    const char* p = Format;
+    while (*p != '\0') {
+        if (*p != '%') {
+            Out += *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            Out += '%';
+            p += 2;
+            continue;
+        }
+
+        std::string spec = "%";
+        ++p;
+        while (*p != '\0' && std::strchr("-+ #0", *p) != nullptr) {
+            spec += *p++;
+        }
+        while (std::isdigit(static_cast<unsigned char>(*p))) {
+            spec += *p++;
+        }
+        if (*p == '.') {
+            spec += *p++;
+            while (std::isdigit(static_cast<unsigned char>(*p))) {
+                spec += *p++;
+            }
+        }
+        // Length modifiers, including MSVC's I64, come from the packed type instead.
+        while (*p != '\0' && std::strchr("hlLzjtqI", *p) != nullptr) {
+            const bool msvcWidth = *p == 'I';
+            ++p;
+            while (msvcWidth && std::isdigit(static_cast<unsigned char>(*p))) {
+                ++p;
+            }
+        }
+        if (*p == '\0') {
+            break;
+        }
+        const char conversion = *p++;
+
+        PackedArg arg{};
+        if (!reader.Next(arg)) {
+            Out += "<missing>";
+            continue;
+        }
+        AppendArg(Out, spec, conversion, arg);
+    }
+    if (!Out.empty() && Out.back() == '\n') {
+        Out.pop_back();
+    }
+}
+
+std::string FormatLine(const LogMessage& Message) {
+    char prefix[96];
+    std::snprintf(prefix, sizeof(prefix), "%10.4f [%u] %-7s %s: ", Message.Seconds,
+                  Message.ThreadId, GetLogLevelName(Message.Level),
+                  GetLogCategoryName(Message.Category));
+    std::string line = prefix;
+    line += Message.Text;
+    line += '\n';
+    return line;
+}
+
+} // anonymous namespace
+
+const char* GetLogLevelName(LogLevel Level) {
+    return LEVEL_NAMES[static_cast<uint32_t>(Level)];
+}
+
+const char* GetLogCategoryName(LogCategory Category) {
+    return Category < LogCategory::Count ? CATEGORY_NAMES[static_cast<uint32_t>(Category)] : "?";
+}
+
+void DebuggerLogSink::Write(const LogMessage& Message) {
+#ifdef _WIN32
+    const std::string line = FormatLine(Message);
+    const int length = MultiByteToWideChar(CP_UTF8, 0, line.c_str(), -1, nullptr, 0);
+    if (length > 0) {
+        std::wstring wide(static_cast<size_t>(length), L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, line.c_str(), -1, wide.data(), length);
+        OutputDebugStringW(wide.c_str());
+    }
+#else
+    (void)Message;
+#endif
+}
+
+void StdoutLogSink::Write(const LogMessage& Message) {
+    std::fputs(FormatLine(Message).c_str(), stdout);
+}
+
+void StdoutLogSink::Flush() {
+    std::fflush(stdout);
+}
+
+FileLogSink::FileLogSink(const std::filesystem::path& Path)
+    : mFile(Path, std::ios::binary | std::ios::trunc) {
+}
+
+void FileLogSink::Write(const LogMessage& Message) {
+    mFile << FormatLine(Message);
+}
+
+void FileLogSink::Flush() {
+    mFile.flush();
+}
+
+LogThreadBuffer::LogThreadBuffer(uint32_t ThreadId)
+    : mData(new std::byte[CAPACITY]), mThreadId(ThreadId) {
+}
+
+std::byte* LogThreadBuffer::Reserve(uint32_t Size) {
+    const uint64_t write = mWrite.load(std::memory_order_relaxed);
+    const uint64_t read = mRead.load(std::memory_order_acquire);
+    const uint64_t offset = write % CAPACITY;
+    // Records never wrap: the tail of the ring is skipped, marked when a header fits there.
+    const uint64_t padding = offset + Size > CAPACITY ? CAPACITY - offset : 0;
+    if (write + padding + Size - read > CAPACITY) {
+        return nullptr;
+    }
+    if (padding >= sizeof(LogPacking::RecordHeader)) {
+        LogPacking::RecordHeader marker{};
+        marker.Size = static_cast<uint32_t>(padding);
+        marker.Format = nullptr;
+        std::memcpy(mData.get() + offset, &marker, sizeof(marker));
+    }
+    mPendingWrite = write + padding + Size;
+    mHalfFull = write - read < CAPACITY / 2 && mPendingWrite - read >= CAPACITY / 2;
+    return mData.get() + (write + padding) % CAPACITY;
+}
+
+Logger& Logger::Get() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() : mStartTime(std::chrono::steady_clock::now()) {
+#ifdef _WIN32
+    mSinks.push_back(std::make_unique<DebuggerLogSink>());
+#endif
+    mThread = std::thread(&Logger::WriterMain, this);
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mCondition.notify_one();
+    mThread.join();
+}
+
+void Logger::SetCategoryEnabled(LogCategory Category, bool Enabled) {
+    const uint32_t bit = 1u << static_cast<uint32_t>(Category);
+    if (Enabled) {
+        mCategoryMask.fetch_or(bit, std::memory_order_relaxed);
+    } else {
+        mCategoryMask.fetch_and(~bit, std::memory_order_relaxed);
+    }
+}
+
+void Logger::AddSink(std::unique_ptr<LogSink> Sink) {
+    std::lock_guard<std::mutex> lock(mSinkMutex);
+    mSinks.push_back(std::move(Sink));
+}
+
+void Logger::ClearSinks() {
+    std::lock_guard<std::mutex> lock(mSinkMutex);
+    mSinks.clear();
+}
+
+void Logger::Flush() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    const uint64_t request = ++mFlushRequests;
+    mCondition.notify_one();
+    mFlushedCondition.wait(lock, [this, request] { return mFlushesDone >= request; });
+}
+
+LogStats Logger::GetStats() const {
+    LogStats stats;
+    stats.Written = mWritten.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mBufferMutex);
+    for (const auto& buffer : mBuffers) {
+        stats.Dropped += buffer->mDropped.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+LogThreadBuffer& Logger::RegisterThread() {
+    std::lock_guard<std::mutex> lock(mBufferMutex);
+    mBuffers.push_back(
+        std::make_unique<LogThreadBuffer>(static_cast<uint32_t>(mBuffers.size() + 1)));
+    return *mBuffers.back();
+}
+
+uint64_t Logger::GetNanoseconds() const {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now() - mStartTime)
+                                     .count());
+}
+
+void Logger::WriterMain() {
+    for (;;) {
+        uint64_t flushRequest;
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait_for(lock, LOG_POLL_INTERVAL, [this] {
+                return mStopping || mFlushRequests != mFlushesDone ||
+                       mWakeRequested.load(std::memory_order_relaxed);
+            });
+            mWakeRequested.store(false, std::memory_order_relaxed);
+            flushRequest = mFlushRequests;
+            stopping = mStopping;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mSinkMutex);
+            mWritten.fetch_add(DrainBuffers(), std::memory_order_relaxed);
+            if (flushRequest != mFlushesDone || stopping) {
+                for (const auto& sink : mSinks) {
+                    sink->Flush();
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mFlushesDone = flushRequest;
+        }
+        mFlushedCondition.notify_all();
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+uint64_t Logger::DrainBuffers() {
+    struct Pending {
+        uint64_t Nanoseconds;
+        uint32_t ThreadId;
+        const std::byte* Record;
+    };
+
+    std::vector<LogThreadBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lock(mBufferMutex);
+        for (const auto& buffer : mBuffers) {
+            buffers.push_back(buffer.get());
+        }
+    }
+
+    // Gather every published record, then write them in time order across threads.
+    std::vector<Pending> pending;
+    std::vector<uint64_t> ends(buffers.size());
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        LogThreadBuffer& buffer = *buffers[i];
+        const uint64_t write = buffer.mWrite.load(std::memory_order_acquire);
+        uint64_t read = buffer.mRead.load(std::memory_order_relaxed);
+        while (read < write) {
+            const uint64_t offset = read % LogThreadBuffer::CAPACITY;
+            if (LogThreadBuffer::CAPACITY - offset < sizeof(LogPacking::RecordHeader)) {
+                read += LogThreadBuffer::CAPACITY - offset;
+                continue;
+            }
+            const std::byte* record = buffer.mData.get() + offset;
+            LogPacking::RecordHeader header;
+            std::memcpy(&header, record, sizeof(header));
+            if (header.Format != nullptr) {
+                pending.push_back({header.Nanoseconds, buffer.mThreadId, record});
+            }
+            read += header.Size;
+        }
+        ends[i] = write;
+    }
+    std::stable_sort(pending.begin(), pending.end(), [](const Pending& A, const Pending& B) {
+        return A.Nanoseconds < B.Nanoseconds;
+    });
+
+    for (const Pending& entry : pending) {
+        LogPacking::RecordHeader header;
+        std::memcpy(&header, entry.Record, sizeof(header));
+        FormatRecord(header.Format, entry.Record + sizeof(header), header.ArgCount, mLine);
+
+        LogMessage message;
+        message.Level = header.Level;
+        message.Category = header.Category;
+        message.ThreadId = entry.ThreadId;
+        message.Seconds = header.Nanoseconds / 1e9;
+        message.Text = mLine.c_str();
+        for (const auto& sink : mSinks) {
+            sink->Write(message);
+        }
+    }
+
+    uint64_t written = pending.size();
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        LogThreadBuffer& buffer = *buffers[i];
+        buffer.mRead.store(ends[i], std::memory_order_release);
+
+        // Report drops once the ring has room again, so the report itself is not lost.
+        const uint64_t dropped = buffer.mDropped.load(std::memory_order_relaxed);
+        if (dropped != buffer.mReportedDrops) {
+            const std::string text = "Dropped " + std::to_string(dropped - buffer.mReportedDrops) +
+                                     " messages: the thread's log ring was full";
+            LogMessage message;
+            message.Level = LogLevel::Warning;
+            message.Category = LogCategory::General;
+            message.ThreadId = buffer.mThreadId;
+            message.Seconds = GetNanoseconds() / 1e9;
+            message.Text = text.c_str();
+            for (const auto& sink : mSinks) {
+                sink->Write(message);
+            }
+            buffer.mReportedDrops = dropped;
+            ++written;
+        }
+    }
+    return written;
+}
@@ -0,0 +1,317 @@
+﻿// src/Common/Log.h
+// Asynchronous logging. A call copies the format string pointer and its arguments, packed as
+// binary, into the calling thread's lock-free ring and returns; a background thread formats the
+// records printf-style and hands the lines to the sinks. A full ring drops the record and counts
+// it rather than blocking the caller.
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+enum class LogLevel : uint8_t { Debug, Info, Warning, Error };
+
+enum class LogCategory : uint8_t { General, Window, Files, Assets, Scene, Graphics, Count };
+
+const char* GetLogLevelName(LogLevel Level);
+const char* GetLogCategoryName(LogCategory Category);
+
+// A formatted record, as the sinks see it.
+struct LogMessage {
+    LogLevel Level;
+    LogCategory Category;
+    uint32_t ThreadId; // Order in which threads first logged, starting at 1
+    double Seconds;    // Since the logger started
+    const char* Text;  // Formatted message, without a trailing newline
+};
+
+// Called on the logging thread only.
+class LogSink {
+  public:
+    virtual ~LogSink() = default;
+    virtual void Write(const LogMessage& Message) = 0;
+    virtual void Flush() {
+    }
+};
+
+// OutputDebugString on Windows; does nothing elsewhere.
+class DebuggerLogSink : public LogSink {
+  public:
+    void Write(const LogMessage& Message) override;
+};
+
+class StdoutLogSink : public LogSink {
+  public:
+    void Write(const LogMessage& Message) override;
+    void Flush() override;
+};
+
+class FileLogSink : public LogSink {
+  public:
+    explicit FileLogSink(const std::filesystem::path& Path);
+    bool IsOpen() const {
+        return mFile.is_open();
+    }
+    void Write(const LogMessage& Message) override;
+    void Flush() override;
+
+  private:
+    std::ofstream mFile;
+};
+
+struct LogStats {
+    uint64_t Written = 0;
+    uint64_t Dropped = 0; // Rings were full
+};
+
+namespace LogPacking {
+
+enum class ArgType : uint8_t { Signed, Unsigned, Float, Pointer, String, WideString };
+
+// Longer string arguments are cut short, visibly.
+constexpr uint32_t MAX_STRING_BYTES = 4096;
+
+struct RecordHeader {
+    uint32_t Size; // Whole record including padding; a null Format marks ring padding
+    LogLevel Level;
+    LogCategory Category;
+    uint16_t ArgCount;
+    const char* Format;
+    uint64_t Nanoseconds;
+};
+
+inline size_t StringBytes(size_t Length, size_t CharSize) {
+    const size_t bytes = Length * CharSize;
+    return bytes < MAX_STRING_BYTES ? bytes : MAX_STRING_BYTES / CharSize * CharSize;
+}
+
+template <typename T>
+size_t GetPackedSize(const T& Value) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        return 1 + sizeof(uint32_t) + StringBytes(Value.size(), 1);
+    } else if constexpr (std::is_same_v<T, std::wstring>) {
+        return 1 + sizeof(uint32_t) + StringBytes(Value.size(), sizeof(wchar_t));
+    } else if constexpr (std::is_convertible_v<T, const char*>) {
+        const char* text = Value;
+        return 1 + sizeof(uint32_t) + (text ? StringBytes(std::strlen(text), 1) : 0);
+    } else if constexpr (std::is_convertible_v<T, const wchar_t*>) {
+        const wchar_t* text = Value;
+        return 1 + sizeof(uint32_t) +
+               (text ? StringBytes(std::char_traits<wchar_t>::length(text), sizeof(wchar_t)) : 0);
+    } else {
+        static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>,
+                      "Log arguments must be numbers, pointers or strings");
+        return 1 + sizeof(uint64_t);
+    }
+}
+
+inline void PackBytes(std::byte*& Out, const void* Data, size_t Size) {
+    std::memcpy(Out, Data, Size);
+    Out += Size;
+}
+
+inline void PackString(std::byte*& Out, ArgType Type, const void* Data, size_t Bytes) {
+    const uint8_t tag = static_cast<uint8_t>(Type);
+    const uint32_t size = static_cast<uint32_t>(Bytes);
+    PackBytes(Out, &tag, 1);
+    PackBytes(Out, &size, sizeof(size));
+    PackBytes(Out, Data, Bytes);
+}
+
+template <typename T>
+void Pack(std::byte*& Out, const T& Value) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        PackString(Out, ArgType::String, Value.data(), StringBytes(Value.size(), 1));
+    } else if constexpr (std::is_same_v<T, std::wstring>) {
+        PackString(Out, ArgType::WideString, Value.data(),
+                   StringBytes(Value.size(), sizeof(wchar_t)));
+    } else if constexpr (std::is_convertible_v<T, const char*>) {
+        const char* text = Value;
+        PackString(Out, ArgType::String, text, text ? StringBytes(std::strlen(text), 1) : 0);
+    } else if constexpr (std::is_convertible_v<T, const wchar_t*>) {
+        const wchar_t* text = Value;
+        PackString(
+            Out, ArgType::WideString, text,
+            text ? StringBytes(std::char_traits<wchar_t>::length(text), sizeof(wchar_t)) : 0);
+    } else {
+        uint8_t tag;
+        uint64_t bits;
+        if constexpr (std::is_floating_point_v<T>) {
+            tag = static_cast<uint8_t>(ArgType::Float);
+            const double value = Value;
+            std::memcpy(&bits, &value, sizeof(bits));
+        } else if constexpr (std::is_pointer_v<T>) {
+            tag = static_cast<uint8_t>(ArgType::Pointer);
+            bits = reinterpret_cast<uintptr_t>(Value);
+        } else if constexpr (std::is_enum_v<T>) {
+            tag = static_cast<uint8_t>(ArgType::Signed);
+            bits = static_cast<uint64_t>(static_cast<int64_t>(Value));
+        } else if constexpr (std::is_signed_v<T>) {
+            tag = static_cast<uint8_t>(ArgType::Signed);
+            bits = static_cast<uint64_t>(static_cast<int64_t>(Value));
+        } else {
+            tag = static_cast<uint8_t>(ArgType::Unsigned);
+            bits = static_cast<uint64_t>(Value);
+        }
+        PackBytes(Out, &tag, 1);
+        PackBytes(Out, &bits, sizeof(bits));
+    }
+}
+
+} // namespace LogPacking
+
+// One thread's records. Only that thread writes; only the logging thread reads.
+class LogThreadBuffer {
+  public:
+    static constexpr uint32_t CAPACITY = 64 * 1024;
+
+    explicit LogThreadBuffer(uint32_t ThreadId);
+
+    // Returns space for Size bytes, a multiple of 8, or null when the ring is full.
+    std::byte* Reserve(uint32_t Size);
+    // Publishes the record written to the last Reserve.
+    void Commit() {
+        mWrite.store(mPendingWrite, std::memory_order_release);
+    }
+
+  private:
+    friend class Logger;
+
+    std::unique_ptr<std::byte[]> mData;
+    std::atomic<uint64_t> mWrite{0}; // Byte positions since creation
+    std::atomic<uint64_t> mRead{0};
+    uint64_t mPendingWrite = 0;
+    bool mHalfFull = false; // The last Reserve filled the ring past half
+    std::atomic<uint64_t> mDropped{0};
+    uint64_t mReportedDrops = 0; // Logging thread only
+    uint32_t mThreadId;
+};
+
+class Logger {
+  public:
+    // Starts the logging thread on first use. On Windows it begins with a DebuggerLogSink.
+    static Logger& Get();
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // Checked by the LOG_ macros before any argument is evaluated.
+    static bool IsEnabled(LogLevel Level, LogCategory Category) {
+        const Logger& logger = Get();
+        return Level >= logger.mMinLevel.load(std::memory_order_relaxed) &&
+               (logger.mCategoryMask.load(std::memory_order_relaxed) &
+                (1u << static_cast<uint32_t>(Category))) != 0;
+    }
+    void SetMinLevel(LogLevel Level) {
+        mMinLevel.store(Level, std::memory_order_relaxed);
+    }
+    void SetCategoryEnabled(LogCategory Category, bool Enabled);
+
+    void AddSink(std::unique_ptr<LogSink> Sink);
+    void ClearSinks();
+
+    // Any thread. Copies Format's arguments; Format itself must be a string literal.
+    template <typename... Args>
+    void Write(LogLevel Level, LogCategory Category, const char* Format, const Args&... Arguments) {
+        const size_t size = sizeof(LogPacking::RecordHeader) +
+                            (size_t{0} + ... + LogPacking::GetPackedSize(Arguments));
+        LogThreadBuffer& buffer = GetThreadBuffer();
+        std::byte* record = size <= LogThreadBuffer::CAPACITY / 4
+                                ? buffer.Reserve(static_cast<uint32_t>((size + 7) & ~size_t{7}))
+                                : nullptr;
+        if (record == nullptr) {
+            buffer.mDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        LogPacking::RecordHeader header;
+        header.Size = static_cast<uint32_t>((size + 7) & ~size_t{7});
+        header.Level = Level;
+        header.Category = Category;
+        header.ArgCount = static_cast<uint16_t>(sizeof...(Args));
+        header.Format = Format;
+        header.Nanoseconds = GetNanoseconds();
+        std::memcpy(record, &header, sizeof(header));
+        std::byte* out = record + sizeof(header);
+        (LogPacking::Pack(out, Arguments), ...);
+        buffer.Commit();
+
+        // Errors go out right away, in case the process is about to die; a filling ring is
+        // drained early rather than dropping records before the next poll.
+        if (Level == LogLevel::Error || buffer.mHalfFull) {
+            mWakeRequested.store(true, std::memory_order_relaxed);
+            mCondition.notify_one();
+        }
+    }
+
+    // Blocks until everything logged before the call has reached the sinks and they are flushed.
+    void Flush();
+
+    LogStats GetStats() const;
+
+  private:
+    Logger();
+    static LogThreadBuffer& GetThreadBuffer() {
+        if (tBuffer == nullptr) {
+            tBuffer = &Get().RegisterThread();
+        }
+        return *tBuffer;
+    }
+    LogThreadBuffer& RegisterThread();
+    uint64_t GetNanoseconds() const;
+    void WriterMain();
+    // Formats and writes every published record. Returns the number written. Needs mSinkMutex.
+    uint64_t DrainBuffers();
+
+    static inline thread_local LogThreadBuffer* tBuffer = nullptr;
+
+    std::atomic<LogLevel> mMinLevel{LogLevel::Debug};
+    std::atomic<uint32_t> mCategoryMask{~0u};
+    const std::chrono::steady_clock::time_point mStartTime;
+
+    mutable std::mutex mBufferMutex;
+    std::vector<std::unique_ptr<LogThreadBuffer>> mBuffers;
+
+    std::mutex mSinkMutex; // Held while records are formatted and written
+    std::vector<std::unique_ptr<LogSink>> mSinks;
+    std::string mLine; // Logging thread's formatting buffer
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::condition_variable mFlushedCondition;
+    uint64_t mFlushRequests = 0;
+    uint64_t mFlushesDone = 0;
+    bool mStopping = false;
+    // Set without the mutex, so a wake can be missed; the poll interval bounds the delay.
+    std::atomic<bool> mWakeRequested{false};
+    std::atomic<uint64_t> mWritten{0};
+    std::thread mThread;
+};
+
+#define LOG_MESSAGE(Level, Category, Format, ...)                                                  \
+    do {                                                                                           \
+        if (Logger::IsEnabled(Level, Category)) {                                                  \
+            Logger::Get().Write(Level, Category, Format, ##__VA_ARGS__);                           \
+        }                                                                                          \
+    } while (0)
+
+#define LOG_DEBUG(Category, Format, ...)                                                           \
+    LOG_MESSAGE(LogLevel::Debug, LogCategory::Category, Format, ##__VA_ARGS__)
+#define LOG_INFO(Category, Format, ...)                                                            \
+    LOG_MESSAGE(LogLevel::Info, LogCategory::Category, Format, ##__VA_ARGS__)
+#define LOG_WARNING(Category, Format, ...)                                                         \
+    LOG_MESSAGE(LogLevel::Warning, LogCategory::Category, Format, ##__VA_ARGS__)
+#define LOG_ERROR(Category, Format, ...)                                                           \
+    LOG_MESSAGE(LogLevel::Error, LogCategory::Category, Format, ##__VA_ARGS__)
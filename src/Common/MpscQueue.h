@@ -0,0 +1,74 @@
+﻿// src/Common/MpscQueue.h
+// Lock-free queue for many producer threads and one consumer, used to hand finished work back
+// to the main loop without it ever waiting on a worker.
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+template <typename T>
+class MpscQueue {
+  public:
+    MpscQueue() = default;
+    ~MpscQueue() {
+        Release(mHead.exchange(nullptr, std::memory_order_acquire));
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Any thread. Everything the producer wrote before Push is visible to the consumer after
+    // it receives Value.
+    void Push(T Value) {
+        Node* node = new Node{std::move(Value), mHead.load(std::memory_order_relaxed)};
+        while (!mHead.compare_exchange_weak(node->Next, node, std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+        }
+    }
+
+    // Consumer thread only. Takes everything pushed so far and calls Consumer on each value in
+    // push order. Returns the number of values. Taking the whole list in one exchange is what
+    // keeps the producers' compare-exchange free of ABA problems.
+    template <typename F>
+    size_t ConsumeAll(F&& Consumer) {
+        Node* node = mHead.exchange(nullptr, std::memory_order_acquire);
+        if (node == nullptr) {
+            return 0;
+        }
+
+        // The list is newest first; reverse it.
+        Node* oldest = nullptr;
+        while (node != nullptr) {
+            Node* next = node->Next;
+            node->Next = oldest;
+            oldest = node;
+            node = next;
+        }
+
+        size_t count = 0;
+        while (oldest != nullptr) {
+            Node* next = oldest->Next;
+            Consumer(std::move(oldest->Value));
+            delete oldest;
+            oldest = next;
+            ++count;
+        }
+        return count;
+    }
+
+  private:
+    struct Node {
+        T Value;
+        Node* Next;
+    };
+
+    static void Release(Node* Head) {
+        while (Head != nullptr) {
+            Node* next = Head->Next;
+            delete Head;
+            Head = next;
+        }
+    }
+
+    std::atomic<Node*> mHead{nullptr};
+};
@@ -0,0 +1,194 @@
+﻿// src/Common/Profiler.cpp
+#include "Profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+namespace {
+
+constexpr ProfileZoneInfo FRAME_ZONE{"Frame", __FILE__, __LINE__};
+
+void WriteJsonString(std::ofstream& File, const char* Text) {
+    File << '"';
+    for (const char* c = Text; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            File << '\\';
+        }
+        File << *c;
+    }
+    File << '"';
+}
+
+} // anonymous namespace
+
+Profiler& Profiler::Get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+    : mStartTicks(ReadProfileTicks()), mStartTime(std::chrono::steady_clock::now()) {
+    mLastFrameTicks = mStartTicks;
+}
+
+ProfileThreadBuffer& Profiler::RegisterThread() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mBuffers.push_back(
+        std::make_unique<ProfileThreadBuffer>(static_cast<uint32_t>(mBuffers.size() + 1)));
+    return *mBuffers.back();
+}
+
+void Profiler::SetThreadName(const char* Name) {
+    ProfileThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(mMutex);
+    buffer.mName = Name;
+}
+
+void Profiler::MarkFrame() {
+    const uint64_t now = ReadProfileTicks();
+    GetThreadBuffer().Push({&FRAME_ZONE, now, now, 0.0, ProfileEventType::Frame});
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    const double msPerTick = 1.0 / (GetTicksPerMicrosecond() * 1000.0);
+    AddSample(&FRAME_ZONE, (now - mLastFrameTicks) * msPerTick);
+    mLastFrameTicks = now;
+
+    for (const auto& buffer : mBuffers) {
+        const uint64_t write = buffer->mWrite.load(std::memory_order_acquire);
+        if (write - buffer->mCollected > ProfileThreadBuffer::CAPACITY) {
+            mDroppedEvents += write - buffer->mCollected - ProfileThreadBuffer::CAPACITY;
+            buffer->mCollected = write - ProfileThreadBuffer::CAPACITY;
+        }
+        for (; buffer->mCollected < write; ++buffer->mCollected) {
+            ProfileEvent event;
+            if (!buffer->Read(buffer->mCollected, event)) {
+                // The thread lapped the collector while it was reading.
+                ++mDroppedEvents;
+                continue;
+            }
+            if (event.Type == ProfileEventType::Zone) {
+                AddSample(event.Zone, (event.End - event.Start) * msPerTick);
+            }
+        }
+    }
+}
+
+std::vector<ProfileZoneStats> Profiler::GetZoneStats() const {
+    std::vector<ProfileZoneStats> result;
+    std::vector<float> sorted;
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (const auto& [zone, samples] : mZones) {
+        sorted = samples.Ms;
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (float ms : sorted) {
+            sum += ms;
+        }
+
+        ProfileZoneStats stats;
+        stats.Zone = zone;
+        stats.Count = samples.Count;
+        stats.MinMs = sorted.front();
+        stats.MaxMs = sorted.back();
+        stats.AvgMs = sum / sorted.size();
+        stats.P99Ms = sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+        result.push_back(stats);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const ProfileZoneStats& A, const ProfileZoneStats& B) {
+                  return A.AvgMs > B.AvgMs;
+              });
+    return result;
+}
+
+uint64_t Profiler::GetDroppedEventCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mDroppedEvents;
+}
+
+bool Profiler::ExportChromeTrace(const std::filesystem::path& Path) const {
+    std::ofstream file(Path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    const double ticksPerUs = GetTicksPerMicrosecond();
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separate = [&file, &first]() {
+        if (!first) {
+            file << ",\n";
+        }
+        first = false;
+    };
+
+    for (const auto& buffer : mBuffers) {
+        if (buffer->mName != nullptr) {
+            separate();
+            file << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->mThreadId
+                 << ",\"args\":{\"name\":";
+            WriteJsonString(file, buffer->mName);
+            file << "}}";
+        }
+
+        const uint64_t write = buffer->mWrite.load(std::memory_order_acquire);
+        const uint64_t begin =
+            write > ProfileThreadBuffer::CAPACITY ? write - ProfileThreadBuffer::CAPACITY : 0;
+        for (uint64_t i = begin; i < write; ++i) {
+            ProfileEvent event;
+            if (!buffer->Read(i, event)) {
+                continue;
+            }
+            // Signed, in case the TSC of another core started a little behind this one.
+            const double startUs =
+                static_cast<double>(static_cast<int64_t>(event.Start - mStartTicks)) / ticksPerUs;
+            separate();
+            file << "{\"name\":";
+            WriteJsonString(file, event.Zone->Name);
+            file << ",\"pid\":1,\"tid\":" << buffer->mThreadId << ",\"ts\":" << startUs;
+            switch (event.Type) {
+            case ProfileEventType::Zone:
+                file << ",\"ph\":\"X\",\"dur\":" << (event.End - event.Start) / ticksPerUs
+                     << ",\"args\":{\"file\":";
+                WriteJsonString(file, event.Zone->File);
+                file << ",\"line\":" << event.Zone->Line << "}}";
+                break;
+            case ProfileEventType::Counter:
+                file << ",\"ph\":\"C\",\"args\":{\"value\":" << event.Value << "}}";
+                break;
+            case ProfileEventType::Frame:
+                file << ",\"ph\":\"i\",\"s\":\"g\"}";
+                break;
+            }
+        }
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
+
+void Profiler::AddSample(const ProfileZoneInfo* Zone, double Ms) {
+    ZoneSamples& samples = mZones[Zone];
+    if (samples.Ms.size() < STATS_WINDOW) {
+        samples.Ms.push_back(static_cast<float>(Ms));
+    } else {
+        samples.Ms[samples.Next] = static_cast<float>(Ms);
+        samples.Next = (samples.Next + 1) % STATS_WINDOW;
+    }
+    ++samples.Count;
+}
+
+double Profiler::GetTicksPerMicrosecond() const {
+#ifdef DXMINI_PROFILER_RDTSC
+    const uint64_t ticks = ReadProfileTicks() - mStartTicks;
+    const double us = std::chrono::duration<double, std::micro>(
+                          std::chrono::steady_clock::now() - mStartTime)
+                          .count();
+    // Too short a baseline gives a noisy rate; assume a typical 3 GHz until there is one.
+    return us > 1000.0 ? ticks / us : 3000.0;
+#else
+    return std::chrono::steady_clock::period::den /
+           (1e6 * std::chrono::steady_clock::period::num);
+#endif
+}
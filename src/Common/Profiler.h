@@ -0,0 +1,227 @@
+﻿// src/Common/Profiler.h
+// Scoped timing zones, frame markers and counters. Each thread records into its own ring of
+// events without locks; MarkFrame folds new samples into rolling per-zone statistics, and the
+// recorded events export as a Chrome trace that chrome://tracing and Perfetto open.
+// With DXMINI_PROFILER off the macros compile to nothing.
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define DXMINI_PROFILER_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define DXMINI_PROFILER_RDTSC 1
+#endif
+
+#ifndef DXMINI_PROFILER
+#define DXMINI_PROFILER 0
+#endif
+
+// One per instrumented call site; its address identifies the zone.
+struct ProfileZoneInfo {
+    const char* Name;
+    const char* File;
+    uint32_t Line;
+};
+
+enum class ProfileEventType : uint8_t { Zone, Counter, Frame };
+
+struct ProfileEvent {
+    const ProfileZoneInfo* Zone;
+    uint64_t Start; // Ticks
+    uint64_t End;   // Ticks; equals Start for counters and frame markers
+    double Value;   // Counters only
+    ProfileEventType Type;
+};
+
+// Rolling statistics over a zone's most recent samples.
+struct ProfileZoneStats {
+    const ProfileZoneInfo* Zone = nullptr;
+    uint64_t Count = 0; // Samples since the start
+    double MinMs = 0.0;
+    double AvgMs = 0.0;
+    double P99Ms = 0.0;
+    double MaxMs = 0.0;
+};
+
+// The invariant TSC where there is one, steady_clock (QueryPerformanceCounter on Windows)
+// elsewhere. Converted to time only when statistics or traces are produced.
+inline uint64_t ReadProfileTicks() {
+#ifdef DXMINI_PROFILER_RDTSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Events of one thread. Only that thread writes; the collector reads behind it. A thread that
+// records more than CAPACITY events between two collections loses the oldest ones.
+class ProfileThreadBuffer {
+  public:
+    static constexpr uint32_t CAPACITY = 1u << 15;
+
+    explicit ProfileThreadBuffer(uint32_t ThreadId)
+        : mSlots(new Slot[CAPACITY]), mThreadId(ThreadId) {
+    }
+
+    // Each slot is a seqlock: its sequence is cleared while the event is written and then set
+    // to the event's index + 1, so a reader can tell a finished event from one being replaced.
+    void Push(const ProfileEvent& Event) {
+        const uint64_t write = mWrite.load(std::memory_order_relaxed);
+        Slot& slot = mSlots[write & (CAPACITY - 1)];
+        slot.Sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.Zone.store(Event.Zone, std::memory_order_relaxed);
+        slot.Start.store(Event.Start, std::memory_order_relaxed);
+        slot.End.store(Event.End, std::memory_order_relaxed);
+        slot.Value.store(Event.Value, std::memory_order_relaxed);
+        slot.Type.store(Event.Type, std::memory_order_relaxed);
+        slot.Sequence.store(write + 1, std::memory_order_release);
+        mWrite.store(write + 1, std::memory_order_release);
+    }
+
+    // Any thread. False when the event at Index was overwritten or is being overwritten.
+    bool Read(uint64_t Index, ProfileEvent& OutEvent) const {
+        const Slot& slot = mSlots[Index & (CAPACITY - 1)];
+        if (slot.Sequence.load(std::memory_order_acquire) != Index + 1) {
+            return false;
+        }
+        OutEvent.Zone = slot.Zone.load(std::memory_order_relaxed);
+        OutEvent.Start = slot.Start.load(std::memory_order_relaxed);
+        OutEvent.End = slot.End.load(std::memory_order_relaxed);
+        OutEvent.Value = slot.Value.load(std::memory_order_relaxed);
+        OutEvent.Type = slot.Type.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.Sequence.load(std::memory_order_relaxed) == Index + 1;
+    }
+
+  private:
+    friend class Profiler;
+
+    // The fields are relaxed atomics, so a read racing a write gets stale values rather than
+    // undefined behaviour, and the sequence check then throws them away.
+    struct Slot {
+        std::atomic<uint64_t> Sequence{0};
+        std::atomic<const ProfileZoneInfo*> Zone{nullptr};
+        std::atomic<uint64_t> Start{0};
+        std::atomic<uint64_t> End{0};
+        std::atomic<double> Value{0.0};
+        std::atomic<ProfileEventType> Type{ProfileEventType::Zone};
+    };
+
+    std::unique_ptr<Slot[]> mSlots;
+    std::atomic<uint64_t> mWrite{0};
+    uint64_t mCollected = 0; // Events already folded into the statistics
+    uint32_t mThreadId;
+    const char* mName = nullptr;
+};
+
+class Profiler {
+  public:
+    // Samples per zone the rolling statistics cover.
+    static constexpr uint32_t STATS_WINDOW = 256;
+
+    static Profiler& Get();
+
+    // The calling thread's buffer, registered on first use.
+    static ProfileThreadBuffer& GetThreadBuffer() {
+        if (tBuffer == nullptr) {
+            tBuffer = &Get().RegisterThread();
+        }
+        return *tBuffer;
+    }
+
+    // Names the calling thread in traces. Name must outlive the profiler, e.g. a literal.
+    void SetThreadName(const char* Name);
+
+    // Ends a frame: records a marker on the calling thread and folds every thread's new zone
+    // samples into the statistics. Call from one thread, normally the main loop.
+    void MarkFrame();
+
+    // Zones seen so far, slowest average first. Frame lengths appear as the zone "Frame".
+    std::vector<ProfileZoneStats> GetZoneStats() const;
+    // Counts events overwritten before MarkFrame got to them.
+    uint64_t GetDroppedEventCount() const;
+
+    // Writes the events still held by every thread's buffer as Chrome trace JSON. Threads may
+    // keep recording; events they overwrite meanwhile are left out.
+    bool ExportChromeTrace(const std::filesystem::path& Path) const;
+
+  private:
+    struct ZoneSamples {
+        std::vector<float> Ms; // Ring of the last STATS_WINDOW samples
+        uint32_t Next = 0;
+        uint64_t Count = 0;
+    };
+
+    Profiler();
+    ProfileThreadBuffer& RegisterThread();
+    void AddSample(const ProfileZoneInfo* Zone, double Ms);
+    // Ticks per microsecond, measured against steady_clock since the profiler started.
+    double GetTicksPerMicrosecond() const;
+
+    static inline thread_local ProfileThreadBuffer* tBuffer = nullptr;
+
+    mutable std::mutex mMutex;
+    std::vector<std::unique_ptr<ProfileThreadBuffer>> mBuffers;
+    std::unordered_map<const ProfileZoneInfo*, ZoneSamples> mZones;
+    uint64_t mDroppedEvents = 0;
+    uint64_t mLastFrameTicks = 0;
+    const uint64_t mStartTicks;
+    const std::chrono::steady_clock::time_point mStartTime;
+};
+
+// Records the time between construction and destruction as one zone event.
+class ProfileScope {
+  public:
+    explicit ProfileScope(const ProfileZoneInfo& Zone) : mZone(&Zone), mStart(ReadProfileTicks()) {
+    }
+    ~ProfileScope() {
+        Profiler::GetThreadBuffer().Push(
+            {mZone, mStart, ReadProfileTicks(), 0.0, ProfileEventType::Zone});
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+  private:
+    const ProfileZoneInfo* mZone;
+    uint64_t mStart;
+};
+
+inline void RecordProfileCounter(const ProfileZoneInfo& Counter, double Value) {
+    const uint64_t now = ReadProfileTicks();
+    Profiler::GetThreadBuffer().Push({&Counter, now, now, Value, ProfileEventType::Counter});
+}
+
+#define PROFILE_CONCAT_INNER(A, B) A##B
+#define PROFILE_CONCAT(A, B) PROFILE_CONCAT_INNER(A, B)
+
+#if DXMINI_PROFILER
+// Times the rest of the enclosing scope. Name must be a string literal.
+#define PROFILE_ZONE(Name)                                                                         \
+    static constexpr ProfileZoneInfo PROFILE_CONCAT(profileZone, __LINE__){Name, __FILE__,         \
+                                                                           __LINE__};              \
+    ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(PROFILE_CONCAT(profileZone, __LINE__))
+#define PROFILE_COUNTER(Name, Value)                                                               \
+    do {                                                                                           \
+        static constexpr ProfileZoneInfo profileCounter{Name, __FILE__, __LINE__};                \
+        RecordProfileCounter(profileCounter, static_cast<double>(Value));                          \
+    } while (0)
+#define PROFILE_FRAME() Profiler::Get().MarkFrame()
+#define PROFILE_THREAD(Name) Profiler::Get().SetThreadName(Name)
+#else
+#define PROFILE_ZONE(Name) ((void)0)
+#define PROFILE_COUNTER(Name, Value) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_THREAD(Name) ((void)0)
+#endif
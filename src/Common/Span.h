@@ -0,0 +1,45 @@
+﻿// src/Common/Span.h
+// Non-owning view of a contiguous array, for data that lives in someone else's buffer such as a
+// memory-mapped file. Stands in for std::span until the project moves to C++20.
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+template <typename T>
+class Span {
+  public:
+    constexpr Span() = default;
+    constexpr Span(T* Data, size_t Size) : mData(Data), mSize(Size) {
+    }
+    template <typename U>
+    Span(const std::vector<U>& Vector) : mData(Vector.data()), mSize(Vector.size()) {
+    }
+    template <typename U>
+    Span(std::vector<U>& Vector) : mData(Vector.data()), mSize(Vector.size()) {
+    }
+
+    constexpr T* GetData() const {
+        return mData;
+    }
+    constexpr size_t GetSize() const {
+        return mSize;
+    }
+    constexpr bool IsEmpty() const {
+        return mSize == 0;
+    }
+
+    constexpr T& operator[](size_t Index) const {
+        return mData[Index];
+    }
+    constexpr T* begin() const {
+        return mData;
+    }
+    constexpr T* end() const {
+        return mData + mSize;
+    }
+
+  private:
+    T* mData = nullptr;
+    size_t mSize = 0;
+};
@@ -0,0 +1,352 @@
+﻿// src/Common/ThreadPool.cpp
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+#include "Profiler.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+struct ThreadPoolJob {
+    ThreadPool::Job Function;
+    JobCounter* Counter = nullptr;
+};
+
+namespace {
+
+// Jobs a thread can have queued before it runs new ones inline.
+constexpr uint32_t JOB_DEQUE_CAPACITY = 4096;
+// Failed looks for work before an idle thread goes to sleep.
+constexpr uint32_t IDLE_SPIN_COUNT = 64;
+
+// The pool and slot of the current thread, set for workers and attached threads.
+thread_local const ThreadPool* tWorkerPool = nullptr;
+thread_local uint32_t tWorkerSlot = 0;
+
+void PinCurrentThread(uint32_t Core) {
+#ifdef _WIN32
+    if (Core < sizeof(DWORD_PTR) * 8) {
+        SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << Core);
+    }
+#elif defined(__linux__)
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(Core, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#else
+    (void)Core;
+#endif
+}
+
+// One ParallelFor: every job working on it takes the next index until none are left.
+struct ParallelLoop {
+    const ThreadPool::ForBody* Body = nullptr;
+    uint32_t Count = 0;
+    std::atomic<uint32_t> NextIndex{0};
+
+    void RunIndices(uint32_t ThreadIndex) {
+        for (;;) {
+            uint32_t index = NextIndex.fetch_add(1, std::memory_order_relaxed);
+            if (index >= Count) {
+                return;
+            }
+            (*Body)(index, ThreadIndex);
+        }
+    }
+};
+
+} // anonymous namespace
+
+ThreadPool::ThreadPool(uint32_t WorkerCount, bool PinWorkers, uint32_t AttachSlots)
+    : mOwnerThread(std::this_thread::get_id()), mAttached(AttachSlots, false) {
+    uint32_t cores = std::thread::hardware_concurrency();
+    if (WorkerCount == 0) {
+        WorkerCount = cores > 1 ? cores - 1 : 0;
+    }
+    PinWorkers = PinWorkers && WorkerCount < cores;
+
+    // All deques exist before any worker starts stealing from them.
+    mDeques.reserve(WorkerCount + 1 + AttachSlots);
+    for (uint32_t i = 0; i <= WorkerCount + AttachSlots; ++i) {
+        mDeques.push_back(std::make_unique<WorkStealingDeque<ThreadPoolJob>>(JOB_DEQUE_CAPACITY));
+    }
+    mWorkers.reserve(WorkerCount);
+    for (uint32_t i = 0; i < WorkerCount; ++i) {
+        mWorkers.emplace_back(&ThreadPool::WorkerMain, this, i + 1, PinWorkers);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    mStopping.store(true, std::memory_order_seq_cst);
+    WakeAll();
+    for (std::thread& worker : mWorkers) {
+        worker.join();
+    }
+
+    // Without workers, or for jobs the creating thread queued last: nobody else will run them.
+    for (;;) {
+        ThreadPoolJob* job = FindJob(0);
+        if (job == nullptr) {
+            break;
+        }
+        Execute(job);
+    }
+}
+
+bool ThreadPool::Attach() {
+    if (tWorkerPool != nullptr || std::this_thread::get_id() == mOwnerThread) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mAttachMutex);
+    for (uint32_t i = 0; i < mAttached.size(); ++i) {
+        if (!mAttached[i]) {
+            mAttached[i] = true;
+            tWorkerPool = this;
+            tWorkerSlot = static_cast<uint32_t>(mWorkers.size()) + 1 + i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::Detach() {
+    if (tWorkerPool != this || tWorkerSlot <= mWorkers.size()) {
+        return;
+    }
+    // Others could steal these too, but without workers nobody else might ever look.
+    const uint32_t slot = tWorkerSlot;
+    while (ThreadPoolJob* job = mDeques[slot]->Pop()) {
+        Execute(job);
+    }
+    tWorkerPool = nullptr;
+    tWorkerSlot = 0;
+    std::lock_guard<std::mutex> lock(mAttachMutex);
+    mAttached[slot - mWorkers.size() - 1] = false;
+}
+
+void ThreadPool::ParallelFor(uint32_t Count, const ForBody& Body) {
+    if (Count == 0) {
+        return;
+    }
+
+    const uint32_t slot = GetCurrentSlot();
+    const uint32_t threadIndex = slot != NO_SLOT ? slot : 0;
+
+    // Not worth waking anybody up for a single item.
+    if (mWorkers.empty() || Count == 1) {
+        for (uint32_t i = 0; i < Count; ++i) {
+            Body(i, threadIndex);
+        }
+        return;
+    }
+
+    ParallelLoop loop;
+    loop.Body = &Body;
+    loop.Count = Count;
+
+    // One job per thread that could help. The jobs take indices until none are left, so a
+    // job stolen late finds nothing to do and returns at once.
+    JobCounter counter;
+    const uint32_t helpers =
+        std::min(static_cast<uint32_t>(mWorkers.size()), slot != NO_SLOT ? Count - 1 : Count);
+    counter.mPending.store(helpers, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < helpers; ++i) {
+        Submit(new ThreadPoolJob{[this, &loop] {
+                                     const uint32_t helperSlot = GetCurrentSlot();
+                                     loop.RunIndices(helperSlot != NO_SLOT ? helperSlot : 0);
+                                 },
+                                 &counter});
+    }
+    WakeAll();
+
+    if (slot != NO_SLOT) {
+        loop.RunIndices(slot);
+    }
+    // The loop and Body must outlive every job still inside RunIndices.
+    Wait(counter);
+}
+
+void ThreadPool::Run(Job Function, JobCounter* Counter) {
+    if (Counter != nullptr) {
+        Counter->mPending.fetch_add(1, std::memory_order_relaxed);
+    }
+    Submit(new ThreadPoolJob{std::move(Function), Counter});
+    WakeAll();
+}
+
+void ThreadPool::RunAfter(JobCounter& Dependency, Job Function, JobCounter* Counter) {
+    if (Counter != nullptr) {
+        Counter->mPending.fetch_add(1, std::memory_order_relaxed);
+    }
+    auto* job = new ThreadPoolJob{std::move(Function), Counter};
+    {
+        // Finish takes the list under the same lock once the count is zero, so the job is
+        // either queued here or picked up there.
+        std::lock_guard<std::mutex> lock(Dependency.mMutex);
+        if (!Dependency.IsDone()) {
+            Dependency.mContinuations.push_back(job);
+            return;
+        }
+    }
+    Submit(job);
+    WakeAll();
+}
+
+void ThreadPool::Wait(JobCounter& Counter) {
+    const uint32_t slot = GetCurrentSlot();
+    uint32_t idleCount = 0;
+    while (!Counter.IsDone()) {
+        if (slot == NO_SLOT) {
+            // Other threads could not give the jobs they run here a ThreadIndex of their own.
+            Sleep(mEpoch.load(std::memory_order_seq_cst), &Counter);
+            continue;
+        }
+
+        const uint64_t epoch = mEpoch.load(std::memory_order_seq_cst);
+        if (ThreadPoolJob* job = FindJob(slot)) {
+            Execute(job);
+            idleCount = 0;
+        } else if (++idleCount < IDLE_SPIN_COUNT) {
+            std::this_thread::yield();
+        } else {
+            Sleep(epoch, &Counter);
+        }
+    }
+    std::lock_guard<std::mutex> lock(Counter.mMutex);
+}
+
+void ThreadPool::WorkerMain(uint32_t Slot, bool Pin) {
+    PROFILE_THREAD("Worker");
+    tWorkerPool = this;
+    tWorkerSlot = Slot;
+    if (Pin) {
+        PinCurrentThread(Slot);
+    }
+
+    uint32_t idleCount = 0;
+    for (;;) {
+        const uint64_t epoch = mEpoch.load(std::memory_order_seq_cst);
+        if (ThreadPoolJob* job = FindJob(Slot)) {
+            Execute(job);
+            idleCount = 0;
+        } else if (mStopping.load(std::memory_order_seq_cst)) {
+            return;
+        } else if (++idleCount < IDLE_SPIN_COUNT) {
+            std::this_thread::yield();
+        } else {
+            Sleep(epoch, nullptr);
+        }
+    }
+}
+
+uint32_t ThreadPool::GetCurrentSlot() const {
+    if (tWorkerPool == this) {
+        return tWorkerSlot;
+    }
+    return std::this_thread::get_id() == mOwnerThread ? 0 : NO_SLOT;
+}
+
+void ThreadPool::Submit(ThreadPoolJob* Job) {
+    const uint32_t slot = GetCurrentSlot();
+    if (slot != NO_SLOT) {
+        if (!mDeques[slot]->Push(Job)) {
+            // Full: running it now is the back-pressure.
+            Execute(Job);
+            return;
+        }
+    } else if (mWorkers.empty()) {
+        // Nobody would run it before the creating thread next waits.
+        Execute(Job);
+        return;
+    } else {
+        std::lock_guard<std::mutex> lock(mInjectMutex);
+        mInjected.push_back(Job);
+        mInjectedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    mEpoch.fetch_add(1, std::memory_order_seq_cst);
+}
+
+ThreadPoolJob* ThreadPool::FindJob(uint32_t Slot) {
+    // Own jobs newest first, as their data is still in cache; then jobs from outside; then
+    // the oldest job of another thread, which tends to be the biggest piece of work left.
+    if (ThreadPoolJob* job = mDeques[Slot]->Pop()) {
+        return job;
+    }
+    if (mInjectedCount.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(mInjectMutex);
+        if (!mInjected.empty()) {
+            ThreadPoolJob* job = mInjected.front();
+            mInjected.pop_front();
+            mInjectedCount.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    const uint32_t dequeCount = static_cast<uint32_t>(mDeques.size());
+    for (uint32_t i = 1; i < dequeCount; ++i) {
+        if (ThreadPoolJob* job = mDeques[(Slot + i) % dequeCount]->Steal()) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void ThreadPool::Execute(ThreadPoolJob* Job) {
+    Job->Function();
+    JobCounter* counter = Job->Counter;
+    delete Job;
+    if (counter != nullptr) {
+        Finish(*counter);
+    }
+}
+
+void ThreadPool::Finish(JobCounter& Counter) {
+    // The count reaches zero under the lock and Wait takes the lock before it returns, so the
+    // waiter cannot destroy Counter while it is still in use here.
+    std::vector<ThreadPoolJob*> continuations;
+    {
+        std::lock_guard<std::mutex> lock(Counter.mMutex);
+        if (Counter.mPending.fetch_sub(1, std::memory_order_seq_cst) != 1) {
+            return;
+        }
+        continuations.swap(Counter.mContinuations);
+    }
+    for (ThreadPoolJob* continuation : continuations) {
+        Submit(continuation);
+    }
+    WakeAll();
+}
+
+void ThreadPool::WakeAll() {
+    // Sleepers register under mSleepMutex before they check their condition, so taking it
+    // here means none of them can miss this notification.
+    if (mSleepers.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mSleepCondition.notify_all();
+    }
+}
+
+void ThreadPool::Sleep(uint64_t SeenEpoch, const JobCounter* Counter) {
+    std::unique_lock<std::mutex> lock(mSleepMutex);
+    mSleepers.fetch_add(1, std::memory_order_seq_cst);
+    mSleepCondition.wait(lock, [&] {
+        return mEpoch.load(std::memory_order_seq_cst) != SeenEpoch ||
+               mStopping.load(std::memory_order_seq_cst) ||
+               (Counter != nullptr && Counter->IsDone());
+    });
+    mSleepers.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void ParallelFor(ThreadPool* Pool, uint32_t Count, const ThreadPool::ForBody& Body) {
+    if (Pool == nullptr || Count <= 1) {
+        for (uint32_t i = 0; i < Count; ++i) {
+            Body(i, 0);
+        }
+        return;
+    }
+    Pool->ParallelFor(Count, Body);
+}
@@ -0,0 +1,130 @@
+﻿// src/Common/ThreadPool.h
+// Work-stealing job system used to fan CPU work out across all cores. Every worker owns a
+// deque of jobs and steals from the others when it runs dry; threads waiting on jobs run jobs.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "WorkStealingDeque.h"
+
+struct ThreadPoolJob;
+
+// Counts unfinished jobs. Jobs run with a counter add one when submitted and remove it when
+// they return; ThreadPool::Wait and ThreadPool::RunAfter wait for it to drop to zero. A counter
+// must outlive its jobs and continuations: destroy it only after Wait on it has returned.
+class JobCounter {
+  public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool IsDone() const {
+        return mPending.load(std::memory_order_acquire) == 0;
+    }
+
+  private:
+    friend class ThreadPool;
+
+    std::atomic<uint32_t> mPending{0};
+    std::mutex mMutex;                          // Guards mContinuations
+    std::vector<ThreadPoolJob*> mContinuations; // Submitted when mPending drops to zero
+};
+
+class ThreadPool {
+  public:
+    using Job = std::function<void()>;
+
+    // Body(Index, ThreadIndex): ThreadIndex is 0 for the thread that created the pool, 1..N
+    // for workers and above that for attached threads, so callers can keep per-thread scratch
+    // data in an array of GetThreadCount() entries. A thread waiting inside Body may run other
+    // indices of the same loop, so scratch data must not be held across a nested ParallelFor
+    // or Wait.
+    using ForBody = std::function<void(uint32_t Index, uint32_t ThreadIndex)>;
+
+    // WorkerCount == 0 picks hardware_concurrency() - 1, the creating thread being the last
+    // core. PinWorkers binds worker N to core N, leaving core 0 to the creating thread.
+    // AttachSlots threads besides the creating one, such as a render thread, can take part
+    // through Attach.
+    explicit ThreadPool(uint32_t WorkerCount = 0,
+                        bool PinWorkers = false,
+                        uint32_t AttachSlots = 0);
+    // Runs the jobs still queued, then stops the workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads that can take part in a ParallelFor: the creating thread, the workers
+    // and the attach slots.
+    uint32_t GetThreadCount() const {
+        return static_cast<uint32_t>(mDeques.size());
+    }
+
+    // Gives the calling thread a deque of its own, so it runs jobs while it waits instead of
+    // blocking. Returns false if every attach slot is taken or the thread already belongs to a
+    // pool. Call Detach on the same thread before it exits and before the pool is destroyed.
+    bool Attach();
+    // Runs the jobs the calling thread still has queued and gives its slot back.
+    void Detach();
+
+    // Runs Body for every index in [0, Count) and returns once all of them are done.
+    // Any thread may call it, and bodies may nest further calls. The creating thread, the
+    // workers and attached threads take indices themselves and run other jobs while they wait;
+    // any other thread blocks until the workers are done.
+    void ParallelFor(uint32_t Count, const ForBody& Body);
+
+    // Queues Function. Counter, if given, counts it until it returns.
+    void Run(Job Function, JobCounter* Counter = nullptr);
+    // Queues Function once Dependency drops to zero, or right away if it already has.
+    // Counter counts it from now, so waiting on Counter also waits for Dependency.
+    void RunAfter(JobCounter& Dependency, Job Function, JobCounter* Counter = nullptr);
+    // Returns once Counter is zero, running queued jobs meanwhile on the creating thread, on
+    // workers and on attached threads.
+    void Wait(JobCounter& Counter);
+
+  private:
+    static constexpr uint32_t NO_SLOT = ~0u;
+
+    void WorkerMain(uint32_t Slot, bool Pin);
+    // This thread's deque: 0 for the creating thread, 1..N for workers, then attached
+    // threads, else NO_SLOT.
+    uint32_t GetCurrentSlot() const;
+    void Submit(ThreadPoolJob* Job);
+    ThreadPoolJob* FindJob(uint32_t Slot);
+    void Execute(ThreadPoolJob* Job);
+    void Finish(JobCounter& Counter);
+    void WakeAll();
+    // Sleeps until new jobs are queued after SeenEpoch, Counter (if any) is done or the
+    // pool stops.
+    void Sleep(uint64_t SeenEpoch, const JobCounter* Counter);
+
+    std::thread::id mOwnerThread;
+    std::vector<std::thread> mWorkers;
+    std::vector<std::unique_ptr<WorkStealingDeque<ThreadPoolJob>>> mDeques; // One per slot
+
+    std::mutex mAttachMutex;
+    std::vector<bool> mAttached; // Per attach slot, after the workers' slots
+
+    // Jobs queued by threads without a deque.
+    std::mutex mInjectMutex;
+    std::deque<ThreadPoolJob*> mInjected;
+    std::atomic<uint32_t> mInjectedCount{0};
+
+    std::mutex mSleepMutex;
+    std::condition_variable mSleepCondition;
+    std::atomic<uint64_t> mEpoch{0}; // Bumped whenever jobs are queued
+    std::atomic<uint32_t> mSleepers{0};
+    std::atomic<bool> mStopping{false};
+};
+
+// ThreadPool::ParallelFor for code where the pool is optional: with a null Pool, or a single
+// index, Body runs inline on the calling thread with ThreadIndex 0.
+void ParallelFor(ThreadPool* Pool, uint32_t Count, const ThreadPool::ForBody& Body);
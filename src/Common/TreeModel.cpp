@@ -0,0 +1,379 @@
+﻿// src/Common/TreeModel.cpp
+#include "TreeModel.h"
+
+#include <algorithm>
+
+TreeModel::TreeModel(const TreeSource& Source, uint32_t BatchSize)
+    : mSource(Source), mBatchSize(std::max(BatchSize, 1u)) {
+    mTop.Key = INVALID_TREE_KEY;
+    mTop.FirstChild = INVALID_TREE_NODE;
+    mTop.LastChild = INVALID_TREE_NODE;
+    mTop.Expanded = true;
+}
+
+void TreeModel::Reset() {
+    mNodes.clear();
+    mNodeOfKey.clear();
+    mRows.clear();
+    mRowOfNode.clear();
+    mIndexedRows = 0;
+    mPlaceholderCount = 0;
+    mLiveCount = 0;
+    mTop.FirstChild = INVALID_TREE_NODE;
+    mTop.LastChild = INVALID_TREE_NODE;
+    mTop.Listed = false;
+    mChanges.clear();
+    mChanges.push_back({TreeChangeType::Reset, INVALID_TREE_NODE});
+
+    ListBatch(INVALID_TREE_NODE, INVALID_TREE_NODE);
+    for (uint32_t node = mTop.FirstChild; node != INVALID_TREE_NODE;
+         node = mNodes[node].NextSibling) {
+        mRows.push_back(node);
+    }
+}
+
+uint32_t TreeModel::FindNode(TreeKey Key) const {
+    auto node = mNodeOfKey.find(Key);
+    return node != mNodeOfKey.end() ? node->second : INVALID_TREE_NODE;
+}
+
+bool TreeModel::Expand(uint32_t Node) {
+    if (IsPlaceholder(Node) || mNodes[Node].Removed || !mNodes[Node].HasChildren) {
+        return false;
+    }
+    if (mNodes[Node].Expanded) {
+        return true;
+    }
+    if (!mNodes[Node].Listed) {
+        ListBatch(Node, INVALID_TREE_NODE);
+    }
+    if (mNodes[Node].FirstChild == INVALID_TREE_NODE) {
+        // The source had children when asked before, but not anymore.
+        mNodes[Node].HasChildren = false;
+        mChanges.push_back({TreeChangeType::Updated, Node});
+        return false;
+    }
+
+    const uint32_t row = FindRow(Node);
+    mNodes[Node].Expanded = true;
+    mChanges.push_back({TreeChangeType::Expanded, Node});
+    if (row != INVALID_TREE_NODE) {
+        std::vector<uint32_t> rows;
+        AppendVisibleRows(Node, rows);
+        mRows.insert(mRows.begin() + row + 1, rows.begin(), rows.end());
+        InvalidateRowsFrom(row + 1);
+    }
+    return true;
+}
+
+void TreeModel::Collapse(uint32_t Node) {
+    if (!mNodes[Node].Expanded) {
+        return;
+    }
+    const uint32_t row = FindRow(Node);
+    mNodes[Node].Expanded = false;
+    if (row != INVALID_TREE_NODE) {
+        mRows.erase(mRows.begin() + row + 1, mRows.begin() + GetRowEnd(row));
+        InvalidateRowsFrom(row + 1);
+    }
+}
+
+uint32_t TreeModel::Reveal(TreeKey Key) {
+    std::vector<TreeKey> chain;
+    for (TreeKey key = Key; key != INVALID_TREE_KEY; key = mSource.GetParent(key)) {
+        chain.push_back(key);
+    }
+
+    // From the top down: open the parent, then page through its children until the key shows.
+    uint32_t parent = INVALID_TREE_NODE;
+    for (size_t i = chain.size(); i-- > 0;) {
+        if (parent != INVALID_TREE_NODE && !Expand(parent)) {
+            return INVALID_TREE_NODE;
+        }
+        uint32_t node = FindNode(chain[i]);
+        while (node == INVALID_TREE_NODE) {
+            const uint32_t last = parent != INVALID_TREE_NODE ? mNodes[parent].LastChild
+                                                              : mTop.LastChild;
+            if (last == INVALID_TREE_NODE || !IsPlaceholder(last)) {
+                return INVALID_TREE_NODE;
+            }
+            ResolvePlaceholder(last, FindRow(last));
+            node = FindNode(chain[i]);
+        }
+        parent = node;
+    }
+    return parent;
+}
+
+void TreeModel::GetExpandedKeys(std::vector<TreeKey>& Out) const {
+    // Nodes are created after their parents.
+    for (const TreeNode& node : mNodes) {
+        if (node.Expanded && !node.Removed) {
+            Out.push_back(node.Key);
+        }
+    }
+}
+
+void TreeModel::GetRows(uint32_t First, uint32_t Count, std::vector<uint32_t>& Out) {
+    Out.clear();
+    for (uint32_t row = First; row < mRows.size() && row - First < Count;) {
+        const uint32_t node = mRows[row];
+        if (IsPlaceholder(node)) {
+            // The rows that replace it are looked at again, another placeholder included.
+            ResolvePlaceholder(node, row);
+            continue;
+        }
+        Out.push_back(node);
+        ++row;
+    }
+}
+
+void TreeModel::OnInserted(TreeKey Parent, TreeKey Key) {
+    if (FindNode(Key) != INVALID_TREE_NODE) {
+        return;
+    }
+    const uint32_t parent = Parent != INVALID_TREE_KEY ? FindNode(Parent) : INVALID_TREE_NODE;
+    if (Parent != INVALID_TREE_KEY && parent == INVALID_TREE_NODE) {
+        return; // Not materialized; it lists the new child when it is
+    }
+    const TreeNode& list = parent != INVALID_TREE_NODE ? mNodes[parent] : mTop;
+    if (!list.Listed || (list.LastChild != INVALID_TREE_NODE && IsPlaceholder(list.LastChild))) {
+        // Listing resumes after the last child listed, so the new one turns up then.
+        if (parent != INVALID_TREE_NODE && !mNodes[parent].HasChildren) {
+            mNodes[parent].HasChildren = true;
+            mChanges.push_back({TreeChangeType::Updated, parent});
+        }
+        return;
+    }
+
+    const uint32_t node = AddNode(parent, Key, INVALID_TREE_NODE);
+    if (parent != INVALID_TREE_NODE && !mNodes[parent].HasChildren) {
+        mNodes[parent].HasChildren = true;
+        mChanges.push_back({TreeChangeType::Updated, parent});
+    }
+    if (parent == INVALID_TREE_NODE) {
+        mRows.push_back(node);
+    } else if (mNodes[parent].Expanded) {
+        const uint32_t row = FindRow(parent);
+        if (row != INVALID_TREE_NODE) {
+            const uint32_t end = GetRowEnd(row);
+            mRows.insert(mRows.begin() + end, node);
+            InvalidateRowsFrom(end);
+        }
+    }
+}
+
+void TreeModel::OnRemoved(TreeKey Key) {
+    const uint32_t node = FindNode(Key);
+    if (node == INVALID_TREE_NODE) {
+        return;
+    }
+    const uint32_t parent = mNodes[node].Parent;
+    const uint32_t last = parent != INVALID_TREE_NODE ? mNodes[parent].LastChild : mTop.LastChild;
+    if (IsPlaceholder(last) && mNodes[last].ResumeAfter == Key) {
+        // Listing goes on from the sibling before it instead.
+        const uint32_t previous = mNodes[node].PrevSibling;
+        mNodes[last].ResumeAfter =
+            previous != INVALID_TREE_NODE ? mNodes[previous].Key : INVALID_TREE_KEY;
+    }
+
+    const uint32_t row = FindRow(node);
+    if (row != INVALID_TREE_NODE) {
+        mRows.erase(mRows.begin() + row, mRows.begin() + GetRowEnd(row));
+        InvalidateRowsFrom(row);
+    }
+    Unlink(node);
+    mChanges.push_back({TreeChangeType::Removed, node});
+
+    std::vector<uint32_t> stack{node};
+    while (!stack.empty()) {
+        TreeNode& removed = mNodes[stack.back()];
+        stack.pop_back();
+        removed.Removed = true;
+        --mLiveCount;
+        if (removed.Key != INVALID_TREE_KEY) {
+            mNodeOfKey.erase(removed.Key);
+        } else {
+            --mPlaceholderCount;
+        }
+        for (uint32_t child = removed.FirstChild; child != INVALID_TREE_NODE;
+             child = mNodes[child].NextSibling) {
+            stack.push_back(child);
+        }
+    }
+
+    if (parent != INVALID_TREE_NODE && mNodes[parent].FirstChild == INVALID_TREE_NODE) {
+        mNodes[parent].HasChildren = false;
+        mChanges.push_back({TreeChangeType::Updated, parent});
+    }
+}
+
+void TreeModel::TakeChanges(std::vector<TreeChange>& Out) {
+    Out.clear();
+    Out.swap(mChanges);
+}
+
+TreeModelStats TreeModel::GetStats() const {
+    TreeModelStats stats;
+    stats.NodeCount = mLiveCount;
+    stats.PlaceholderCount = mPlaceholderCount;
+    stats.RowCount = static_cast<uint32_t>(mRows.size());
+    return stats;
+}
+
+uint32_t TreeModel::AddNode(uint32_t Parent, TreeKey Key, uint32_t Before) {
+    const uint32_t node = static_cast<uint32_t>(mNodes.size());
+    TreeNode added{};
+    added.Key = Key;
+    added.ResumeAfter = INVALID_TREE_KEY;
+    added.Parent = Parent;
+    added.FirstChild = INVALID_TREE_NODE;
+    added.LastChild = INVALID_TREE_NODE;
+    added.Depth =
+        Parent != INVALID_TREE_NODE ? static_cast<uint16_t>(mNodes[Parent].Depth + 1) : 0;
+    added.HasChildren = Key != INVALID_TREE_KEY && mSource.HasChildren(Key);
+
+    TreeNode& list = Parent != INVALID_TREE_NODE ? mNodes[Parent] : mTop;
+    added.NextSibling = Before;
+    added.PrevSibling = Before != INVALID_TREE_NODE ? mNodes[Before].PrevSibling : list.LastChild;
+    if (added.PrevSibling != INVALID_TREE_NODE) {
+        mNodes[added.PrevSibling].NextSibling = node;
+    } else {
+        list.FirstChild = node;
+    }
+    if (Before != INVALID_TREE_NODE) {
+        mNodes[Before].PrevSibling = node;
+    } else {
+        list.LastChild = node;
+    }
+    // Linked through indices only, so growing the array is safe from here.
+    mNodes.push_back(added);
+    mRowOfNode.push_back(INVALID_TREE_NODE);
+
+    ++mLiveCount;
+    if (Key != INVALID_TREE_KEY) {
+        mNodeOfKey.emplace(Key, node);
+    } else {
+        ++mPlaceholderCount;
+    }
+    mChanges.push_back({TreeChangeType::Inserted, node});
+    return node;
+}
+
+void TreeModel::Unlink(uint32_t Node) {
+    TreeNode& node = mNodes[Node];
+    TreeNode& list = node.Parent != INVALID_TREE_NODE ? mNodes[node.Parent] : mTop;
+    if (node.PrevSibling != INVALID_TREE_NODE) {
+        mNodes[node.PrevSibling].NextSibling = node.NextSibling;
+    } else {
+        list.FirstChild = node.NextSibling;
+    }
+    if (node.NextSibling != INVALID_TREE_NODE) {
+        mNodes[node.NextSibling].PrevSibling = node.PrevSibling;
+    } else {
+        list.LastChild = node.PrevSibling;
+    }
+}
+
+uint32_t TreeModel::ListBatch(uint32_t Parent, uint32_t Placeholder) {
+    const TreeKey parentKey = Parent != INVALID_TREE_NODE ? mNodes[Parent].Key : INVALID_TREE_KEY;
+    TreeKey after = Placeholder != INVALID_TREE_NODE ? mNodes[Placeholder].ResumeAfter
+                                                     : INVALID_TREE_KEY;
+    uint32_t added = 0;
+    bool more = true;
+    while (more && added == 0) {
+        // Children inserted since the listing began were materialized already: skip those.
+        mKeys.clear();
+        more = mSource.ListChildren(parentKey, after, mBatchSize, mKeys) && !mKeys.empty();
+        for (TreeKey key : mKeys) {
+            if (FindNode(key) == INVALID_TREE_NODE) {
+                AddNode(Parent, key, Placeholder);
+                ++added;
+            }
+        }
+        if (!mKeys.empty()) {
+            after = mKeys.back();
+        }
+    }
+
+    if (Parent != INVALID_TREE_NODE) {
+        mNodes[Parent].Listed = true;
+    } else {
+        mTop.Listed = true;
+    }
+    if (more && Placeholder == INVALID_TREE_NODE) {
+        Placeholder = AddNode(Parent, INVALID_TREE_KEY, INVALID_TREE_NODE);
+    } else if (!more && Placeholder != INVALID_TREE_NODE) {
+        Unlink(Placeholder);
+        mNodes[Placeholder].Removed = true;
+        --mLiveCount;
+        --mPlaceholderCount;
+        mChanges.push_back({TreeChangeType::Removed, Placeholder});
+        return added;
+    }
+    if (more) {
+        mNodes[Placeholder].ResumeAfter = after;
+    }
+    return added;
+}
+
+void TreeModel::ResolvePlaceholder(uint32_t Placeholder, uint32_t Row) {
+    const uint32_t firstAdded = static_cast<uint32_t>(mNodes.size());
+    const uint32_t added = ListBatch(mNodes[Placeholder].Parent, Placeholder);
+    if (Row == INVALID_TREE_NODE) {
+        return; // Hidden by a collapsed ancestor
+    }
+    // New children are collapsed, so each one is a single row, in front of the placeholder's.
+    std::vector<uint32_t> rows(added);
+    for (uint32_t i = 0; i < added; ++i) {
+        rows[i] = firstAdded + i;
+    }
+    if (mNodes[Placeholder].Removed) {
+        mRows.erase(mRows.begin() + Row);
+    }
+    mRows.insert(mRows.begin() + Row, rows.begin(), rows.end());
+    InvalidateRowsFrom(Row);
+}
+
+uint32_t TreeModel::FindRow(uint32_t Node) const {
+    for (uint32_t parent = mNodes[Node].Parent; parent != INVALID_TREE_NODE;
+         parent = mNodes[parent].Parent) {
+        if (!mNodes[parent].Expanded) {
+            return INVALID_TREE_NODE;
+        }
+    }
+    const uint32_t known = mRowOfNode[Node];
+    if (known < mIndexedRows && mRows[known] == Node) {
+        return known;
+    }
+    // Index the stale rows up to Node's only: right after an edit that is the rows between the
+    // edit and Node, not everything below it.
+    const uint32_t rowCount = static_cast<uint32_t>(mRows.size());
+    while (mIndexedRows < rowCount) {
+        const uint32_t row = mIndexedRows++;
+        mRowOfNode[mRows[row]] = row;
+        if (mRows[row] == Node) {
+            return row;
+        }
+    }
+    return INVALID_TREE_NODE;
+}
+
+void TreeModel::AppendVisibleRows(uint32_t Node, std::vector<uint32_t>& Out) const {
+    for (uint32_t child = mNodes[Node].FirstChild; child != INVALID_TREE_NODE;
+         child = mNodes[child].NextSibling) {
+        Out.push_back(child);
+        if (mNodes[child].Expanded) {
+            AppendVisibleRows(child, Out);
+        }
+    }
+}
+
+uint32_t TreeModel::GetRowEnd(uint32_t Row) const {
+    const uint16_t depth = mNodes[mRows[Row]].Depth;
+    uint32_t end = Row + 1;
+    while (end < mRows.size() && mNodes[mRows[end]].Depth > depth) {
+        ++end;
+    }
+    return end;
+}
@@ -0,0 +1,160 @@
+﻿// src/Common/TreeModel.h
+// Platform-independent model behind the tree views. Nodes exist only once their parent has been
+// expanded, and a long child list comes in batches: a placeholder node stands for the rest until
+// it scrolls into view. The expanded rows are kept flat, so a view asks for the slice at its
+// scroll offset and only ever creates controls for what is on screen.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Identifies an item of a TreeSource, e.g. a file index or a scene node id.
+using TreeKey = uint32_t;
+constexpr TreeKey INVALID_TREE_KEY = ~0u;
+
+constexpr uint32_t INVALID_TREE_NODE = ~0u;
+
+// The data a TreeModel shows. Children are listed in order and resumed after the last one
+// listed, so a source with linked children never has to count or index them.
+class TreeSource {
+  public:
+    virtual ~TreeSource() = default;
+
+    // Appends up to MaxCount children of Parent, INVALID_TREE_KEY for the top level, that come
+    // after After, or from the first one if After is INVALID_TREE_KEY. Returns true if more
+    // children follow the last one appended.
+    virtual bool ListChildren(TreeKey Parent,
+                              TreeKey After,
+                              uint32_t MaxCount,
+                              std::vector<TreeKey>& Out) const = 0;
+    virtual bool HasChildren(TreeKey Key) const = 0;
+    // INVALID_TREE_KEY at the top level.
+    virtual TreeKey GetParent(TreeKey Key) const = 0;
+};
+
+struct TreeNode {
+    TreeKey Key;         // INVALID_TREE_KEY for placeholders
+    TreeKey ResumeAfter; // Placeholders: the last sibling listed so far
+    uint32_t Parent;     // INVALID_TREE_NODE at the top level
+    uint32_t FirstChild; // Materialized children, placeholder last
+    uint32_t LastChild;
+    uint32_t PrevSibling;
+    uint32_t NextSibling;
+    uint16_t Depth;
+    bool HasChildren; // As the source said; the view shows an expander
+    bool Listed;      // Children have been materialized, at least the first batch
+    bool Expanded;
+    bool Removed;
+};
+
+enum class TreeChangeType : uint8_t {
+    Inserted, // Node is new, after PrevSibling under Parent
+    Removed,  // Node and everything below it are gone
+    Updated,  // HasChildren of Node changed
+    Expanded, // Node was expanded, e.g. by Reveal; its children were inserted before
+    Reset,    // Every node is gone; the top level starts over
+};
+
+struct TreeChange {
+    TreeChangeType Type;
+    uint32_t Node;
+};
+
+struct TreeModelStats {
+    uint32_t NodeCount = 0; // Materialized, placeholders included
+    uint32_t PlaceholderCount = 0;
+    uint32_t RowCount = 0; // Visible with the current expansion
+};
+
+class TreeModel {
+  public:
+    // BatchSize children are materialized at a time.
+    explicit TreeModel(const TreeSource& Source, uint32_t BatchSize = 256);
+
+    TreeModel(const TreeModel&) = delete;
+    TreeModel& operator=(const TreeModel&) = delete;
+
+    // Forgets every node and lists the top level again.
+    void Reset();
+
+    const TreeNode& GetNode(uint32_t Node) const {
+        return mNodes[Node];
+    }
+    bool IsPlaceholder(uint32_t Node) const {
+        return mNodes[Node].Key == INVALID_TREE_KEY;
+    }
+    // The node of Key, or INVALID_TREE_NODE if it has not been materialized.
+    uint32_t FindNode(TreeKey Key) const;
+
+    // Materializes the first batch of children if needed and shows them. False for nodes
+    // without children.
+    bool Expand(uint32_t Node);
+    void Collapse(uint32_t Node);
+    // Expands the ancestors of Key and materializes siblings until Key has a node, which is
+    // returned, or INVALID_TREE_NODE if the source does not list it.
+    uint32_t Reveal(TreeKey Key);
+    // Appends the keys of the expanded nodes, parents first, e.g. to expand them again after a
+    // Reset.
+    void GetExpandedKeys(std::vector<TreeKey>& Out) const;
+
+    // --- Rows: the nodes a view shows, in order, with the current expansion ---
+
+    uint32_t GetRowCount() const {
+        return static_cast<uint32_t>(mRows.size());
+    }
+    // Replaces Out with the nodes of rows [First, First + Count), after materializing the
+    // placeholders among them, e.g. for the rows at a view's scroll offset.
+    void GetRows(uint32_t First, uint32_t Count, std::vector<uint32_t>& Out);
+
+    // --- Following changes of the source ---
+
+    // Key was added under Parent. Nothing happens unless Parent's children are listed to the
+    // end, as a later batch lists it anyway.
+    void OnInserted(TreeKey Parent, TreeKey Key);
+    // Key and everything below it are gone from the source.
+    void OnRemoved(TreeKey Key);
+
+    // Replaces Out with the changes since the last call, for the view to mirror.
+    void TakeChanges(std::vector<TreeChange>& Out);
+
+    TreeModelStats GetStats() const;
+
+  private:
+    // Creates the node of Key, or a placeholder for INVALID_TREE_KEY, under Parent in front of
+    // Before, or last.
+    uint32_t AddNode(uint32_t Parent, TreeKey Key, uint32_t Before);
+    void Unlink(uint32_t Node);
+    // Materializes the next batch of children of Parent in front of Placeholder, which is
+    // created or removed as more children follow or not. Returns the nodes added.
+    uint32_t ListBatch(uint32_t Parent, uint32_t Placeholder);
+    // Lists the batch Placeholder stands for and updates the rows, Row being its own or
+    // INVALID_TREE_NODE if hidden.
+    void ResolvePlaceholder(uint32_t Placeholder, uint32_t Row);
+    // The row of Node, or INVALID_TREE_NODE if it is hidden by a collapsed ancestor. Looked up
+    // in mRowOfNode, which is brought up to date only as far as the rows looked for.
+    uint32_t FindRow(uint32_t Node) const;
+    // Rows from Row on moved: their entries in mRowOfNode are stale.
+    void InvalidateRowsFrom(uint32_t Row) {
+        mIndexedRows = std::min(mIndexedRows, Row);
+    }
+    // Appends the rows below the expanded Node, as they would show.
+    void AppendVisibleRows(uint32_t Node, std::vector<uint32_t>& Out) const;
+    // The row after the last one below Row.
+    uint32_t GetRowEnd(uint32_t Row) const;
+
+    const TreeSource& mSource;
+    uint32_t mBatchSize;
+    std::vector<TreeNode> mNodes;
+    std::unordered_map<TreeKey, uint32_t> mNodeOfKey;
+    TreeNode mTop{}; // Pseudo node heading the top level
+    std::vector<uint32_t> mRows;
+    // Row of each node, current for the nodes of rows [0, mIndexedRows).
+    mutable std::vector<uint32_t> mRowOfNode;
+    mutable uint32_t mIndexedRows = 0;
+    std::vector<TreeChange> mChanges;
+    std::vector<TreeKey> mKeys; // ListBatch scratch
+    uint32_t mLiveCount = 0;
+    uint32_t mPlaceholderCount = 0;
+};
@@ -0,0 +1,81 @@
+﻿// src/Common/WorkStealingDeque.h
+// Fixed-capacity Chase-Lev deque of pointers: the owning thread pushes and pops at the bottom
+// without locks while other threads steal the oldest items from the top.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+template <typename T>
+class WorkStealingDeque {
+  public:
+    // Capacity must be a power of two.
+    explicit WorkStealingDeque(uint32_t Capacity)
+        : mItems(new std::atomic<T*>[Capacity]), mMask(static_cast<int64_t>(Capacity) - 1) {
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Owner thread only. Returns false when the deque is full. Everything the owner wrote
+    // before Push is visible to the thread that later pops or steals Item.
+    bool Push(T* Item) {
+        const int64_t bottom = mBottom.load(std::memory_order_relaxed);
+        const int64_t top = mTop.load(std::memory_order_acquire);
+        if (bottom - top > mMask) {
+            return false;
+        }
+        mItems[bottom & mMask].store(Item, std::memory_order_relaxed);
+        mBottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Owner thread only. Newest item first, or null when empty.
+    T* Pop() {
+        const int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+        mBottom.store(bottom, std::memory_order_seq_cst);
+        int64_t top = mTop.load(std::memory_order_seq_cst);
+        if (top > bottom) {
+            mBottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T* item = mItems[bottom & mMask].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // The last item: race the thieves for it.
+            if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            mBottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Any thread. Oldest item first, or null when empty or when another thread won the race.
+    T* Steal() {
+        int64_t top = mTop.load(std::memory_order_seq_cst);
+        const int64_t bottom = mBottom.load(std::memory_order_seq_cst);
+        if (top >= bottom) {
+            return nullptr;
+        }
+        T* item = mItems[top & mMask].load(std::memory_order_relaxed);
+        if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    // A hint only; another thread may change it right away.
+    bool IsEmpty() const {
+        return mTop.load(std::memory_order_relaxed) >= mBottom.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::unique_ptr<std::atomic<T*>[]> mItems;
+    const int64_t mMask;
+    std::atomic<int64_t> mTop{0};
+    std::atomic<int64_t> mBottom{0};
+};
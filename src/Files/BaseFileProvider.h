@@ -1,18 +1,20 @@
 ﻿// src/Files/BaseFileProvider.h
 // Created by dtcimbal on 2/06/2025.
 #pragma once
-#include <filesystem> // For std::filesystem::directory_iterator
-#include <string>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <vector>
 
-// Represents a single file entry found during iteration.
-struct FileEntry {
-    std::wstring name;
-};
+#include "DirectoryScan.h"
+#include "DirectoryWatcher.h"
 
-// Custom iterator wrapper for std::filesystem::directory_iterator
+// Walks the entries of a DirectoryScan in index order, parents before their children, skipping
+// removed ones. Dereferencing gives a reference into the scan; nothing is copied per step.
 class FileIterator {
   public:
-    using iterator_category = std::input_iterator_tag;
+    using iterator_category = std::forward_iterator_tag;
     using value_type = FileEntry;
     using difference_type = std::ptrdiff_t;
     using pointer = const FileEntry*;
@@ -20,32 +22,27 @@ class FileIterator {
 
     FileIterator() = default;
 
-    explicit FileIterator(std::filesystem::directory_iterator it) : m_it(std::move(it)) {
-        if (m_it != std::filesystem::directory_iterator()) {
-            m_currentEntry.name = m_it->path().filename().wstring();
-        }
+    FileIterator(const DirectoryScan& scan, uint32_t index) : m_scan(&scan), m_index(index) {
+        skipRemoved();
     }
 
     // Dereference operator
-    FileEntry operator*() const {
-        if (m_it == std::filesystem::directory_iterator()) {
-            throw std::out_of_range("Dereferencing invalid FileIterator.");
-        }
-        return m_currentEntry;
+    const FileEntry& operator*() const {
+        return m_scan->GetEntries()[m_index];
+    }
+    const FileEntry* operator->() const {
+        return &m_scan->GetEntries()[m_index];
+    }
+
+    // Position of the entry in the scan, for DirectoryScan::GetPath and parent lookups.
+    uint32_t getIndex() const {
+        return m_index;
     }
 
     // Pre-increment operator
     FileIterator& operator++() {
-        if (m_it == std::filesystem::directory_iterator()) {
-            throw std::out_of_range("Incrementing invalid FileIterator.");
-        }
-        ++m_it;
-        if (m_it != std::filesystem::directory_iterator()) {
-            m_currentEntry.name = m_it->path().filename().wstring();
-        } else {
-            // If we reached the end, clear the entry.
-            m_currentEntry.name.clear();
-        }
+        ++m_index;
+        skipRemoved();
         return *this;
     }
 
@@ -58,7 +55,7 @@ class FileIterator {
 
     // Equality comparison
     bool operator==(const FileIterator& other) const {
-        return m_it == other.m_it;
+        return m_index == other.m_index;
     }
 
     // Inequality comparison
@@ -67,8 +64,21 @@ class FileIterator {
     }
 
   private:
-    std::filesystem::directory_iterator m_it;
-    FileEntry m_currentEntry; // Cache the current entry
+    void skipRemoved() {
+        const std::vector<FileEntry>& entries = m_scan->GetEntries();
+        while (m_index < entries.size() && entries[m_index].Removed) {
+            ++m_index;
+        }
+    }
+
+    const DirectoryScan* m_scan = nullptr;
+    uint32_t m_index = 0;
+};
+
+// One entry that changed on disk since the last pollChanges.
+struct FileDelta {
+    FileChangeType Type;
+    uint32_t Index; // Into the provider's entries; unused for Overflow
 };
 
 class BaseFileProvider {
@@ -88,6 +98,30 @@ class BaseFileProvider {
     // Returns the display name of the directory being provided as a FileEntry.
     virtual FileEntry getCurrentDirectory() const = 0;
 
+    // Returns the entry at index, as given by FileIterator::getIndex or a FileDelta.
+    virtual const FileEntry& getEntry(uint32_t index) const = 0;
+
+    // Returns the full path of the entry at index, as given by FileIterator::getIndex.
+    virtual std::filesystem::path getEntryPath(uint32_t index) const = 0;
+
+    // Applies the changes on disk since the last call to the entries and replaces out with them.
+    // Added entries come after their parents. An Overflow delta alone means the entries were read
+    // again and indices from before are stale. Returns false if nothing changed, always for
+    // providers that do not watch.
+    virtual bool pollChanges(std::vector<FileDelta>& out) {
+        out.clear();
+        return false;
+    }
+
+    // Sets a callback, invoked on any thread, for when pollChanges has something to report.
+    virtual void setChangeListener(std::function<void()> /*listener*/) {
+    }
+
+    // Returns the full path of the directory being provided, so entries can be opened.
+    const std::filesystem::path& getDirectoryPath() const {
+        return mDirectoryPath;
+    }
+
   protected:
     std::filesystem::path mDirectoryPath; // The directory path to be iterated
 };
\ No newline at end of file
@@ -0,0 +1,525 @@
+﻿// src/Files/DirectoryScan.cpp
+#include "DirectoryScan.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+#include "Common/Profiler.h"
+#include "Common/ThreadPool.h"
+
+namespace {
+
+// A thread's name arena starts here and doubles as it fills.
+constexpr size_t NAME_BLOCK_BYTES = 256 * 1024;
+
+// 100 ns intervals between the FILETIME epoch (1601) and the Unix epoch.
+constexpr int64_t FILETIME_UNIX_OFFSET = 116444736000000000LL;
+
+struct DirectoryToRead {
+    uint32_t Index; // Entry of the directory, or INVALID_FILE_INDEX for the root
+    std::filesystem::path Path;
+};
+
+// Where one directory's children landed in its thread's list.
+struct DirectoryListing {
+    uint32_t Thread = 0;
+    uint32_t Begin = 0;
+    uint32_t Count = 0;
+    bool Failed = false;
+};
+
+struct ThreadScratch {
+    std::vector<FileEntry> Entries;
+    uint32_t FilteredCount = 0;
+};
+
+bool IsDotOrDotDot(const FileChar* Name) {
+    return Name[0] == '.' && (Name[1] == '\0' || (Name[1] == '.' && Name[2] == '\0'));
+}
+
+FileChar ToLowerAscii(FileChar C) {
+    return C >= 'A' && C <= 'Z' ? static_cast<FileChar>(C - 'A' + 'a') : C;
+}
+
+bool MatchesExtension(const FileChar* Name, size_t Length, const DirectoryScanSettings& Settings) {
+    if (Settings.Extensions.empty()) {
+        return true;
+    }
+    for (const std::string& extension : Settings.Extensions) {
+        if (extension.size() > Length) {
+            continue;
+        }
+        const FileChar* tail = Name + Length - extension.size();
+        size_t i = 0;
+        while (i < extension.size() &&
+               ToLowerAscii(tail[i]) == static_cast<FileChar>(extension[i])) {
+            ++i;
+        }
+        if (i == extension.size()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MatchesName(const FileChar* Name, size_t Length, const std::string& Expected) {
+    if (Expected.size() != Length) {
+        return false;
+    }
+    for (size_t i = 0; i < Length; ++i) {
+        if (Name[i] != static_cast<FileChar>(Expected[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Files without a listed extension and excluded directories.
+bool IsFiltered(const FileChar* Name,
+                size_t Length,
+                FileType Type,
+                const DirectoryScanSettings& Settings) {
+    if (Type == FileType::File) {
+        return !MatchesExtension(Name, Length, Settings);
+    }
+    if (Type == FileType::Directory) {
+        for (const std::string& excluded : Settings.ExcludedDirectories) {
+            if (MatchesName(Name, Length, excluded)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void AddEntry(const FileChar* Name,
+              size_t Length,
+              FileType Type,
+              uint64_t Size,
+              int64_t ModifiedTime,
+              LinearArena& Names,
+              ThreadScratch& Out) {
+    FileChar* name = Names.AllocateArray<FileChar>(Length + 1);
+    std::memcpy(name, Name, Length * sizeof(FileChar));
+    name[Length] = '\0';
+    Out.Entries.push_back({name, Size, ModifiedTime, INVALID_FILE_INDEX, INVALID_FILE_INDEX,
+                           INVALID_FILE_INDEX, 0, Type, false});
+}
+
+#ifdef _WIN32
+
+FileType GetFileType(DWORD Attributes) {
+    if (Attributes & FILE_ATTRIBUTE_REPARSE_POINT) {
+        return FileType::Symlink; // Junctions too; not followed, so the walk cannot loop
+    }
+    return Attributes & FILE_ATTRIBUTE_DIRECTORY ? FileType::Directory : FileType::File;
+}
+
+int64_t ToUnixNanoseconds(const FILETIME& Time) {
+    const int64_t ticks = static_cast<int64_t>(
+        (static_cast<uint64_t>(Time.dwHighDateTime) << 32) | Time.dwLowDateTime);
+    return (ticks - FILETIME_UNIX_OFFSET) * 100;
+}
+
+uint64_t GetFileSize(FileType Type, DWORD SizeHigh, DWORD SizeLow) {
+    return Type == FileType::File ? (static_cast<uint64_t>(SizeHigh) << 32) | SizeLow : 0;
+}
+
+bool ReadEntryInfo(const std::filesystem::path& Path,
+                   FileType& OutType,
+                   uint64_t& OutSize,
+                   int64_t& OutModifiedTime) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(Path.c_str(), GetFileExInfoStandard, &data)) {
+        return false;
+    }
+    OutType = GetFileType(data.dwFileAttributes);
+    OutSize = GetFileSize(OutType, data.nFileSizeHigh, data.nFileSizeLow);
+    OutModifiedTime = ToUnixNanoseconds(data.ftLastWriteTime);
+    return true;
+}
+
+bool ReadDirectory(const std::filesystem::path& Path,
+                   const DirectoryScanSettings& Settings,
+                   LinearArena& Names,
+                   ThreadScratch& Out) {
+    // Basic info skips the 8.3 names; large fetch asks for bigger batches per kernel call. Both
+    // directory listing calls return size, time and attributes, so no entry is opened.
+    WIN32_FIND_DATAW data;
+    HANDLE find = FindFirstFileExW((Path / L"*").c_str(), FindExInfoBasic, &data,
+                                   FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (find == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    do {
+        if (IsDotOrDotDot(data.cFileName)) {
+            continue;
+        }
+        const FileType type = GetFileType(data.dwFileAttributes);
+        const size_t length = std::wcslen(data.cFileName);
+        if (IsFiltered(data.cFileName, length, type, Settings)) {
+            ++Out.FilteredCount;
+            continue;
+        }
+        AddEntry(data.cFileName, length, type,
+                 GetFileSize(type, data.nFileSizeHigh, data.nFileSizeLow),
+                 ToUnixNanoseconds(data.ftLastWriteTime), Names, Out);
+    } while (FindNextFileW(find, &data));
+    FindClose(find);
+    return true;
+}
+
+#else
+
+FileType GetFileType(mode_t Mode) {
+    return S_ISREG(Mode)   ? FileType::File
+           : S_ISDIR(Mode) ? FileType::Directory
+           : S_ISLNK(Mode) ? FileType::Symlink
+                           : FileType::Other;
+}
+
+int64_t GetModifiedTime(const struct stat& Info) {
+#ifdef __APPLE__
+    const timespec& modified = Info.st_mtimespec;
+#else
+    const timespec& modified = Info.st_mtim;
+#endif
+    return static_cast<int64_t>(modified.tv_sec) * 1000000000LL + modified.tv_nsec;
+}
+
+bool ReadEntryInfo(const std::filesystem::path& Path,
+                   FileType& OutType,
+                   uint64_t& OutSize,
+                   int64_t& OutModifiedTime) {
+    struct stat info;
+    if (lstat(Path.c_str(), &info) != 0) {
+        return false;
+    }
+    OutType = GetFileType(info.st_mode);
+    OutSize = OutType == FileType::File ? static_cast<uint64_t>(info.st_size) : 0;
+    OutModifiedTime = GetModifiedTime(info);
+    return true;
+}
+
+bool ReadDirectory(const std::filesystem::path& Path,
+                   const DirectoryScanSettings& Settings,
+                   LinearArena& Names,
+                   ThreadScratch& Out) {
+    DIR* dir = opendir(Path.c_str());
+    if (dir == nullptr) {
+        return false;
+    }
+    const int dirFd = dirfd(dir);
+    while (const dirent* item = readdir(dir)) {
+        if (IsDotOrDotDot(item->d_name)) {
+            continue;
+        }
+        const size_t length = std::strlen(item->d_name);
+        // The listing usually knows the type, so filtered files are skipped without a stat.
+        FileType type = FileType::Other;
+        switch (item->d_type) {
+        case DT_REG:
+            type = FileType::File;
+            break;
+        case DT_DIR:
+            type = FileType::Directory;
+            break;
+        case DT_LNK:
+            type = FileType::Symlink;
+            break;
+        default:
+            break;
+        }
+        if (IsFiltered(item->d_name, length, type, Settings)) {
+            ++Out.FilteredCount;
+            continue;
+        }
+
+        struct stat info;
+        if (fstatat(dirFd, item->d_name, &info, AT_SYMLINK_NOFOLLOW) != 0) {
+            continue; // Removed since the listing was read
+        }
+        if (item->d_type == DT_UNKNOWN) {
+            type = GetFileType(info.st_mode);
+            if (IsFiltered(item->d_name, length, type, Settings)) {
+                ++Out.FilteredCount;
+                continue;
+            }
+        }
+        const uint64_t size = type == FileType::File ? static_cast<uint64_t>(info.st_size) : 0;
+        AddEntry(item->d_name, length, type, size, GetModifiedTime(info), Names, Out);
+    }
+    closedir(dir);
+    return true;
+}
+
+#endif
+
+} // anonymous namespace
+
+DirectoryScan::DirectoryScan() = default;
+
+DirectoryScan::~DirectoryScan() = default;
+
+bool DirectoryScan::Scan(const std::filesystem::path& Root,
+                         const DirectoryScanSettings& Settings,
+                         ThreadPool* Pool) {
+    PROFILE_ZONE("DirectoryScan::Scan");
+    const auto start = std::chrono::steady_clock::now();
+
+    const uint32_t threadCount = Pool != nullptr ? Pool->GetThreadCount() : 1;
+    while (mNameArenas.size() < threadCount) {
+        mNameArenas.push_back(std::make_unique<LinearArena>(NAME_BLOCK_BYTES));
+    }
+    for (const auto& arena : mNameArenas) {
+        arena->Reset();
+    }
+    mRoot = Root;
+    mSettings = Settings;
+    mEntries.clear();
+    mFirstTopLevel = INVALID_FILE_INDEX;
+    mTopLevelCount = 0;
+    mStats = {};
+
+    if (!ReadTree(INVALID_FILE_INDEX, Root, 0, Pool)) {
+        mStats.ErrorCount = 1;
+        return false;
+    }
+    for (const auto& arena : mNameArenas) {
+        mStats.NameBytes += arena->GetStats().UsedBytes;
+    }
+    mStats.ScanMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+            .count();
+    return true;
+}
+
+bool DirectoryScan::ReadTree(uint32_t Index,
+                             const std::filesystem::path& Path,
+                             uint32_t Depth,
+                             ThreadPool* Pool) {
+    const uint32_t threadCount = Pool != nullptr ? Pool->GetThreadCount() : 1;
+    std::vector<ThreadScratch> scratch(threadCount);
+    std::vector<DirectoryToRead> level{{Index, Path}};
+    std::vector<DirectoryToRead> nextLevel;
+    std::vector<DirectoryListing> listings;
+    for (uint32_t depth = Depth; !level.empty(); ++depth) {
+        // Every directory of this depth is read in parallel, each into its thread's list.
+        listings.assign(level.size(), DirectoryListing());
+        auto readOne = [&](uint32_t Item, uint32_t ThreadIndex) {
+            ThreadScratch& out = scratch[ThreadIndex];
+            DirectoryListing& listing = listings[Item];
+            listing.Thread = ThreadIndex;
+            listing.Begin = static_cast<uint32_t>(out.Entries.size());
+            listing.Failed = !ReadDirectory(level[Item].Path, mSettings,
+                                            *mNameArenas[ThreadIndex], out);
+            listing.Count = static_cast<uint32_t>(out.Entries.size()) - listing.Begin;
+        };
+        if (Pool != nullptr && level.size() > 1) {
+            Pool->ParallelFor(static_cast<uint32_t>(level.size()), readOne);
+        } else {
+            for (uint32_t i = 0; i < level.size(); ++i) {
+                readOne(i, 0);
+            }
+        }
+        if (depth == Depth && listings[0].Failed) {
+            return false;
+        }
+
+        // Append the listings in directory order, so the result does not depend on timing.
+        nextLevel.clear();
+        for (size_t i = 0; i < level.size(); ++i) {
+            const DirectoryListing& listing = listings[i];
+            const uint32_t parent = level[i].Index;
+            const uint32_t first = static_cast<uint32_t>(mEntries.size());
+            if (listing.Failed) {
+                ++mStats.ErrorCount;
+            }
+            const FileEntry* source = scratch[listing.Thread].Entries.data() + listing.Begin;
+            mEntries.insert(mEntries.end(), source, source + listing.Count);
+            if (listing.Count > 0) {
+                GetFirstChild(parent) = first;
+            }
+            if (parent == INVALID_FILE_INDEX) {
+                mTopLevelCount = listing.Count;
+            } else {
+                mEntries[parent].ChildCount = listing.Count;
+            }
+
+            const uint32_t end = first + listing.Count;
+            for (uint32_t index = first; index < end; ++index) {
+                FileEntry& entry = mEntries[index];
+                entry.Parent = parent;
+                entry.NextSibling = index + 1 < end ? index + 1 : INVALID_FILE_INDEX;
+                if (entry.Type != FileType::Directory) {
+                    ++mStats.FileCount;
+                    continue;
+                }
+                ++mStats.DirectoryCount;
+                if (depth < mSettings.MaxDepth) {
+                    nextLevel.push_back({index, level[i].Path / entry.Name});
+                }
+            }
+        }
+        for (ThreadScratch& threadScratch : scratch) {
+            threadScratch.Entries.clear();
+        }
+        level.swap(nextLevel);
+        mStats.LevelCount = std::max(mStats.LevelCount, depth + 1);
+    }
+
+    for (const ThreadScratch& threadScratch : scratch) {
+        mStats.FilteredCount += threadScratch.FilteredCount;
+    }
+    return true;
+}
+
+uint32_t DirectoryScan::Find(const std::filesystem::path& Relative) const {
+    uint32_t index = INVALID_FILE_INDEX;
+    uint32_t child = mFirstTopLevel;
+    for (const std::filesystem::path& part : Relative) {
+        while (child != INVALID_FILE_INDEX && part.native() != mEntries[child].Name) {
+            child = mEntries[child].NextSibling;
+        }
+        if (child == INVALID_FILE_INDEX) {
+            return INVALID_FILE_INDEX;
+        }
+        index = child;
+        child = mEntries[child].FirstChild;
+    }
+    return index;
+}
+
+uint32_t DirectoryScan::Add(const std::filesystem::path& Relative) {
+    if (mNameArenas.empty() || Relative.empty() || Find(Relative) != INVALID_FILE_INDEX) {
+        return INVALID_FILE_INDEX;
+    }
+    uint32_t parent = INVALID_FILE_INDEX;
+    if (Relative.has_parent_path()) {
+        parent = Find(Relative.parent_path());
+        if (parent == INVALID_FILE_INDEX || mEntries[parent].Type != FileType::Directory) {
+            return INVALID_FILE_INDEX;
+        }
+    }
+    const uint32_t depth =
+        static_cast<uint32_t>(std::distance(Relative.begin(), Relative.end())) - 1;
+    if (depth > mSettings.MaxDepth) {
+        return INVALID_FILE_INDEX;
+    }
+
+    const std::filesystem::path path = mRoot / Relative;
+    FileType type;
+    uint64_t size;
+    int64_t modifiedTime;
+    if (!ReadEntryInfo(path, type, size, modifiedTime)) {
+        return INVALID_FILE_INDEX;
+    }
+    const std::filesystem::path fileName = Relative.filename();
+    const std::filesystem::path::string_type& name = fileName.native();
+    if (IsFiltered(name.c_str(), name.size(), type, mSettings)) {
+        return INVALID_FILE_INDEX;
+    }
+
+    ThreadScratch added;
+    AddEntry(name.c_str(), name.size(), type, size, modifiedTime, *mNameArenas[0], added);
+    const uint32_t index = static_cast<uint32_t>(mEntries.size());
+    mEntries.push_back(added.Entries[0]);
+    mEntries[index].Parent = parent;
+
+    // Link it in at the end of its directory.
+    uint32_t* link = &GetFirstChild(parent);
+    while (*link != INVALID_FILE_INDEX) {
+        link = &mEntries[*link].NextSibling;
+    }
+    *link = index;
+    if (parent == INVALID_FILE_INDEX) {
+        ++mTopLevelCount;
+    } else {
+        ++mEntries[parent].ChildCount;
+    }
+
+    if (type != FileType::Directory) {
+        ++mStats.FileCount;
+        return index;
+    }
+    ++mStats.DirectoryCount;
+    if (depth < mSettings.MaxDepth) {
+        ReadTree(index, path, depth + 1, nullptr);
+    }
+    return index;
+}
+
+void DirectoryScan::Remove(uint32_t Index) {
+    if (Index >= mEntries.size() || mEntries[Index].Removed) {
+        return;
+    }
+    const uint32_t parent = mEntries[Index].Parent;
+    uint32_t* link = &GetFirstChild(parent);
+    while (*link != Index) {
+        link = &mEntries[*link].NextSibling;
+    }
+    *link = mEntries[Index].NextSibling;
+    if (parent == INVALID_FILE_INDEX) {
+        --mTopLevelCount;
+    } else {
+        --mEntries[parent].ChildCount;
+    }
+
+    std::vector<uint32_t> stack{Index};
+    while (!stack.empty()) {
+        FileEntry& entry = mEntries[stack.back()];
+        stack.pop_back();
+        entry.Removed = true;
+        if (entry.Type == FileType::Directory) {
+            --mStats.DirectoryCount;
+        } else {
+            --mStats.FileCount;
+        }
+        for (uint32_t child = entry.FirstChild; child != INVALID_FILE_INDEX;
+             child = mEntries[child].NextSibling) {
+            stack.push_back(child);
+        }
+    }
+}
+
+bool DirectoryScan::Refresh(uint32_t Index) {
+    if (Index >= mEntries.size() || mEntries[Index].Removed) {
+        return false;
+    }
+    FileType type;
+    uint64_t size;
+    int64_t modifiedTime;
+    if (!ReadEntryInfo(GetPath(Index), type, size, modifiedTime)) {
+        return false;
+    }
+    FileEntry& entry = mEntries[Index];
+    if (entry.Size == size && entry.ModifiedTime == modifiedTime) {
+        return false;
+    }
+    entry.Size = size;
+    entry.ModifiedTime = modifiedTime;
+    return true;
+}
+
+std::filesystem::path DirectoryScan::GetPath(uint32_t Index) const {
+    // Walk up to the top level, then join the names from there down.
+    std::vector<const FileChar*> names;
+    for (uint32_t i = Index; i != INVALID_FILE_INDEX; i = mEntries[i].Parent) {
+        names.push_back(mEntries[i].Name);
+    }
+    std::filesystem::path path = mRoot;
+    for (auto name = names.rbegin(); name != names.rend(); ++name) {
+        path /= *name;
+    }
+    return path;
+}
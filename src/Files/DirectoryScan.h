@@ -0,0 +1,126 @@
+﻿// src/Files/DirectoryScan.h
+// Recursive directory listing with size, modification time and type per entry. Directories of
+// one depth are read in parallel, and names go into per-thread arenas rather than one string
+// each. The listing can then follow changes on disk entry by entry, without reading it again.
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common/FrameArena.h"
+
+class ThreadPool;
+
+// The platform's path character: wchar_t on Windows, char elsewhere.
+using FileChar = std::filesystem::path::value_type;
+
+constexpr uint32_t INVALID_FILE_INDEX = ~0u;
+
+enum class FileType : uint8_t { File, Directory, Symlink, Other };
+
+// Entries are linked into a tree. A scan lists every directory's children next to each other;
+// entries added later are linked in at the end of their directory.
+struct FileEntry {
+    const FileChar* Name; // Null-terminated; owned by the scan
+    uint64_t Size;        // Bytes; 0 for directories
+    int64_t ModifiedTime; // Nanoseconds since the Unix epoch
+    uint32_t Parent;      // Containing directory, or INVALID_FILE_INDEX at the top level
+    uint32_t FirstChild;  // Directories; INVALID_FILE_INDEX when empty
+    uint32_t NextSibling;
+    uint32_t ChildCount;
+    FileType Type;
+    bool Removed; // Gone from disk; the index stays reserved until the next Scan
+};
+
+struct DirectoryScanSettings {
+    // Lower-case extensions with the dot, e.g. ".obj". Files matching none are left out;
+    // directories are always listed. Empty lists every file.
+    std::vector<std::string> Extensions;
+    // Directory names left out along with everything below them, such as a cache the
+    // application writes next to the files it lists. Matched exactly.
+    std::vector<std::string> ExcludedDirectories;
+    uint32_t MaxDepth = ~0u; // 0 lists the top level only
+};
+
+struct DirectoryScanStats {
+    uint32_t FileCount = 0; // Listed now, entries added and removed since the scan included
+    uint32_t DirectoryCount = 0;
+    uint32_t FilteredCount = 0; // Files and directories the settings left out
+    uint32_t ErrorCount = 0;    // Directories that could not be read
+    uint32_t LevelCount = 0;
+    size_t NameBytes = 0;
+    double ScanMs = 0.0;
+};
+
+class DirectoryScan {
+  public:
+    DirectoryScan();
+    ~DirectoryScan();
+
+    DirectoryScan(const DirectoryScan&) = delete;
+    DirectoryScan& operator=(const DirectoryScan&) = delete;
+
+    // Lists everything below Root, replacing the previous scan. Pool may be null to read on the
+    // calling thread only. Returns false if Root itself cannot be read.
+    bool Scan(const std::filesystem::path& Root,
+              const DirectoryScanSettings& Settings,
+              ThreadPool* Pool = nullptr);
+
+    const std::filesystem::path& GetRoot() const {
+        return mRoot;
+    }
+    // Parents come before their children. Removed entries stay in the list.
+    const std::vector<FileEntry>& GetEntries() const {
+        return mEntries;
+    }
+    uint32_t GetFirstTopLevel() const {
+        return mFirstTopLevel;
+    }
+    uint32_t GetTopLevelCount() const {
+        return mTopLevelCount;
+    }
+    // Full path of an entry, built from its parents.
+    std::filesystem::path GetPath(uint32_t Index) const;
+
+    // --- Following changes on disk, with the settings of the last Scan ---
+
+    // The entry at Relative, a path below the root, or INVALID_FILE_INDEX.
+    uint32_t Find(const std::filesystem::path& Relative) const;
+    // Reads Relative from disk and links it in, with everything below it for a directory. The
+    // new entries are [returned index, GetEntries().size()). Returns INVALID_FILE_INDEX if
+    // Relative is listed already, its directory is not, it is gone again or the filter rejects
+    // it.
+    uint32_t Add(const std::filesystem::path& Relative);
+    // Unlinks the entry and marks it and everything below it removed.
+    void Remove(uint32_t Index);
+    // Reads the entry's size and time again. Returns true if either changed.
+    bool Refresh(uint32_t Index);
+
+    DirectoryScanStats GetStats() const {
+        return mStats;
+    }
+
+  private:
+    // Lists the directory at Path, entry Index or INVALID_FILE_INDEX for the root, and the ones
+    // below it down to the maximum depth. Depth is that of the entries read first. Returns false
+    // if Path itself cannot be read.
+    bool ReadTree(uint32_t Index,
+                  const std::filesystem::path& Path,
+                  uint32_t Depth,
+                  ThreadPool* Pool);
+    // The head of the child list of Parent, or of the top level.
+    uint32_t& GetFirstChild(uint32_t Parent) {
+        return Parent != INVALID_FILE_INDEX ? mEntries[Parent].FirstChild : mFirstTopLevel;
+    }
+
+    std::filesystem::path mRoot;
+    DirectoryScanSettings mSettings;
+    std::vector<FileEntry> mEntries;
+    uint32_t mFirstTopLevel = INVALID_FILE_INDEX;
+    uint32_t mTopLevelCount = 0;
+    std::vector<std::unique_ptr<LinearArena>> mNameArenas; // One per scanning thread
+    DirectoryScanStats mStats;
+};
@@ -0,0 +1,403 @@
+﻿// src/Files/DirectoryWatcher.cpp
+#include "DirectoryWatcher.h"
+
+#include <chrono>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <dirent.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "Common/Log.h"
+#include "Common/Profiler.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Kernel buffer for one batch of events. ReadDirectoryChangesW fails above 64 KiB on network
+// shares.
+constexpr uint32_t EVENT_BUFFER_BYTES = 64 * 1024;
+
+#ifdef __linux__
+constexpr uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+                                IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR | IN_DONT_FOLLOW |
+                                IN_EXCL_UNLINK;
+#endif
+
+// Milliseconds until the pending changes have been quiet for QuietMs, or -1 with none pending.
+int GetWaitMs(bool HasPending, Clock::time_point LastEvent, uint32_t QuietMs) {
+    if (!HasPending) {
+        return -1;
+    }
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        LastEvent + std::chrono::milliseconds(QuietMs) - Clock::now());
+    // Rounded up, so the wait does not end just short of the deadline and spin.
+    return remaining.count() > 0 ? static_cast<int>(remaining.count()) + 1 : 0;
+}
+
+} // anonymous namespace
+
+DirectoryWatcher::DirectoryWatcher(std::filesystem::path Root,
+                                   std::vector<std::string> ExcludedDirectories,
+                                   uint32_t QuietMs)
+    : mRoot(std::move(Root)), mExcludedDirectories(std::move(ExcludedDirectories)),
+      mQuietMs(QuietMs) {
+#ifdef _WIN32
+    mDirectory = CreateFileW(mRoot.c_str(), FILE_LIST_DIRECTORY,
+                             FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                             OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+                             nullptr);
+    if (mDirectory == INVALID_HANDLE_VALUE) {
+        mDirectory = nullptr;
+    }
+    mStopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    mWatching = mDirectory != nullptr && mStopEvent != nullptr;
+    mStats.WatchCount = mWatching ? 1 : 0;
+#elif defined(__linux__)
+    mInotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    mStopEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (mInotify >= 0 && mStopEvent >= 0) {
+        AddWatchTree({});
+        mWatching = !mWatches.empty();
+    }
+#endif
+    if (!mWatching) {
+        LOG_WARNING(Files, "Cannot watch %s for changes", mRoot.c_str());
+        return;
+    }
+    mThread = std::thread(&DirectoryWatcher::WatcherMain, this);
+}
+
+DirectoryWatcher::~DirectoryWatcher() {
+    mStopping.store(true, std::memory_order_relaxed);
+#ifdef _WIN32
+    if (mStopEvent != nullptr) {
+        SetEvent(mStopEvent);
+    }
+#elif defined(__linux__)
+    if (mStopEvent >= 0) {
+        const uint64_t one = 1;
+        (void)write(mStopEvent, &one, sizeof(one));
+    }
+#endif
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+#ifdef _WIN32
+    if (mDirectory != nullptr) {
+        CloseHandle(mDirectory);
+    }
+    if (mStopEvent != nullptr) {
+        CloseHandle(mStopEvent);
+    }
+#elif defined(__linux__)
+    if (mInotify >= 0) {
+        close(mInotify);
+    }
+    if (mStopEvent >= 0) {
+        close(mStopEvent);
+    }
+#endif
+}
+
+void DirectoryWatcher::SetListener(std::function<void()> Listener) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mListener = std::move(Listener);
+}
+
+bool DirectoryWatcher::Poll(std::vector<FileChange>& Out) {
+    Out.clear();
+    std::lock_guard<std::mutex> lock(mMutex);
+    Out.swap(mReady);
+    return !Out.empty();
+}
+
+DirectoryWatcherStats DirectoryWatcher::GetStats() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+bool DirectoryWatcher::IsExcluded(const std::filesystem::path& Relative) const {
+    for (const std::filesystem::path& component : Relative) {
+        for (const std::string& excluded : mExcludedDirectories) {
+            if (component == excluded) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void DirectoryWatcher::Record(FileChangeType Type, const std::filesystem::path& Path) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++mStats.Events;
+        if (Type == FileChangeType::Overflow) {
+            ++mStats.Overflows;
+        }
+    }
+    // ReadDirectoryChangesW watches the whole tree, so events below excluded directories are
+    // dropped here rather than not asked for.
+    if (Type != FileChangeType::Overflow && IsExcluded(Path)) {
+        return;
+    }
+    if (Type == FileChangeType::Overflow) {
+        // Whoever polls starts over from the disk, so the details no longer matter.
+        mPending.clear();
+        mPendingIndex.clear();
+        mPending.push_back({{FileChangeType::Overflow, {}}, false});
+        mPendingIndex.emplace(std::filesystem::path::string_type(), 0);
+        return;
+    }
+
+    auto [entry, isNew] = mPendingIndex.emplace(Path.native(), mPending.size());
+    if (isNew) {
+        mPending.push_back({{Type, Path}, false});
+        return;
+    }
+
+    // What the path went through since the last delivery, as one change: only whether it
+    // existed then and whether it exists now matter.
+    PendingChange& pending = mPending[entry->second];
+    const bool existedBefore = !pending.Dropped && pending.Change.Type != FileChangeType::Added;
+    pending.Dropped = false;
+    if (Type == FileChangeType::Removed) {
+        pending.Change.Type = FileChangeType::Removed;
+        pending.Dropped = !existedBefore;
+    } else {
+        // A save through a temporary file and a rename replaces the old file: Modified.
+        pending.Change.Type = existedBefore ? FileChangeType::Modified : FileChangeType::Added;
+    }
+}
+
+void DirectoryWatcher::Publish() {
+    std::function<void()> listener;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (PendingChange& pending : mPending) {
+            if (!pending.Dropped) {
+                mReady.push_back(std::move(pending.Change));
+                ++mStats.Delivered;
+            }
+        }
+        listener = mListener;
+    }
+    mPending.clear();
+    mPendingIndex.clear();
+    if (listener) {
+        listener();
+    }
+}
+
+#ifdef _WIN32
+
+void DirectoryWatcher::WatcherMain() {
+    PROFILE_THREAD("Directory watcher");
+    // FILE_NOTIFY_INFORMATION records are DWORD aligned.
+    std::vector<DWORD> buffer(EVENT_BUFFER_BYTES / sizeof(DWORD));
+    OVERLAPPED overlapped{};
+    overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME |
+                         FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE;
+    Clock::time_point lastEvent;
+    bool reading = false;
+
+    while (!mStopping.load(std::memory_order_relaxed)) {
+        if (!reading) {
+            ResetEvent(overlapped.hEvent);
+            if (!ReadDirectoryChangesW(mDirectory, buffer.data(), EVENT_BUFFER_BYTES, TRUE,
+                                       filter, nullptr, &overlapped, nullptr)) {
+                LOG_ERROR(Files, "ReadDirectoryChangesW failed for %s. Error: %lu",
+                          mRoot.c_str(), GetLastError());
+                break;
+            }
+            reading = true;
+        }
+
+        const int waitMs = GetWaitMs(!mPending.empty(), lastEvent, mQuietMs);
+        const HANDLE handles[] = {overlapped.hEvent, static_cast<HANDLE>(mStopEvent)};
+        const DWORD timeout = waitMs < 0 ? INFINITE : static_cast<DWORD>(waitMs);
+        const DWORD wait = WaitForMultipleObjects(2, handles, FALSE, timeout);
+        if (wait == WAIT_TIMEOUT) {
+            Publish();
+            continue;
+        }
+        if (wait != WAIT_OBJECT_0) {
+            break; // Stopping
+        }
+
+        reading = false;
+        DWORD bytes = 0;
+        if (!GetOverlappedResult(mDirectory, &overlapped, &bytes, FALSE)) {
+            break;
+        }
+        lastEvent = Clock::now();
+        if (bytes == 0) {
+            // The system's buffer overflowed and the events are gone.
+            Record(FileChangeType::Overflow, {});
+            continue;
+        }
+
+        const BYTE* record = reinterpret_cast<const BYTE*>(buffer.data());
+        for (;;) {
+            const FILE_NOTIFY_INFORMATION& info =
+                *reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(record);
+            const std::filesystem::path path(
+                std::wstring(info.FileName, info.FileNameLength / sizeof(WCHAR)));
+            switch (info.Action) {
+            case FILE_ACTION_ADDED:
+            case FILE_ACTION_RENAMED_NEW_NAME:
+                Record(FileChangeType::Added, path);
+                break;
+            case FILE_ACTION_REMOVED:
+            case FILE_ACTION_RENAMED_OLD_NAME:
+                Record(FileChangeType::Removed, path);
+                break;
+            default:
+                Record(FileChangeType::Modified, path);
+                break;
+            }
+            if (info.NextEntryOffset == 0) {
+                break;
+            }
+            record += info.NextEntryOffset;
+        }
+    }
+
+    if (reading) {
+        CancelIoEx(mDirectory, &overlapped);
+        DWORD bytes = 0;
+        GetOverlappedResult(mDirectory, &overlapped, &bytes, TRUE);
+    }
+    CloseHandle(overlapped.hEvent);
+}
+
+#elif defined(__linux__)
+
+void DirectoryWatcher::AddWatchTree(const std::filesystem::path& Relative) {
+    // inotify is not recursive: every directory gets its own watch, added as it is found.
+    std::vector<std::filesystem::path> stack{Relative};
+    while (!stack.empty()) {
+        const std::filesystem::path relative = std::move(stack.back());
+        stack.pop_back();
+        if (IsExcluded(relative)) {
+            continue;
+        }
+        const std::filesystem::path full = relative.empty() ? mRoot : mRoot / relative;
+        const int watch = inotify_add_watch(mInotify, full.c_str(), WATCH_MASK);
+        if (watch < 0) {
+            continue;
+        }
+        mWatches[watch] = relative;
+
+        DIR* dir = opendir(full.c_str());
+        if (dir == nullptr) {
+            continue;
+        }
+        while (const dirent* item = readdir(dir)) {
+            const char* name = item->d_name;
+            if (item->d_type != DT_DIR ||
+                (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))) {
+                continue;
+            }
+            stack.push_back(relative / name);
+        }
+        closedir(dir);
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.WatchCount = static_cast<uint32_t>(mWatches.size());
+}
+
+void DirectoryWatcher::RemoveWatchTree(const std::filesystem::path& Relative) {
+    // A directory moved out keeps its watches; they would report under the old path.
+    const std::filesystem::path::string_type& prefix = Relative.native();
+    for (auto it = mWatches.begin(); it != mWatches.end();) {
+        const std::filesystem::path::string_type& path = it->second.native();
+        if (path.compare(0, prefix.size(), prefix) == 0 &&
+            (path.size() == prefix.size() ||
+             path[prefix.size()] == std::filesystem::path::preferred_separator)) {
+            inotify_rm_watch(mInotify, it->first);
+            it = mWatches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.WatchCount = static_cast<uint32_t>(mWatches.size());
+}
+
+void DirectoryWatcher::ReadEvents() {
+    alignas(inotify_event) char buffer[EVENT_BUFFER_BYTES];
+    for (;;) {
+        const ssize_t bytes = read(mInotify, buffer, sizeof(buffer));
+        if (bytes <= 0) {
+            return;
+        }
+        for (const char* p = buffer; p < buffer + bytes;) {
+            const inotify_event& event = *reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + event.len;
+
+            if (event.mask & IN_Q_OVERFLOW) {
+                Record(FileChangeType::Overflow, {});
+                continue;
+            }
+            if (event.mask & IN_IGNORED) {
+                mWatches.erase(event.wd);
+                continue;
+            }
+            auto watch = mWatches.find(event.wd);
+            if (watch == mWatches.end() || event.len == 0) {
+                continue;
+            }
+            const std::filesystem::path path = watch->second / event.name;
+            if (event.mask & (IN_CREATE | IN_MOVED_TO)) {
+                if (event.mask & IN_ISDIR) {
+                    AddWatchTree(path);
+                }
+                Record(FileChangeType::Added, path);
+            } else if (event.mask & (IN_DELETE | IN_MOVED_FROM)) {
+                if (event.mask & IN_ISDIR) {
+                    RemoveWatchTree(path);
+                }
+                Record(FileChangeType::Removed, path);
+            } else if (!(event.mask & IN_ISDIR)) {
+                Record(FileChangeType::Modified, path);
+            }
+        }
+    }
+}
+
+void DirectoryWatcher::WatcherMain() {
+    PROFILE_THREAD("Directory watcher");
+    Clock::time_point lastEvent;
+    while (!mStopping.load(std::memory_order_relaxed)) {
+        pollfd fds[2] = {{mInotify, POLLIN, 0}, {mStopEvent, POLLIN, 0}};
+        const int waitMs = GetWaitMs(!mPending.empty(), lastEvent, mQuietMs);
+        const int ready = poll(fds, 2, waitMs);
+        if (ready < 0) {
+            continue; // Interrupted by a signal
+        }
+        if (ready == 0) {
+            Publish();
+            continue;
+        }
+        if (fds[0].revents & POLLIN) {
+            ReadEvents();
+            lastEvent = Clock::now();
+        }
+    }
+}
+
+#else
+
+void DirectoryWatcher::WatcherMain() {
+}
+
+#endif
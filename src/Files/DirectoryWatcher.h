@@ -0,0 +1,105 @@
+﻿// src/Files/DirectoryWatcher.h
+// Reports files added, removed and modified anywhere below a directory: ReadDirectoryChangesW on
+// Windows, inotify on Linux. A background thread folds bursts of events per path, e.g. the many
+// writes of one save, and hands them out once the directory has been quiet for a moment.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+enum class FileChangeType : uint8_t {
+    Added,
+    Removed,
+    Modified,
+    Overflow, // Events were lost; everything below the root may have changed
+};
+
+struct FileChange {
+    FileChangeType Type;
+    std::filesystem::path Path; // Relative to the root; empty for Overflow
+};
+
+struct DirectoryWatcherStats {
+    uint64_t Events = 0;    // As the system reported them
+    uint64_t Delivered = 0; // Changes handed to Poll after folding
+    uint32_t Overflows = 0;
+    uint32_t WatchCount = 0; // Directories watched; inotify needs one watch per directory
+};
+
+class DirectoryWatcher {
+  public:
+    // Starts watching Root and everything below it, except directories named in
+    // ExcludedDirectories and their contents. Changes are handed out once no new event arrived
+    // for QuietMs.
+    explicit DirectoryWatcher(std::filesystem::path Root,
+                              std::vector<std::string> ExcludedDirectories = {},
+                              uint32_t QuietMs = 100);
+    ~DirectoryWatcher();
+
+    DirectoryWatcher(const DirectoryWatcher&) = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+    // False when the platform has no watch support or Root could not be watched.
+    bool IsWatching() const {
+        return mWatching;
+    }
+
+    // Called on the watcher thread whenever Poll has new changes, e.g. to wake an idle loop.
+    void SetListener(std::function<void()> Listener);
+
+    // Any thread. Replaces Out with the changes settled since the last call, in the order their
+    // paths first changed. Returns false if there were none.
+    bool Poll(std::vector<FileChange>& Out);
+
+    DirectoryWatcherStats GetStats() const;
+
+  private:
+    struct PendingChange {
+        FileChange Change;
+        bool Dropped = false; // Added, then removed again before delivery
+    };
+
+    void WatcherMain();
+    // True when a component of Relative is an excluded directory.
+    bool IsExcluded(const std::filesystem::path& Relative) const;
+    // Folds one event into the pending changes. Watcher thread only.
+    void Record(FileChangeType Type, const std::filesystem::path& Path);
+    // Hands the pending changes to Poll. Watcher thread only.
+    void Publish();
+#ifdef __linux__
+    void AddWatchTree(const std::filesystem::path& Relative);
+    void RemoveWatchTree(const std::filesystem::path& Relative);
+    void ReadEvents();
+#endif
+
+    std::filesystem::path mRoot;
+    std::vector<std::string> mExcludedDirectories;
+    uint32_t mQuietMs;
+    bool mWatching = false;
+
+    // Watcher thread only.
+    std::vector<PendingChange> mPending;
+    std::unordered_map<std::filesystem::path::string_type, size_t> mPendingIndex;
+#ifdef _WIN32
+    void* mDirectory = nullptr; // HANDLE
+    void* mStopEvent = nullptr;
+#elif defined(__linux__)
+    int mInotify = -1;
+    int mStopEvent = -1; // eventfd
+    std::unordered_map<int, std::filesystem::path> mWatches; // Watch descriptor to directory
+#endif
+
+    mutable std::mutex mMutex;
+    std::vector<FileChange> mReady;
+    std::function<void()> mListener;
+    DirectoryWatcherStats mStats;
+    std::atomic<bool> mStopping{false};
+    std::thread mThread;
+};
@@ -0,0 +1,44 @@
+﻿// src/Files/FileTreeSource.cpp
+#include "FileTreeSource.h"
+
+bool FileTreeSource::ListChildren(TreeKey Parent,
+                                  TreeKey After,
+                                  uint32_t MaxCount,
+                                  std::vector<TreeKey>& Out) const {
+    if (Parent == INVALID_TREE_KEY) {
+        if (After == INVALID_TREE_KEY && MaxCount > 0) {
+            Out.push_back(FILE_TREE_ROOT_KEY);
+        }
+        return false;
+    }
+
+    // Siblings are linked, so listing resumes from the last one without counting.
+    uint32_t index;
+    if (After != INVALID_TREE_KEY) {
+        index = mProvider.getEntry(After).NextSibling;
+    } else if (Parent == FILE_TREE_ROOT_KEY) {
+        index = mProvider.getCurrentDirectory().FirstChild;
+    } else {
+        index = mProvider.getEntry(Parent).FirstChild;
+    }
+    for (; index != INVALID_FILE_INDEX && MaxCount > 0; --MaxCount) {
+        Out.push_back(index);
+        index = mProvider.getEntry(index).NextSibling;
+    }
+    return index != INVALID_FILE_INDEX;
+}
+
+bool FileTreeSource::HasChildren(TreeKey Key) const {
+    if (Key == FILE_TREE_ROOT_KEY) {
+        return mProvider.getCurrentDirectory().FirstChild != INVALID_FILE_INDEX;
+    }
+    return mProvider.getEntry(Key).FirstChild != INVALID_FILE_INDEX;
+}
+
+TreeKey FileTreeSource::GetParent(TreeKey Key) const {
+    if (Key == FILE_TREE_ROOT_KEY) {
+        return INVALID_TREE_KEY;
+    }
+    const uint32_t parent = mProvider.getEntry(Key).Parent;
+    return parent != INVALID_FILE_INDEX ? parent : FILE_TREE_ROOT_KEY;
+}
@@ -0,0 +1,26 @@
+﻿// src/Files/FileTreeSource.h
+// Presents a BaseFileProvider to a TreeModel: a single item for the provided directory, with the
+// entries below it. Keys are entry indices.
+#pragma once
+
+#include "Common/TreeModel.h"
+#include "Files/BaseFileProvider.h"
+
+// Key of the item standing for the provided directory itself.
+constexpr TreeKey FILE_TREE_ROOT_KEY = INVALID_TREE_KEY - 1;
+
+class FileTreeSource : public TreeSource {
+  public:
+    explicit FileTreeSource(const BaseFileProvider& Provider) : mProvider(Provider) {
+    }
+
+    bool ListChildren(TreeKey Parent,
+                      TreeKey After,
+                      uint32_t MaxCount,
+                      std::vector<TreeKey>& Out) const override;
+    bool HasChildren(TreeKey Key) const override;
+    TreeKey GetParent(TreeKey Key) const override;
+
+  private:
+    const BaseFileProvider& mProvider;
+};
@@ -0,0 +1,159 @@
+﻿// src/Files/FrameWriter.cpp
+#include "FrameWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <system_error>
+
+#include "Common/Profiler.h"
+#include "ImageEncoder.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double MillisecondsSince(Clock::time_point Start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+}
+
+} // anonymous namespace
+
+FrameWriter::FrameWriter(std::filesystem::path Directory,
+                         std::string Prefix,
+                         FrameFormat Format,
+                         uint32_t QueueCapacity,
+                         FrameQueuePolicy Policy)
+    : mDirectory(std::move(Directory)), mPrefix(std::move(Prefix)), mFormat(Format),
+      mPolicy(Policy) {
+    std::error_code ec;
+    std::filesystem::create_directories(mDirectory, ec);
+
+    // The pool is the bound: a frame is either free, queued or being written.
+    const uint32_t capacity = QueueCapacity > 0 ? QueueCapacity : 1;
+    for (uint32_t i = 0; i < capacity; ++i) {
+        mFreeFrames.push_back(std::make_unique<Frame>());
+    }
+
+    mThread = std::thread(&FrameWriter::WriterMain, this);
+}
+
+FrameWriter::~FrameWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mQueueCondition.notify_one();
+    mThread.join();
+}
+
+bool FrameWriter::Submit(uint32_t FrameIndex,
+                         const uint32_t* Pixels,
+                         uint32_t Width,
+                         uint32_t Height,
+                         uint32_t Pitch) {
+    std::unique_ptr<Frame> frame;
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        ++mStats.Submitted;
+        if (mFreeFrames.empty()) {
+            if (mPolicy == FrameQueuePolicy::Drop) {
+                ++mStats.Dropped;
+                return false;
+            }
+            mSpaceCondition.wait(lock, [this] { return !mFreeFrames.empty(); });
+        }
+        frame = std::move(mFreeFrames.back());
+        mFreeFrames.pop_back();
+    }
+
+    // Copy outside the lock; buffers keep their capacity between frames.
+    frame->Index = FrameIndex;
+    frame->Width = Width;
+    frame->Height = Height;
+    frame->Pixels.resize(static_cast<size_t>(Width) * Height);
+    for (uint32_t y = 0; y < Height; ++y) {
+        const uint32_t* src = Pixels + static_cast<size_t>(y) * Pitch;
+        std::copy(src, src + Width, frame->Pixels.begin() + static_cast<size_t>(y) * Width);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQueue.push_back(std::move(frame));
+    }
+    mQueueCondition.notify_one();
+    return true;
+}
+
+void FrameWriter::Flush() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mSpaceCondition.wait(lock, [this] { return mQueue.empty() && !mWriting; });
+}
+
+FrameWriterStats FrameWriter::GetStats() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+void FrameWriter::WriterMain() {
+    PROFILE_THREAD("Frame writer");
+    std::vector<uint8_t> encoded;
+    for (;;) {
+        std::unique_ptr<Frame> frame;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mQueueCondition.wait(lock, [this] { return mStopping || !mQueue.empty(); });
+            if (mQueue.empty()) {
+                return; // Stopping, and everything has been drained
+            }
+            frame = std::move(mQueue.front());
+            mQueue.pop_front();
+            mWriting = true;
+        }
+
+        bool written = WriteFrame(*frame, encoded);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (written) {
+                ++mStats.Written;
+            } else {
+                ++mStats.Failed;
+            }
+            mFreeFrames.push_back(std::move(frame));
+            mWriting = false;
+        }
+        mSpaceCondition.notify_all();
+    }
+}
+
+bool FrameWriter::WriteFrame(const Frame& Frame, std::vector<uint8_t>& Encoded) {
+    Clock::time_point encodeStart = Clock::now();
+    if (mFormat == FrameFormat::Png) {
+        EncodePng(Frame.Pixels.data(), Frame.Width, Frame.Height, Frame.Width, Encoded);
+    } else {
+        EncodePpm(Frame.Pixels.data(), Frame.Width, Frame.Height, Frame.Width, Encoded);
+    }
+    double encodeMs = MillisecondsSince(encodeStart);
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "_%06u.%s", Frame.Index,
+                  mFormat == FrameFormat::Png ? "png" : "ppm");
+
+    Clock::time_point writeStart = Clock::now();
+    std::ofstream file(mDirectory / (mPrefix + name), std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(Encoded.data()),
+               static_cast<std::streamsize>(Encoded.size()));
+    bool ok = static_cast<bool>(file);
+    file.close();
+    double writeMs = MillisecondsSince(writeStart);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.EncodeMs += encodeMs;
+    mStats.WriteMs += writeMs;
+    if (ok) {
+        mStats.BytesWritten += Encoded.size();
+    }
+    return ok;
+}
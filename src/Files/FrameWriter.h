@@ -0,0 +1,86 @@
+﻿// src/Files/FrameWriter.h
+// Streams rendered frames to numbered image files from a background thread.
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class FrameFormat { Ppm, Png };
+
+// What Submit does when the queue is full.
+enum class FrameQueuePolicy {
+    Drop,  // Skip the frame; the render loop never waits on the disk
+    Block, // Wait for a free slot; every frame is written
+};
+
+struct FrameWriterStats {
+    uint64_t Submitted = 0;
+    uint64_t Written = 0;
+    uint64_t Dropped = 0;
+    uint64_t Failed = 0;
+    uint64_t BytesWritten = 0;
+    double EncodeMs = 0.0;
+    double WriteMs = 0.0;
+};
+
+class FrameWriter {
+  public:
+    // Frames go to Directory/<Prefix>_<index>.<ext>. The directory is created if missing.
+    FrameWriter(std::filesystem::path Directory,
+                std::string Prefix,
+                FrameFormat Format,
+                uint32_t QueueCapacity,
+                FrameQueuePolicy Policy);
+    // Writes everything still queued before returning.
+    ~FrameWriter();
+
+    FrameWriter(const FrameWriter&) = delete;
+    FrameWriter& operator=(const FrameWriter&) = delete;
+
+    // Copies the frame into a pooled buffer and queues it for encoding.
+    // Returns false when the frame was dropped.
+    bool Submit(uint32_t FrameIndex,
+                const uint32_t* Pixels,
+                uint32_t Width,
+                uint32_t Height,
+                uint32_t Pitch);
+
+    // Blocks until every queued frame has been written.
+    void Flush();
+
+    FrameWriterStats GetStats() const;
+
+  private:
+    struct Frame {
+        uint32_t Index = 0;
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        std::vector<uint32_t> Pixels; // Tightly packed rows
+    };
+
+    void WriterMain();
+    bool WriteFrame(const Frame& Frame, std::vector<uint8_t>& Encoded);
+
+    std::filesystem::path mDirectory;
+    std::string mPrefix;
+    FrameFormat mFormat;
+    FrameQueuePolicy mPolicy;
+
+    mutable std::mutex mMutex;
+    std::condition_variable mQueueCondition; // Signals the writer: work queued or stopping
+    std::condition_variable mSpaceCondition; // Signals producers: a buffer was recycled
+    std::deque<std::unique_ptr<Frame>> mQueue;
+    std::vector<std::unique_ptr<Frame>> mFreeFrames;
+    bool mWriting = false;
+    bool mStopping = false;
+
+    FrameWriterStats mStats;
+    std::thread mThread;
+};
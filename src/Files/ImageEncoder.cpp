@@ -0,0 +1,143 @@
+﻿// src/Files/ImageEncoder.cpp
+#include "ImageEncoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+std::array<uint32_t, 256> MakeCrcTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t n = 0; n < 256; ++n) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[n] = c;
+    }
+    return table;
+}
+
+uint32_t Crc32(const uint8_t* Data, size_t Size, uint32_t Crc = 0) {
+    static const std::array<uint32_t, 256> table = MakeCrcTable();
+    Crc = ~Crc;
+    for (size_t i = 0; i < Size; ++i) {
+        Crc = table[(Crc ^ Data[i]) & 0xFF] ^ (Crc >> 8);
+    }
+    return ~Crc;
+}
+
+uint32_t Adler32(const uint8_t* Data, size_t Size) {
+    // 5552 is the largest block that cannot overflow the 32-bit sums before the modulo.
+    uint32_t a = 1;
+    uint32_t b = 0;
+    while (Size > 0) {
+        size_t block = std::min<size_t>(Size, 5552);
+        Size -= block;
+        while (block-- > 0) {
+            a += *Data++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+void PutBigEndian32(std::vector<uint8_t>& Out, uint32_t Value) {
+    Out.push_back(static_cast<uint8_t>(Value >> 24));
+    Out.push_back(static_cast<uint8_t>(Value >> 16));
+    Out.push_back(static_cast<uint8_t>(Value >> 8));
+    Out.push_back(static_cast<uint8_t>(Value));
+}
+
+void PutPngChunk(std::vector<uint8_t>& Out, const char* Type, const uint8_t* Data, size_t Size) {
+    PutBigEndian32(Out, static_cast<uint32_t>(Size));
+    size_t typeOffset = Out.size();
+    Out.insert(Out.end(), Type, Type + 4);
+    Out.insert(Out.end(), Data, Data + Size);
+    PutBigEndian32(Out, Crc32(Out.data() + typeOffset, Size + 4));
+}
+
+} // anonymous namespace
+
+void EncodePpm(const uint32_t* Pixels,
+               uint32_t Width,
+               uint32_t Height,
+               uint32_t Pitch,
+               std::vector<uint8_t>& Out) {
+    char header[64];
+    int headerSize = std::snprintf(header, sizeof(header), "P6\n%u %u\n255\n", Width, Height);
+
+    Out.resize(static_cast<size_t>(headerSize) + static_cast<size_t>(Width) * Height * 3);
+    std::memcpy(Out.data(), header, headerSize);
+
+    uint8_t* dst = Out.data() + headerSize;
+    for (uint32_t y = 0; y < Height; ++y) {
+        const uint32_t* row = Pixels + static_cast<size_t>(y) * Pitch;
+        for (uint32_t x = 0; x < Width; ++x) {
+            uint32_t p = row[x];
+            *dst++ = static_cast<uint8_t>(p >> 16);
+            *dst++ = static_cast<uint8_t>(p >> 8);
+            *dst++ = static_cast<uint8_t>(p);
+        }
+    }
+}
+
+void EncodePng(const uint32_t* Pixels,
+               uint32_t Width,
+               uint32_t Height,
+               uint32_t Pitch,
+               std::vector<uint8_t>& Out) {
+    // Raw scanlines: a filter byte (0 = None) followed by RGB triples.
+    const size_t rowSize = static_cast<size_t>(Width) * 3 + 1;
+    std::vector<uint8_t> raw(rowSize * Height);
+    for (uint32_t y = 0; y < Height; ++y) {
+        const uint32_t* row = Pixels + static_cast<size_t>(y) * Pitch;
+        uint8_t* dst = raw.data() + rowSize * y;
+        *dst++ = 0;
+        for (uint32_t x = 0; x < Width; ++x) {
+            uint32_t p = row[x];
+            *dst++ = static_cast<uint8_t>(p >> 16);
+            *dst++ = static_cast<uint8_t>(p >> 8);
+            *dst++ = static_cast<uint8_t>(p);
+        }
+    }
+
+    // zlib stream made of stored deflate blocks of at most 65535 bytes each.
+    constexpr size_t MAX_STORED_BLOCK = 65535;
+    std::vector<uint8_t> zlib;
+    zlib.reserve(raw.size() + raw.size() / MAX_STORED_BLOCK * 5 + 16);
+    zlib.push_back(0x78);
+    zlib.push_back(0x01);
+    size_t offset = 0;
+    do {
+        size_t block = std::min(raw.size() - offset, MAX_STORED_BLOCK);
+        bool last = offset + block == raw.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back(static_cast<uint8_t>(block));
+        zlib.push_back(static_cast<uint8_t>(block >> 8));
+        zlib.push_back(static_cast<uint8_t>(~block));
+        zlib.push_back(static_cast<uint8_t>(~block >> 8));
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + block);
+        offset += block;
+    } while (offset < raw.size());
+    PutBigEndian32(zlib, Adler32(raw.data(), raw.size()));
+
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    Out.assign(signature, signature + sizeof(signature));
+
+    std::vector<uint8_t> ihdr;
+    PutBigEndian32(ihdr, Width);
+    PutBigEndian32(ihdr, Height);
+    ihdr.push_back(8); // Bit depth
+    ihdr.push_back(2); // Color type: RGB
+    ihdr.push_back(0); // Compression: deflate
+    ihdr.push_back(0); // Filter method
+    ihdr.push_back(0); // No interlace
+    PutPngChunk(Out, "IHDR", ihdr.data(), ihdr.size());
+    PutPngChunk(Out, "IDAT", zlib.data(), zlib.size());
+    PutPngChunk(Out, "IEND", nullptr, 0);
+}
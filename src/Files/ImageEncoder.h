@@ -0,0 +1,21 @@
+﻿// src/Files/ImageEncoder.h
+// Encoders for 32-bit BGRA frames into simple on-disk image formats.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Encodes 0xAARRGGBB pixels as a binary PPM (P6). Pitch is the row stride in pixels.
+void EncodePpm(const uint32_t* Pixels,
+               uint32_t Width,
+               uint32_t Height,
+               uint32_t Pitch,
+               std::vector<uint8_t>& Out);
+
+// Encodes 0xAARRGGBB pixels as an 8-bit RGB PNG. The deflate stream uses stored blocks only:
+// files are large but encoding is a plain copy, which keeps the writer thread I/O bound.
+void EncodePng(const uint32_t* Pixels,
+               uint32_t Width,
+               uint32_t Height,
+               uint32_t Pitch,
+               std::vector<uint8_t>& Out);
@@ -0,0 +1,130 @@
+﻿// src/Files/MappedFile.cpp
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() = default;
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& Other) noexcept
+    : mData(std::exchange(Other.mData, nullptr)), mSize(std::exchange(Other.mSize, 0)),
+      mIsOpen(std::exchange(Other.mIsOpen, false)) {
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& Other) noexcept {
+    if (this != &Other) {
+        Close();
+        mData = std::exchange(Other.mData, nullptr);
+        mSize = std::exchange(Other.mSize, 0);
+        mIsOpen = std::exchange(Other.mIsOpen, false);
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::filesystem::path& Path) {
+    Close();
+
+    HANDLE file = CreateFileW(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size) || static_cast<uint64_t>(size.QuadPart) > SIZE_MAX) {
+        CloseHandle(file);
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        mIsOpen = true;
+        return true;
+    }
+
+    // The view keeps the mapping object and the file alive, so both handles can go right away.
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr) {
+        return false;
+    }
+
+    mData = static_cast<const uint8_t*>(view);
+    mSize = static_cast<size_t>(size.QuadPart);
+    mIsOpen = true;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (mData != nullptr) {
+        UnmapViewOfFile(mData);
+    }
+    mData = nullptr;
+    mSize = 0;
+    mIsOpen = false;
+}
+
+#else
+
+bool MappedFile::Open(const std::filesystem::path& Path) {
+    Close();
+
+    int file = open(Path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        return false;
+    }
+
+    struct stat info {};
+    if (fstat(file, &info) != 0 || !S_ISREG(info.st_mode)) {
+        close(file);
+        return false;
+    }
+    if (info.st_size == 0) {
+        close(file);
+        mIsOpen = true;
+        return true;
+    }
+
+    const size_t size = static_cast<size_t>(info.st_size);
+    void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file); // The mapping holds its own reference to the file
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    // Readers usually touch every page, often from several threads at once.
+    madvise(view, size, MADV_WILLNEED);
+
+    mData = static_cast<const uint8_t*>(view);
+    mSize = size;
+    mIsOpen = true;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (mData != nullptr) {
+        munmap(const_cast<uint8_t*>(mData), mSize);
+    }
+    mData = nullptr;
+    mSize = 0;
+    mIsOpen = false;
+}
+
+#endif
@@ -0,0 +1,39 @@
+﻿// src/Files/MappedFile.h
+// Read-only memory mapping of a whole file. Parsers read straight from the mapped pages instead
+// of copying the file into a buffer first.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+class MappedFile {
+  public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& Other) noexcept;
+    MappedFile& operator=(MappedFile&& Other) noexcept;
+
+    // Maps Path for reading, closing any previous mapping first. An empty file opens with a null
+    // data pointer and a size of zero. Returns false if the file cannot be opened or mapped.
+    bool Open(const std::filesystem::path& Path);
+    void Close();
+
+    bool IsOpen() const {
+        return mIsOpen;
+    }
+    const uint8_t* GetData() const {
+        return mData;
+    }
+    size_t GetSize() const {
+        return mSize;
+    }
+
+  private:
+    const uint8_t* mData = nullptr;
+    size_t mSize = 0;
+    bool mIsOpen = false;
+};
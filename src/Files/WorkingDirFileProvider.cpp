@@ -1,33 +1,108 @@
 ﻿// src/Files/WorkingDirFileProvider.cpp
 // Created by dtcimbal on 2/06/2025.
 #include "WorkingDirFileProvider.h"
-#include <windows.h>
 #include <filesystem>
 
-#include "Common/Debug.h"
+#include "Common/Log.h"
 
-FileIterator WorkingDirFileProvider::begin() {
-    try {
-        // Construct a FileIterator from a std::filesystem::directory_iterator
-        return FileIterator(std::filesystem::directory_iterator(mDirectoryPath));
-    } catch (const std::filesystem::filesystem_error& e) {
+WorkingDirFileProvider::WorkingDirFileProvider(ThreadPool* pool, DirectoryScanSettings settings)
+    : BaseFileProvider(std::filesystem::current_path()), mPool(pool),
+      mSettings(std::move(settings)) {
+    mDisplayName = mDirectoryPath.filename().empty() ? mDirectoryPath.root_path().native()
+                                                     : mDirectoryPath.filename().native();
+    // Watching starts before the first scan, so nothing changing in between is missed.
+    mWatcher = std::make_unique<DirectoryWatcher>(mDirectoryPath, mSettings.ExcludedDirectories);
+}
+
+bool WorkingDirFileProvider::Rescan() {
+    mScanned = true;
+    if (!mScan.Scan(mDirectoryPath, mSettings, mPool)) {
         // Handle cases where directory cannot be opened (e.g., permissions)
-        DEBUGPRINT(L"Filesystem error in WorkingDirFileProvider::begin: %s.\n",
-                   std::filesystem::path(e.what()).wstring().c_str());
-        // Return an end sentinel
-        return FileIterator();
+        LOG_ERROR(Files, "WorkingDirFileProvider: cannot read %s", mDirectoryPath.c_str());
+        return false;
+    }
+
+    const DirectoryScanStats stats = mScan.GetStats();
+    LOG_INFO(Files,
+             "Scanned %s in %.1f ms: %u files, %u directories, %u levels, %u filtered out, "
+             "%u unreadable, %zu name bytes",
+             mDirectoryPath.c_str(), stats.ScanMs, stats.FileCount, stats.DirectoryCount,
+             stats.LevelCount, stats.FilteredCount, stats.ErrorCount, stats.NameBytes);
+    return true;
+}
+
+FileIterator WorkingDirFileProvider::begin() {
+    if (!mScanned) {
+        Rescan();
     }
+    return FileIterator(mScan, 0);
 }
 
 FileIterator WorkingDirFileProvider::end() {
-    return FileIterator(std::filesystem::directory_iterator());
+    return FileIterator(mScan, static_cast<uint32_t>(mScan.GetEntries().size()));
 }
 
 FileEntry WorkingDirFileProvider::getCurrentDirectory() const {
     // Construct a FileEntry from the directory path's display name
-    FileEntry entry;
-    entry.name = mDirectoryPath.filename().empty() ? mDirectoryPath.root_path().wstring() +
-                                                         mDirectoryPath.root_directory().wstring()
-                                                   : mDirectoryPath.filename().wstring();
+    FileEntry entry{};
+    entry.Name = mDisplayName.c_str();
+    entry.Parent = INVALID_FILE_INDEX;
+    entry.FirstChild = mScan.GetFirstTopLevel();
+    entry.NextSibling = INVALID_FILE_INDEX;
+    entry.ChildCount = mScan.GetTopLevelCount();
+    entry.Type = FileType::Directory;
     return entry;
 }
+
+const FileEntry& WorkingDirFileProvider::getEntry(uint32_t index) const {
+    return mScan.GetEntries()[index];
+}
+
+std::filesystem::path WorkingDirFileProvider::getEntryPath(uint32_t index) const {
+    return mScan.GetPath(index);
+}
+
+bool WorkingDirFileProvider::pollChanges(std::vector<FileDelta>& out) {
+    out.clear();
+    if (!mScanned || !mWatcher->Poll(mChanges)) {
+        return false;
+    }
+
+    for (const FileChange& change : mChanges) {
+        if (change.Type == FileChangeType::Overflow) {
+            LOG_WARNING(Files, "Lost track of changes below %s, reading it again",
+                        mDirectoryPath.c_str());
+            Rescan();
+            out.assign(1, {FileChangeType::Overflow, INVALID_FILE_INDEX});
+            return true;
+        }
+
+        const uint32_t index = mScan.Find(change.Path);
+        if (change.Type == FileChangeType::Removed) {
+            if (index != INVALID_FILE_INDEX) {
+                mScan.Remove(index);
+                out.push_back({FileChangeType::Removed, index});
+            }
+            continue;
+        }
+        if (index == INVALID_FILE_INDEX) {
+            // Also lists whatever a new directory already holds.
+            const uint32_t first = mScan.Add(change.Path);
+            if (first == INVALID_FILE_INDEX) {
+                continue; // Filtered out, or gone again
+            }
+            const uint32_t end = static_cast<uint32_t>(mScan.GetEntries().size());
+            for (uint32_t added = first; added < end; ++added) {
+                out.push_back({FileChangeType::Added, added});
+            }
+        } else if (mScan.GetEntries()[index].Type != FileType::Directory &&
+                   mScan.Refresh(index)) {
+            out.push_back({FileChangeType::Modified, index});
+        }
+    }
+    return !out.empty();
+}
+
+void WorkingDirFileProvider::setChangeListener(std::function<void()> listener) {
+    mWatcher->SetListener(std::move(listener));
+}
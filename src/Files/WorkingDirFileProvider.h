@@ -3,17 +3,42 @@
 #pragma once
 
 #include <filesystem>
+#include <memory>
 #include "BaseFileProvider.h"
 
-// Provides access to files within the current working directory, supporting range-based for loops.
+class ThreadPool;
+
+// Provides the files below the current working directory, recursively, supporting range-based
+// for loops. The tree is read once, on the first begin() or an explicit Rescan(), and then kept
+// up to date entry by entry from a DirectoryWatcher through pollChanges().
 class WorkingDirFileProvider : public BaseFileProvider {
   public:
-    // Constructor now calls the base class constructor with std::filesystem::current_path()
-    WorkingDirFileProvider() : BaseFileProvider(std::filesystem::current_path()) {
-    }
+    // Pool, if given, reads directories in parallel and must outlive the provider.
+    explicit WorkingDirFileProvider(ThreadPool* pool = nullptr,
+                                    DirectoryScanSettings settings = {});
     ~WorkingDirFileProvider() = default;
 
     FileIterator begin() override;
     FileIterator end() override;
     FileEntry getCurrentDirectory() const override;
+    const FileEntry& getEntry(uint32_t index) const override;
+    std::filesystem::path getEntryPath(uint32_t index) const override;
+    bool pollChanges(std::vector<FileDelta>& out) override;
+    void setChangeListener(std::function<void()> listener) override;
+
+    // Reads the directory tree again. Returns false if the working directory cannot be read.
+    bool Rescan();
+
+    const DirectoryScan& getScan() const {
+        return mScan;
+    }
+
+  private:
+    ThreadPool* mPool;
+    DirectoryScanSettings mSettings;
+    DirectoryScan mScan;
+    bool mScanned = false;
+    std::unique_ptr<DirectoryWatcher> mWatcher;
+    std::vector<FileChange> mChanges; // Reused by pollChanges
+    std::filesystem::path::string_type mDisplayName; // Backs getCurrentDirectory's name
 };
@@ -0,0 +1,104 @@
+﻿// src/Graphics/DescriptorAllocator.cpp
+#include "DescriptorAllocator.h"
+
+#include <algorithm>
+
+DescriptorAllocator::DescriptorAllocator(uint32_t PersistentCount, uint32_t TransientCount)
+    : mSlots(PersistentCount), mTransientBase(PersistentCount), mTransientCount(TransientCount) {
+    // Lowest indices first, which keeps a lightly used heap compact.
+    mFreeList.reserve(PersistentCount);
+    for (uint32_t i = PersistentCount; i > 0; --i) {
+        mFreeList.push_back(i - 1);
+    }
+    mStats.PersistentCapacity = PersistentCount;
+    mStats.TransientCapacity = TransientCount;
+}
+
+bool DescriptorAllocator::Allocate(DescriptorHandle& OutHandle) {
+    if (mFreeList.empty()) {
+        ++mStats.FullCount;
+        return false;
+    }
+    const uint32_t index = mFreeList.back();
+    mFreeList.pop_back();
+    mSlots[index].Live = true;
+
+    ++mStats.PersistentUsed;
+    mStats.PersistentPeak = std::max(mStats.PersistentPeak, mStats.PersistentUsed);
+
+    OutHandle.Index = index;
+    OutHandle.Generation = mSlots[index].Generation;
+    return true;
+}
+
+bool DescriptorAllocator::Free(DescriptorHandle Handle) {
+    if (!IsLive(Handle)) {
+        ++mStats.StaleCount;
+        return false;
+    }
+    Slot& slot = mSlots[Handle.Index];
+    slot.Live = false;
+    ++slot.Generation;
+    mPendingFrees.push_back({Handle.Index, 0});
+    ++mUntaggedFrees;
+    return true;
+}
+
+uint32_t DescriptorAllocator::Resolve(DescriptorHandle Handle) {
+    if (!IsLive(Handle)) {
+        ++mStats.StaleCount;
+        return ~0u;
+    }
+    return Handle.Index;
+}
+
+bool DescriptorAllocator::IsLive(DescriptorHandle Handle) const {
+    return Handle.Index < mSlots.size() && mSlots[Handle.Index].Live &&
+           mSlots[Handle.Index].Generation == Handle.Generation;
+}
+
+bool DescriptorAllocator::AllocateTransient(uint32_t Count, uint32_t& OutFirstIndex) {
+    const uint64_t position = mHead % std::max(mTransientCount, 1u);
+    uint64_t head = mHead;
+    uint64_t start = position;
+    if (position + Count > mTransientCount) {
+        // Tables must be contiguous: skip to the start of the ring.
+        head += mTransientCount - position;
+        start = 0;
+    }
+    if (head + Count - mTail > mTransientCount) {
+        ++mStats.FullCount;
+        return false;
+    }
+
+    mHead = head + Count;
+    mStats.TransientUsed = static_cast<uint32_t>(mHead - mTail);
+    mStats.TransientPeak = std::max(mStats.TransientPeak, mStats.TransientUsed);
+    OutFirstIndex = mTransientBase + static_cast<uint32_t>(start);
+    return true;
+}
+
+void DescriptorAllocator::EndFrame(uint64_t FenceValue) {
+    mRetiredFrames.push_back({FenceValue, mHead});
+    for (size_t i = mPendingFrees.size() - mUntaggedFrees; i < mPendingFrees.size(); ++i) {
+        mPendingFrees[i].FenceValue = FenceValue;
+    }
+    mUntaggedFrees = 0;
+}
+
+void DescriptorAllocator::Reclaim(uint64_t CompletedFenceValue) {
+    while (!mRetiredFrames.empty() && mRetiredFrames.front().FenceValue <= CompletedFenceValue) {
+        mTail = mRetiredFrames.front().Head;
+        mRetiredFrames.pop_front();
+    }
+    mStats.TransientUsed = static_cast<uint32_t>(mHead - mTail);
+
+    const size_t tagged = mPendingFrees.size() - mUntaggedFrees;
+    size_t completed = 0;
+    while (completed < tagged && mPendingFrees.front().FenceValue <= CompletedFenceValue) {
+        mFreeList.push_back(mPendingFrees.front().Index);
+        mPendingFrees.pop_front();
+        --mStats.PersistentUsed;
+        ++completed;
+    }
+}
@@ -0,0 +1,97 @@
+﻿// src/Graphics/DescriptorAllocator.h
+// Hands out slots of one descriptor heap. The front of the heap holds long-lived views, allocated
+// and freed one at a time; the back is a ring of per-frame tables reclaimed in bulk by fence.
+// Only indices are managed here, so the owner maps them to CPU/GPU descriptor handles.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Names a persistent slot. The generation changes every time the slot is freed, so a handle
+// kept past its Free is recognised as stale instead of silently naming a new descriptor.
+struct DescriptorHandle {
+    uint32_t Index = ~0u;
+    uint32_t Generation = 0;
+
+    bool IsNull() const {
+        return Index == ~0u;
+    }
+};
+
+struct DescriptorAllocatorStats {
+    uint32_t PersistentCapacity = 0;
+    uint32_t PersistentUsed = 0; // Allocated, or freed with a fence not yet completed
+    uint32_t PersistentPeak = 0;
+    uint32_t TransientCapacity = 0;
+    uint32_t TransientUsed = 0; // Ring slots not yet reclaimed, wrap padding included
+    uint32_t TransientPeak = 0;
+    uint32_t StaleCount = 0; // Frees and lookups of handles that were already freed
+    uint32_t FullCount = 0;  // Allocations refused because a region was full
+};
+
+// Not thread-safe: the owner serialises allocation, as it does command recording.
+class DescriptorAllocator {
+  public:
+    // Slots [0, PersistentCount) are persistent, the next TransientCount form the ring.
+    DescriptorAllocator(uint32_t PersistentCount, uint32_t TransientCount);
+
+    DescriptorAllocator(const DescriptorAllocator&) = delete;
+    DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+    // O(1). Returns false when every persistent slot is taken.
+    bool Allocate(DescriptorHandle& OutHandle);
+    // The handle goes stale right away, but its slot is reused only once the frame being
+    // recorded has completed, since the GPU may still read the descriptor. Returns false for a
+    // stale or null handle.
+    bool Free(DescriptorHandle Handle);
+    // Heap index of a live handle, or ~0u for a stale one.
+    uint32_t Resolve(DescriptorHandle Handle);
+    bool IsLive(DescriptorHandle Handle) const;
+
+    // Count contiguous slots valid until the current frame's fence completes, for a descriptor
+    // table. OutFirstIndex is a heap index. Returns false when the ring has no room until an
+    // older frame is reclaimed.
+    bool AllocateTransient(uint32_t Count, uint32_t& OutFirstIndex);
+
+    // Tags the transient tables and frees since the last call with FenceValue. Values must
+    // increase.
+    void EndFrame(uint64_t FenceValue);
+    // Recycles everything tagged with a fence value at most CompletedFenceValue.
+    void Reclaim(uint64_t CompletedFenceValue);
+
+    const DescriptorAllocatorStats& GetStats() const {
+        return mStats;
+    }
+
+  private:
+    struct Slot {
+        uint32_t Generation = 0;
+        bool Live = false;
+    };
+
+    struct PendingFree {
+        uint32_t Index;
+        uint64_t FenceValue;
+    };
+
+    struct RetiredFrame {
+        uint64_t FenceValue;
+        uint64_t Head; // Transient head when the frame ended
+    };
+
+    std::vector<Slot> mSlots;
+    std::vector<uint32_t> mFreeList; // Persistent slots ready for reuse, popped from the back
+    std::deque<PendingFree> mPendingFrees;
+    size_t mUntaggedFrees = 0; // Trailing pending frees made since the last EndFrame
+
+    uint32_t mTransientBase;
+    uint32_t mTransientCount;
+    // Slot counts since creation; the ring position is the count modulo mTransientCount.
+    uint64_t mHead = 0;
+    uint64_t mTail = 0;
+    std::deque<RetiredFrame> mRetiredFrames;
+
+    DescriptorAllocatorStats mStats;
+};
@@ -2,8 +2,69 @@
 // Created by dtcimbal on 27/07/2025.
 #include "Device.h"
 
-bool Device::CreateRenderer(std::unique_ptr<Renderer>& OutRenderer) {
-    // TODO handle device creation logic here
-    OutRenderer = std::make_unique<Renderer>();
-    return true;
+#include "Graphics/Software/SoftwareRenderer.h"
+
+namespace {
+
+// Software backend that copies each finished frame into the device's window.
+class PresentingSoftwareRenderer final : public SoftwareRenderer {
+  public:
+    explicit PresentingSoftwareRenderer(HWND hWnd) : mHwnd(hWnd) {
+    }
+    PresentingSoftwareRenderer(HWND hWnd, ThreadPool& Pool) : SoftwareRenderer(Pool), mHwnd(hWnd) {
+    }
+
+    bool Draw(Camera& Camera) override {
+        if (!SoftwareRenderer::Draw(Camera)) {
+            return false;
+        }
+        return Present();
+    }
+
+  private:
+    bool Present() {
+        const RasterTarget& target = GetTarget();
+
+        BITMAPINFO bmi{};
+        bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bmi.bmiHeader.biWidth = static_cast<LONG>(target.GetPitch());
+        bmi.bmiHeader.biHeight = -static_cast<LONG>(target.GetHeight()); // Top-down rows
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+
+        HDC hdc = GetDC(mHwnd);
+        if (hdc == nullptr) {
+            return false;
+        }
+        const int width = static_cast<int>(target.GetWidth());
+        const int height = static_cast<int>(target.GetHeight());
+        int lines = StretchDIBits(hdc, 0, 0, width, height, 0, 0, width, height,
+                                  target.GetColor(), &bmi, DIB_RGB_COLORS, SRCCOPY);
+        ReleaseDC(mHwnd, hdc);
+        return lines != 0;
+    }
+
+    HWND mHwnd;
+};
+
+} // anonymous namespace
+
+bool Device::CreateRenderer(std::unique_ptr<Renderer>& OutRenderer,
+                            RendererBackend Backend,
+                            ThreadPool* Pool) {
+    switch (Backend) {
+    case RendererBackend::Software:
+        if (Pool != nullptr) {
+            OutRenderer = std::make_unique<PresentingSoftwareRenderer>(mHwnd, *Pool);
+        } else {
+            OutRenderer = std::make_unique<PresentingSoftwareRenderer>(mHwnd);
+        }
+        return true;
+    case RendererBackend::Null:
+        // TODO handle device creation logic here
+        OutRenderer = std::make_unique<Renderer>();
+        return true;
+    }
+    return false;
 }
@@ -6,13 +6,24 @@
 
 #include "Renderer.h"
 
+class ThreadPool;
+
+// Rendering backends Device::CreateRenderer can produce.
+enum class RendererBackend {
+    Null,     // The base Renderer; draws nothing
+    Software, // Multithreaded CPU rasterizer, presented to the window with GDI
+};
+
 class Device {
 
   public:
     Device(HWND hWnd) : mHwnd(hWnd) {};
     ~Device() = default;
 
-    bool CreateRenderer(std::unique_ptr<Renderer>& OutRenderer);
+    // The software backend draws on Pool if given, else on a pool of its own.
+    bool CreateRenderer(std::unique_ptr<Renderer>& OutRenderer,
+                        RendererBackend Backend = RendererBackend::Software,
+                        ThreadPool* Pool = nullptr);
 
   private:
     HWND mHwnd;
@@ -0,0 +1,130 @@
+﻿// src/Graphics/FramePipeline.cpp
+#include "FramePipeline.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "Common/Profiler.h"
+#include "Common/ThreadPool.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double MillisecondsSince(Clock::time_point Start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+}
+
+} // anonymous namespace
+
+FramePipeline::FramePipeline(FrameRenderFunction Render,
+                             uint32_t SnapshotCount,
+                             ThreadPool* RenderPool)
+    : mRender(std::move(Render)), mSnapshotCount(SnapshotCount > 0 ? SnapshotCount : 1),
+      mRenderPool(RenderPool) {
+    // The pool is the bound: a snapshot is either free, being filled, queued or being drawn.
+    for (uint32_t i = 0; i < mSnapshotCount; ++i) {
+        mFree.push_back(std::make_unique<FrameSnapshot>());
+    }
+    if (mSnapshotCount > 1) {
+        mThread = std::thread(&FramePipeline::RenderMain, this);
+    }
+}
+
+FramePipeline::~FramePipeline() {
+    if (!mThread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mQueueCondition.notify_one();
+    mThread.join();
+}
+
+FrameSnapshot& FramePipeline::BeginFrame() {
+    if (mFilling == nullptr) {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mFree.empty()) {
+            const Clock::time_point waitStart = Clock::now();
+            mFreeCondition.wait(lock, [this] { return !mFree.empty(); });
+            mStats.UpdateWaitMs += MillisecondsSince(waitStart);
+        }
+        mFilling = std::move(mFree.back());
+        mFree.pop_back();
+    }
+    // Also drops the previous frame's references to mesh data.
+    mFilling->Reset();
+    return *mFilling;
+}
+
+void FramePipeline::SubmitFrame() {
+    if (mFilling == nullptr) {
+        return;
+    }
+    const size_t arenaBytes =
+        mFilling->Arena.GetStats().UsedBytes + mFilling->WorkerArenas.GetStats().UsedBytes;
+    if (!mThread.joinable()) {
+        const bool rendered = mRender(*mFilling);
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++mStats.Submitted;
+        mStats.SnapshotBytes = arenaBytes;
+        mStats.SnapshotPeakBytes = std::max(mStats.SnapshotPeakBytes, arenaBytes);
+        ++(rendered ? mStats.Rendered : mStats.Failed);
+        mFree.push_back(std::move(mFilling));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++mStats.Submitted;
+        mStats.SnapshotBytes = arenaBytes;
+        mStats.SnapshotPeakBytes = std::max(mStats.SnapshotPeakBytes, arenaBytes);
+        mQueue.push_back(std::move(mFilling));
+    }
+    mQueueCondition.notify_one();
+}
+
+void FramePipeline::Flush() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mFreeCondition.wait(lock, [this] { return mQueue.empty() && !mRendering; });
+}
+
+FramePipelineStats FramePipeline::GetStats() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+void FramePipeline::RenderMain() {
+    PROFILE_THREAD("Render");
+    const bool attached = mRenderPool != nullptr && mRenderPool->Attach();
+    for (;;) {
+        std::unique_ptr<FrameSnapshot> snapshot;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            const Clock::time_point waitStart = Clock::now();
+            mQueueCondition.wait(lock, [this] { return mStopping || !mQueue.empty(); });
+            if (mQueue.empty()) {
+                break; // Stopping, and everything has been drawn
+            }
+            mStats.RenderWaitMs += MillisecondsSince(waitStart);
+            snapshot = std::move(mQueue.front());
+            mQueue.pop_front();
+            mRendering = true;
+        }
+
+        const bool rendered = mRender(*snapshot);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            ++(rendered ? mStats.Rendered : mStats.Failed);
+            mFree.push_back(std::move(snapshot));
+            mRendering = false;
+        }
+        mFreeCondition.notify_all();
+    }
+    if (attached) {
+        mRenderPool->Detach();
+    }
+}
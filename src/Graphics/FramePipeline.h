@@ -0,0 +1,79 @@
+﻿// src/Graphics/FramePipeline.h
+// Runs rendering on its own thread, one frame behind the update thread. The update thread fills
+// a FrameSnapshot and submits it; the render thread draws it while the next one is filled.
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Scene/FrameSnapshot.h"
+
+class ThreadPool;
+
+struct FramePipelineStats {
+    uint64_t Submitted = 0;
+    uint64_t Rendered = 0;
+    uint64_t Failed = 0;
+    double UpdateWaitMs = 0.0; // Update thread blocked on a free snapshot
+    double RenderWaitMs = 0.0; // Render thread idle, waiting for a snapshot
+    size_t SnapshotBytes = 0;     // Arena memory the last submitted frame used, all threads
+    size_t SnapshotPeakBytes = 0; // Most any frame used
+};
+
+// Draws one snapshot on the render thread. Returns false if the frame failed.
+using FrameRenderFunction = std::function<bool(const FrameSnapshot& Snapshot)>;
+
+class FramePipeline {
+  public:
+    // SnapshotCount 2 double-buffers (the update thread runs one frame ahead), 3 triple-buffers.
+    // 1 has no render thread: SubmitFrame renders on the calling thread. The render thread
+    // attaches to RenderPool, if given and it has a free attach slot, so it runs its share of
+    // the renderer's jobs instead of blocking on them.
+    FramePipeline(FrameRenderFunction Render,
+                  uint32_t SnapshotCount,
+                  ThreadPool* RenderPool = nullptr);
+    // Renders everything already submitted, then stops the render thread.
+    ~FramePipeline();
+
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+
+    // BeginFrame, SubmitFrame and Flush belong to the update thread.
+
+    // Returns an empty snapshot to fill, waiting while every snapshot is queued or being drawn.
+    FrameSnapshot& BeginFrame();
+    // Queues the snapshot from BeginFrame for the render thread.
+    void SubmitFrame();
+    // Blocks until every submitted frame has been drawn.
+    void Flush();
+
+    uint32_t GetSnapshotCount() const {
+        return mSnapshotCount;
+    }
+    FramePipelineStats GetStats() const;
+
+  private:
+    void RenderMain();
+
+    FrameRenderFunction mRender;
+    uint32_t mSnapshotCount = 0;
+    ThreadPool* mRenderPool = nullptr;
+    std::unique_ptr<FrameSnapshot> mFilling; // Between BeginFrame and SubmitFrame
+
+    mutable std::mutex mMutex;
+    std::condition_variable mQueueCondition; // Signals the render thread: frame queued or stopping
+    std::condition_variable mFreeCondition;  // Signals the update thread: a snapshot was drawn
+    std::deque<std::unique_ptr<FrameSnapshot>> mQueue;
+    std::vector<std::unique_ptr<FrameSnapshot>> mFree;
+    bool mRendering = false;
+    bool mStopping = false;
+
+    FramePipelineStats mStats;
+    std::thread mThread;
+};
@@ -0,0 +1,455 @@
+﻿// src/Graphics/RenderGraph.cpp
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace {
+
+uint64_t AlignUp(uint64_t Value, uint64_t Alignment) {
+    return (Value + Alignment - 1) / Alignment * Alignment;
+}
+
+} // anonymous namespace
+
+uint32_t GetRenderFormatBytes(RenderFormat Format) {
+    switch (Format) {
+    case RenderFormat::Raw8:
+        return 1;
+    case RenderFormat::Rgba8:
+    case RenderFormat::R32F:
+    case RenderFormat::Depth32F:
+        return 4;
+    case RenderFormat::Rgba16F:
+        return 8;
+    case RenderFormat::Rgba32F:
+        return 16;
+    }
+    return 0;
+}
+
+RenderHandle RenderPassBuilder::Create(const std::string& Name, const RenderResourceDesc& Desc) {
+    RenderGraph::Resource resource;
+    resource.Name = Name;
+    resource.Desc = Desc;
+    mGraph.mResources.push_back(std::move(resource));
+    return mGraph.AddVersion(static_cast<uint32_t>(mGraph.mResources.size() - 1),
+                             RenderGraph::NO_PASS);
+}
+
+void RenderPassBuilder::Read(RenderHandle Handle, RenderResourceState State) {
+    if (!mGraph.IsValidHandle(Handle)) {
+        mGraph.mValid = false;
+        return;
+    }
+    mGraph.mPasses[mPass].Accesses.push_back({Handle, INVALID_RENDER_HANDLE, State});
+}
+
+RenderHandle RenderPassBuilder::Write(RenderHandle Handle, RenderResourceState State) {
+    if (!mGraph.IsValidHandle(Handle) ||
+        mGraph.mVersions[Handle].NextVersion != INVALID_RENDER_HANDLE) {
+        // Two writes of one version would leave readers of the result ambiguous.
+        mGraph.mValid = false;
+        return INVALID_RENDER_HANDLE;
+    }
+    const RenderHandle written = mGraph.AddVersion(mGraph.mVersions[Handle].Resource, mPass);
+    mGraph.mVersions[Handle].NextVersion = written;
+    mGraph.mPasses[mPass].Accesses.push_back({Handle, written, State});
+    return written;
+}
+
+void RenderPassBuilder::SetSideEffects() {
+    mGraph.mPasses[mPass].SideEffects = true;
+}
+
+void RenderGraph::Reset() {
+    mResources.clear();
+    mVersions.clear();
+    mPasses.clear();
+    mValid = true;
+    mOrder.clear();
+    mBarriers.clear();
+    mFinalBarriers.clear();
+    mStats = RenderGraphStats{};
+}
+
+RenderHandle RenderGraph::Import(const std::string& Name,
+                                 const RenderResourceDesc& Desc,
+                                 RenderResourceState Initial,
+                                 RenderResourceState Final) {
+    Resource resource;
+    resource.Name = Name;
+    resource.Desc = Desc;
+    resource.Imported = true;
+    resource.Initial = Initial;
+    resource.Final = Final;
+    mResources.push_back(std::move(resource));
+    return AddVersion(static_cast<uint32_t>(mResources.size() - 1), NO_PASS);
+}
+
+void RenderGraph::MarkOutput(RenderHandle Handle) {
+    if (!IsValidHandle(Handle)) {
+        mValid = false;
+        return;
+    }
+    mVersions[Handle].Output = true;
+}
+
+uint32_t RenderGraph::AddPass(const std::string& Name,
+                              const SetupFunction& Setup,
+                              ExecuteFunction Execute) {
+    Pass pass;
+    pass.Name = Name;
+    pass.Execute = std::move(Execute);
+    mPasses.push_back(std::move(pass));
+
+    const uint32_t index = static_cast<uint32_t>(mPasses.size() - 1);
+    RenderPassBuilder builder(*this, index);
+    if (Setup) {
+        Setup(builder);
+    }
+    return index;
+}
+
+bool RenderGraph::Compile() {
+    mOrder.clear();
+    mBarriers.clear();
+    mFinalBarriers.clear();
+    mStats = RenderGraphStats{};
+    mStats.PassCount = static_cast<uint32_t>(mPasses.size());
+    for (Resource& resource : mResources) {
+        resource.FirstUse = NO_PASS;
+        resource.LastUse = NO_PASS;
+        resource.HeapOffset = 0;
+        resource.AliasesEarlier = false;
+    }
+    for (Pass& pass : mPasses) {
+        pass.Live = false;
+        pass.FirstBarrier = 0;
+        pass.BarrierCount = 0;
+    }
+    if (!mValid) {
+        return false;
+    }
+
+    for (const Pass& pass : mPasses) {
+        for (size_t i = 0; i < pass.Accesses.size(); ++i) {
+            const Access& access = pass.Accesses[i];
+            const Version& version = mVersions[access.Handle];
+            if (access.WrittenTo == INVALID_RENDER_HANDLE && version.Writer == NO_PASS &&
+                !mResources[version.Resource].Imported) {
+                return false;
+            }
+            // One state per resource and pass; a backend cannot be in two at once.
+            for (size_t j = 0; j < i; ++j) {
+                const Access& other = pass.Accesses[j];
+                if (mVersions[other.Handle].Resource == version.Resource &&
+                    other.State != access.State) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    CullPasses();
+    if (!SortPasses()) {
+        return false;
+    }
+    PlaceResources();
+    ComputeBarriers();
+    mStats.CulledPassCount = mStats.PassCount - static_cast<uint32_t>(mOrder.size());
+    return true;
+}
+
+void RenderGraph::Execute(const BarrierFunction& OnBarrier) const {
+    for (uint32_t passIndex : mOrder) {
+        const Pass& pass = mPasses[passIndex];
+        if (OnBarrier) {
+            for (const RenderBarrier& barrier : GetPassBarriers(passIndex)) {
+                OnBarrier(barrier);
+            }
+        }
+        if (pass.Execute) {
+            pass.Execute(*this);
+        }
+    }
+    if (OnBarrier) {
+        for (const RenderBarrier& barrier : mFinalBarriers) {
+            OnBarrier(barrier);
+        }
+    }
+}
+
+bool RenderGraph::IsPassCulled(uint32_t Pass) const {
+    return !mPasses[Pass].Live;
+}
+
+const std::string& RenderGraph::GetPassName(uint32_t Pass) const {
+    return mPasses[Pass].Name;
+}
+
+Span<const RenderBarrier> RenderGraph::GetPassBarriers(uint32_t Pass) const {
+    const RenderGraph::Pass& pass = mPasses[Pass];
+    return Span<const RenderBarrier>(mBarriers.data() + pass.FirstBarrier, pass.BarrierCount);
+}
+
+uint32_t RenderGraph::GetResource(RenderHandle Handle) const {
+    return mVersions[Handle].Resource;
+}
+
+const std::string& RenderGraph::GetResourceName(uint32_t Resource) const {
+    return mResources[Resource].Name;
+}
+
+const RenderResourceDesc& RenderGraph::GetResourceDesc(uint32_t Resource) const {
+    return mResources[Resource].Desc;
+}
+
+bool RenderGraph::IsImported(uint32_t Resource) const {
+    return mResources[Resource].Imported;
+}
+
+uint64_t RenderGraph::GetHeapOffset(uint32_t Resource) const {
+    return mResources[Resource].HeapOffset;
+}
+
+RenderHandle RenderGraph::AddVersion(uint32_t Resource, uint32_t Writer) {
+    Version version;
+    version.Resource = Resource;
+    version.Writer = Writer;
+    mVersions.push_back(version);
+    return static_cast<RenderHandle>(mVersions.size() - 1);
+}
+
+void RenderGraph::CullPasses() {
+    // Walk back from what the frame must produce; whatever is not reached does wasted work.
+    std::vector<uint32_t> pending;
+    for (uint32_t i = 0; i < mPasses.size(); ++i) {
+        if (mPasses[i].SideEffects) {
+            mPasses[i].Live = true;
+            pending.push_back(i);
+        }
+    }
+    for (const Version& version : mVersions) {
+        if (version.Output && version.Writer != NO_PASS && !mPasses[version.Writer].Live) {
+            mPasses[version.Writer].Live = true;
+            pending.push_back(version.Writer);
+        }
+    }
+
+    while (!pending.empty()) {
+        const uint32_t passIndex = pending.back();
+        pending.pop_back();
+        // Reads need their producer, and writes keep what they do not overwrite.
+        for (const Access& access : mPasses[passIndex].Accesses) {
+            const uint32_t writer = mVersions[access.Handle].Writer;
+            if (writer != NO_PASS && !mPasses[writer].Live) {
+                mPasses[writer].Live = true;
+                pending.push_back(writer);
+            }
+        }
+    }
+}
+
+bool RenderGraph::SortPasses() {
+    // Edges: producer before consumer, and readers of a version before the pass overwriting it.
+    std::vector<std::vector<uint32_t>> readers(mVersions.size());
+    for (uint32_t i = 0; i < mPasses.size(); ++i) {
+        if (!mPasses[i].Live) {
+            continue;
+        }
+        for (const Access& access : mPasses[i].Accesses) {
+            if (access.WrittenTo == INVALID_RENDER_HANDLE) {
+                readers[access.Handle].push_back(i);
+            }
+        }
+    }
+
+    std::vector<std::vector<uint32_t>> successors(mPasses.size());
+    std::vector<uint32_t> inDegree(mPasses.size(), 0);
+    auto addEdge = [&](uint32_t From, uint32_t To) {
+        if (From != To) {
+            successors[From].push_back(To);
+            ++inDegree[To];
+        }
+    };
+    uint32_t liveCount = 0;
+    for (uint32_t i = 0; i < mPasses.size(); ++i) {
+        if (!mPasses[i].Live) {
+            continue;
+        }
+        ++liveCount;
+        for (const Access& access : mPasses[i].Accesses) {
+            const uint32_t writer = mVersions[access.Handle].Writer;
+            if (writer != NO_PASS) {
+                addEdge(writer, i);
+            }
+            if (access.WrittenTo != INVALID_RENDER_HANDLE) {
+                for (uint32_t reader : readers[access.Handle]) {
+                    addEdge(reader, i);
+                }
+            }
+        }
+    }
+
+    // Kahn's algorithm, taking the earliest declared pass among the ready ones so that
+    // independent passes keep the order they were added in.
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> ready;
+    for (uint32_t i = 0; i < mPasses.size(); ++i) {
+        if (mPasses[i].Live && inDegree[i] == 0) {
+            ready.push(i);
+        }
+    }
+    mOrder.reserve(liveCount);
+    while (!ready.empty()) {
+        const uint32_t passIndex = ready.top();
+        ready.pop();
+        mOrder.push_back(passIndex);
+        for (uint32_t next : successors[passIndex]) {
+            if (--inDegree[next] == 0) {
+                ready.push(next);
+            }
+        }
+    }
+    if (mOrder.size() != liveCount) {
+        mOrder.clear(); // A cycle
+        return false;
+    }
+    return true;
+}
+
+void RenderGraph::PlaceResources() {
+    for (uint32_t position = 0; position < mOrder.size(); ++position) {
+        for (const Access& access : mPasses[mOrder[position]].Accesses) {
+            Resource& resource = mResources[mVersions[access.Handle].Resource];
+            resource.FirstUse = std::min(resource.FirstUse, position);
+            resource.LastUse =
+                resource.LastUse == NO_PASS ? position : std::max(resource.LastUse, position);
+        }
+    }
+
+    std::vector<uint32_t> transients;
+    for (uint32_t i = 0; i < mResources.size(); ++i) {
+        const Resource& resource = mResources[i];
+        if (!resource.Imported && resource.FirstUse != NO_PASS) {
+            transients.push_back(i);
+            mStats.TransientBytes += AlignUp(resource.Desc.GetBytes(), RESOURCE_ALIGNMENT);
+        }
+    }
+    mStats.TransientCount = static_cast<uint32_t>(transients.size());
+
+    // Greedy first fit, biggest first: each resource takes the lowest offset that does not
+    // overlap a resource placed before it whose lifetime overlaps its own.
+    std::sort(transients.begin(), transients.end(), [this](uint32_t A, uint32_t B) {
+        const uint64_t sizeA = mResources[A].Desc.GetBytes();
+        const uint64_t sizeB = mResources[B].Desc.GetBytes();
+        if (sizeA != sizeB) {
+            return sizeA > sizeB;
+        }
+        return mResources[A].FirstUse < mResources[B].FirstUse;
+    });
+
+    auto livesOverlap = [](const Resource& A, const Resource& B) {
+        return A.FirstUse <= B.LastUse && B.FirstUse <= A.LastUse;
+    };
+    std::vector<std::pair<uint64_t, uint64_t>> taken; // [start, end) byte ranges
+    for (size_t i = 0; i < transients.size(); ++i) {
+        Resource& resource = mResources[transients[i]];
+        const uint64_t size = AlignUp(resource.Desc.GetBytes(), RESOURCE_ALIGNMENT);
+
+        taken.clear();
+        for (size_t j = 0; j < i; ++j) {
+            const Resource& placed = mResources[transients[j]];
+            if (livesOverlap(resource, placed)) {
+                taken.emplace_back(placed.HeapOffset,
+                                   placed.HeapOffset +
+                                       AlignUp(placed.Desc.GetBytes(), RESOURCE_ALIGNMENT));
+            }
+        }
+        std::sort(taken.begin(), taken.end());
+
+        uint64_t offset = 0;
+        for (const auto& range : taken) {
+            if (offset + size <= range.first) {
+                break;
+            }
+            offset = std::max(offset, range.second);
+        }
+        resource.HeapOffset = offset;
+        mStats.HeapBytes = std::max(mStats.HeapBytes, offset + size);
+    }
+
+    // A resource whose bytes something used earlier in the frame needs an aliasing barrier.
+    for (uint32_t a : transients) {
+        Resource& resource = mResources[a];
+        const uint64_t end =
+            resource.HeapOffset + AlignUp(resource.Desc.GetBytes(), RESOURCE_ALIGNMENT);
+        for (uint32_t b : transients) {
+            const Resource& other = mResources[b];
+            const uint64_t otherEnd =
+                other.HeapOffset + AlignUp(other.Desc.GetBytes(), RESOURCE_ALIGNMENT);
+            if (other.LastUse < resource.FirstUse && other.HeapOffset < end &&
+                resource.HeapOffset < otherEnd) {
+                resource.AliasesEarlier = true;
+                break;
+            }
+        }
+    }
+}
+
+void RenderGraph::ComputeBarriers() {
+    std::vector<RenderResourceState> states(mResources.size());
+    std::vector<bool> unorderedWritten(mResources.size(), false);
+    for (uint32_t i = 0; i < mResources.size(); ++i) {
+        states[i] = mResources[i].Initial;
+    }
+
+    for (uint32_t position = 0; position < mOrder.size(); ++position) {
+        Pass& pass = mPasses[mOrder[position]];
+        pass.FirstBarrier = static_cast<uint32_t>(mBarriers.size());
+        for (size_t i = 0; i < pass.Accesses.size(); ++i) {
+            const Access& access = pass.Accesses[i];
+            const uint32_t resourceIndex = mVersions[access.Handle].Resource;
+            const Resource& resource = mResources[resourceIndex];
+            const bool seenInPass =
+                std::any_of(pass.Accesses.begin(), pass.Accesses.begin() + i,
+                            [&](const Access& Other) {
+                                return mVersions[Other.Handle].Resource == resourceIndex;
+                            });
+            const bool writes = access.WrittenTo != INVALID_RENDER_HANDLE;
+            if (seenInPass) {
+                unorderedWritten[resourceIndex] =
+                    unorderedWritten[resourceIndex] ||
+                    (writes && access.State == RenderResourceState::UnorderedAccess);
+                continue;
+            }
+
+            RenderBarrier barrier;
+            barrier.Resource = resourceIndex;
+            barrier.Before = states[resourceIndex];
+            barrier.After = access.State;
+            barrier.Aliasing = resource.AliasesEarlier && resource.FirstUse == position;
+            // Unordered writes followed by unordered access still need the earlier writes to
+            // finish, hence a barrier with no transition.
+            const bool unorderedHazard = access.State == RenderResourceState::UnorderedAccess &&
+                                         states[resourceIndex] == access.State &&
+                                         unorderedWritten[resourceIndex];
+            if (barrier.Before != barrier.After || barrier.Aliasing || unorderedHazard) {
+                mBarriers.push_back(barrier);
+            }
+            states[resourceIndex] = access.State;
+            unorderedWritten[resourceIndex] =
+                writes && access.State == RenderResourceState::UnorderedAccess;
+        }
+        pass.BarrierCount = static_cast<uint32_t>(mBarriers.size()) - pass.FirstBarrier;
+    }
+
+    for (uint32_t i = 0; i < mResources.size(); ++i) {
+        const Resource& resource = mResources[i];
+        if (resource.Imported && states[i] != resource.Final) {
+            mFinalBarriers.push_back({i, states[i], resource.Final, false});
+        }
+    }
+    mStats.BarrierCount = static_cast<uint32_t>(mBarriers.size() + mFinalBarriers.size());
+}
@@ -0,0 +1,211 @@
+﻿// src/Graphics/RenderGraph.h
+// Declarative frame description: passes state which resources they create, read and write, and
+// Compile turns that into an execution order, the state transitions between passes and a memory
+// layout in which transient resources with disjoint lifetimes share the same bytes. Nothing here
+// talks to a GPU; backends apply the barriers and placements a compiled graph hands them.
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Common/Span.h"
+
+enum class RenderResourceState : uint8_t {
+    Undefined, // Contents are garbage: new or aliased memory
+    RenderTarget,
+    DepthWrite,
+    DepthRead,
+    ShaderRead,
+    UnorderedAccess,
+    CopySource,
+    CopyDest,
+    Present,
+};
+
+enum class RenderFormat : uint8_t { Raw8, Rgba8, Rgba16F, Rgba32F, R32F, Depth32F };
+
+uint32_t GetRenderFormatBytes(RenderFormat Format);
+
+// Textures are Width x Height texels; buffers are Raw8 with Width bytes and Height 1.
+struct RenderResourceDesc {
+    uint32_t Width = 0;
+    uint32_t Height = 1;
+    RenderFormat Format = RenderFormat::Rgba8;
+
+    uint64_t GetBytes() const {
+        return static_cast<uint64_t>(Width) * Height * GetRenderFormatBytes(Format);
+    }
+};
+
+// A version of a resource. Every write makes a new one, so a read names exactly the contents it
+// needs: a pass added after the one overwriting a version still runs before it.
+using RenderHandle = uint32_t;
+constexpr RenderHandle INVALID_RENDER_HANDLE = ~0u;
+
+struct RenderBarrier {
+    uint32_t Resource = 0; // See RenderGraph::GetResource
+    RenderResourceState Before = RenderResourceState::Undefined;
+    RenderResourceState After = RenderResourceState::Undefined;
+    // The resource starts using heap memory that resources earlier in the frame used.
+    bool Aliasing = false;
+};
+
+struct RenderGraphStats {
+    uint32_t PassCount = 0;
+    uint32_t CulledPassCount = 0;
+    uint32_t TransientCount = 0; // Transient resources used by passes that run
+    uint32_t BarrierCount = 0;
+    uint64_t TransientBytes = 0; // What the transients would take without aliasing
+    uint64_t HeapBytes = 0;      // What they take with it
+};
+
+class RenderGraph;
+
+// Handed to a pass's setup function to declare what the pass touches.
+class RenderPassBuilder {
+  public:
+    // A transient resource owned by the graph. Its contents start undefined, so the first use
+    // must be a write.
+    RenderHandle Create(const std::string& Name, const RenderResourceDesc& Desc);
+    void Read(RenderHandle Handle, RenderResourceState State = RenderResourceState::ShaderRead);
+    // Returns the version holding what this pass wrote; later readers must use it.
+    RenderHandle Write(RenderHandle Handle,
+                       RenderResourceState State = RenderResourceState::RenderTarget);
+    // Keeps the pass even when nothing reads its outputs, e.g. for readbacks.
+    void SetSideEffects();
+
+  private:
+    friend class RenderGraph;
+    RenderPassBuilder(RenderGraph& Graph, uint32_t Pass) : mGraph(Graph), mPass(Pass) {
+    }
+
+    RenderGraph& mGraph;
+    uint32_t mPass;
+};
+
+class RenderGraph {
+  public:
+    using SetupFunction = std::function<void(RenderPassBuilder& Builder)>;
+    using ExecuteFunction = std::function<void(const RenderGraph& Graph)>;
+    using BarrierFunction = std::function<void(const RenderBarrier& Barrier)>;
+
+    // Placements in the transient heap are multiples of this, as for placed GPU resources.
+    static constexpr uint64_t RESOURCE_ALIGNMENT = 64 * 1024;
+
+    RenderGraph() = default;
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    // Drops every pass and resource, keeping allocations for the next frame.
+    void Reset();
+
+    // A resource that lives outside the graph, such as the back buffer. It is in Initial when
+    // the frame starts and is moved to Final once the last pass has run.
+    RenderHandle Import(const std::string& Name,
+                        const RenderResourceDesc& Desc,
+                        RenderResourceState Initial,
+                        RenderResourceState Final);
+    // Marks a version as a result of the frame: the passes producing it are never culled.
+    void MarkOutput(RenderHandle Handle);
+
+    // Runs Setup right away and returns the pass index.
+    uint32_t AddPass(const std::string& Name, const SetupFunction& Setup, ExecuteFunction Execute);
+
+    // Orders the passes, culls those whose work nobody needs, places transient resources and
+    // computes barriers. Returns false for invalid handles, a version written twice, a read of a
+    // transient nothing wrote, a resource used in two states by one pass, or a dependency cycle.
+    bool Compile();
+
+    // Compiled graphs only. Runs the passes in order, reporting each pass's barriers just before
+    // it and the transitions to the imported resources' final states at the end.
+    void Execute(const BarrierFunction& OnBarrier) const;
+
+    // Passes that run, in execution order.
+    const std::vector<uint32_t>& GetPassOrder() const {
+        return mOrder;
+    }
+    bool IsPassCulled(uint32_t Pass) const;
+    const std::string& GetPassName(uint32_t Pass) const;
+    // Barriers to record before Pass runs.
+    Span<const RenderBarrier> GetPassBarriers(uint32_t Pass) const;
+    const std::vector<RenderBarrier>& GetFinalBarriers() const {
+        return mFinalBarriers;
+    }
+
+    // The resource a version belongs to; barriers and placements are per resource.
+    uint32_t GetResource(RenderHandle Handle) const;
+    const std::string& GetResourceName(uint32_t Resource) const;
+    const RenderResourceDesc& GetResourceDesc(uint32_t Resource) const;
+    bool IsImported(uint32_t Resource) const;
+    // Byte offset of a transient resource in the heap.
+    uint64_t GetHeapOffset(uint32_t Resource) const;
+    uint64_t GetHeapSize() const {
+        return mStats.HeapBytes;
+    }
+
+    const RenderGraphStats& GetStats() const {
+        return mStats;
+    }
+
+  private:
+    friend class RenderPassBuilder;
+
+    static constexpr uint32_t NO_PASS = ~0u;
+
+    struct Resource {
+        std::string Name;
+        RenderResourceDesc Desc;
+        bool Imported = false;
+        RenderResourceState Initial = RenderResourceState::Undefined;
+        RenderResourceState Final = RenderResourceState::Undefined;
+        // Compiled: first and last position in mOrder, NO_PASS if no running pass uses it.
+        uint32_t FirstUse = NO_PASS;
+        uint32_t LastUse = NO_PASS;
+        uint64_t HeapOffset = 0;
+        bool AliasesEarlier = false;
+    };
+
+    struct Version {
+        uint32_t Resource = 0;
+        uint32_t Writer = NO_PASS;
+        uint32_t NextVersion = INVALID_RENDER_HANDLE; // Set by the write that supersedes it
+        bool Output = false;
+    };
+
+    struct Access {
+        RenderHandle Handle;      // Version read, or version written over
+        RenderHandle WrittenTo;   // New version, or INVALID_RENDER_HANDLE for reads
+        RenderResourceState State;
+    };
+
+    struct Pass {
+        std::string Name;
+        ExecuteFunction Execute;
+        std::vector<Access> Accesses;
+        bool SideEffects = false;
+        bool Live = false;
+        uint32_t FirstBarrier = 0;
+        uint32_t BarrierCount = 0;
+    };
+
+    RenderHandle AddVersion(uint32_t Resource, uint32_t Writer);
+    bool IsValidHandle(RenderHandle Handle) const {
+        return Handle < mVersions.size();
+    }
+    void CullPasses();
+    bool SortPasses();
+    void PlaceResources();
+    void ComputeBarriers();
+
+    std::vector<Resource> mResources;
+    std::vector<Version> mVersions;
+    std::vector<Pass> mPasses;
+    bool mValid = true; // Cleared by a bad declaration; Compile reports it
+
+    std::vector<uint32_t> mOrder;
+    std::vector<RenderBarrier> mBarriers; // Per pass, ranges given by Pass::FirstBarrier
+    std::vector<RenderBarrier> mFinalBarriers;
+    RenderGraphStats mStats;
+};
@@ -2,12 +2,21 @@
 // Created by dtcimbal on 27/07/2025.
 #include "Renderer.h"
 
-bool Renderer::OnResize(uint32_t NewWidth, uint32_t NewHeight) {
+bool Renderer::OnResize([[maybe_unused]] uint32_t NewWidth, [[maybe_unused]] uint32_t NewHeight) {
     // TODO Handle resizing logic here
     return true;
 }
 
-bool Renderer::Draw(Camera& Camera) {
+bool Renderer::Draw([[maybe_unused]] Camera& Camera) {
     // TODO Handle rendering logic here
     return true;
 }
+
+void Renderer::SubmitMesh([[maybe_unused]] const Vector3* Positions,
+                          [[maybe_unused]] uint32_t VertexCount,
+                          [[maybe_unused]] const uint32_t* Indices,
+                          [[maybe_unused]] uint32_t IndexCount,
+                          [[maybe_unused]] const Matrix4& World,
+                          [[maybe_unused]] uint32_t Color) {
+    // The base renderer draws nothing, so there is nothing to queue.
+}
@@ -1,11 +1,26 @@
 ﻿//
 // Created by dtcimbal on 27/07/2025.
 #pragma once
+#include <cstdint>
 #include <memory>
+#include "Math/Matrix.h"
 #include "Scene/Camera.h"
 
+// Base renderer interface. The base implementation draws nothing; backends such as the
+// SoftwareRenderer override it and are picked through Device::CreateRenderer.
 class Renderer {
   public:
-    bool OnResize(uint32_t NewWidth, uint32_t NewHeight);
-    bool Draw(Camera& Camera);
+    virtual ~Renderer() = default;
+
+    virtual bool OnResize(uint32_t NewWidth, uint32_t NewHeight);
+    virtual bool Draw(Camera& Camera);
+
+    // Queues an object-space indexed mesh for the next Draw, transformed by World and then by the
+    // view-projection of the camera passed to Draw. The arrays must stay valid until then.
+    virtual void SubmitMesh(const Vector3* Positions,
+                            uint32_t VertexCount,
+                            const uint32_t* Indices,
+                            uint32_t IndexCount,
+                            const Matrix4& World,
+                            uint32_t Color);
 };
@@ -0,0 +1,58 @@
+﻿// src/Graphics/Software/RasterTarget.h
+// Color and depth buffers the software rasterizer renders into.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Rows are padded to a multiple of RASTER_ROW_ALIGNMENT pixels so SIMD kernels can always work on
+// full vectors; the padding columns are scratch and never presented.
+constexpr uint32_t RASTER_ROW_ALIGNMENT = 8;
+
+class RasterTarget {
+  public:
+    bool Resize(uint32_t NewWidth, uint32_t NewHeight) {
+        if (NewWidth == 0 || NewHeight == 0) {
+            return false;
+        }
+        mWidth = NewWidth;
+        mHeight = NewHeight;
+        mPitch = (NewWidth + RASTER_ROW_ALIGNMENT - 1) & ~(RASTER_ROW_ALIGNMENT - 1);
+        mColor.assign(static_cast<size_t>(mPitch) * mHeight, 0);
+        mDepth.assign(static_cast<size_t>(mPitch) * mHeight, 1.0f);
+        return true;
+    }
+
+    uint32_t GetWidth() const {
+        return mWidth;
+    }
+    uint32_t GetHeight() const {
+        return mHeight;
+    }
+    // Row stride in pixels for both buffers.
+    uint32_t GetPitch() const {
+        return mPitch;
+    }
+
+    // 32-bit 0xAARRGGBB pixels, i.e. BGRA byte order in memory.
+    uint32_t* GetColor() {
+        return mColor.data();
+    }
+    const uint32_t* GetColor() const {
+        return mColor.data();
+    }
+    float* GetDepth() {
+        return mDepth.data();
+    }
+    const float* GetDepth() const {
+        return mDepth.data();
+    }
+
+  private:
+    uint32_t mWidth = 0;
+    uint32_t mHeight = 0;
+    uint32_t mPitch = 0;
+    std::vector<uint32_t> mColor;
+    std::vector<float> mDepth;
+};
@@ -0,0 +1,252 @@
+﻿// src/Graphics/Software/SoftwareRenderer.cpp
+#include "SoftwareRenderer.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "Common/Profiler.h"
+#include "Math/SoA.h"
+#include "TileRasterizer.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Attach slots of an owned pool: one for a render thread that is not the one creating it.
+constexpr uint32_t RENDER_THREAD_SLOTS = 1;
+
+double MillisecondsBetween(Clock::time_point Start, Clock::time_point End) {
+    return std::chrono::duration<double, std::milli>(End - Start).count();
+}
+
+} // anonymous namespace
+
+SoftwareRenderer::SoftwareRenderer(uint32_t WorkerCount, bool PinWorkers)
+    : mOwnedPool(std::make_unique<ThreadPool>(WorkerCount, PinWorkers, RENDER_THREAD_SLOTS)),
+      mThreadPool(mOwnedPool.get()) {
+}
+
+SoftwareRenderer::SoftwareRenderer(ThreadPool& Pool) : mThreadPool(&Pool) {
+}
+
+SoftwareRenderer::~SoftwareRenderer() = default;
+
+bool SoftwareRenderer::OnResize(uint32_t NewWidth, uint32_t NewHeight) {
+    if (NewWidth > RASTER_MAX_DIMENSION || NewHeight > RASTER_MAX_DIMENSION) {
+        return false;
+    }
+    if (!mTarget.Resize(NewWidth, NewHeight)) {
+        return false;
+    }
+    mTilesX = (NewWidth + RASTER_TILE_SIZE - 1) >> RASTER_TILE_SHIFT;
+    mTilesY = (NewHeight + RASTER_TILE_SIZE - 1) >> RASTER_TILE_SHIFT;
+    return true;
+}
+
+void SoftwareRenderer::SubmitMesh(const Vector3* Positions,
+                                  uint32_t VertexCount,
+                                  const uint32_t* Indices,
+                                  uint32_t IndexCount,
+                                  const Matrix4& World,
+                                  uint32_t Color) {
+    MeshDraw draw;
+    draw.World = World;
+    draw.FirstPosition = static_cast<uint32_t>(mPositions.size());
+    draw.FirstVertex = static_cast<uint32_t>(mVertices.size());
+    draw.VertexCount = VertexCount;
+    mMeshDraws.push_back(draw);
+
+    mPositions.insert(mPositions.end(), Positions, Positions + VertexCount);
+    mVertices.resize(mVertices.size() + VertexCount); // Written by TransformVertices
+
+    // A mirroring World turns the mesh inside out on screen; swapping two corners of every
+    // triangle restores its front faces.
+    const Vector3 axisX{World.M[0][0], World.M[0][1], World.M[0][2]};
+    const Vector3 axisY{World.M[1][0], World.M[1][1], World.M[1][2]};
+    const Vector3 axisZ{World.M[2][0], World.M[2][1], World.M[2][2]};
+    const bool mirrored = Dot(Cross(axisX, axisY), axisZ) < 0.0f;
+    AddTriangles(draw.FirstVertex, VertexCount, Indices, IndexCount, Color, mirrored);
+}
+
+void SoftwareRenderer::SubmitTriangles(const RasterVertex* Vertices,
+                                       uint32_t VertexCount,
+                                       const uint32_t* Indices,
+                                       uint32_t IndexCount,
+                                       uint32_t Color) {
+    uint32_t base = static_cast<uint32_t>(mVertices.size());
+    mVertices.insert(mVertices.end(), Vertices, Vertices + VertexCount);
+    AddTriangles(base, VertexCount, Indices, IndexCount, Color, false);
+}
+
+void SoftwareRenderer::AddTriangles(uint32_t BaseVertex,
+                                    uint32_t VertexCount,
+                                    const uint32_t* Indices,
+                                    uint32_t IndexCount,
+                                    uint32_t Color,
+                                    bool FlipWinding) {
+    const uint32_t second = FlipWinding ? 2 : 1;
+    const uint32_t third = FlipWinding ? 1 : 2;
+    for (uint32_t i = 0; i + 2 < IndexCount; i += 3) {
+        if (Indices[i] >= VertexCount || Indices[i + 1] >= VertexCount ||
+            Indices[i + 2] >= VertexCount) {
+            continue; // Out-of-range indices would read past this submission's vertices
+        }
+        mTriangles.push_back({{BaseVertex + Indices[i], BaseVertex + Indices[i + second],
+                               BaseVertex + Indices[i + third]},
+                              Color});
+    }
+}
+
+bool SoftwareRenderer::Draw(Camera& Camera) {
+    PROFILE_ZONE("SoftwareRenderer::Draw");
+    if (mTarget.GetWidth() == 0) {
+        return false;
+    }
+
+    const Clock::time_point frameStart = Clock::now();
+
+    // 0. Bring mesh vertices into clip space.
+    TransformVertices(Camera);
+    const Clock::time_point transformEnd = Clock::now();
+    const uint32_t tileCount = mTilesX * mTilesY;
+    const uint32_t triangleCount = static_cast<uint32_t>(mTriangles.size());
+
+    mChunkCount = (triangleCount + TRIANGLES_PER_CHUNK - 1) / TRIANGLES_PER_CHUNK;
+    if (mChunkTriangles.size() < mChunkCount) {
+        mChunkTriangles.resize(mChunkCount);
+    }
+    mBinCursors.assign(static_cast<size_t>(mChunkCount) * tileCount, 0);
+
+    // 1. Clip, cull and set up triangles, counting how many land in every tile.
+    mThreadPool->ParallelFor(mChunkCount, [this](uint32_t Chunk, uint32_t) { SetupChunk(Chunk); });
+    const Clock::time_point setupEnd = Clock::now();
+
+    // 2. Turn the counts into write cursors, tile-major then chunk order, and scatter.
+    mTileStarts.resize(tileCount + 1);
+    uint32_t running = 0;
+    for (uint32_t tile = 0; tile < tileCount; ++tile) {
+        mTileStarts[tile] = running;
+        for (uint32_t chunk = 0; chunk < mChunkCount; ++chunk) {
+            uint32_t& cursor = mBinCursors[static_cast<size_t>(chunk) * tileCount + tile];
+            uint32_t count = cursor;
+            cursor = running;
+            running += count;
+        }
+    }
+    mTileStarts[tileCount] = running;
+    mBins.resize(running);
+    mThreadPool->ParallelFor(mChunkCount, [this](uint32_t Chunk, uint32_t) { BinChunk(Chunk); });
+    const Clock::time_point binEnd = Clock::now();
+
+    // 3. Every tile is owned by exactly one thread, so no synchronization on the target.
+    mThreadPool->ParallelFor(tileCount, [this](uint32_t Tile, uint32_t) { RasterizeTile(Tile); });
+    const Clock::time_point rasterEnd = Clock::now();
+
+    uint32_t rasterized = 0;
+    for (uint32_t chunk = 0; chunk < mChunkCount; ++chunk) {
+        rasterized += static_cast<uint32_t>(mChunkTriangles[chunk].size());
+    }
+
+    mStats.TransformMs = MillisecondsBetween(frameStart, transformEnd);
+    mStats.SetupMs = MillisecondsBetween(transformEnd, setupEnd);
+    mStats.BinMs = MillisecondsBetween(setupEnd, binEnd);
+    mStats.RasterMs = MillisecondsBetween(binEnd, rasterEnd);
+    mStats.TotalMs = MillisecondsBetween(frameStart, rasterEnd);
+    mStats.SubmittedTriangles = triangleCount;
+    mStats.RasterizedTriangles = rasterized;
+    mStats.TileCount = tileCount;
+    mStats.ThreadCount = mThreadPool->GetThreadCount();
+    PROFILE_COUNTER("Submitted triangles", triangleCount);
+    PROFILE_COUNTER("Rasterized triangles", rasterized);
+
+    mVertices.clear();
+    mTriangles.clear();
+    mPositions.clear();
+    mMeshDraws.clear();
+    return true;
+}
+
+void SoftwareRenderer::TransformVertices(const Camera& Camera) {
+    PROFILE_ZONE("Transform vertices");
+    mTransformJobs.clear();
+    for (uint32_t draw = 0; draw < mMeshDraws.size(); ++draw) {
+        const uint32_t count = mMeshDraws[draw].VertexCount;
+        for (uint32_t first = 0; first < count; first += VERTICES_PER_TRANSFORM_JOB) {
+            mTransformJobs.push_back(
+                {draw, first, std::min(VERTICES_PER_TRANSFORM_JOB, count - first)});
+        }
+    }
+
+    const Matrix4& viewProjection = Camera.GetViewProjection();
+    mThreadPool->ParallelFor(
+        static_cast<uint32_t>(mTransformJobs.size()), [&](uint32_t Index, uint32_t) {
+            const TransformJob& job = mTransformJobs[Index];
+            const MeshDraw& draw = mMeshDraws[job.Draw];
+            Matrix4 worldViewProjection = Multiply(draw.World, viewProjection);
+            TransformPointArray(worldViewProjection,
+                                mPositions.data() + draw.FirstPosition + job.First, job.Count,
+                                mVertices.data() + draw.FirstVertex + job.First);
+        });
+}
+
+void SoftwareRenderer::SetupChunk(uint32_t Chunk) {
+    PROFILE_ZONE("Setup chunk");
+    std::vector<RasterTriangle>& out = mChunkTriangles[Chunk];
+    out.clear();
+
+    const uint32_t first = Chunk * TRIANGLES_PER_CHUNK;
+    const uint32_t last = std::min(first + TRIANGLES_PER_CHUNK,
+                                   static_cast<uint32_t>(mTriangles.size()));
+    for (uint32_t i = first; i < last; ++i) {
+        const SubmittedTriangle& tri = mTriangles[i];
+        SetupTriangle(mVertices[tri.Indices[0]], mVertices[tri.Indices[1]],
+                      mVertices[tri.Indices[2]], tri.Color, mTarget.GetWidth(),
+                      mTarget.GetHeight(), mCullMode, out);
+    }
+
+    const uint32_t tileCount = mTilesX * mTilesY;
+    uint32_t* counts = mBinCursors.data() + static_cast<size_t>(Chunk) * tileCount;
+    for (const RasterTriangle& tri : out) {
+        for (int32_t ty = tri.MinY >> RASTER_TILE_SHIFT; ty <= (tri.MaxY >> RASTER_TILE_SHIFT);
+             ++ty) {
+            for (int32_t tx = tri.MinX >> RASTER_TILE_SHIFT;
+                 tx <= (tri.MaxX >> RASTER_TILE_SHIFT); ++tx) {
+                ++counts[ty * mTilesX + tx];
+            }
+        }
+    }
+}
+
+void SoftwareRenderer::BinChunk(uint32_t Chunk) {
+    PROFILE_ZONE("Bin chunk");
+    const uint32_t tileCount = mTilesX * mTilesY;
+    uint32_t* cursors = mBinCursors.data() + static_cast<size_t>(Chunk) * tileCount;
+    for (const RasterTriangle& tri : mChunkTriangles[Chunk]) {
+        for (int32_t ty = tri.MinY >> RASTER_TILE_SHIFT; ty <= (tri.MaxY >> RASTER_TILE_SHIFT);
+             ++ty) {
+            for (int32_t tx = tri.MinX >> RASTER_TILE_SHIFT;
+                 tx <= (tri.MaxX >> RASTER_TILE_SHIFT); ++tx) {
+                mBins[cursors[ty * mTilesX + tx]++] = &tri;
+            }
+        }
+    }
+}
+
+void SoftwareRenderer::RasterizeTile(uint32_t Tile) {
+    PROFILE_ZONE("Rasterize tile");
+    const int32_t tx = static_cast<int32_t>(Tile % mTilesX);
+    const int32_t ty = static_cast<int32_t>(Tile / mTilesX);
+
+    RasterTileRect rect;
+    rect.X0 = tx * static_cast<int32_t>(RASTER_TILE_SIZE);
+    rect.Y0 = ty * static_cast<int32_t>(RASTER_TILE_SIZE);
+    rect.X1 = std::min(rect.X0 + static_cast<int32_t>(RASTER_TILE_SIZE),
+                       static_cast<int32_t>(mTarget.GetWidth()));
+    rect.Y1 = std::min(rect.Y0 + static_cast<int32_t>(RASTER_TILE_SIZE),
+                       static_cast<int32_t>(mTarget.GetHeight()));
+
+    ClearTile(rect, mClearColor, 1.0f, mTarget);
+    for (uint32_t i = mTileStarts[Tile]; i < mTileStarts[Tile + 1]; ++i) {
+        RasterizeTriangleInTile(*mBins[i], rect, mTarget);
+    }
+}
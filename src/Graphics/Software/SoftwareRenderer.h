@@ -0,0 +1,141 @@
+﻿// src/Graphics/Software/SoftwareRenderer.h
+// Multithreaded tile-binning CPU renderer. Portable: it only needs the C++ standard library.
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Common/ThreadPool.h"
+#include "Graphics/Renderer.h"
+#include "Math/Matrix.h"
+#include "RasterTarget.h"
+#include "TriangleSetup.h"
+
+// Per-frame timings of the pipeline stages, in milliseconds.
+struct SoftwareFrameStats {
+    double TransformMs = 0.0;
+    double SetupMs = 0.0;
+    double BinMs = 0.0;
+    double RasterMs = 0.0;
+    double TotalMs = 0.0;
+    uint32_t SubmittedTriangles = 0;
+    uint32_t RasterizedTriangles = 0; // After clipping and culling
+    uint32_t TileCount = 0;
+    uint32_t ThreadCount = 0;
+};
+
+class SoftwareRenderer : public Renderer {
+  public:
+    // WorkerCount == 0 uses every core. PinWorkers keeps each worker on its own core. The pool
+    // has an attach slot for a render thread; see ThreadPool::Attach.
+    explicit SoftwareRenderer(uint32_t WorkerCount = 0, bool PinWorkers = false);
+    // Draws on Pool, which the application shares with its other CPU work so the machine is
+    // not oversubscribed. Pool must outlive the renderer, and a render thread other than its
+    // creator should be attached to it.
+    explicit SoftwareRenderer(ThreadPool& Pool);
+    ~SoftwareRenderer() override;
+
+    bool OnResize(uint32_t NewWidth, uint32_t NewHeight) override;
+
+    // Renders the triangles submitted since the last Draw and clears the submission list.
+    bool Draw(Camera& Camera) override;
+
+    // Queues an object-space indexed mesh for the next Draw. Its vertices are transformed by
+    // World and then by the view-projection of the camera passed to Draw.
+    void SubmitMesh(const Vector3* Positions,
+                    uint32_t VertexCount,
+                    const uint32_t* Indices,
+                    uint32_t IndexCount,
+                    const Matrix4& World,
+                    uint32_t Color) override;
+
+    // Queues an indexed triangle list for the next Draw. Vertices are already in clip space.
+    void SubmitTriangles(const RasterVertex* Vertices,
+                         uint32_t VertexCount,
+                         const uint32_t* Indices,
+                         uint32_t IndexCount,
+                         uint32_t Color);
+
+    void SetClearColor(uint32_t Color) {
+        mClearColor = Color;
+    }
+    void SetCullMode(CullMode Cull) {
+        mCullMode = Cull;
+    }
+
+    const RasterTarget& GetTarget() const {
+        return mTarget;
+    }
+    // The workers idle between Draw calls, so other per-frame CPU work can borrow them.
+    ThreadPool& GetThreadPool() {
+        return *mThreadPool;
+    }
+
+    const SoftwareFrameStats& GetFrameStats() const {
+        return mStats;
+    }
+
+  private:
+    struct SubmittedTriangle {
+        uint32_t Indices[3];
+        uint32_t Color;
+    };
+
+    // A mesh whose clip-space vertices mVertices[FirstVertex ..] are filled in by Draw.
+    struct MeshDraw {
+        Matrix4 World;
+        uint32_t FirstPosition;
+        uint32_t FirstVertex;
+        uint32_t VertexCount;
+    };
+
+    // A slice of one MeshDraw's vertices, the unit of parallel vertex transformation.
+    struct TransformJob {
+        uint32_t Draw;
+        uint32_t First;
+        uint32_t Count;
+    };
+
+    static constexpr uint32_t VERTICES_PER_TRANSFORM_JOB = 4096;
+
+    // Triangles are set up and binned in fixed-size chunks. Bins are filled chunk by chunk, so
+    // every tile sees its triangles in submission order regardless of which thread did the work.
+    static constexpr uint32_t TRIANGLES_PER_CHUNK = 1024;
+
+    void AddTriangles(uint32_t BaseVertex,
+                      uint32_t VertexCount,
+                      const uint32_t* Indices,
+                      uint32_t IndexCount,
+                      uint32_t Color,
+                      bool FlipWinding);
+    void TransformVertices(const Camera& Camera);
+    void SetupChunk(uint32_t Chunk);
+    void BinChunk(uint32_t Chunk);
+    void RasterizeTile(uint32_t Tile);
+
+    std::unique_ptr<ThreadPool> mOwnedPool; // Null when drawing on a shared pool
+    ThreadPool* mThreadPool;
+    RasterTarget mTarget;
+    uint32_t mTilesX = 0;
+    uint32_t mTilesY = 0;
+
+    uint32_t mClearColor = 0xFF202020;
+    CullMode mCullMode = CullMode::None;
+
+    std::vector<RasterVertex> mVertices;
+    std::vector<SubmittedTriangle> mTriangles;
+    std::vector<Vector3> mPositions;
+    std::vector<MeshDraw> mMeshDraws;
+    std::vector<TransformJob> mTransformJobs;
+
+    uint32_t mChunkCount = 0;
+    std::vector<std::vector<RasterTriangle>> mChunkTriangles;
+    // [Chunk * TileCount + Tile]: triangle counts after setup, then write cursors while binning.
+    std::vector<uint32_t> mBinCursors;
+    // Tile t's triangles are mBins[mTileStarts[t] .. mTileStarts[t + 1]).
+    std::vector<uint32_t> mTileStarts;
+    std::vector<const RasterTriangle*> mBins;
+
+    SoftwareFrameStats mStats;
+};
@@ -0,0 +1,279 @@
+﻿// src/Graphics/Software/TileRasterizer.cpp
+#include "TileRasterizer.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__AVX2__)
+#define RASTER_KERNEL_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RASTER_KERNEL_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+#if defined(RASTER_KERNEL_AVX2)
+constexpr int32_t LANES = 8;
+#elif defined(RASTER_KERNEL_SSE2)
+constexpr int32_t LANES = 4;
+#else
+constexpr int32_t LANES = 1;
+#endif
+
+static_assert(RASTER_TILE_SIZE % RASTER_ROW_ALIGNMENT == 0, "Tiles must hold whole SIMD rows");
+static_assert(RASTER_ROW_ALIGNMENT % LANES == 0, "Row padding must fit the SIMD kernel");
+
+// The part of a triangle's bounds that overlaps a tile, with the edge functions evaluated at the
+// center of its first pixel.
+struct TileSpan {
+    int32_t X0;
+    int32_t Y0;
+    int32_t Columns; // Rounded up to a multiple of LANES
+    int32_t Rows;
+
+    int32_t Edge[3];
+    int32_t EdgeStepX[3];
+    int32_t EdgeStepY[3];
+
+    float Z;
+    float DzDx;
+    float DzDy;
+};
+
+// Returns false when the triangle cannot touch any pixel of the tile.
+bool PrepareSpan(const RasterTriangle& Tri, const RasterTileRect& Tile, TileSpan& Span) {
+    int32_t x0 = std::max(Tile.X0, Tri.MinX);
+    int32_t y0 = std::max(Tile.Y0, Tri.MinY);
+    int32_t x1 = std::min(Tile.X1 - 1, Tri.MaxX);
+    int32_t y1 = std::min(Tile.Y1 - 1, Tri.MaxY);
+    if (x0 > x1 || y0 > y1) {
+        return false;
+    }
+
+    // Tiles start on a SIMD boundary, so aligning down stays inside the tile.
+    x0 &= ~(LANES - 1);
+    Span.X0 = x0;
+    Span.Y0 = y0;
+    Span.Columns = (x1 - x0 + LANES) & ~(LANES - 1);
+    Span.Rows = y1 - y0 + 1;
+
+    const int64_t half = RASTER_SUBPIXEL_STEP / 2;
+    for (int e = 0; e < 3; ++e) {
+        int32_t stepX = Tri.EdgeA[e] * RASTER_SUBPIXEL_STEP;
+        int32_t stepY = Tri.EdgeB[e] * RASTER_SUBPIXEL_STEP;
+        int64_t value = static_cast<int64_t>(Tri.EdgeA[e]) * (x0 * RASTER_SUBPIXEL_STEP + half) +
+                        static_cast<int64_t>(Tri.EdgeB[e]) * (y0 * RASTER_SUBPIXEL_STEP + half) +
+                        Tri.EdgeC[e];
+
+        int64_t maxX = static_cast<int64_t>(stepX) * (Span.Columns - 1);
+        int64_t maxY = static_cast<int64_t>(stepY) * (Span.Rows - 1);
+        if (value + std::max<int64_t>(maxX, 0) + std::max<int64_t>(maxY, 0) < 0) {
+            return false;
+        }
+
+        // Far away from the edge only the sign matters, so clamp the start value into the range
+        // where stepping across the span cannot flip the sign or overflow int32.
+        int64_t range = std::llabs(maxX) + std::llabs(maxY) + 1;
+        value = std::min(std::max(value, -range), range);
+
+        Span.Edge[e] = static_cast<int32_t>(value);
+        Span.EdgeStepX[e] = stepX;
+        Span.EdgeStepY[e] = stepY;
+    }
+
+    Span.DzDx = Tri.DzDx;
+    Span.DzDy = Tri.DzDy;
+    Span.Z = Tri.Z + Tri.DzDx * (x0 - Tri.MinX) + Tri.DzDy * (y0 - Tri.MinY);
+    return true;
+}
+
+#if defined(RASTER_KERNEL_AVX2)
+
+void RasterizeSpan(const TileSpan& Span, uint32_t Color, RasterTarget& Target) {
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 lanesF = _mm256_cvtepi32_ps(lanes);
+
+    __m256i rowEdge[3];
+    __m256i stepX[3];
+    __m256i stepY[3];
+    for (int e = 0; e < 3; ++e) {
+        rowEdge[e] = _mm256_add_epi32(_mm256_set1_epi32(Span.Edge[e]),
+                                      _mm256_mullo_epi32(lanes, _mm256_set1_epi32(Span.EdgeStepX[e])));
+        stepX[e] = _mm256_set1_epi32(Span.EdgeStepX[e] * LANES);
+        stepY[e] = _mm256_set1_epi32(Span.EdgeStepY[e]);
+    }
+    __m256 rowZ = _mm256_add_ps(_mm256_set1_ps(Span.Z), _mm256_mul_ps(lanesF, _mm256_set1_ps(Span.DzDx)));
+    const __m256 zStepX = _mm256_set1_ps(Span.DzDx * LANES);
+    const __m256 zStepY = _mm256_set1_ps(Span.DzDy);
+    const __m256i color = _mm256_set1_epi32(static_cast<int32_t>(Color));
+    const __m256i minusOne = _mm256_set1_epi32(-1);
+
+    const size_t pitch = Target.GetPitch();
+    uint32_t* colorRow = Target.GetColor() + Span.Y0 * pitch + Span.X0;
+    float* depthRow = Target.GetDepth() + Span.Y0 * pitch + Span.X0;
+
+    for (int32_t y = 0; y < Span.Rows; ++y) {
+        __m256i e0 = rowEdge[0];
+        __m256i e1 = rowEdge[1];
+        __m256i e2 = rowEdge[2];
+        __m256 z = rowZ;
+
+        for (int32_t x = 0; x < Span.Columns; x += LANES) {
+            __m256i any = _mm256_or_si256(_mm256_or_si256(e0, e1), e2);
+            if (_mm256_movemask_ps(_mm256_castsi256_ps(any)) != 0xFF) {
+                __m256 inside = _mm256_castsi256_ps(_mm256_cmpgt_epi32(any, minusOne));
+                __m256 oldDepth = _mm256_loadu_ps(depthRow + x);
+                __m256 pass = _mm256_and_ps(inside, _mm256_cmp_ps(z, oldDepth, _CMP_LT_OQ));
+                if (_mm256_movemask_ps(pass) != 0) {
+                    _mm256_storeu_ps(depthRow + x, _mm256_blendv_ps(oldDepth, z, pass));
+                    __m256i* dst = reinterpret_cast<__m256i*>(colorRow + x);
+                    __m256 oldColor = _mm256_castsi256_ps(_mm256_loadu_si256(dst));
+                    __m256 newColor =
+                        _mm256_blendv_ps(oldColor, _mm256_castsi256_ps(color), pass);
+                    _mm256_storeu_si256(dst, _mm256_castps_si256(newColor));
+                }
+            }
+            e0 = _mm256_add_epi32(e0, stepX[0]);
+            e1 = _mm256_add_epi32(e1, stepX[1]);
+            e2 = _mm256_add_epi32(e2, stepX[2]);
+            z = _mm256_add_ps(z, zStepX);
+        }
+
+        for (int e = 0; e < 3; ++e) {
+            rowEdge[e] = _mm256_add_epi32(rowEdge[e], stepY[e]);
+        }
+        rowZ = _mm256_add_ps(rowZ, zStepY);
+        colorRow += pitch;
+        depthRow += pitch;
+    }
+}
+
+#elif defined(RASTER_KERNEL_SSE2)
+
+void RasterizeSpan(const TileSpan& Span, uint32_t Color, RasterTarget& Target) {
+    __m128i rowEdge[3];
+    __m128i stepX[3];
+    __m128i stepY[3];
+    for (int e = 0; e < 3; ++e) {
+        // SSE2 has no 32-bit multiply, the lane offsets are cheap to build by hand.
+        int32_t s = Span.Edge[e];
+        int32_t a = Span.EdgeStepX[e];
+        rowEdge[e] = _mm_setr_epi32(s, s + a, s + 2 * a, s + 3 * a);
+        stepX[e] = _mm_set1_epi32(a * LANES);
+        stepY[e] = _mm_set1_epi32(Span.EdgeStepY[e]);
+    }
+    __m128 rowZ = _mm_add_ps(_mm_set1_ps(Span.Z),
+                             _mm_mul_ps(_mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f), _mm_set1_ps(Span.DzDx)));
+    const __m128 zStepX = _mm_set1_ps(Span.DzDx * LANES);
+    const __m128 zStepY = _mm_set1_ps(Span.DzDy);
+    const __m128i color = _mm_set1_epi32(static_cast<int32_t>(Color));
+    const __m128i minusOne = _mm_set1_epi32(-1);
+
+    const size_t pitch = Target.GetPitch();
+    uint32_t* colorRow = Target.GetColor() + Span.Y0 * pitch + Span.X0;
+    float* depthRow = Target.GetDepth() + Span.Y0 * pitch + Span.X0;
+
+    for (int32_t y = 0; y < Span.Rows; ++y) {
+        __m128i e0 = rowEdge[0];
+        __m128i e1 = rowEdge[1];
+        __m128i e2 = rowEdge[2];
+        __m128 z = rowZ;
+
+        for (int32_t x = 0; x < Span.Columns; x += LANES) {
+            __m128i any = _mm_or_si128(_mm_or_si128(e0, e1), e2);
+            if (_mm_movemask_ps(_mm_castsi128_ps(any)) != 0xF) {
+                __m128 inside = _mm_castsi128_ps(_mm_cmpgt_epi32(any, minusOne));
+                __m128 oldDepth = _mm_loadu_ps(depthRow + x);
+                __m128 pass = _mm_and_ps(inside, _mm_cmplt_ps(z, oldDepth));
+                if (_mm_movemask_ps(pass) != 0) {
+                    _mm_storeu_ps(depthRow + x,
+                                  _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, oldDepth)));
+                    __m128i passMask = _mm_castps_si128(pass);
+                    __m128i* dst = reinterpret_cast<__m128i*>(colorRow + x);
+                    __m128i oldColor = _mm_loadu_si128(dst);
+                    _mm_storeu_si128(dst, _mm_or_si128(_mm_and_si128(passMask, color),
+                                                       _mm_andnot_si128(passMask, oldColor)));
+                }
+            }
+            e0 = _mm_add_epi32(e0, stepX[0]);
+            e1 = _mm_add_epi32(e1, stepX[1]);
+            e2 = _mm_add_epi32(e2, stepX[2]);
+            z = _mm_add_ps(z, zStepX);
+        }
+
+        for (int e = 0; e < 3; ++e) {
+            rowEdge[e] = _mm_add_epi32(rowEdge[e], stepY[e]);
+        }
+        rowZ = _mm_add_ps(rowZ, zStepY);
+        colorRow += pitch;
+        depthRow += pitch;
+    }
+}
+
+#else
+
+void RasterizeSpan(const TileSpan& Span, uint32_t Color, RasterTarget& Target) {
+    const size_t pitch = Target.GetPitch();
+    int32_t rowEdge[3] = {Span.Edge[0], Span.Edge[1], Span.Edge[2]};
+    float rowZ = Span.Z;
+
+    for (int32_t y = 0; y < Span.Rows; ++y) {
+        uint32_t* colorRow = Target.GetColor() + (Span.Y0 + y) * pitch + Span.X0;
+        float* depthRow = Target.GetDepth() + (Span.Y0 + y) * pitch + Span.X0;
+        int32_t e0 = rowEdge[0];
+        int32_t e1 = rowEdge[1];
+        int32_t e2 = rowEdge[2];
+        float z = rowZ;
+
+        for (int32_t x = 0; x < Span.Columns; ++x) {
+            if ((e0 | e1 | e2) >= 0 && z < depthRow[x]) {
+                depthRow[x] = z;
+                colorRow[x] = Color;
+            }
+            e0 += Span.EdgeStepX[0];
+            e1 += Span.EdgeStepX[1];
+            e2 += Span.EdgeStepX[2];
+            z += Span.DzDx;
+        }
+
+        for (int e = 0; e < 3; ++e) {
+            rowEdge[e] += Span.EdgeStepY[e];
+        }
+        rowZ += Span.DzDy;
+    }
+}
+
+#endif
+
+} // anonymous namespace
+
+const char* GetRasterKernelName() {
+#if defined(RASTER_KERNEL_AVX2)
+    return "AVX2";
+#elif defined(RASTER_KERNEL_SSE2)
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
+
+void ClearTile(const RasterTileRect& Tile, uint32_t Color, float Depth, RasterTarget& Target) {
+    const size_t pitch = Target.GetPitch();
+    for (int32_t y = Tile.Y0; y < Tile.Y1; ++y) {
+        uint32_t* colorRow = Target.GetColor() + y * pitch;
+        float* depthRow = Target.GetDepth() + y * pitch;
+        std::fill(colorRow + Tile.X0, colorRow + Tile.X1, Color);
+        std::fill(depthRow + Tile.X0, depthRow + Tile.X1, Depth);
+    }
+}
+
+void RasterizeTriangleInTile(const RasterTriangle& Triangle,
+                             const RasterTileRect& Tile,
+                             RasterTarget& Target) {
+    TileSpan span;
+    if (PrepareSpan(Triangle, Tile, span)) {
+        RasterizeSpan(span, Triangle.Color, Target);
+    }
+}
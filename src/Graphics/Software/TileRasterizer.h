@@ -0,0 +1,31 @@
+﻿// src/Graphics/Software/TileRasterizer.h
+// SIMD edge-function rasterization of set-up triangles into one screen tile.
+#pragma once
+
+#include <cstdint>
+
+#include "RasterTarget.h"
+#include "TriangleSetup.h"
+
+// Tiles are square and a multiple of the widest SIMD kernel.
+constexpr uint32_t RASTER_TILE_SIZE = 64;
+constexpr uint32_t RASTER_TILE_SHIFT = 6;
+
+// Pixel rectangle of a tile, X1/Y1 exclusive and already clamped to the target.
+struct RasterTileRect {
+    int32_t X0;
+    int32_t Y0;
+    int32_t X1;
+    int32_t Y1;
+};
+
+// Name of the kernel compiled into this build ("AVX2", "SSE2" or "Scalar").
+const char* GetRasterKernelName();
+
+// Fills the tile's color and depth with the clear values.
+void ClearTile(const RasterTileRect& Tile, uint32_t Color, float Depth, RasterTarget& Target);
+
+// Rasterizes the part of Triangle that falls inside Tile with a less-than depth test.
+void RasterizeTriangleInTile(const RasterTriangle& Triangle,
+                             const RasterTileRect& Tile,
+                             RasterTarget& Target);
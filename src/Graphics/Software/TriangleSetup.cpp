@@ -0,0 +1,223 @@
+﻿// src/Graphics/Software/TriangleSetup.cpp
+#include "TriangleSetup.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// A triangle clipped against all five clip planes has at most 3 + 5 vertices.
+constexpr uint32_t MAX_CLIP_VERTICES = 8;
+
+// Plane distance = A * x + B * y + C * z + D * w; a vertex is inside when it is >= 0.
+struct ClipPlane {
+    float A;
+    float B;
+    float C;
+    float D;
+};
+
+// The first CLIP_PLANE_COUNT planes are clipped against, the rest are only used to reject
+// triangles that are completely off-screen or beyond the far plane.
+constexpr uint32_t CLIP_PLANE_COUNT = 5;
+constexpr uint32_t PLANE_COUNT = 10;
+
+float Distance(const ClipPlane& Plane, const RasterVertex& V) {
+    return Plane.A * V.X + Plane.B * V.Y + Plane.C * V.Z + Plane.D * V.W;
+}
+
+RasterVertex Lerp(const RasterVertex& From, const RasterVertex& To, float T) {
+    return {From.X + (To.X - From.X) * T, From.Y + (To.Y - From.Y) * T,
+            From.Z + (To.Z - From.Z) * T, From.W + (To.W - From.W) * T};
+}
+
+// Sutherland-Hodgman clip of a convex polygon against one plane.
+uint32_t ClipPolygon(const RasterVertex* In,
+                     uint32_t Count,
+                     const ClipPlane& Plane,
+                     RasterVertex* Out) {
+    uint32_t outCount = 0;
+    for (uint32_t i = 0; i < Count; ++i) {
+        const RasterVertex& current = In[i];
+        const RasterVertex& next = In[(i + 1) % Count];
+        float dCurrent = Distance(Plane, current);
+        float dNext = Distance(Plane, next);
+
+        if (dCurrent >= 0.0f) {
+            Out[outCount++] = current;
+        }
+        if ((dCurrent >= 0.0f) != (dNext >= 0.0f)) {
+            Out[outCount++] = Lerp(current, next, dCurrent / (dCurrent - dNext));
+        }
+    }
+    return outCount;
+}
+
+int32_t FloorDiv(int32_t Value, int32_t Divisor) {
+    int32_t quotient = Value / Divisor;
+    return (Value % Divisor != 0 && Value < 0) ? quotient - 1 : quotient;
+}
+
+// Pixels exactly on an edge belong to the triangle only for top and left edges, so adjacent
+// triangles never both cover (or both miss) a pixel. Inside is E >= 0 and y points down.
+bool IsTopLeftEdge(int32_t A, int32_t B) {
+    return A > 0 || (A == 0 && B > 0);
+}
+
+bool EmitTriangle(const int32_t (&X)[3],
+                  const int32_t (&Y)[3],
+                  const float (&Z)[3],
+                  uint32_t Color,
+                  uint32_t Width,
+                  uint32_t Height,
+                  CullMode Cull,
+                  std::vector<RasterTriangle>& Out) {
+    int64_t area = static_cast<int64_t>(X[1] - X[0]) * (Y[2] - Y[0]) -
+                   static_cast<int64_t>(X[2] - X[0]) * (Y[1] - Y[0]);
+    // Positive area is clockwise on screen, i.e. a front face.
+    if (area == 0 || (Cull == CullMode::Back && area < 0) ||
+        (Cull == CullMode::Front && area > 0)) {
+        return false;
+    }
+
+    // Order the vertices so the inside of every edge is positive.
+    int i1 = area > 0 ? 1 : 2;
+    int i2 = area > 0 ? 2 : 1;
+    const int order[3] = {0, i1, i2};
+
+    RasterTriangle tri;
+    int32_t minSX = std::min({X[0], X[1], X[2]});
+    int32_t minSY = std::min({Y[0], Y[1], Y[2]});
+    int32_t maxSX = std::max({X[0], X[1], X[2]});
+    int32_t maxSY = std::max({Y[0], Y[1], Y[2]});
+
+    // Pixel centers sit at half-pixel offsets.
+    const int32_t half = RASTER_SUBPIXEL_STEP / 2;
+    tri.MinX = std::max(-FloorDiv(half - minSX, RASTER_SUBPIXEL_STEP), 0);
+    tri.MinY = std::max(-FloorDiv(half - minSY, RASTER_SUBPIXEL_STEP), 0);
+    tri.MaxX = std::min(FloorDiv(maxSX - half, RASTER_SUBPIXEL_STEP),
+                        static_cast<int32_t>(Width) - 1);
+    tri.MaxY = std::min(FloorDiv(maxSY - half, RASTER_SUBPIXEL_STEP),
+                        static_cast<int32_t>(Height) - 1);
+    if (tri.MinX > tri.MaxX || tri.MinY > tri.MaxY) {
+        return false;
+    }
+
+    for (int e = 0; e < 3; ++e) {
+        int i = order[e];
+        int j = order[(e + 1) % 3];
+        tri.EdgeA[e] = Y[i] - Y[j];
+        tri.EdgeB[e] = X[j] - X[i];
+        tri.EdgeC[e] = static_cast<int64_t>(X[i]) * Y[j] - static_cast<int64_t>(Y[i]) * X[j];
+        if (!IsTopLeftEdge(tri.EdgeA[e], tri.EdgeB[e])) {
+            tri.EdgeC[e] -= 1;
+        }
+    }
+
+    // Depth plane through the three snapped vertices, in pixel units.
+    const double scale = 1.0 / RASTER_SUBPIXEL_STEP;
+    double x0 = X[0] * scale;
+    double y0 = Y[0] * scale;
+    double d1x = (X[1] - X[0]) * scale;
+    double d1y = (Y[1] - Y[0]) * scale;
+    double d2x = (X[2] - X[0]) * scale;
+    double d2y = (Y[2] - Y[0]) * scale;
+    double dz1 = static_cast<double>(Z[1]) - Z[0];
+    double dz2 = static_cast<double>(Z[2]) - Z[0];
+    double denom = d1x * d2y - d2x * d1y;
+    double dzdx = (dz1 * d2y - dz2 * d1y) / denom;
+    double dzdy = (dz2 * d1x - dz1 * d2x) / denom;
+
+    tri.DzDx = static_cast<float>(dzdx);
+    tri.DzDy = static_cast<float>(dzdy);
+    tri.Z = static_cast<float>(Z[0] + dzdx * (tri.MinX + 0.5 - x0) + dzdy * (tri.MinY + 0.5 - y0));
+    tri.Color = Color;
+
+    Out.push_back(tri);
+    return true;
+}
+
+} // anonymous namespace
+
+uint32_t SetupTriangle(const RasterVertex& V0,
+                       const RasterVertex& V1,
+                       const RasterVertex& V2,
+                       uint32_t Color,
+                       uint32_t Width,
+                       uint32_t Height,
+                       CullMode Cull,
+                       std::vector<RasterTriangle>& Out) {
+    const float guardX = RASTER_GUARD_BAND_PIXELS / (Width * 0.5f);
+    const float guardY = RASTER_GUARD_BAND_PIXELS / (Height * 0.5f);
+    const ClipPlane planes[PLANE_COUNT] = {
+        // Clipped against
+        {0.0f, 0.0f, 1.0f, 0.0f},    // Near: z >= 0
+        {1.0f, 0.0f, 0.0f, guardX},  // Guard band left
+        {-1.0f, 0.0f, 0.0f, guardX}, // Guard band right
+        {0.0f, 1.0f, 0.0f, guardY},  // Guard band bottom
+        {0.0f, -1.0f, 0.0f, guardY}, // Guard band top
+        // Rejected against
+        {1.0f, 0.0f, 0.0f, 1.0f},  // Viewport left
+        {-1.0f, 0.0f, 0.0f, 1.0f}, // Viewport right
+        {0.0f, 1.0f, 0.0f, 1.0f},  // Viewport bottom
+        {0.0f, -1.0f, 0.0f, 1.0f}, // Viewport top
+        {0.0f, 0.0f, -1.0f, 1.0f}, // Far: z <= w
+    };
+
+    const RasterVertex* input[3] = {&V0, &V1, &V2};
+    uint32_t outCodes[3] = {0, 0, 0};
+    for (int v = 0; v < 3; ++v) {
+        for (uint32_t p = 0; p < PLANE_COUNT; ++p) {
+            if (Distance(planes[p], *input[v]) < 0.0f) {
+                outCodes[v] |= 1u << p;
+            }
+        }
+    }
+
+    // Entirely outside one plane.
+    if ((outCodes[0] & outCodes[1] & outCodes[2]) != 0) {
+        return 0;
+    }
+
+    RasterVertex polygon[2][MAX_CLIP_VERTICES] = {{V0, V1, V2}};
+    uint32_t count = 3;
+    uint32_t current = 0;
+    uint32_t crossing = (outCodes[0] | outCodes[1] | outCodes[2]) & ((1u << CLIP_PLANE_COUNT) - 1);
+    for (uint32_t p = 0; p < CLIP_PLANE_COUNT && count >= 3; ++p) {
+        if (crossing & (1u << p)) {
+            count = ClipPolygon(polygon[current], count, planes[p], polygon[current ^ 1]);
+            current ^= 1;
+        }
+    }
+    if (count < 3) {
+        return 0;
+    }
+
+    int32_t sx[MAX_CLIP_VERTICES];
+    int32_t sy[MAX_CLIP_VERTICES];
+    float sz[MAX_CLIP_VERTICES];
+    for (uint32_t i = 0; i < count; ++i) {
+        const RasterVertex& v = polygon[current][i];
+        if (v.W <= 1e-7f) {
+            return 0;
+        }
+        float invW = 1.0f / v.W;
+        float x = (v.X * invW * 0.5f + 0.5f) * Width;
+        float y = (0.5f - v.Y * invW * 0.5f) * Height;
+        sx[i] = static_cast<int32_t>(std::lrint(x * RASTER_SUBPIXEL_STEP));
+        sy[i] = static_cast<int32_t>(std::lrint(y * RASTER_SUBPIXEL_STEP));
+        sz[i] = v.Z * invW;
+    }
+
+    // The clipped polygon is convex, so a fan covers it.
+    uint32_t emitted = 0;
+    for (uint32_t i = 1; i + 1 < count; ++i) {
+        const int32_t x[3] = {sx[0], sx[i], sx[i + 1]};
+        const int32_t y[3] = {sy[0], sy[i], sy[i + 1]};
+        const float z[3] = {sz[0], sz[i], sz[i + 1]};
+        if (EmitTriangle(x, y, z, Color, Width, Height, Cull, Out)) {
+            ++emitted;
+        }
+    }
+    return emitted;
+}
@@ -0,0 +1,59 @@
+﻿// src/Graphics/Software/TriangleSetup.h
+// Clip-space triangle clipping and screen-space edge/depth setup for the software rasterizer.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Math/Vector.h"
+
+// Largest render target the fixed-point setup supports. Together with the guard band below this
+// keeps every edge function value inside a tile within int32 range.
+constexpr uint32_t RASTER_MAX_DIMENSION = 8192;
+
+// Triangles are clipped to this many pixels around the viewport center, so huge triangles
+// crossing the screen edges still fit the fixed-point edge functions.
+constexpr float RASTER_GUARD_BAND_PIXELS = 4096.0f;
+
+// Screen positions are snapped to 1/16th of a pixel.
+constexpr int32_t RASTER_SUBPIXEL_BITS = 4;
+constexpr int32_t RASTER_SUBPIXEL_STEP = 1 << RASTER_SUBPIXEL_BITS;
+
+// A clip-space vertex following D3D conventions: visible when -w <= x, y <= w and 0 <= z <= w.
+using RasterVertex = Vector4;
+
+// Which winding gets rejected. Front faces are clockwise on screen, as in D3D.
+enum class CullMode { None, Back, Front };
+
+// A screen-space triangle ready to be rasterized.
+// The edge function for edge i is EdgeA[i] * x + EdgeB[i] * y + EdgeC[i] in subpixel units. It is
+// >= 0 inside the triangle, with the top-left fill rule already folded into EdgeC.
+struct RasterTriangle {
+    // Inclusive pixel bounds, clamped to the viewport.
+    int32_t MinX;
+    int32_t MinY;
+    int32_t MaxX;
+    int32_t MaxY;
+
+    int32_t EdgeA[3];
+    int32_t EdgeB[3];
+    int64_t EdgeC[3];
+
+    // Depth (z / w) at the center of pixel (MinX, MinY) and its per-pixel gradients.
+    float Z;
+    float DzDx;
+    float DzDy;
+
+    uint32_t Color;
+};
+
+// Clips the clip-space triangle (V0, V1, V2) against the near plane and guard band, culls it and
+// appends the resulting 0..n screen-space triangles to Out. Returns the number appended.
+uint32_t SetupTriangle(const RasterVertex& V0,
+                       const RasterVertex& V1,
+                       const RasterVertex& V2,
+                       uint32_t Color,
+                       uint32_t Width,
+                       uint32_t Height,
+                       CullMode Cull,
+                       std::vector<RasterTriangle>& Out);
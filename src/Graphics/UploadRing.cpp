@@ -0,0 +1,134 @@
+﻿// src/Graphics/UploadRing.cpp
+#include "UploadRing.h"
+
+#include <algorithm>
+#include <new>
+
+namespace {
+
+uint64_t AlignUp(uint64_t Value, uint64_t Alignment) {
+    return (Value + Alignment - 1) & ~(Alignment - 1);
+}
+
+std::byte* AlignPointer(std::byte* Pointer, uint64_t Alignment) {
+    const uintptr_t address = reinterpret_cast<uintptr_t>(Pointer);
+    return Pointer + (AlignUp(address, Alignment) - address);
+}
+
+} // anonymous namespace
+
+UploadRing::UploadRing(uint64_t Capacity)
+    : mHostMemory(new std::byte[Capacity + DEDICATED_ALIGNMENT]),
+      mMemory(AlignPointer(mHostMemory.get(), DEDICATED_ALIGNMENT)), mCapacity(Capacity),
+      mDedicatedThreshold(Capacity / 4) {
+    mStats.CapacityBytes = Capacity;
+    SetDedicatedFunctions(nullptr, nullptr);
+}
+
+UploadRing::UploadRing(void* MappedMemory, uint64_t Capacity)
+    : mMemory(static_cast<std::byte*>(MappedMemory)), mCapacity(Capacity),
+      mDedicatedThreshold(Capacity / 4) {
+    mStats.CapacityBytes = Capacity;
+    SetDedicatedFunctions(nullptr, nullptr);
+}
+
+UploadRing::~UploadRing() {
+    for (const DedicatedBlock& block : mDedicated) {
+        ReleaseDedicated(block);
+    }
+}
+
+void UploadRing::SetDedicatedFunctions(DedicatedAllocateFunction Allocate,
+                                       DedicatedReleaseFunction Release) {
+    if (Allocate && Release) {
+        mAllocateDedicated = std::move(Allocate);
+        mReleaseDedicated = std::move(Release);
+        return;
+    }
+    mAllocateDedicated = [](uint64_t Size) -> void* {
+        return ::operator new(Size, std::align_val_t(DEDICATED_ALIGNMENT), std::nothrow);
+    };
+    mReleaseDedicated = [](void* Memory) {
+        ::operator delete(Memory, std::align_val_t(DEDICATED_ALIGNMENT));
+    };
+}
+
+bool UploadRing::Allocate(uint64_t Size, uint64_t Alignment, UploadAllocation& OutAllocation) {
+    if (Alignment == 0 || (Alignment & (Alignment - 1)) != 0 || Alignment > DEDICATED_ALIGNMENT) {
+        return false;
+    }
+    if (Size > mDedicatedThreshold || mCapacity == 0) {
+        return AllocateDedicated(Size, OutAllocation);
+    }
+
+    const uint64_t offset = mHead % mCapacity;
+    uint64_t start = AlignUp(offset, Alignment);
+    uint64_t head = mHead + (start - offset);
+    if (start + Size > mCapacity) {
+        // An allocation never straddles the end: skip the rest of the buffer and start over at
+        // offset 0, which satisfies any alignment. The skipped bytes are reclaimed with the frame.
+        head = mHead + (mCapacity - offset);
+        start = 0;
+    }
+    if (head + Size - mTail > mCapacity) {
+        ++mStats.FullCount;
+        return false;
+    }
+
+    mHead = head + Size;
+    mStats.UsedBytes = mHead - mTail;
+    mStats.PeakBytes = std::max(mStats.PeakBytes, mStats.UsedBytes);
+
+    OutAllocation.CpuAddress = mMemory + start;
+    OutAllocation.Offset = start;
+    OutAllocation.Size = Size;
+    OutAllocation.Dedicated = false;
+    return true;
+}
+
+void UploadRing::EndFrame(uint64_t FenceValue) {
+    mRetiredFrames.push_back({FenceValue, mHead});
+    for (size_t i = mDedicated.size() - mUntaggedDedicated; i < mDedicated.size(); ++i) {
+        mDedicated[i].FenceValue = FenceValue;
+    }
+    mUntaggedDedicated = 0;
+}
+
+void UploadRing::Reclaim(uint64_t CompletedFenceValue) {
+    while (!mRetiredFrames.empty() && mRetiredFrames.front().FenceValue <= CompletedFenceValue) {
+        mTail = mRetiredFrames.front().Head;
+        mRetiredFrames.pop_front();
+    }
+    mStats.UsedBytes = mHead - mTail;
+
+    // Tagged blocks are in fence order, so the completed ones form a prefix.
+    const size_t tagged = mDedicated.size() - mUntaggedDedicated;
+    size_t completed = 0;
+    while (completed < tagged && mDedicated[completed].FenceValue <= CompletedFenceValue) {
+        ReleaseDedicated(mDedicated[completed]);
+        ++completed;
+    }
+    mDedicated.erase(mDedicated.begin(), mDedicated.begin() + completed);
+}
+
+bool UploadRing::AllocateDedicated(uint64_t Size, UploadAllocation& OutAllocation) {
+    void* memory = mAllocateDedicated(Size);
+    if (memory == nullptr) {
+        return false;
+    }
+    mDedicated.push_back({memory, Size, 0});
+    ++mUntaggedDedicated;
+    mStats.DedicatedBytes += Size;
+    ++mStats.DedicatedCount;
+
+    OutAllocation.CpuAddress = static_cast<std::byte*>(memory);
+    OutAllocation.Offset = 0;
+    OutAllocation.Size = Size;
+    OutAllocation.Dedicated = true;
+    return true;
+}
+
+void UploadRing::ReleaseDedicated(const DedicatedBlock& Block) {
+    mReleaseDedicated(Block.Memory);
+    mStats.DedicatedBytes -= Block.Size;
+}
@@ -0,0 +1,106 @@
+﻿// src/Graphics/UploadRing.h
+// Suballocates per-frame uploads (constants, dynamic geometry) from one persistently mapped
+// buffer instead of creating a buffer per upload. Allocations are tagged with the fence value of
+// the frame that made them and come back in bulk once that fence completes. Nothing here talks
+// to a GPU: the owner maps the buffer and reports completed fence values.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct UploadAllocation {
+    std::byte* CpuAddress = nullptr;
+    uint64_t Offset = 0; // Into the ring buffer; 0 for dedicated allocations
+    uint64_t Size = 0;
+    bool Dedicated = false;
+};
+
+struct UploadRingStats {
+    uint64_t CapacityBytes = 0;
+    uint64_t UsedBytes = 0; // Ring bytes not yet reclaimed, alignment and wrap padding included
+    uint64_t PeakBytes = 0;
+    uint64_t DedicatedBytes = 0; // Held by dedicated allocations not yet reclaimed
+    uint32_t DedicatedCount = 0; // Dedicated allocations made so far
+    uint32_t FullCount = 0;      // Allocations refused because the ring was full
+};
+
+// Not thread-safe: one ring per recording thread.
+class UploadRing {
+  public:
+    // Returns mapped memory aligned to DEDICATED_ALIGNMENT, or null on failure.
+    using DedicatedAllocateFunction = std::function<void*(uint64_t Size)>;
+    using DedicatedReleaseFunction = std::function<void(void* Memory)>;
+
+    // Placement rule for constant buffer views.
+    static constexpr uint64_t CONSTANT_ALIGNMENT = 256;
+    // Dedicated allocations start at this alignment, as committed GPU resources do.
+    static constexpr uint64_t DEDICATED_ALIGNMENT = 64 * 1024;
+
+    // Ring in host memory aligned to DEDICATED_ALIGNMENT, for CPU consumers and tests. A ring
+    // with a Capacity of 0 makes every allocation dedicated.
+    explicit UploadRing(uint64_t Capacity);
+    // Ring over a buffer the caller has mapped and keeps mapped for the ring's lifetime.
+    UploadRing(void* MappedMemory, uint64_t Capacity);
+    // Releases every dedicated allocation; the consumer must be done with all of them.
+    ~UploadRing();
+
+    UploadRing(const UploadRing&) = delete;
+    UploadRing& operator=(const UploadRing&) = delete;
+
+    // Replaces the host-memory default, e.g. with committed upload buffers.
+    void SetDedicatedFunctions(DedicatedAllocateFunction Allocate,
+                               DedicatedReleaseFunction Release);
+    // Requests larger than this bypass the ring. Defaults to a quarter of the capacity, so one
+    // large upload cannot stall the frames around it.
+    void SetDedicatedThreshold(uint64_t Bytes) {
+        mDedicatedThreshold = Bytes;
+    }
+
+    // Alignment must be a power of two no larger than DEDICATED_ALIGNMENT. Returns false when the
+    // ring has no room until an older frame is reclaimed, or a dedicated allocation failed.
+    bool Allocate(uint64_t Size, uint64_t Alignment, UploadAllocation& OutAllocation);
+
+    // Tags everything allocated since the last call with FenceValue, the value the consumer will
+    // signal once it has finished reading this frame's uploads. Values must increase.
+    void EndFrame(uint64_t FenceValue);
+    // Frees the space of every frame whose fence value is at most CompletedFenceValue.
+    void Reclaim(uint64_t CompletedFenceValue);
+
+    const UploadRingStats& GetStats() const {
+        return mStats;
+    }
+
+  private:
+    struct RetiredFrame {
+        uint64_t FenceValue;
+        uint64_t Head; // Ring head when the frame ended; reclaiming moves the tail up to it
+    };
+
+    struct DedicatedBlock {
+        void* Memory;
+        uint64_t Size;
+        uint64_t FenceValue;
+    };
+
+    bool AllocateDedicated(uint64_t Size, UploadAllocation& OutAllocation);
+    void ReleaseDedicated(const DedicatedBlock& Block);
+
+    std::unique_ptr<std::byte[]> mHostMemory; // Set when the ring owns its memory
+    std::byte* mMemory;
+    uint64_t mCapacity;
+    uint64_t mDedicatedThreshold;
+    // Byte counts since creation; the ring offset is the count modulo the capacity.
+    uint64_t mHead = 0;
+    uint64_t mTail = 0;
+    std::deque<RetiredFrame> mRetiredFrames;
+    std::vector<DedicatedBlock> mDedicated; // Oldest first; the current frame's blocks are last
+    size_t mUntaggedDedicated = 0;          // Trailing blocks made since the last EndFrame
+
+    DedicatedAllocateFunction mAllocateDedicated;
+    DedicatedReleaseFunction mReleaseDedicated;
+    UploadRingStats mStats;
+};
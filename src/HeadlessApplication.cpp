@@ -0,0 +1,605 @@
+﻿// src/HeadlessApplication.cpp
+#include "HeadlessApplication.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "Assets/GltfAsset.h"
+#include "Assets/SceneImport.h"
+#include "Common/FramePacer.h"
+#include "Common/Profiler.h"
+#include "Graphics/FramePipeline.h"
+#include "Graphics/Software/SoftwareRenderer.h"
+#include "Graphics/Software/TileRasterizer.h"
+#include "Scene/Camera.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float DEMO_GRID_SPACING = 1.8f;
+constexpr float DEMO_CUBE_RADIUS = 0.8660254f; // Half the diagonal of a unit cube
+constexpr uint32_t DEMO_PICKED_COLOR = 0xFFFFFFFF;
+constexpr uint32_t DEMO_MESH_COLOR = 0xFFC0C0C0;
+constexpr float DEMO_MESH_SIZE = 4.0f;   // Longest side of the loaded mesh after fitting
+constexpr float DEMO_MESH_HEIGHT = 3.0f; // Pivot height above the grid
+constexpr uint64_t STREAMED_MESH_BUDGET_BYTES = 4ull * 1024 * 1024 * 1024;
+
+const Vector3 DEMO_CUBE_POSITIONS[8] = {
+    {-0.5f, -0.5f, -0.5f}, {0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, -0.5f}, {-0.5f, 0.5f, -0.5f},
+    {-0.5f, -0.5f, 0.5f},  {0.5f, -0.5f, 0.5f},  {0.5f, 0.5f, 0.5f},  {-0.5f, 0.5f, 0.5f}};
+// Clockwise when seen from outside, the D3D front-face winding.
+const uint32_t DEMO_CUBE_INDICES[36] = {0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0, 1, 5, 0, 5, 4,
+                                        3, 6, 2, 3, 7, 6, 0, 4, 7, 0, 7, 3, 1, 2, 6, 1, 6, 5};
+
+void PrintUsage() {
+    std::printf("Usage: DXMiniHeadless [options]\n"
+                "  --frames N        Number of frames to render (default 60)\n"
+                "  --fps N           Cap the frame rate at N, 0 = no cap (default 0)\n"
+                "  --width W         Frame width in pixels (default 1280)\n"
+                "  --height H        Frame height in pixels (default 720)\n"
+                "  --threads N       Renderer worker threads, 0 = all cores (default 0)\n"
+                "  --pin             Pin each renderer worker to its own core\n"
+                "  --grid N          Demo scene has N x N cubes (default 13)\n"
+                "  --mesh FILE       OBJ, glTF, GLB or .dxmesh model to show above the grid\n"
+                "  --no-cache        Parse OBJ meshes instead of using their cooked copy\n"
+                "  --no-optimize     Keep OBJ triangles and vertices in file order\n"
+                "  --no-meshlet-cull Draw whole meshes instead of their visible meshlets\n"
+                "  --lod-error PX    Draw the coarsest LOD within PX pixels of error,\n"
+                "                    0 = full meshes only (default 1)\n"
+                "  --stream          Load the mesh on an I/O thread while frames render\n"
+                "  --output DIR      Output directory (default ./frames)\n"
+                "  --prefix NAME     File name prefix (default frame)\n"
+                "  --format ppm|png  Image format (default ppm)\n"
+                "  --queue N         Frames buffered for the writer thread (default 8)\n"
+                "  --snapshots N     Frames in flight between update and render, 1 = no\n"
+                "                    render thread (default 2)\n"
+                "  --no-drop         Wait for the writer instead of dropping frames\n"
+                "  --no-output       Render only, write nothing\n"
+                "  --trace FILE      Write a Chrome trace of the run and print zone timings\n");
+}
+
+bool ParseUInt(const char* Text, uint32_t& OutValue) {
+    char* end = nullptr;
+    unsigned long value = std::strtoul(Text, &end, 10);
+    if (end == Text || *end != '\0' || value > 0xFFFFFFFFul) {
+        return false;
+    }
+    OutValue = static_cast<uint32_t>(value);
+    return true;
+}
+
+bool ParseFloat(const char* Text, float& OutValue) {
+    char* end = nullptr;
+    const float value = std::strtof(Text, &end);
+    if (end == Text || *end != '\0' || !std::isfinite(value)) {
+        return false;
+    }
+    OutValue = value;
+    return true;
+}
+
+} // anonymous namespace
+
+bool ParseHeadlessOptions(int argc, char** argv, HeadlessOptions& OutOptions) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool ok = true;
+
+        if (std::strcmp(arg, "--no-drop") == 0) {
+            OutOptions.Policy = FrameQueuePolicy::Block;
+            continue;
+        }
+        if (std::strcmp(arg, "--no-output") == 0) {
+            OutOptions.WriteFrames = false;
+            continue;
+        }
+        if (std::strcmp(arg, "--no-cache") == 0) {
+            OutOptions.UseMeshCache = false;
+            continue;
+        }
+        if (std::strcmp(arg, "--no-optimize") == 0) {
+            OutOptions.OptimizeMesh = false;
+            continue;
+        }
+        if (std::strcmp(arg, "--no-meshlet-cull") == 0) {
+            OutOptions.CullMeshlets = false;
+            continue;
+        }
+        if (std::strcmp(arg, "--stream") == 0) {
+            OutOptions.StreamMesh = true;
+            continue;
+        }
+        if (std::strcmp(arg, "--pin") == 0) {
+            OutOptions.PinWorkers = true;
+            continue;
+        }
+        if (value == nullptr || std::strcmp(arg, "--help") == 0) {
+            PrintUsage();
+            return false;
+        }
+
+        if (std::strcmp(arg, "--frames") == 0) {
+            ok = ParseUInt(value, OutOptions.FrameCount);
+        } else if (std::strcmp(arg, "--fps") == 0) {
+            ok = ParseUInt(value, OutOptions.TargetFps);
+        } else if (std::strcmp(arg, "--width") == 0) {
+            ok = ParseUInt(value, OutOptions.Width);
+        } else if (std::strcmp(arg, "--height") == 0) {
+            ok = ParseUInt(value, OutOptions.Height);
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            ok = ParseUInt(value, OutOptions.WorkerCount);
+        } else if (std::strcmp(arg, "--lod-error") == 0) {
+            ok = ParseFloat(value, OutOptions.LodPixelError) && OutOptions.LodPixelError >= 0.0f;
+        } else if (std::strcmp(arg, "--grid") == 0) {
+            ok = ParseUInt(value, OutOptions.GridSize) && OutOptions.GridSize > 0 &&
+                 OutOptions.GridSize <= 4096;
+        } else if (std::strcmp(arg, "--queue") == 0) {
+            ok = ParseUInt(value, OutOptions.QueueCapacity);
+        } else if (std::strcmp(arg, "--snapshots") == 0) {
+            ok = ParseUInt(value, OutOptions.SnapshotCount) && OutOptions.SnapshotCount > 0 &&
+                 OutOptions.SnapshotCount <= 4;
+        } else if (std::strcmp(arg, "--mesh") == 0) {
+            OutOptions.MeshPath = value;
+        } else if (std::strcmp(arg, "--output") == 0) {
+            OutOptions.OutputDirectory = value;
+        } else if (std::strcmp(arg, "--trace") == 0) {
+            OutOptions.TracePath = value;
+        } else if (std::strcmp(arg, "--prefix") == 0) {
+            OutOptions.Prefix = value;
+        } else if (std::strcmp(arg, "--format") == 0) {
+            if (std::strcmp(value, "ppm") == 0) {
+                OutOptions.Format = FrameFormat::Ppm;
+            } else if (std::strcmp(value, "png") == 0) {
+                OutOptions.Format = FrameFormat::Png;
+            } else {
+                ok = false;
+            }
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::printf("Invalid argument: %s %s\n", arg, value);
+            PrintUsage();
+            return false;
+        }
+        ++i; // Consumed the value
+    }
+    return true;
+}
+
+HeadlessApplication::HeadlessApplication(HeadlessOptions Options) : mOptions(std::move(Options)) {
+    mCamera = std::make_unique<Camera>();
+    mCamera->SetPerspective(1.0471976f, static_cast<float>(mOptions.Width) / mOptions.Height,
+                            0.1f, 200.0f);
+    // Worker threads are the only difference from the windowed backend: nothing needs an HWND.
+    mRenderer = std::make_unique<SoftwareRenderer>(mOptions.WorkerCount, mOptions.PinWorkers);
+    mRenderer->SetCullMode(CullMode::Back);
+    BuildScene();
+}
+
+HeadlessApplication::~HeadlessApplication() = default;
+
+int HeadlessApplication::Run() {
+    PROFILE_THREAD("Main");
+    if (!mRenderer->OnResize(mOptions.Width, mOptions.Height)) {
+        std::printf("Unsupported resolution %ux%u.\n", mOptions.Width, mOptions.Height);
+        return 1;
+    }
+    if (!mOptions.MeshPath.empty()) {
+        if (mOptions.StreamMesh) {
+            RequestMesh();
+        } else if (!LoadMesh()) {
+            return 1;
+        }
+    }
+
+    std::unique_ptr<FrameWriter> writer;
+    if (mOptions.WriteFrames) {
+        writer = std::make_unique<FrameWriter>(mOptions.OutputDirectory, mOptions.Prefix,
+                                               mOptions.Format, mOptions.QueueCapacity,
+                                               mOptions.Policy);
+    }
+
+    double cullMs = 0.0;
+    uint64_t visibleCubes = 0;
+    const Clock::time_point runStart = Clock::now();
+
+    // This thread animates, culls and picks frame N + 1 while the render thread draws frame N.
+    FramePipeline pipeline(
+        [this, &writer](const FrameSnapshot& Snapshot) {
+            return RenderFrame(Snapshot, writer.get());
+        },
+        mOptions.SnapshotCount, &mRenderer->GetThreadPool());
+    // The animation advances a fixed amount per frame so runs stay reproducible; the pacer only
+    // spaces the frames out.
+    SystemFrameClock frameClock;
+    FramePacingSettings pacing;
+    pacing.Mode = mOptions.TargetFps > 0 ? FramePacingMode::Limited : FramePacingMode::Unlimited;
+    pacing.TargetFps = mOptions.TargetFps;
+    FramePacer pacer(frameClock, pacing);
+    for (uint32_t frame = 0; frame < mOptions.FrameCount; ++frame) {
+        if (pipeline.GetStats().Failed > 0) {
+            break;
+        }
+        pacer.BeginFrame();
+        if (mStreamer) {
+            mStreamer->Update();
+        }
+        FrameSnapshot& snapshot = pipeline.BeginFrame();
+        UpdateScene(frame, snapshot);
+        pipeline.SubmitFrame();
+
+        cullMs += mCuller.GetStats().CullMs;
+        visibleCubes += mCuller.GetStats().Visible;
+        mFramesSubmitted = frame + 1;
+        pacer.EndFrame();
+        PROFILE_FRAME();
+    }
+    pipeline.Flush();
+
+    const double loopMs =
+        std::chrono::duration<double, std::milli>(Clock::now() - runStart).count();
+    const FramePipelineStats frameStats = pipeline.GetStats();
+    if (frameStats.Failed > 0) {
+        return 1;
+    }
+    if (writer) {
+        writer->Flush();
+    }
+    const double totalMs =
+        std::chrono::duration<double, std::milli>(Clock::now() - runStart).count();
+
+    const SoftwareFrameStats& last = mRenderer->GetFrameStats();
+    const uint32_t frames = mOptions.FrameCount > 0 ? mOptions.FrameCount : 1;
+    std::printf("Rendered %u frames at %ux%u, %u triangles/frame, %u threads, %s kernel\n",
+                mOptions.FrameCount, mOptions.Width, mOptions.Height, last.SubmittedTriangles,
+                last.ThreadCount, GetRasterKernelName());
+    std::printf("  render: avg %.3f ms, max %.3f ms, %.1f fps\n", mRenderMs / frames,
+                mSlowestRenderMs, mRenderMs > 0.0 ? 1000.0 * frames / mRenderMs : 0.0);
+    std::printf("  cull:   avg %.3f ms, %.1f of %u cubes visible, %s kernel\n", cullMs / frames,
+                static_cast<double>(visibleCubes) / frames, mCuller.GetStats().Tested,
+                GetCullKernelName());
+    if (mDrawStats.InstancesTested > 0) {
+        std::printf("  scene:  %.1f of %.1f instances outside the frustum\n",
+                    static_cast<double>(mDrawStats.InstancesCulled) / frames,
+                    static_cast<double>(mDrawStats.InstancesTested) / frames);
+    }
+    const MeshletCullStats& meshlets = mDrawStats.Meshlets;
+    if (meshlets.Tested > 0) {
+        std::printf("  meshlets: avg %.3f ms, %.1f of %.1f visible, %.1f outside the frustum, "
+                    "%.1f backfacing\n",
+                    meshlets.CullMs / frames, static_cast<double>(meshlets.Visible) / frames,
+                    static_cast<double>(meshlets.Tested) / frames,
+                    static_cast<double>(meshlets.FrustumCulled) / frames,
+                    static_cast<double>(meshlets.BackfaceCulled) / frames);
+    }
+    if (mOptions.LodPixelError > 0.0f && !mScene.GetInstances().empty()) {
+        std::printf("  lods:   %.1f scene triangles/frame, draws by LOD:",
+                    static_cast<double>(mDrawStats.Triangles) / frames);
+        for (uint32_t count : mDrawStats.LodDraws) {
+            std::printf(" %u", count);
+        }
+        std::printf("\n");
+    }
+    std::printf("  pick:   avg %.3f ms including refit, screen center hit a cube in %u frames\n",
+                mPickMs / frames, mPickHits);
+    std::printf("  loop:   %.1f ms (%.1f fps), %.1f ms including writer drain\n", loopMs,
+                loopMs > 0.0 ? 1000.0 * frames / loopMs : 0.0, totalMs);
+    std::printf("  frames: %u in flight, update waited %.1f ms, render thread waited %.1f ms, "
+                "snapshot arena %.1f KB (peak %.1f KB)\n",
+                pipeline.GetSnapshotCount(), frameStats.UpdateWaitMs, frameStats.RenderWaitMs,
+                frameStats.SnapshotBytes / 1024.0, frameStats.SnapshotPeakBytes / 1024.0);
+    if (mOptions.TargetFps > 0) {
+        const FramePacerStats& paced = pacer.GetStats();
+        std::printf("  pacing: %u fps cap, slept %.1f ms, spun %.1f ms, %llu frames over budget\n",
+                    mOptions.TargetFps, paced.SleptMs, paced.SpunMs,
+                    static_cast<unsigned long long>(paced.LateFrames));
+    }
+
+    if (writer) {
+        FrameWriterStats io = writer->GetStats();
+        std::printf("  writer: %llu written, %llu dropped, %llu failed, %.1f MB, encode %.1f ms, "
+                    "write %.1f ms\n",
+                    static_cast<unsigned long long>(io.Written),
+                    static_cast<unsigned long long>(io.Dropped),
+                    static_cast<unsigned long long>(io.Failed), io.BytesWritten / (1024.0 * 1024.0),
+                    io.EncodeMs, io.WriteMs);
+        if (io.Failed > 0) {
+            return 1;
+        }
+    }
+    if (!mOptions.TracePath.empty() && !WriteTrace()) {
+        return 1;
+    }
+    if (mMeshRequest.IsValid() && mMeshRequest.GetStatus() != AssetStatus::Ready &&
+        !mMeshFailed) {
+        std::printf("  stream: %s was still loading when the run ended\n",
+                    mOptions.MeshPath.filename().string().c_str());
+    }
+    return mMeshFailed ? 1 : 0;
+}
+
+void HeadlessApplication::BuildScene() {
+    const float center = (mOptions.GridSize - 1) * 0.5f;
+    SceneHierarchy& hierarchy = mScene.GetHierarchy();
+    SceneNodeId root = hierarchy.CreateNode("Grid", mScene.GetRoot());
+    for (uint32_t z = 0; z < mOptions.GridSize; ++z) {
+        Transform rowLocal;
+        rowLocal.Translation = Vector3{0.0f, 0.0f, (z - center) * DEMO_GRID_SPACING};
+        SceneNodeId row = hierarchy.CreateNode("Row " + std::to_string(z), root, rowLocal);
+
+        for (uint32_t x = 0; x < mOptions.GridSize; ++x) {
+            Transform cubeLocal;
+            cubeLocal.Translation = Vector3{(x - center) * DEMO_GRID_SPACING, 0.0f, 0.0f};
+            mCubeNodes.push_back(hierarchy.CreateNode("Cube " + std::to_string(x), row, cubeLocal));
+        }
+    }
+    mCubeBounds.Resize(static_cast<uint32_t>(mCubeNodes.size()));
+    mCubeMeshBvh.Build(DEMO_CUBE_POSITIONS, DEMO_CUBE_INDICES, 12);
+}
+
+SceneImportSettings HeadlessApplication::GetImportSettings() const {
+    SceneImportSettings settings;
+    settings.UseMeshCache = mOptions.UseMeshCache;
+    settings.Obj.Optimize.Enabled = mOptions.OptimizeMesh;
+    return settings;
+}
+
+bool HeadlessApplication::LoadMesh() {
+    auto import = std::make_shared<SceneImport>();
+    if (!LoadSceneImport(mOptions.MeshPath, GetImportSettings(), &mRenderer->GetThreadPool(),
+                         *import)) {
+        std::printf("Failed to load mesh %s.\n", mOptions.MeshPath.string().c_str());
+        return false;
+    }
+    AttachMesh(std::move(import));
+    return true;
+}
+
+void HeadlessApplication::RequestMesh() {
+    // The main thread runs the renderer pool's queued jobs while it waits on a frame, so parse
+    // jobs queued there would stall frames; the I/O thread parses on its own.
+    mStreamer = std::make_unique<AssetStreamer>(1, STREAMED_MESH_BUDGET_BYTES);
+    AssetRequest request;
+    request.Path = mOptions.MeshPath;
+    request.Loader = MakeSceneImportLoader(GetImportSettings(), nullptr);
+    request.OnComplete = [this](const AssetHandle& Handle) {
+        if (Handle.GetStatus() == AssetStatus::Ready) {
+            std::printf("Streamed %s in after %u frames.\n",
+                        mOptions.MeshPath.filename().string().c_str(), mFramesSubmitted);
+            AttachMesh(Handle.Get<SceneImport>());
+        } else {
+            std::printf("Failed to load mesh %s.\n", mOptions.MeshPath.string().c_str());
+            mMeshFailed = true;
+        }
+    };
+    mMeshRequest = mStreamer->Request(std::move(request));
+}
+
+void HeadlessApplication::AttachMesh(std::shared_ptr<const SceneImport> Import) {
+    SceneHierarchy& hierarchy = mScene.GetHierarchy();
+    const std::string name = mOptions.MeshPath.filename().string();
+    mMeshPivot = hierarchy.CreateNode("Mesh", mScene.GetRoot());
+    const SceneNodeId fitNode = hierarchy.CreateNode("Fit", mMeshPivot);
+    GltfImportStats gltfStats;
+    AddSceneImport(Import, name, mScene, fitNode, DEMO_MESH_COLOR, &gltfStats);
+
+    if (Import->Gltf) {
+        uint64_t triangles = 0;
+        for (uint32_t i = 0; i < mScene.GetMeshCount(); ++i) {
+            triangles += mScene.GetMesh(i).GetIndexCount() / 3;
+        }
+        std::printf("Loaded %s: %u nodes, %u primitives, %llu triangles, %u materials\n",
+                    name.c_str(), gltfStats.NodeCount, gltfStats.PrimitiveCount,
+                    static_cast<unsigned long long>(triangles),
+                    static_cast<uint32_t>(Import->Gltf->GetMaterials().size()));
+        std::printf("  import: %.2f ms, %u streams mapped (%.1f MB), %u copied (%.1f MB)\n",
+                    Import->LoadMs, gltfStats.MappedStreams,
+                    gltfStats.MappedBytes / (1024.0 * 1024.0), gltfStats.CopiedStreams,
+                    gltfStats.CopiedBytes / (1024.0 * 1024.0));
+    } else {
+        const MeshCacheStats& stats = Import->MeshStats;
+        std::printf("Loaded %s: %u vertices, %u triangles\n", name.c_str(),
+                    Import->Mesh.GetVertexCount(), Import->Mesh.GetIndexCount() / 3);
+        if (stats.Hit) {
+            std::printf("  import: %.2f ms from the cooked copy\n", stats.LoadMs);
+        } else {
+            const ObjLoadStats& obj = stats.Import;
+            std::printf("  import: %.1f ms total, map %.2f ms, parse %.1f ms, merge %.1f ms, "
+                        "dedup %.1f ms, %u chunks on %u threads, %.1f MB\n",
+                        obj.TotalMs, obj.MapMs, obj.ParseMs, obj.MergeMs, obj.DedupMs,
+                        obj.ChunkCount, obj.ThreadCount, obj.FileBytes / (1024.0 * 1024.0));
+            if (mOptions.OptimizeMesh) {
+                const MeshOptimizeStats& optimize = obj.Optimize;
+                std::printf("  optimized: %.1f ms, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, "
+                            "%u clusters\n",
+                            obj.OptimizeMs, optimize.Before.Acmr, optimize.After.Acmr,
+                            optimize.Before.Atvr, optimize.After.Atvr, optimize.ClusterCount);
+            }
+            if (obj.Meshlets.MeshletCount > 0) {
+                std::printf("  meshlets: %.1f ms, %u meshlets, %.1f vertices and %.1f triangles "
+                            "each, %u with a usable cone\n",
+                            obj.MeshletMs, obj.Meshlets.MeshletCount,
+                            obj.Meshlets.AverageVertices, obj.Meshlets.AverageTriangles,
+                            obj.Meshlets.ConeCount);
+            }
+            if (obj.Lods.LodCount > 0) {
+                std::printf("  lods:   %.1f ms, %u LODs down to %u triangles, error %.4g\n",
+                            obj.LodMs, obj.Lods.LodCount, obj.Lods.CoarsestTriangles,
+                            obj.Lods.CoarsestError);
+            }
+            if (mOptions.UseMeshCache) {
+                std::printf("  cooked: %.1f ms\n", stats.CookMs);
+            }
+        }
+    }
+
+    // The pivot spins above the grid center; the fit node scales the import to a fixed size and
+    // moves its center onto the pivot. Measured while both are still at the origin.
+    hierarchy.UpdateWorldTransforms(&mRenderer->GetThreadPool());
+    const BoundingBox bounds = mScene.ComputeWorldBounds();
+    if (!IsEmpty(bounds)) {
+        const Vector3 size = bounds.Max - bounds.Min;
+        const float longest = std::max(size.X, std::max(size.Y, size.Z));
+        const float scale = longest > 0.0f ? DEMO_MESH_SIZE / longest : 1.0f;
+        Transform fit;
+        fit.Scale = Vector3{scale, scale, scale};
+        fit.Translation = GetCenter(bounds) * -scale;
+        hierarchy.SetLocalTransform(fitNode, fit);
+    }
+    Transform pivot;
+    pivot.Translation = Vector3{0.0f, DEMO_MESH_HEIGHT, 0.0f};
+    hierarchy.SetLocalTransform(mMeshPivot, pivot);
+}
+
+void HeadlessApplication::UpdateScene(uint32_t FrameIndex, FrameSnapshot& Out) {
+    PROFILE_ZONE("HeadlessApplication::UpdateScene");
+    // A grid of spinning cubes seen by a camera orbiting the grid center.
+    static const uint32_t palette[4] = {0xFFE08030, 0xFF3080E0, 0xFF40C060, 0xFFD0D040};
+
+    const float time = FrameIndex * 0.03f;
+
+    const float orbit = time * 0.5f;
+    mCamera->SetPosition(Vector3{std::sin(orbit) * 14.0f, 8.0f, -std::cos(orbit) * 14.0f});
+    mCamera->LookAt(Vector3{0.0f, 0.0f, 0.0f});
+
+    // Only the cubes' local rotations change; the hierarchy recomputes their world matrices.
+    SceneHierarchy& hierarchy = mScene.GetHierarchy();
+    const float center = (mOptions.GridSize - 1) * 0.5f;
+    for (uint32_t i = 0; i < mCubeNodes.size(); ++i) {
+        const float x = i % mOptions.GridSize - center;
+        const float z = i / mOptions.GridSize - center;
+        Transform local = hierarchy.GetLocalTransform(mCubeNodes[i]);
+        local.Rotation = QuaternionFromEuler(time + x * 0.3f, time * 1.3f + z * 0.2f, 0.0f);
+        hierarchy.SetLocalTransform(mCubeNodes[i], local);
+    }
+    if (mMeshPivot != INVALID_SCENE_NODE) {
+        Transform pivot = hierarchy.GetLocalTransform(mMeshPivot);
+        pivot.Rotation = QuaternionFromEuler(0.0f, time, 0.0f);
+        hierarchy.SetLocalTransform(mMeshPivot, pivot);
+    }
+    ThreadPool& pool = mRenderer->GetThreadPool();
+    hierarchy.UpdateWorldTransforms(&pool);
+
+    // Nothing reaches the renderer unless its bounding sphere touches the view volume.
+    for (uint32_t i = 0; i < mCubeNodes.size(); ++i) {
+        mCubeBounds.Set(i, GetTranslation(hierarchy.GetWorldMatrix(mCubeNodes[i])),
+                         DEMO_CUBE_RADIUS);
+    }
+    mCuller.Cull(mCamera->GetFrustum(), mCubeBounds, &pool, mVisibleCubes);
+
+    const uint32_t picked = PickCube(0.0f, 0.0f);
+    Out.FrameIndex = FrameIndex;
+    Out.View = *mCamera;
+    Out.Draws.reserve(mVisibleCubes.size() + mScene.GetInstances().size());
+    for (uint32_t i : mVisibleCubes) {
+        DrawItem draw;
+        draw.Positions = DEMO_CUBE_POSITIONS;
+        draw.VertexCount = 8;
+        draw.Indices = DEMO_CUBE_INDICES;
+        draw.IndexCount = 36;
+        draw.World = hierarchy.GetWorldMatrix(mCubeNodes[i]);
+        draw.Color = i == picked ? DEMO_PICKED_COLOR : palette[i % 4];
+        Out.Draws.push_back(std::move(draw));
+    }
+    SceneDrawSettings drawSettings;
+    drawSettings.CullMeshlets = mOptions.CullMeshlets;
+    drawSettings.MaxLodPixelError = mOptions.LodPixelError;
+    drawSettings.ViewportHeight = mOptions.LodPixelError > 0.0f ? mOptions.Height : 0;
+    AddSceneDraws(mScene, Out, drawSettings, &mDrawStats, &pool);
+}
+
+bool HeadlessApplication::RenderFrame(const FrameSnapshot& Snapshot, FrameWriter* Writer) {
+    PROFILE_ZONE("HeadlessApplication::RenderFrame");
+    for (const DrawItem& draw : Snapshot.Draws) {
+        mRenderer->SubmitMesh(draw.Positions, draw.VertexCount, draw.Indices, draw.IndexCount,
+                              draw.World, draw.Color);
+    }
+    Camera camera = Snapshot.View;
+    const uint32_t frame = static_cast<uint32_t>(Snapshot.FrameIndex);
+    if (!mRenderer->Draw(camera)) {
+        std::printf("Frame %u failed to render.\n", frame);
+        return false;
+    }
+
+    const SoftwareFrameStats& stats = mRenderer->GetFrameStats();
+    mRenderMs += stats.TotalMs;
+    mSlowestRenderMs = stats.TotalMs > mSlowestRenderMs ? stats.TotalMs : mSlowestRenderMs;
+    if (Writer != nullptr) {
+        const RasterTarget& target = mRenderer->GetTarget();
+        Writer->Submit(frame, target.GetColor(), target.GetWidth(), target.GetHeight(),
+                       target.GetPitch());
+    }
+    return true;
+}
+
+bool HeadlessApplication::WriteTrace() {
+#if DXMINI_PROFILER
+    const Profiler& profiler = Profiler::Get();
+    std::printf("  zones:  last %u samples each    avg ms   p99 ms   max ms    count\n",
+                Profiler::STATS_WINDOW);
+    for (const ProfileZoneStats& zone : profiler.GetZoneStats()) {
+        std::printf("    %-32s %8.3f %8.3f %8.3f %8llu\n", zone.Zone->Name, zone.AvgMs, zone.P99Ms,
+                    zone.MaxMs, static_cast<unsigned long long>(zone.Count));
+    }
+    if (!profiler.ExportChromeTrace(mOptions.TracePath)) {
+        std::printf("Failed to write %s.\n", mOptions.TracePath.string().c_str());
+        return false;
+    }
+    std::printf("  trace:  %s, %llu events dropped\n", mOptions.TracePath.string().c_str(),
+                static_cast<unsigned long long>(profiler.GetDroppedEventCount()));
+#else
+    std::printf("  trace:  not written, the profiler is compiled out\n");
+#endif
+    return true;
+}
+
+uint32_t HeadlessApplication::PickCube(float NdcX, float NdcY) {
+    PROFILE_ZONE("HeadlessApplication::PickCube");
+    const Clock::time_point start = Clock::now();
+
+    // Top level: cube boxes in world space, built once and refit as the cubes spin.
+    BoundingBox localBox{Vector3{-0.5f, -0.5f, -0.5f}, Vector3{0.5f, 0.5f, 0.5f}};
+    mCubeWorldBounds.resize(mCubeNodes.size());
+    for (uint32_t i = 0; i < mCubeNodes.size(); ++i) {
+        mCubeWorldBounds[i] =
+            TransformBounds(localBox, mScene.GetHierarchy().GetWorldMatrix(mCubeNodes[i]));
+    }
+    if (mCubeBvh.GetNodeCount() == 0) {
+        mCubeBvh.Build(mCubeWorldBounds.data(), static_cast<uint32_t>(mCubeWorldBounds.size()),
+                       &mRenderer->GetThreadPool());
+    } else {
+        mCubeBvh.Refit(mCubeWorldBounds.data());
+    }
+
+    // Bottom level: the shared cube mesh, hit with the ray moved into each candidate's space.
+    // Affine transforms keep the ray parameter, so distances compare across cubes.
+    const Ray ray = mCamera->GetPickRay(NdcX, NdcY);
+    float closest = std::numeric_limits<float>::max();
+    uint32_t picked = mCubeBvh.Intersect(ray, closest, [&](uint32_t Cube, float& InOutMaxT) {
+        const Matrix4 toLocal =
+            InverseAffine(mScene.GetHierarchy().GetWorldMatrix(mCubeNodes[Cube]));
+        const Vector4 origin = TransformPoint(toLocal, ray.Origin);
+        const Ray localRay{Vector3{origin.X, origin.Y, origin.Z},
+                           TransformDirection(toLocal, ray.Direction)};
+        RayHit hit;
+        if (!mCubeMeshBvh.IntersectRay(localRay, hit, InOutMaxT)) {
+            return false;
+        }
+        InOutMaxT = hit.T;
+        return true;
+    });
+
+    mPickMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    mPickHits += picked != INVALID_BVH_INDEX ? 1 : 0;
+    return picked;
+}
@@ -0,0 +1,100 @@
+﻿// src/HeadlessApplication.h
+// Renders a fixed number of frames offscreen, without a window or GPU, and streams them to disk.
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Assets/AssetStreamer.h"
+#include "Assets/SceneImport.h"
+#include "Files/FrameWriter.h"
+#include "Scene/Bvh.h"
+#include "Scene/Culling.h"
+#include "Scene/FrameSnapshot.h"
+#include "Scene/Scene.h"
+
+class Camera;
+class SoftwareRenderer;
+
+struct HeadlessOptions {
+    uint32_t FrameCount = 60;
+    uint32_t TargetFps = 0; // Frame rate cap; 0 renders as fast as possible
+    uint32_t Width = 1280;
+    uint32_t Height = 720;
+    uint32_t WorkerCount = 0; // 0: every core
+    bool PinWorkers = false;  // One core per renderer worker
+    uint32_t GridSize = 13;   // Demo cubes per side
+    uint32_t QueueCapacity = 8;
+    uint32_t SnapshotCount = 2; // Frames in flight; 1 renders on the main thread
+    bool WriteFrames = true;
+    FrameFormat Format = FrameFormat::Ppm;
+    FrameQueuePolicy Policy = FrameQueuePolicy::Drop;
+    std::filesystem::path OutputDirectory = "frames";
+    std::string Prefix = "frame";
+    std::filesystem::path MeshPath; // OBJ or glTF shown above the grid; empty for none
+    bool UseMeshCache = true;       // Load OBJ files through their cooked .dxmesh copy
+    bool OptimizeMesh = true;       // Reorder OBJ meshes for the vertex cache on import
+    bool CullMeshlets = true;       // Draw only the meshlets that face the camera and are in view
+    float LodPixelError = 1.0f;     // Pixels of error a LOD may show; 0 draws full meshes
+    bool StreamMesh = false;        // Load the mesh while frames render instead of before
+    std::filesystem::path TracePath; // Chrome trace of the run; empty for none
+};
+
+// Parses the headless command line. Prints usage and returns false on bad input or --help.
+bool ParseHeadlessOptions(int argc, char** argv, HeadlessOptions& OutOptions);
+
+class HeadlessApplication {
+  public:
+    explicit HeadlessApplication(HeadlessOptions Options);
+    ~HeadlessApplication();
+
+    // Renders all frames and prints throughput numbers. Returns the process exit code.
+    int Run();
+
+  private:
+    // Builds the demo hierarchy: a grid node, one node per grid row, one cube per cell.
+    void BuildScene();
+    SceneImportSettings GetImportSettings() const;
+    // Imports MeshPath and hangs it above the grid. Returns false if the import fails.
+    bool LoadMesh();
+    // Same as LoadMesh, on a streamer I/O thread; the mesh appears once Update hands it over.
+    void RequestMesh();
+    // Places a loaded import above the grid and prints its load statistics.
+    void AttachMesh(std::shared_ptr<const SceneImport> Import);
+    // Animates the demo scene for FrameIndex, culls it and fills Out with the visible cubes and
+    // the scene's instances.
+    void UpdateScene(uint32_t FrameIndex, FrameSnapshot& Out);
+    // Render thread: draws Snapshot and hands the image to Writer, which may be null.
+    bool RenderFrame(const FrameSnapshot& Snapshot, FrameWriter* Writer);
+    // Prints per-zone timings and writes the Chrome trace. Returns false if writing fails.
+    bool WriteTrace();
+    // Returns the cube under the given normalized device coordinates, or INVALID_BVH_INDEX.
+    uint32_t PickCube(float NdcX, float NdcY);
+
+    HeadlessOptions mOptions;
+    std::unique_ptr<Camera> mCamera;
+    std::unique_ptr<SoftwareRenderer> mRenderer;
+    Scene mScene; // The cubes are drawn directly; the imported mesh is the scene's instances
+    std::vector<SceneNodeId> mCubeNodes;
+    SceneNodeId mMeshPivot = INVALID_SCENE_NODE; // Spins; its child fits the mesh to the pivot
+    std::unique_ptr<AssetStreamer> mStreamer;    // Only with StreamMesh
+    AssetHandle mMeshRequest;
+    bool mMeshFailed = false;
+    uint32_t mFramesSubmitted = 0;
+    BoundingSphereSet mCubeBounds;
+    FrustumCuller mCuller;
+    std::vector<uint32_t> mVisibleCubes;
+    SceneDrawStats mDrawStats; // Summed over all frames
+    std::vector<BoundingBox> mCubeWorldBounds;
+    Bvh mCubeBvh;
+    TriangleBvh mCubeMeshBvh;
+    double mPickMs = 0.0;
+    uint32_t mPickHits = 0;
+
+    // Render thread only until the pipeline is flushed.
+    double mRenderMs = 0.0;
+    double mSlowestRenderMs = 0.0;
+};
@@ -0,0 +1,14 @@
+﻿// src/HeadlessMain.cpp
+// Entry point of the console-only DXMiniHeadless tool.
+#include "HeadlessApplication.h"
+
+int main(int argc, char** argv) {
+    HeadlessOptions options;
+    if (!ParseHeadlessOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    HeadlessApplication app(options);
+
+    return app.Run();
+}
@@ -0,0 +1,67 @@
+﻿// src/Math/Bounds.h
+// Axis-aligned boxes and rays, shared by culling, picking and asset processing.
+#pragma once
+
+#include <cmath>
+#include <limits>
+
+#include "Matrix.h"
+#include "Vector.h"
+
+// Default-constructed boxes are empty: growing one by a point yields exactly that point.
+struct BoundingBox {
+    Vector3 Min{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                std::numeric_limits<float>::max()};
+    Vector3 Max{-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(),
+                -std::numeric_limits<float>::max()};
+};
+
+struct Ray {
+    Vector3 Origin;
+    Vector3 Direction; // Need not be unit length; hit distances are in multiples of it.
+};
+
+inline bool IsEmpty(const BoundingBox& Box) {
+    return Box.Min.X > Box.Max.X || Box.Min.Y > Box.Max.Y || Box.Min.Z > Box.Max.Z;
+}
+
+inline void Grow(BoundingBox& Box, const Vector3& Point) {
+    Box.Min = Min(Box.Min, Point);
+    Box.Max = Max(Box.Max, Point);
+}
+
+inline void Grow(BoundingBox& Box, const BoundingBox& Other) {
+    Box.Min = Min(Box.Min, Other.Min);
+    Box.Max = Max(Box.Max, Other.Max);
+}
+
+inline Vector3 GetCenter(const BoundingBox& Box) {
+    return (Box.Min + Box.Max) * 0.5f;
+}
+
+inline Vector3 GetExtent(const BoundingBox& Box) {
+    return (Box.Max - Box.Min) * 0.5f;
+}
+
+// Zero for empty boxes, so SAH costs of empty partitions vanish.
+inline float SurfaceArea(const BoundingBox& Box) {
+    if (IsEmpty(Box)) {
+        return 0.0f;
+    }
+    Vector3 d = Box.Max - Box.Min;
+    return 2.0f * (d.X * d.Y + d.Y * d.Z + d.Z * d.X);
+}
+
+// Tight box around Box after transforming it by the affine M (Arvo's method).
+inline BoundingBox TransformBounds(const BoundingBox& Box, const Matrix4& M) {
+    const Vector3 center = TransformDirection(M, GetCenter(Box)) + GetTranslation(M);
+    const Vector3 extent = GetExtent(Box);
+    Vector3 radius;
+    radius.X = std::fabs(M.M[0][0]) * extent.X + std::fabs(M.M[1][0]) * extent.Y +
+               std::fabs(M.M[2][0]) * extent.Z;
+    radius.Y = std::fabs(M.M[0][1]) * extent.X + std::fabs(M.M[1][1]) * extent.Y +
+               std::fabs(M.M[2][1]) * extent.Z;
+    radius.Z = std::fabs(M.M[0][2]) * extent.X + std::fabs(M.M[1][2]) * extent.Y +
+               std::fabs(M.M[2][2]) * extent.Z;
+    return BoundingBox{center - radius, center + radius};
+}
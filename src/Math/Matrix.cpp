@@ -0,0 +1,243 @@
+﻿// src/Math/Matrix.cpp
+#include "Matrix.h"
+
+#include <cmath>
+
+Matrix4 MatrixTranslation(const Vector3& Offset) {
+    Matrix4 result;
+    result.M[3][0] = Offset.X;
+    result.M[3][1] = Offset.Y;
+    result.M[3][2] = Offset.Z;
+    return result;
+}
+
+Matrix4 MatrixScaling(const Vector3& Scale) {
+    Matrix4 result;
+    result.M[0][0] = Scale.X;
+    result.M[1][1] = Scale.Y;
+    result.M[2][2] = Scale.Z;
+    return result;
+}
+
+Matrix4 MatrixRotation(const Quaternion& Rotation) {
+    const float x = Rotation.X;
+    const float y = Rotation.Y;
+    const float z = Rotation.Z;
+    const float w = Rotation.W;
+
+    Matrix4 result;
+    result.M[0][0] = 1.0f - 2.0f * (y * y + z * z);
+    result.M[0][1] = 2.0f * (x * y + z * w);
+    result.M[0][2] = 2.0f * (x * z - y * w);
+    result.M[1][0] = 2.0f * (x * y - z * w);
+    result.M[1][1] = 1.0f - 2.0f * (x * x + z * z);
+    result.M[1][2] = 2.0f * (y * z + x * w);
+    result.M[2][0] = 2.0f * (x * z + y * w);
+    result.M[2][1] = 2.0f * (y * z - x * w);
+    result.M[2][2] = 1.0f - 2.0f * (x * x + y * y);
+    return result;
+}
+
+Matrix4 MatrixCompose(const Vector3& Translation,
+                      const Quaternion& Rotation,
+                      const Vector3& Scale) {
+    // Scaling the rotation rows directly is the same as MatrixScaling * MatrixRotation.
+    Matrix4 result = MatrixRotation(Rotation);
+    const float scale[3] = {Scale.X, Scale.Y, Scale.Z};
+    for (int row = 0; row < 3; ++row) {
+        StoreRow(result, row, Simd::Mul(LoadRow(result, row), Simd::Splat(scale[row])));
+    }
+    result.M[3][0] = Translation.X;
+    result.M[3][1] = Translation.Y;
+    result.M[3][2] = Translation.Z;
+    return result;
+}
+
+Quaternion QuaternionFromMatrix(const Matrix4& M) {
+    // Shepperd's method: branch on the largest diagonal term to keep the square root well away
+    // from zero.
+    const float(&m)[4][4] = M.M;
+    float trace = m[0][0] + m[1][1] + m[2][2];
+    Quaternion q;
+    if (trace > 0.0f) {
+        float s = std::sqrt(trace + 1.0f) * 2.0f;
+        q.W = 0.25f * s;
+        q.X = (m[1][2] - m[2][1]) / s;
+        q.Y = (m[2][0] - m[0][2]) / s;
+        q.Z = (m[0][1] - m[1][0]) / s;
+    } else if (m[0][0] > m[1][1] && m[0][0] > m[2][2]) {
+        float s = std::sqrt(1.0f + m[0][0] - m[1][1] - m[2][2]) * 2.0f;
+        q.W = (m[1][2] - m[2][1]) / s;
+        q.X = 0.25f * s;
+        q.Y = (m[1][0] + m[0][1]) / s;
+        q.Z = (m[2][0] + m[0][2]) / s;
+    } else if (m[1][1] > m[2][2]) {
+        float s = std::sqrt(1.0f + m[1][1] - m[0][0] - m[2][2]) * 2.0f;
+        q.W = (m[2][0] - m[0][2]) / s;
+        q.X = (m[1][0] + m[0][1]) / s;
+        q.Y = 0.25f * s;
+        q.Z = (m[2][1] + m[1][2]) / s;
+    } else {
+        float s = std::sqrt(1.0f + m[2][2] - m[0][0] - m[1][1]) * 2.0f;
+        q.W = (m[0][1] - m[1][0]) / s;
+        q.X = (m[2][0] + m[0][2]) / s;
+        q.Y = (m[2][1] + m[1][2]) / s;
+        q.Z = 0.25f * s;
+    }
+    return Normalize(q);
+}
+
+bool MatrixDecompose(const Matrix4& M,
+                     Vector3& OutTranslation,
+                     Quaternion& OutRotation,
+                     Vector3& OutScale) {
+    Vector3 axes[3];
+    float scale[3];
+    for (int row = 0; row < 3; ++row) {
+        axes[row] = Vector3{M.M[row][0], M.M[row][1], M.M[row][2]};
+        scale[row] = Length(axes[row]);
+        if (scale[row] < 1e-20f) {
+            return false;
+        }
+    }
+    if (Dot(Cross(axes[0], axes[1]), axes[2]) < 0.0f) {
+        scale[0] = -scale[0];
+    }
+
+    Matrix4 rotation;
+    for (int row = 0; row < 3; ++row) {
+        const Vector3 axis = axes[row] * (1.0f / scale[row]);
+        rotation.M[row][0] = axis.X;
+        rotation.M[row][1] = axis.Y;
+        rotation.M[row][2] = axis.Z;
+    }
+    OutTranslation = GetTranslation(M);
+    OutRotation = QuaternionFromMatrix(rotation);
+    OutScale = Vector3{scale[0], scale[1], scale[2]};
+    return true;
+}
+
+bool Inverse(const Matrix4& M, Matrix4& OutInverse) {
+    // Cofactor expansion through 2x2 sub-determinants of the top and bottom row pairs.
+    const float(&m)[4][4] = M.M;
+    float s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+    float s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+    float s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+    float s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+    float s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+    float s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+    float c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+    float c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+    float c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+    float c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+    float c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+    float c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+    float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if (std::fabs(det) < 1e-30f) {
+        return false;
+    }
+    float invDet = 1.0f / det;
+
+    float(&r)[4][4] = OutInverse.M;
+    r[0][0] = (m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * invDet;
+    r[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * invDet;
+    r[0][2] = (m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * invDet;
+    r[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * invDet;
+    r[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * invDet;
+    r[1][1] = (m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * invDet;
+    r[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * invDet;
+    r[1][3] = (m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * invDet;
+    r[2][0] = (m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * invDet;
+    r[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * invDet;
+    r[2][2] = (m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * invDet;
+    r[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * invDet;
+    r[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * invDet;
+    r[3][1] = (m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * invDet;
+    r[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * invDet;
+    r[3][3] = (m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * invDet;
+    return true;
+}
+
+Matrix4 InverseAffine(const Matrix4& M) {
+    // Invert the upper 3x3 through its adjugate, then carry the translation across.
+    const float(&m)[4][4] = M.M;
+    Vector3 r0{m[0][0], m[0][1], m[0][2]};
+    Vector3 r1{m[1][0], m[1][1], m[1][2]};
+    Vector3 r2{m[2][0], m[2][1], m[2][2]};
+    Vector3 c0 = Cross(r1, r2);
+    Vector3 c1 = Cross(r2, r0);
+    Vector3 c2 = Cross(r0, r1);
+    float det = Dot(r0, c0);
+    float invDet = std::fabs(det) > 1e-30f ? 1.0f / det : 0.0f;
+
+    Matrix4 result;
+    result.M[0][0] = c0.X * invDet;
+    result.M[1][0] = c0.Y * invDet;
+    result.M[2][0] = c0.Z * invDet;
+    result.M[0][1] = c1.X * invDet;
+    result.M[1][1] = c1.Y * invDet;
+    result.M[2][1] = c1.Z * invDet;
+    result.M[0][2] = c2.X * invDet;
+    result.M[1][2] = c2.Y * invDet;
+    result.M[2][2] = c2.Z * invDet;
+
+    Vector3 t = TransformDirection(result, Vector3{m[3][0], m[3][1], m[3][2]});
+    result.M[3][0] = -t.X;
+    result.M[3][1] = -t.Y;
+    result.M[3][2] = -t.Z;
+    return result;
+}
+
+Matrix4 MatrixLookTo(const Vector3& Eye, const Vector3& Forward, const Vector3& Up) {
+    Vector3 z = Normalize(Forward);
+    Vector3 x = Normalize(Cross(Up, z));
+    Vector3 y = Cross(z, x);
+
+    // The view matrix is the inverse of the camera's world transform; for an orthonormal basis
+    // that is the transposed rotation and the translation projected onto the axes.
+    Matrix4 result;
+    result.M[0][0] = x.X;
+    result.M[1][0] = x.Y;
+    result.M[2][0] = x.Z;
+    result.M[0][1] = y.X;
+    result.M[1][1] = y.Y;
+    result.M[2][1] = y.Z;
+    result.M[0][2] = z.X;
+    result.M[1][2] = z.Y;
+    result.M[2][2] = z.Z;
+    result.M[3][0] = -Dot(x, Eye);
+    result.M[3][1] = -Dot(y, Eye);
+    result.M[3][2] = -Dot(z, Eye);
+    return result;
+}
+
+Matrix4 MatrixLookAt(const Vector3& Eye, const Vector3& Target, const Vector3& Up) {
+    return MatrixLookTo(Eye, Target - Eye, Up);
+}
+
+Matrix4 MatrixPerspectiveFov(float FovY, float AspectRatio, float NearZ, float FarZ) {
+    float yScale = 1.0f / std::tan(FovY * 0.5f);
+    float xScale = yScale / AspectRatio;
+    float range = FarZ / (FarZ - NearZ);
+
+    Matrix4 result;
+    result.M[0][0] = xScale;
+    result.M[1][1] = yScale;
+    result.M[2][2] = range;
+    result.M[2][3] = 1.0f;
+    result.M[3][2] = -range * NearZ;
+    result.M[3][3] = 0.0f;
+    return result;
+}
+
+Matrix4 MatrixOrthographic(float Width, float Height, float NearZ, float FarZ) {
+    float range = 1.0f / (FarZ - NearZ);
+
+    Matrix4 result;
+    result.M[0][0] = 2.0f / Width;
+    result.M[1][1] = 2.0f / Height;
+    result.M[2][2] = range;
+    result.M[3][2] = -range * NearZ;
+    return result;
+}
@@ -0,0 +1,112 @@
+﻿// src/Math/Matrix.h
+// 4x4 matrices. Conventions match DirectXMath: row-major storage, row vectors (v' = v * M), so
+// transforms chain left to right (World * View * Projection), left-handed view space looking
+// down +Z and a [0, 1] clip-space depth range.
+#pragma once
+
+#include "Quaternion.h"
+#include "Simd.h"
+#include "Vector.h"
+
+struct alignas(16) Matrix4 {
+    float M[4][4] = {{1.0f, 0.0f, 0.0f, 0.0f},
+                     {0.0f, 1.0f, 0.0f, 0.0f},
+                     {0.0f, 0.0f, 1.0f, 0.0f},
+                     {0.0f, 0.0f, 0.0f, 1.0f}};
+
+    static Matrix4 Identity() {
+        return Matrix4{};
+    }
+};
+
+inline Simd::Float4 LoadRow(const Matrix4& Matrix, int Row) {
+    return Simd::LoadAligned(Matrix.M[Row]);
+}
+
+inline void StoreRow(Matrix4& Matrix, int Row, Simd::Float4 Value) {
+    Simd::StoreAligned(Matrix.M[Row], Value);
+}
+
+// Row vector V times M.
+inline Simd::Float4 TransformFloat4(Simd::Float4 V, const Matrix4& M) {
+    using namespace Simd;
+    Float4 r = Mul(SplatLane<0>(V), LoadRow(M, 0));
+    r = MulAdd(SplatLane<1>(V), LoadRow(M, 1), r);
+    r = MulAdd(SplatLane<2>(V), LoadRow(M, 2), r);
+    return MulAdd(SplatLane<3>(V), LoadRow(M, 3), r);
+}
+
+// A then B.
+inline Matrix4 Multiply(const Matrix4& A, const Matrix4& B) {
+    Matrix4 result;
+    for (int row = 0; row < 4; ++row) {
+        StoreRow(result, row, TransformFloat4(LoadRow(A, row), B));
+    }
+    return result;
+}
+
+inline Matrix4 operator*(const Matrix4& A, const Matrix4& B) {
+    return Multiply(A, B);
+}
+
+inline Matrix4 Transpose(const Matrix4& M) {
+    Simd::Float4 r0 = LoadRow(M, 0);
+    Simd::Float4 r1 = LoadRow(M, 1);
+    Simd::Float4 r2 = LoadRow(M, 2);
+    Simd::Float4 r3 = LoadRow(M, 3);
+    Simd::Transpose(r0, r1, r2, r3);
+    Matrix4 result;
+    StoreRow(result, 0, r0);
+    StoreRow(result, 1, r1);
+    StoreRow(result, 2, r2);
+    StoreRow(result, 3, r3);
+    return result;
+}
+
+inline Vector4 TransformPoint(const Matrix4& M, const Vector3& P) {
+    alignas(16) float out[4];
+    Simd::StoreAligned(out, TransformFloat4(Simd::Set(P.X, P.Y, P.Z, 1.0f), M));
+    return {out[0], out[1], out[2], out[3]};
+}
+
+// Ignores translation.
+inline Vector3 TransformDirection(const Matrix4& M, const Vector3& D) {
+    alignas(16) float out[4];
+    Simd::StoreAligned(out, TransformFloat4(Simd::Set(D.X, D.Y, D.Z, 0.0f), M));
+    return {out[0], out[1], out[2]};
+}
+
+inline Vector3 GetTranslation(const Matrix4& M) {
+    return {M.M[3][0], M.M[3][1], M.M[3][2]};
+}
+
+Matrix4 MatrixTranslation(const Vector3& Offset);
+Matrix4 MatrixScaling(const Vector3& Scale);
+Matrix4 MatrixRotation(const Quaternion& Rotation);
+
+// Scale, then rotate, then translate.
+Matrix4 MatrixCompose(const Vector3& Translation, const Quaternion& Rotation, const Vector3& Scale);
+
+// Rotation part of an orthonormal (unscaled) rotation matrix.
+Quaternion QuaternionFromMatrix(const Matrix4& M);
+
+// Inverse of MatrixCompose for affine matrices without shear. A mirroring matrix comes back with
+// a negative X scale. Returns false, leaving the outputs untouched, if an axis has zero length.
+bool MatrixDecompose(const Matrix4& M,
+                     Vector3& OutTranslation,
+                     Quaternion& OutRotation,
+                     Vector3& OutScale);
+
+// General inverse. Returns false and leaves OutInverse untouched for singular matrices.
+bool Inverse(const Matrix4& M, Matrix4& OutInverse);
+
+// Inverse of a matrix whose last column is (0, 0, 0, 1), i.e. rotation/scale plus translation.
+Matrix4 InverseAffine(const Matrix4& M);
+
+// View matrix looking from Eye along Forward (need not be normalized).
+Matrix4 MatrixLookTo(const Vector3& Eye, const Vector3& Forward, const Vector3& Up);
+Matrix4 MatrixLookAt(const Vector3& Eye, const Vector3& Target, const Vector3& Up);
+
+// Projections map view-space z in [NearZ, FarZ] to clip depth [0, 1].
+Matrix4 MatrixPerspectiveFov(float FovY, float AspectRatio, float NearZ, float FarZ);
+Matrix4 MatrixOrthographic(float Width, float Height, float NearZ, float FarZ);
@@ -0,0 +1,98 @@
+﻿// src/Math/Quaternion.h
+// Unit quaternions for orientations. Composition follows the row-vector convention used by
+// Matrix4: Multiply(A, B) applies A first, then B.
+#pragma once
+
+#include <cmath>
+
+#include "Simd.h"
+#include "Vector.h"
+
+struct Quaternion {
+    float X = 0.0f;
+    float Y = 0.0f;
+    float Z = 0.0f;
+    float W = 1.0f;
+};
+
+// Rotation of Angle radians around the unit-length Axis.
+inline Quaternion QuaternionFromAxisAngle(const Vector3& Axis, float Angle) {
+    float s = std::sin(Angle * 0.5f);
+    return {Axis.X * s, Axis.Y * s, Axis.Z * s, std::cos(Angle * 0.5f)};
+}
+
+// Roll around Z, then pitch around X, then yaw around Y (left-handed, Y up).
+inline Quaternion QuaternionFromEuler(float Pitch, float Yaw, float Roll) {
+    float cp = std::cos(Pitch * 0.5f);
+    float sp = std::sin(Pitch * 0.5f);
+    float cy = std::cos(Yaw * 0.5f);
+    float sy = std::sin(Yaw * 0.5f);
+    float cr = std::cos(Roll * 0.5f);
+    float sr = std::sin(Roll * 0.5f);
+    return {cr * sp * cy + sr * cp * sy, cr * cp * sy - sr * sp * cy,
+            sr * cp * cy - cr * sp * sy, cr * cp * cy + sr * sp * sy};
+}
+
+inline Quaternion Conjugate(const Quaternion& Q) {
+    return {-Q.X, -Q.Y, -Q.Z, Q.W};
+}
+
+inline float Dot(const Quaternion& A, const Quaternion& B) {
+    return A.X * B.X + A.Y * B.Y + A.Z * B.Z + A.W * B.W;
+}
+
+inline Quaternion Normalize(const Quaternion& Q) {
+    float length = std::sqrt(Dot(Q, Q));
+    if (length <= 1e-20f) {
+        return Quaternion{};
+    }
+    float inv = 1.0f / length;
+    return {Q.X * inv, Q.Y * inv, Q.Z * inv, Q.W * inv};
+}
+
+// Rotation A followed by rotation B.
+inline Quaternion Multiply(const Quaternion& A, const Quaternion& B) {
+    // Hamilton product B * A, laid out so the four lanes are computed together.
+    using namespace Simd;
+    Float4 a = Set(A.X, A.Y, A.Z, A.W);
+    Float4 r = Mul(Splat(B.W), a);
+    r = MulAdd(Splat(B.X), Set(A.W, -A.Z, A.Y, -A.X), r);
+    r = MulAdd(Splat(B.Y), Set(A.Z, A.W, -A.X, -A.Y), r);
+    r = MulAdd(Splat(B.Z), Set(-A.Y, A.X, A.W, -A.Z), r);
+    alignas(16) float out[4];
+    StoreAligned(out, r);
+    return {out[0], out[1], out[2], out[3]};
+}
+
+// Rotates V by the unit quaternion Q.
+inline Vector3 Rotate(const Quaternion& Q, const Vector3& V) {
+    // v' = v + 2w(q x v) + 2(q x (q x v))
+    Vector3 q{Q.X, Q.Y, Q.Z};
+    Vector3 t = Cross(q, V) * 2.0f;
+    return V + t * Q.W + Cross(q, t);
+}
+
+// Shortest-path spherical interpolation between unit quaternions.
+inline Quaternion Slerp(const Quaternion& A, const Quaternion& B, float T) {
+    float cosTheta = Dot(A, B);
+    Quaternion b = B;
+    if (cosTheta < 0.0f) {
+        cosTheta = -cosTheta;
+        b = {-B.X, -B.Y, -B.Z, -B.W};
+    }
+
+    float wa;
+    float wb;
+    if (cosTheta > 0.9995f) {
+        // Nearly parallel: lerp and renormalize avoids dividing by sin(~0).
+        wa = 1.0f - T;
+        wb = T;
+    } else {
+        float theta = std::acos(cosTheta);
+        float invSin = 1.0f / std::sin(theta);
+        wa = std::sin((1.0f - T) * theta) * invSin;
+        wb = std::sin(T * theta) * invSin;
+    }
+    return Normalize(Quaternion{A.X * wa + b.X * wb, A.Y * wa + b.Y * wb, A.Z * wa + b.Z * wb,
+                                A.W * wa + b.W * wb});
+}
@@ -0,0 +1,370 @@
+﻿// src/Math/Simd.h
+// Thin 4-wide float SIMD layer over SSE2, NEON or plain scalar code.
+// Everything in src/Math builds on these primitives instead of raw intrinsics.
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATH_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define MATH_SIMD_NEON 1
+#include <arm_neon.h>
+#else
+#define MATH_SIMD_SCALAR 1
+#endif
+
+namespace Simd {
+
+#if defined(MATH_SIMD_SSE2)
+
+using Float4 = __m128;
+// Lanes are all ones (true) or all zeros (false).
+using Mask4 = __m128;
+
+inline Float4 Load(const float* P) {
+    return _mm_loadu_ps(P);
+}
+// P must be 16-byte aligned.
+inline Float4 LoadAligned(const float* P) {
+    return _mm_load_ps(P);
+}
+inline void Store(float* P, Float4 V) {
+    _mm_storeu_ps(P, V);
+}
+inline void StoreAligned(float* P, Float4 V) {
+    _mm_store_ps(P, V);
+}
+inline Float4 Set(float X, float Y, float Z, float W) {
+    return _mm_setr_ps(X, Y, Z, W);
+}
+inline Float4 Splat(float V) {
+    return _mm_set1_ps(V);
+}
+inline Float4 Zero() {
+    return _mm_setzero_ps();
+}
+inline float GetX(Float4 V) {
+    return _mm_cvtss_f32(V);
+}
+
+inline Float4 Add(Float4 A, Float4 B) {
+    return _mm_add_ps(A, B);
+}
+inline Float4 Sub(Float4 A, Float4 B) {
+    return _mm_sub_ps(A, B);
+}
+inline Float4 Mul(Float4 A, Float4 B) {
+    return _mm_mul_ps(A, B);
+}
+inline Float4 Div(Float4 A, Float4 B) {
+    return _mm_div_ps(A, B);
+}
+// A * B + C
+inline Float4 MulAdd(Float4 A, Float4 B, Float4 C) {
+    return _mm_add_ps(_mm_mul_ps(A, B), C);
+}
+inline Float4 Min(Float4 A, Float4 B) {
+    return _mm_min_ps(A, B);
+}
+inline Float4 Max(Float4 A, Float4 B) {
+    return _mm_max_ps(A, B);
+}
+inline Float4 Sqrt(Float4 V) {
+    return _mm_sqrt_ps(V);
+}
+inline Float4 Abs(Float4 V) {
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), V);
+}
+inline Float4 Negate(Float4 V) {
+    return _mm_xor_ps(_mm_set1_ps(-0.0f), V);
+}
+
+template <int Lane> inline Float4 SplatLane(Float4 V) {
+    return _mm_shuffle_ps(V, V, _MM_SHUFFLE(Lane, Lane, Lane, Lane));
+}
+
+inline Mask4 CmpLt(Float4 A, Float4 B) {
+    return _mm_cmplt_ps(A, B);
+}
+inline Mask4 CmpLe(Float4 A, Float4 B) {
+    return _mm_cmple_ps(A, B);
+}
+inline Mask4 CmpGt(Float4 A, Float4 B) {
+    return _mm_cmpgt_ps(A, B);
+}
+inline Mask4 CmpGe(Float4 A, Float4 B) {
+    return _mm_cmpge_ps(A, B);
+}
+inline Mask4 And(Mask4 A, Mask4 B) {
+    return _mm_and_ps(A, B);
+}
+inline Mask4 Or(Mask4 A, Mask4 B) {
+    return _mm_or_ps(A, B);
+}
+// Per lane: Mask ? A : B
+inline Float4 Select(Mask4 Mask, Float4 A, Float4 B) {
+    return _mm_or_ps(_mm_and_ps(Mask, A), _mm_andnot_ps(Mask, B));
+}
+// Bit i is set when lane i of the mask is true.
+inline int MoveMask(Mask4 Mask) {
+    return _mm_movemask_ps(Mask);
+}
+
+inline void Transpose(Float4& R0, Float4& R1, Float4& R2, Float4& R3) {
+    _MM_TRANSPOSE4_PS(R0, R1, R2, R3);
+}
+
+#elif defined(MATH_SIMD_NEON)
+
+using Float4 = float32x4_t;
+using Mask4 = uint32x4_t;
+
+inline Float4 Load(const float* P) {
+    return vld1q_f32(P);
+}
+inline Float4 LoadAligned(const float* P) {
+    return vld1q_f32(P);
+}
+inline void Store(float* P, Float4 V) {
+    vst1q_f32(P, V);
+}
+inline void StoreAligned(float* P, Float4 V) {
+    vst1q_f32(P, V);
+}
+inline Float4 Set(float X, float Y, float Z, float W) {
+    const float v[4] = {X, Y, Z, W};
+    return vld1q_f32(v);
+}
+inline Float4 Splat(float V) {
+    return vdupq_n_f32(V);
+}
+inline Float4 Zero() {
+    return vdupq_n_f32(0.0f);
+}
+inline float GetX(Float4 V) {
+    return vgetq_lane_f32(V, 0);
+}
+
+inline Float4 Add(Float4 A, Float4 B) {
+    return vaddq_f32(A, B);
+}
+inline Float4 Sub(Float4 A, Float4 B) {
+    return vsubq_f32(A, B);
+}
+inline Float4 Mul(Float4 A, Float4 B) {
+    return vmulq_f32(A, B);
+}
+inline Float4 Div(Float4 A, Float4 B) {
+#if defined(__aarch64__) || defined(_M_ARM64)
+    return vdivq_f32(A, B);
+#else
+    Float4 r = vrecpeq_f32(B);
+    r = vmulq_f32(vrecpsq_f32(B, r), r);
+    r = vmulq_f32(vrecpsq_f32(B, r), r);
+    return vmulq_f32(A, r);
+#endif
+}
+inline Float4 MulAdd(Float4 A, Float4 B, Float4 C) {
+    return vmlaq_f32(C, A, B);
+}
+inline Float4 Min(Float4 A, Float4 B) {
+    return vminq_f32(A, B);
+}
+inline Float4 Max(Float4 A, Float4 B) {
+    return vmaxq_f32(A, B);
+}
+inline Float4 Sqrt(Float4 V) {
+#if defined(__aarch64__) || defined(_M_ARM64)
+    return vsqrtq_f32(V);
+#else
+    float v[4];
+    vst1q_f32(v, V);
+    return Set(std::sqrt(v[0]), std::sqrt(v[1]), std::sqrt(v[2]), std::sqrt(v[3]));
+#endif
+}
+inline Float4 Abs(Float4 V) {
+    return vabsq_f32(V);
+}
+inline Float4 Negate(Float4 V) {
+    return vnegq_f32(V);
+}
+
+template <int Lane> inline Float4 SplatLane(Float4 V) {
+    return vdupq_n_f32(vgetq_lane_f32(V, Lane));
+}
+
+inline Mask4 CmpLt(Float4 A, Float4 B) {
+    return vcltq_f32(A, B);
+}
+inline Mask4 CmpLe(Float4 A, Float4 B) {
+    return vcleq_f32(A, B);
+}
+inline Mask4 CmpGt(Float4 A, Float4 B) {
+    return vcgtq_f32(A, B);
+}
+inline Mask4 CmpGe(Float4 A, Float4 B) {
+    return vcgeq_f32(A, B);
+}
+inline Mask4 And(Mask4 A, Mask4 B) {
+    return vandq_u32(A, B);
+}
+inline Mask4 Or(Mask4 A, Mask4 B) {
+    return vorrq_u32(A, B);
+}
+inline Float4 Select(Mask4 Mask, Float4 A, Float4 B) {
+    return vbslq_f32(Mask, A, B);
+}
+inline int MoveMask(Mask4 Mask) {
+    return static_cast<int>((vgetq_lane_u32(Mask, 0) & 1) | (vgetq_lane_u32(Mask, 1) & 2) |
+                            (vgetq_lane_u32(Mask, 2) & 4) | (vgetq_lane_u32(Mask, 3) & 8));
+}
+
+inline void Transpose(Float4& R0, Float4& R1, Float4& R2, Float4& R3) {
+    float32x4x2_t t01 = vtrnq_f32(R0, R1);
+    float32x4x2_t t23 = vtrnq_f32(R2, R3);
+    R0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+    R1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+    R2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+    R3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+#else
+
+struct Float4 {
+    float V[4];
+};
+struct Mask4 {
+    uint32_t V[4];
+};
+
+inline Float4 Load(const float* P) {
+    return {{P[0], P[1], P[2], P[3]}};
+}
+inline Float4 LoadAligned(const float* P) {
+    return Load(P);
+}
+inline void Store(float* P, Float4 V) {
+    for (int i = 0; i < 4; ++i) {
+        P[i] = V.V[i];
+    }
+}
+inline void StoreAligned(float* P, Float4 V) {
+    Store(P, V);
+}
+inline Float4 Set(float X, float Y, float Z, float W) {
+    return {{X, Y, Z, W}};
+}
+inline Float4 Splat(float V) {
+    return {{V, V, V, V}};
+}
+inline Float4 Zero() {
+    return Splat(0.0f);
+}
+inline float GetX(Float4 V) {
+    return V.V[0];
+}
+
+#define MATH_SCALAR_LANES(Expr)                                                                    \
+    Float4 r;                                                                                      \
+    for (int i = 0; i < 4; ++i) {                                                                  \
+        r.V[i] = (Expr);                                                                           \
+    }                                                                                              \
+    return r
+
+inline Float4 Add(Float4 A, Float4 B) {
+    MATH_SCALAR_LANES(A.V[i] + B.V[i]);
+}
+inline Float4 Sub(Float4 A, Float4 B) {
+    MATH_SCALAR_LANES(A.V[i] - B.V[i]);
+}
+inline Float4 Mul(Float4 A, Float4 B) {
+    MATH_SCALAR_LANES(A.V[i] * B.V[i]);
+}
+inline Float4 Div(Float4 A, Float4 B) {
+    MATH_SCALAR_LANES(A.V[i] / B.V[i]);
+}
+inline Float4 MulAdd(Float4 A, Float4 B, Float4 C) {
+    MATH_SCALAR_LANES(A.V[i] * B.V[i] + C.V[i]);
+}
+inline Float4 Min(Float4 A, Float4 B) {
+    MATH_SCALAR_LANES(A.V[i] < B.V[i] ? A.V[i] : B.V[i]);
+}
+inline Float4 Max(Float4 A, Float4 B) {
+    MATH_SCALAR_LANES(A.V[i] > B.V[i] ? A.V[i] : B.V[i]);
+}
+inline Float4 Sqrt(Float4 V) {
+    MATH_SCALAR_LANES(std::sqrt(V.V[i]));
+}
+inline Float4 Abs(Float4 V) {
+    MATH_SCALAR_LANES(std::fabs(V.V[i]));
+}
+inline Float4 Negate(Float4 V) {
+    MATH_SCALAR_LANES(-V.V[i]);
+}
+
+#undef MATH_SCALAR_LANES
+
+template <int Lane> inline Float4 SplatLane(Float4 V) {
+    return Splat(V.V[Lane]);
+}
+
+#define MATH_SCALAR_COMPARE(Op)                                                                    \
+    Mask4 r;                                                                                       \
+    for (int i = 0; i < 4; ++i) {                                                                  \
+        r.V[i] = (A.V[i] Op B.V[i]) ? 0xFFFFFFFFu : 0u;                                            \
+    }                                                                                              \
+    return r
+
+inline Mask4 CmpLt(Float4 A, Float4 B) {
+    MATH_SCALAR_COMPARE(<);
+}
+inline Mask4 CmpLe(Float4 A, Float4 B) {
+    MATH_SCALAR_COMPARE(<=);
+}
+inline Mask4 CmpGt(Float4 A, Float4 B) {
+    MATH_SCALAR_COMPARE(>);
+}
+inline Mask4 CmpGe(Float4 A, Float4 B) {
+    MATH_SCALAR_COMPARE(>=);
+}
+
+#undef MATH_SCALAR_COMPARE
+
+inline Mask4 And(Mask4 A, Mask4 B) {
+    return {{A.V[0] & B.V[0], A.V[1] & B.V[1], A.V[2] & B.V[2], A.V[3] & B.V[3]}};
+}
+inline Mask4 Or(Mask4 A, Mask4 B) {
+    return {{A.V[0] | B.V[0], A.V[1] | B.V[1], A.V[2] | B.V[2], A.V[3] | B.V[3]}};
+}
+inline Float4 Select(Mask4 Mask, Float4 A, Float4 B) {
+    Float4 r;
+    for (int i = 0; i < 4; ++i) {
+        r.V[i] = Mask.V[i] ? A.V[i] : B.V[i];
+    }
+    return r;
+}
+inline int MoveMask(Mask4 Mask) {
+    return (Mask.V[0] & 1) | (Mask.V[1] & 2) | (Mask.V[2] & 4) | (Mask.V[3] & 8);
+}
+
+inline void Transpose(Float4& R0, Float4& R1, Float4& R2, Float4& R3) {
+    Float4 rows[4] = {R0, R1, R2, R3};
+    R0 = {{rows[0].V[0], rows[1].V[0], rows[2].V[0], rows[3].V[0]}};
+    R1 = {{rows[0].V[1], rows[1].V[1], rows[2].V[1], rows[3].V[1]}};
+    R2 = {{rows[0].V[2], rows[1].V[2], rows[2].V[2], rows[3].V[2]}};
+    R3 = {{rows[0].V[3], rows[1].V[3], rows[2].V[3], rows[3].V[3]}};
+}
+
+#endif
+
+// Horizontal sum of all four lanes.
+inline float HorizontalAdd(Float4 V) {
+    alignas(16) float lanes[4];
+    StoreAligned(lanes, V);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+} // namespace Simd
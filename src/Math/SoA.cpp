@@ -0,0 +1,38 @@
+﻿// src/Math/SoA.cpp
+#include "SoA.h"
+
+void TransformPointArray(const Matrix4& M, const Vector3* Points, size_t Count, Vector4* Out) {
+    size_t i = 0;
+    for (; i + 4 <= Count; i += 4) {
+        Store4x4(TransformPoints(M, Load3x4(Points + i)), Out + i);
+    }
+    for (; i < Count; ++i) {
+        Out[i] = TransformPoint(M, Points[i]);
+    }
+}
+
+void TransformPointArraySoA(const Matrix4& M,
+                            const float* X,
+                            const float* Y,
+                            const float* Z,
+                            size_t Count,
+                            float* OutX,
+                            float* OutY,
+                            float* OutZ,
+                            float* OutW) {
+    size_t i = 0;
+    for (; i + 4 <= Count; i += 4) {
+        Float4x4 r = TransformPoints(M, Load3x4(X + i, Y + i, Z + i));
+        Simd::Store(OutX + i, r.X);
+        Simd::Store(OutY + i, r.Y);
+        Simd::Store(OutZ + i, r.Z);
+        Simd::Store(OutW + i, r.W);
+    }
+    for (; i < Count; ++i) {
+        Vector4 r = TransformPoint(M, Vector3{X[i], Y[i], Z[i]});
+        OutX[i] = r.X;
+        OutY[i] = r.Y;
+        OutZ[i] = r.Z;
+        OutW[i] = r.W;
+    }
+}
@@ -0,0 +1,162 @@
+﻿// src/Math/SoA.h
+// 4-wide structure-of-arrays batches: each Float4 holds one component of four different vectors,
+// so per-object transform/cull/projection loops run four objects per instruction.
+#pragma once
+
+#include <cstddef>
+
+#include "Matrix.h"
+#include "Quaternion.h"
+#include "Simd.h"
+#include "Vector.h"
+
+struct Float3x4 {
+    Simd::Float4 X;
+    Simd::Float4 Y;
+    Simd::Float4 Z;
+};
+
+struct Float4x4 {
+    Simd::Float4 X;
+    Simd::Float4 Y;
+    Simd::Float4 Z;
+    Simd::Float4 W;
+};
+
+struct Quaternion4 {
+    Simd::Float4 X;
+    Simd::Float4 Y;
+    Simd::Float4 Z;
+    Simd::Float4 W;
+};
+
+inline Float3x4 Load3x4(const float* X, const float* Y, const float* Z) {
+    return {Simd::Load(X), Simd::Load(Y), Simd::Load(Z)};
+}
+
+inline void Store3x4(const Float3x4& V, float* X, float* Y, float* Z) {
+    Simd::Store(X, V.X);
+    Simd::Store(Y, V.Y);
+    Simd::Store(Z, V.Z);
+}
+
+// Gathers four AoS vectors into SoA form.
+inline Float3x4 Load3x4(const Vector3* V) {
+    Simd::Float4 r0 = Simd::Set(V[0].X, V[0].Y, V[0].Z, 0.0f);
+    Simd::Float4 r1 = Simd::Set(V[1].X, V[1].Y, V[1].Z, 0.0f);
+    Simd::Float4 r2 = Simd::Set(V[2].X, V[2].Y, V[2].Z, 0.0f);
+    Simd::Float4 r3 = Simd::Set(V[3].X, V[3].Y, V[3].Z, 0.0f);
+    Simd::Transpose(r0, r1, r2, r3);
+    return {r0, r1, r2};
+}
+
+// Scatters four SoA vectors back into AoS form.
+inline void Store4x4(const Float4x4& V, Vector4* Out) {
+    Simd::Float4 r0 = V.X;
+    Simd::Float4 r1 = V.Y;
+    Simd::Float4 r2 = V.Z;
+    Simd::Float4 r3 = V.W;
+    Simd::Transpose(r0, r1, r2, r3);
+    Simd::Store(&Out[0].X, r0);
+    Simd::Store(&Out[1].X, r1);
+    Simd::Store(&Out[2].X, r2);
+    Simd::Store(&Out[3].X, r3);
+}
+
+inline Float3x4 Add(const Float3x4& A, const Float3x4& B) {
+    return {Simd::Add(A.X, B.X), Simd::Add(A.Y, B.Y), Simd::Add(A.Z, B.Z)};
+}
+
+inline Float3x4 Sub(const Float3x4& A, const Float3x4& B) {
+    return {Simd::Sub(A.X, B.X), Simd::Sub(A.Y, B.Y), Simd::Sub(A.Z, B.Z)};
+}
+
+inline Float3x4 Scale(const Float3x4& V, Simd::Float4 S) {
+    return {Simd::Mul(V.X, S), Simd::Mul(V.Y, S), Simd::Mul(V.Z, S)};
+}
+
+inline Simd::Float4 Dot(const Float3x4& A, const Float3x4& B) {
+    return Simd::MulAdd(A.Z, B.Z, Simd::MulAdd(A.Y, B.Y, Simd::Mul(A.X, B.X)));
+}
+
+inline Float3x4 Cross(const Float3x4& A, const Float3x4& B) {
+    using namespace Simd;
+    return {Sub(Mul(A.Y, B.Z), Mul(A.Z, B.Y)), Sub(Mul(A.Z, B.X), Mul(A.X, B.Z)),
+            Sub(Mul(A.X, B.Y), Mul(A.Y, B.X))};
+}
+
+inline Simd::Float4 Length(const Float3x4& V) {
+    return Simd::Sqrt(Dot(V, V));
+}
+
+// Four points (w = 1) times M.
+inline Float4x4 TransformPoints(const Matrix4& M, const Float3x4& P) {
+    using namespace Simd;
+    const float(&m)[4][4] = M.M;
+    Float4x4 r;
+    r.X = MulAdd(P.X, Splat(m[0][0]),
+                 MulAdd(P.Y, Splat(m[1][0]), MulAdd(P.Z, Splat(m[2][0]), Splat(m[3][0]))));
+    r.Y = MulAdd(P.X, Splat(m[0][1]),
+                 MulAdd(P.Y, Splat(m[1][1]), MulAdd(P.Z, Splat(m[2][1]), Splat(m[3][1]))));
+    r.Z = MulAdd(P.X, Splat(m[0][2]),
+                 MulAdd(P.Y, Splat(m[1][2]), MulAdd(P.Z, Splat(m[2][2]), Splat(m[3][2]))));
+    r.W = MulAdd(P.X, Splat(m[0][3]),
+                 MulAdd(P.Y, Splat(m[1][3]), MulAdd(P.Z, Splat(m[2][3]), Splat(m[3][3]))));
+    return r;
+}
+
+// Four points times M, dropping w. Only meaningful for affine M.
+inline Float3x4 TransformPointsAffine(const Matrix4& M, const Float3x4& P) {
+    Float4x4 r = TransformPoints(M, P);
+    return {r.X, r.Y, r.Z};
+}
+
+// Four directions (w = 0) times M.
+inline Float3x4 TransformDirections(const Matrix4& M, const Float3x4& D) {
+    using namespace Simd;
+    const float(&m)[4][4] = M.M;
+    return {MulAdd(D.X, Splat(m[0][0]), MulAdd(D.Y, Splat(m[1][0]), Mul(D.Z, Splat(m[2][0])))),
+            MulAdd(D.X, Splat(m[0][1]), MulAdd(D.Y, Splat(m[1][1]), Mul(D.Z, Splat(m[2][1])))),
+            MulAdd(D.X, Splat(m[0][2]), MulAdd(D.Y, Splat(m[1][2]), Mul(D.Z, Splat(m[2][2]))))};
+}
+
+inline Quaternion4 Load4(const Quaternion* Q) {
+    Simd::Float4 r0 = Simd::Load(&Q[0].X);
+    Simd::Float4 r1 = Simd::Load(&Q[1].X);
+    Simd::Float4 r2 = Simd::Load(&Q[2].X);
+    Simd::Float4 r3 = Simd::Load(&Q[3].X);
+    Simd::Transpose(r0, r1, r2, r3);
+    return {r0, r1, r2, r3};
+}
+
+// Four vectors rotated by four unit quaternions.
+inline Float3x4 Rotate(const Quaternion4& Q, const Float3x4& V) {
+    Float3x4 q{Q.X, Q.Y, Q.Z};
+    Float3x4 t = Scale(Cross(q, V), Simd::Splat(2.0f));
+    return Add(Add(V, Scale(t, Q.W)), Cross(q, t));
+}
+
+// Four rotations, each Ai followed by Bi.
+inline Quaternion4 Multiply(const Quaternion4& A, const Quaternion4& B) {
+    using namespace Simd;
+    return {Sub(MulAdd(B.W, A.X, MulAdd(B.X, A.W, Mul(B.Y, A.Z))), Mul(B.Z, A.Y)),
+            Add(Sub(Mul(B.W, A.Y), Mul(B.X, A.Z)), MulAdd(B.Y, A.W, Mul(B.Z, A.X))),
+            Add(MulAdd(B.W, A.Z, Mul(B.X, A.Y)), Sub(Mul(B.Z, A.W), Mul(B.Y, A.X))),
+            Sub(Sub(Mul(B.W, A.W), Mul(B.X, A.X)), Add(Mul(B.Y, A.Y), Mul(B.Z, A.Z)))};
+}
+
+// Batch helpers over whole arrays. Counts need not be multiples of four.
+
+// Out[i] = Points[i] * M with w = 1.
+void TransformPointArray(const Matrix4& M, const Vector3* Points, size_t Count, Vector4* Out);
+
+// Same over separate X/Y/Z arrays, writing homogeneous X/Y/Z/W arrays.
+void TransformPointArraySoA(const Matrix4& M,
+                            const float* X,
+                            const float* Y,
+                            const float* Z,
+                            size_t Count,
+                            float* OutX,
+                            float* OutY,
+                            float* OutZ,
+                            float* OutW);
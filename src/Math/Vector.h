@@ -0,0 +1,66 @@
+﻿// src/Math/Vector.h
+// Plain storage vectors used in scene data, with the handful of scalar helpers the scene code
+// needs. Bulk work goes through the SoA batches in Math/SoA.h instead.
+#pragma once
+
+#include <cmath>
+
+struct Vector2 {
+    float X = 0.0f;
+    float Y = 0.0f;
+};
+
+struct Vector3 {
+    float X = 0.0f;
+    float Y = 0.0f;
+    float Z = 0.0f;
+};
+
+struct Vector4 {
+    float X = 0.0f;
+    float Y = 0.0f;
+    float Z = 0.0f;
+    float W = 0.0f;
+};
+
+inline Vector3 operator+(const Vector3& A, const Vector3& B) {
+    return {A.X + B.X, A.Y + B.Y, A.Z + B.Z};
+}
+inline Vector3 operator-(const Vector3& A, const Vector3& B) {
+    return {A.X - B.X, A.Y - B.Y, A.Z - B.Z};
+}
+inline Vector3 operator-(const Vector3& V) {
+    return {-V.X, -V.Y, -V.Z};
+}
+inline Vector3 operator*(const Vector3& V, float S) {
+    return {V.X * S, V.Y * S, V.Z * S};
+}
+inline Vector3 operator*(float S, const Vector3& V) {
+    return V * S;
+}
+
+inline float Dot(const Vector3& A, const Vector3& B) {
+    return A.X * B.X + A.Y * B.Y + A.Z * B.Z;
+}
+
+inline Vector3 Cross(const Vector3& A, const Vector3& B) {
+    return {A.Y * B.Z - A.Z * B.Y, A.Z * B.X - A.X * B.Z, A.X * B.Y - A.Y * B.X};
+}
+
+inline float Length(const Vector3& V) {
+    return std::sqrt(Dot(V, V));
+}
+
+// Returns V unchanged when it is (nearly) zero length.
+inline Vector3 Normalize(const Vector3& V) {
+    float length = Length(V);
+    return length > 1e-20f ? V * (1.0f / length) : V;
+}
+
+inline Vector3 Min(const Vector3& A, const Vector3& B) {
+    return {A.X < B.X ? A.X : B.X, A.Y < B.Y ? A.Y : B.Y, A.Z < B.Z ? A.Z : B.Z};
+}
+
+inline Vector3 Max(const Vector3& A, const Vector3& B) {
+    return {A.X > B.X ? A.X : B.X, A.Y > B.Y ? A.Y : B.Y, A.Z > B.Z ? A.Z : B.Z};
+}
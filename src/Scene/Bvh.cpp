@@ -0,0 +1,543 @@
+﻿// src/Scene/Bvh.cpp
+#include "Bvh.h"
+
+#include <algorithm>
+#include <deque>
+
+#include "Common/ThreadPool.h"
+
+namespace {
+
+constexpr uint32_t SAH_BIN_COUNT = 16;
+
+// Nodes this small become leaves whenever SAH says splitting does not pay off.
+constexpr uint32_t MAX_LEAF_SIZE = 8;
+
+// Past this depth everything left becomes a leaf. Keeps traversal stacks fixed-size.
+constexpr uint32_t MAX_BVH_DEPTH = 64;
+
+// Cost of visiting a node relative to testing one primitive.
+constexpr float SAH_TRAVERSAL_COST = 1.0f;
+
+// Ranges at least this large bin and reduce bounds across the pool in chunks of this size.
+constexpr uint32_t PARALLEL_BIN_MIN = 1u << 16;
+constexpr uint32_t PARALLEL_BIN_CHUNK = 1u << 14;
+
+// Subtrees at most this large are handed to a single thread.
+constexpr uint32_t PARALLEL_SUBTREE_MIN = 4096;
+
+struct SahBin {
+    BoundingBox Bounds;
+    uint32_t Count = 0;
+};
+
+using SahBins = SahBin[3][SAH_BIN_COUNT];
+
+} // anonymous namespace
+
+// Scratch state of one Bvh::Build call.
+class BvhBuilder {
+  public:
+    BvhBuilder(Bvh& Target, const BoundingBox* Bounds, uint32_t Count)
+        : mBounds(Bounds), mIndices(Target.mPrimitiveIndices.data()),
+          mCentroids(Count) {
+        for (uint32_t i = 0; i < Count; ++i) {
+            mCentroids[i] = GetCenter(Bounds[i]);
+        }
+    }
+
+    // Builds the subtree under Nodes[Root] over index entries [First, First + Count).
+    void BuildSubtree(std::vector<BvhNode>& Nodes,
+                      uint32_t Root,
+                      uint32_t First,
+                      uint32_t Count,
+                      uint32_t Depth) {
+        struct Task {
+            uint32_t Node;
+            uint32_t First;
+            uint32_t Count;
+            uint32_t Depth;
+        };
+        std::vector<Task> stack;
+        stack.push_back({Root, First, Count, Depth});
+        while (!stack.empty()) {
+            Task task = stack.back();
+            stack.pop_back();
+
+            BoundingBox bounds;
+            uint32_t leftCount = 0;
+            bool split = SplitRange(task.First, task.Count, task.Depth, nullptr, bounds, leftCount);
+            Nodes[task.Node].Bounds = bounds;
+            if (!split) {
+                Nodes[task.Node].LeftFirst = task.First;
+                Nodes[task.Node].Count = task.Count;
+                continue;
+            }
+
+            const uint32_t left = static_cast<uint32_t>(Nodes.size());
+            Nodes.resize(Nodes.size() + 2);
+            Nodes[task.Node].LeftFirst = left;
+            Nodes[task.Node].Count = 0;
+            stack.push_back({left + 1, task.First + leftCount, task.Count - leftCount,
+                             task.Depth + 1});
+            stack.push_back({left, task.First, leftCount, task.Depth + 1});
+        }
+    }
+
+    // Computes the range's bounds and, unless it should be a leaf, partitions it at the best SAH
+    // plane. Returns false for leaves.
+    bool SplitRange(uint32_t First,
+                    uint32_t Count,
+                    uint32_t Depth,
+                    ThreadPool* Pool,
+                    BoundingBox& OutBounds,
+                    uint32_t& OutLeftCount) {
+        BoundingBox centroidBounds;
+        ComputeRangeBounds(First, Count, Pool, OutBounds, centroidBounds);
+        if (Count <= 1 || Depth >= MAX_BVH_DEPTH) {
+            return false;
+        }
+
+        const Vector3 extent = centroidBounds.Max - centroidBounds.Min;
+        const float extents[3] = {extent.X, extent.Y, extent.Z};
+        const float minimums[3] = {centroidBounds.Min.X, centroidBounds.Min.Y,
+                                   centroidBounds.Min.Z};
+
+        SahBins bins;
+        BinRange(First, Count, centroidBounds, Pool, bins);
+
+        // Sweep each axis: prefix from the left, suffix from the right.
+        float bestCost = std::numeric_limits<float>::max();
+        int bestAxis = -1;
+        uint32_t bestBin = 0;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (extents[axis] <= 0.0f) {
+                continue;
+            }
+            float leftArea[SAH_BIN_COUNT - 1];
+            uint32_t leftCount[SAH_BIN_COUNT - 1];
+            BoundingBox box;
+            uint32_t count = 0;
+            for (uint32_t b = 0; b < SAH_BIN_COUNT - 1; ++b) {
+                Grow(box, bins[axis][b].Bounds);
+                count += bins[axis][b].Count;
+                leftArea[b] = SurfaceArea(box);
+                leftCount[b] = count;
+            }
+            box = BoundingBox{};
+            count = 0;
+            for (uint32_t b = SAH_BIN_COUNT - 1; b > 0; --b) {
+                Grow(box, bins[axis][b].Bounds);
+                count += bins[axis][b].Count;
+                float cost = leftArea[b - 1] * leftCount[b - 1] + SurfaceArea(box) * count;
+                if (leftCount[b - 1] > 0 && count > 0 && cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = b;
+                }
+            }
+        }
+
+        const float parentArea = SurfaceArea(OutBounds);
+        const float splitCost =
+            SAH_TRAVERSAL_COST + (parentArea > 0.0f ? bestCost / parentArea : 0.0f);
+        if (bestAxis < 0) {
+            // Every centroid coincides. Only worth splitting, arbitrarily, if the leaf is huge.
+            if (Count <= MAX_LEAF_SIZE) {
+                return false;
+            }
+            OutLeftCount = Count / 2;
+            return true;
+        }
+        if (Count <= MAX_LEAF_SIZE && splitCost >= static_cast<float>(Count)) {
+            return false;
+        }
+
+        const float scale = SAH_BIN_COUNT / extents[bestAxis];
+        const float minimum = minimums[bestAxis];
+        const Vector3* centroids = mCentroids.data();
+        uint32_t* middle = std::partition(
+            mIndices + First, mIndices + First + Count, [=](uint32_t Primitive) {
+                const float* c = &centroids[Primitive].X;
+                return BinIndex(c[bestAxis], minimum, scale) < bestBin;
+            });
+        OutLeftCount = static_cast<uint32_t>(middle - (mIndices + First));
+        if (OutLeftCount == 0 || OutLeftCount == Count) {
+            OutLeftCount = Count / 2;
+        }
+        return true;
+    }
+
+  private:
+    static uint32_t BinIndex(float Value, float Minimum, float Scale) {
+        int32_t bin = static_cast<int32_t>((Value - Minimum) * Scale);
+        return static_cast<uint32_t>(std::min(std::max(bin, 0), int32_t(SAH_BIN_COUNT) - 1));
+    }
+
+    void ComputeRangeBounds(uint32_t First,
+                            uint32_t Count,
+                            ThreadPool* Pool,
+                            BoundingBox& OutBounds,
+                            BoundingBox& OutCentroidBounds) {
+        auto reduce = [this](uint32_t Begin, uint32_t End, BoundingBox& Bounds,
+                             BoundingBox& Centroids) {
+            for (uint32_t i = Begin; i < End; ++i) {
+                Grow(Bounds, mBounds[mIndices[i]]);
+                Grow(Centroids, mCentroids[mIndices[i]]);
+            }
+        };
+
+        OutBounds = BoundingBox{};
+        OutCentroidBounds = BoundingBox{};
+        if (Pool == nullptr || Count < PARALLEL_BIN_MIN) {
+            reduce(First, First + Count, OutBounds, OutCentroidBounds);
+            return;
+        }
+
+        const uint32_t chunks = (Count + PARALLEL_BIN_CHUNK - 1) / PARALLEL_BIN_CHUNK;
+        std::vector<BoundingBox> bounds(chunks);
+        std::vector<BoundingBox> centroids(chunks);
+        Pool->ParallelFor(chunks, [&](uint32_t Chunk, uint32_t) {
+            const uint32_t begin = First + Chunk * PARALLEL_BIN_CHUNK;
+            const uint32_t end = std::min(begin + PARALLEL_BIN_CHUNK, First + Count);
+            reduce(begin, end, bounds[Chunk], centroids[Chunk]);
+        });
+        for (uint32_t c = 0; c < chunks; ++c) {
+            Grow(OutBounds, bounds[c]);
+            Grow(OutCentroidBounds, centroids[c]);
+        }
+    }
+
+    void BinRange(uint32_t First,
+                  uint32_t Count,
+                  const BoundingBox& CentroidBounds,
+                  ThreadPool* Pool,
+                  SahBins& OutBins) {
+        const Vector3 extent = CentroidBounds.Max - CentroidBounds.Min;
+        const float scales[3] = {extent.X > 0.0f ? SAH_BIN_COUNT / extent.X : 0.0f,
+                                 extent.Y > 0.0f ? SAH_BIN_COUNT / extent.Y : 0.0f,
+                                 extent.Z > 0.0f ? SAH_BIN_COUNT / extent.Z : 0.0f};
+        const float minimums[3] = {CentroidBounds.Min.X, CentroidBounds.Min.Y,
+                                   CentroidBounds.Min.Z};
+
+        auto bin = [&](uint32_t Begin, uint32_t End, SahBins& Bins) {
+            for (uint32_t i = Begin; i < End; ++i) {
+                const uint32_t primitive = mIndices[i];
+                const float* c = &mCentroids[primitive].X;
+                for (int axis = 0; axis < 3; ++axis) {
+                    SahBin& target = Bins[axis][BinIndex(c[axis], minimums[axis], scales[axis])];
+                    Grow(target.Bounds, mBounds[primitive]);
+                    ++target.Count;
+                }
+            }
+        };
+
+        for (auto& axisBins : OutBins) {
+            for (SahBin& b : axisBins) {
+                b = SahBin{};
+            }
+        }
+        if (Pool == nullptr || Count < PARALLEL_BIN_MIN) {
+            bin(First, First + Count, OutBins);
+            return;
+        }
+
+        const uint32_t chunks = (Count + PARALLEL_BIN_CHUNK - 1) / PARALLEL_BIN_CHUNK;
+        std::vector<SahBin> partial(static_cast<size_t>(chunks) * 3 * SAH_BIN_COUNT);
+        Pool->ParallelFor(chunks, [&](uint32_t Chunk, uint32_t) {
+            const uint32_t begin = First + Chunk * PARALLEL_BIN_CHUNK;
+            const uint32_t end = std::min(begin + PARALLEL_BIN_CHUNK, First + Count);
+            bin(begin, end, *reinterpret_cast<SahBins*>(&partial[Chunk * 3 * SAH_BIN_COUNT]));
+        });
+        for (uint32_t c = 0; c < chunks; ++c) {
+            const SahBins& chunkBins = *reinterpret_cast<SahBins*>(&partial[c * 3 * SAH_BIN_COUNT]);
+            for (int axis = 0; axis < 3; ++axis) {
+                for (uint32_t b = 0; b < SAH_BIN_COUNT; ++b) {
+                    Grow(OutBins[axis][b].Bounds, chunkBins[axis][b].Bounds);
+                    OutBins[axis][b].Count += chunkBins[axis][b].Count;
+                }
+            }
+        }
+    }
+
+    const BoundingBox* mBounds;
+    uint32_t* mIndices;
+    std::vector<Vector3> mCentroids;
+};
+
+Bvh::Bvh() = default;
+
+Bvh::~Bvh() = default;
+
+bool Bvh::Build(const BoundingBox* Bounds, uint32_t Count, ThreadPool* Pool) {
+    mNodes.clear();
+    mWideNodes.clear();
+    mWideSource.clear();
+    mPrimitiveIndices.resize(Count);
+    if (Count == 0) {
+        return false;
+    }
+    for (uint32_t i = 0; i < Count; ++i) {
+        mPrimitiveIndices[i] = i;
+    }
+
+    BvhBuilder builder(*this, Bounds, Count);
+    mNodes.reserve(2 * static_cast<size_t>(Count));
+    mNodes.resize(1);
+
+    const uint32_t threads = Pool ? Pool->GetThreadCount() : 1;
+    if (threads == 1 || Count <= PARALLEL_SUBTREE_MIN) {
+        builder.BuildSubtree(mNodes, 0, 0, Count, 0);
+    } else {
+        struct Task {
+            uint32_t Node;
+            uint32_t First;
+            uint32_t Count;
+            uint32_t Depth;
+        };
+
+        // Split breadth-first, binning each big node across the pool, until there are enough
+        // independent subtrees to keep every thread busy.
+        const size_t targetTasks = static_cast<size_t>(threads) * 8;
+        std::deque<Task> pending;
+        std::vector<Task> tasks;
+        pending.push_back({0, 0, Count, 0});
+        while (!pending.empty()) {
+            Task task = pending.front();
+            pending.pop_front();
+            if (task.Count <= PARALLEL_SUBTREE_MIN ||
+                pending.size() + tasks.size() + 1 >= targetTasks) {
+                tasks.push_back(task);
+                continue;
+            }
+
+            BoundingBox bounds;
+            uint32_t leftCount = 0;
+            bool split =
+                builder.SplitRange(task.First, task.Count, task.Depth, Pool, bounds, leftCount);
+            mNodes[task.Node].Bounds = bounds;
+            if (!split) {
+                mNodes[task.Node].LeftFirst = task.First;
+                mNodes[task.Node].Count = task.Count;
+                continue;
+            }
+            const uint32_t left = static_cast<uint32_t>(mNodes.size());
+            mNodes.resize(mNodes.size() + 2);
+            mNodes[task.Node].LeftFirst = left;
+            mNodes[task.Node].Count = 0;
+            pending.push_back({left, task.First, leftCount, task.Depth + 1});
+            pending.push_back(
+                {left + 1, task.First + leftCount, task.Count - leftCount, task.Depth + 1});
+        }
+
+        std::vector<std::vector<BvhNode>> subtrees(tasks.size());
+        Pool->ParallelFor(static_cast<uint32_t>(tasks.size()), [&](uint32_t Index, uint32_t) {
+            const Task& task = tasks[Index];
+            subtrees[Index].resize(1);
+            builder.BuildSubtree(subtrees[Index], 0, task.First, task.Count, task.Depth);
+        });
+
+        // Each subtree root replaces its placeholder; the rest is appended with child links
+        // rebased. Children still come after their parents, which Refit relies on.
+        for (size_t t = 0; t < tasks.size(); ++t) {
+            const std::vector<BvhNode>& local = subtrees[t];
+            const uint32_t base = static_cast<uint32_t>(mNodes.size()) - 1;
+            for (size_t i = 0; i < local.size(); ++i) {
+                BvhNode node = local[i];
+                if (node.Count == 0) {
+                    node.LeftFirst += base;
+                }
+                if (i == 0) {
+                    mNodes[tasks[t].Node] = node;
+                } else {
+                    mNodes.push_back(node);
+                }
+            }
+        }
+    }
+
+    Collapse(0);
+    return true;
+}
+
+uint32_t Bvh::Collapse(uint32_t Node) {
+    // Open the largest interior slot until four are filled, which keeps big boxes, the ones
+    // rays hit most, from costing an extra level.
+    uint32_t slots[4];
+    uint32_t slotCount = 0;
+    if (mNodes[Node].Count > 0) {
+        slots[slotCount++] = Node;
+    } else {
+        slots[slotCount++] = mNodes[Node].LeftFirst;
+        slots[slotCount++] = mNodes[Node].LeftFirst + 1;
+    }
+    while (slotCount < 4) {
+        int best = -1;
+        float bestArea = -1.0f;
+        for (uint32_t s = 0; s < slotCount; ++s) {
+            const BvhNode& node = mNodes[slots[s]];
+            float area = SurfaceArea(node.Bounds);
+            if (node.Count == 0 && area > bestArea) {
+                best = static_cast<int>(s);
+                bestArea = area;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        const uint32_t left = mNodes[slots[best]].LeftFirst;
+        slots[best] = left;
+        slots[slotCount++] = left + 1;
+    }
+
+    const uint32_t wide = static_cast<uint32_t>(mWideNodes.size());
+    mWideNodes.push_back(BvhWideNode{});
+    mWideSource.resize(mWideSource.size() + 4, INVALID_BVH_INDEX);
+
+    for (uint32_t s = 0; s < 4; ++s) {
+        BvhWideNode& target = mWideNodes[wide];
+        if (s >= slotCount) {
+            target.Child[s] = INVALID_BVH_INDEX;
+            target.Count[s] = 0;
+            continue;
+        }
+        const BvhNode& source = mNodes[slots[s]];
+        target.MinX[s] = source.Bounds.Min.X;
+        target.MinY[s] = source.Bounds.Min.Y;
+        target.MinZ[s] = source.Bounds.Min.Z;
+        target.MaxX[s] = source.Bounds.Max.X;
+        target.MaxY[s] = source.Bounds.Max.Y;
+        target.MaxZ[s] = source.Bounds.Max.Z;
+        target.Count[s] = source.Count;
+        mWideSource[wide * 4 + s] = slots[s];
+        if (source.Count > 0) {
+            target.Child[s] = source.LeftFirst;
+        } else {
+            // Recursion may reallocate mWideNodes, so write through the index afterwards.
+            const uint32_t child = Collapse(slots[s]);
+            mWideNodes[wide].Child[s] = child;
+        }
+    }
+    return wide;
+}
+
+void Bvh::Refit(const BoundingBox* Bounds) {
+    for (size_t i = mNodes.size(); i-- > 0;) {
+        BvhNode& node = mNodes[i];
+        BoundingBox box;
+        if (node.Count > 0) {
+            for (uint32_t p = node.LeftFirst; p < node.LeftFirst + node.Count; ++p) {
+                Grow(box, Bounds[mPrimitiveIndices[p]]);
+            }
+        } else {
+            box = mNodes[node.LeftFirst].Bounds;
+            Grow(box, mNodes[node.LeftFirst + 1].Bounds);
+        }
+        node.Bounds = box;
+    }
+
+    for (size_t w = 0; w < mWideNodes.size(); ++w) {
+        BvhWideNode& target = mWideNodes[w];
+        for (uint32_t s = 0; s < 4; ++s) {
+            const uint32_t source = mWideSource[w * 4 + s];
+            if (source == INVALID_BVH_INDEX) {
+                continue;
+            }
+            const BoundingBox& box = mNodes[source].Bounds;
+            target.MinX[s] = box.Min.X;
+            target.MinY[s] = box.Min.Y;
+            target.MinZ[s] = box.Min.Z;
+            target.MaxX[s] = box.Max.X;
+            target.MaxY[s] = box.Max.Y;
+            target.MaxZ[s] = box.Max.Z;
+        }
+    }
+}
+
+bool IntersectTriangle(const Ray& R,
+                       const Vector3& P0,
+                       const Vector3& P1,
+                       const Vector3& P2,
+                       float MaxT,
+                       float& OutT,
+                       float& OutU,
+                       float& OutV) {
+    const Vector3 edge1 = P1 - P0;
+    const Vector3 edge2 = P2 - P0;
+    const Vector3 p = Cross(R.Direction, edge2);
+    const float determinant = Dot(edge1, p);
+    if (std::fabs(determinant) < 1e-12f) {
+        return false; // Parallel to the triangle's plane
+    }
+    const float inv = 1.0f / determinant;
+    const Vector3 s = R.Origin - P0;
+    const float u = Dot(s, p) * inv;
+    if (u < 0.0f || u > 1.0f) {
+        return false;
+    }
+    const Vector3 q = Cross(s, edge1);
+    const float v = Dot(R.Direction, q) * inv;
+    if (v < 0.0f || u + v > 1.0f) {
+        return false;
+    }
+    const float t = Dot(edge2, q) * inv;
+    if (t <= 0.0f || t > MaxT) {
+        return false;
+    }
+    OutT = t;
+    OutU = u;
+    OutV = v;
+    return true;
+}
+
+bool TriangleBvh::Build(const Vector3* Positions,
+                        const uint32_t* Indices,
+                        uint32_t TriangleCount,
+                        ThreadPool* Pool) {
+    mPositions = Positions;
+    mIndices = Indices;
+    mTriangleCount = TriangleCount;
+    ComputeTriangleBounds();
+    return mBvh.Build(mTriangleBounds.data(), TriangleCount, Pool);
+}
+
+void TriangleBvh::Refit(const Vector3* Positions) {
+    mPositions = Positions;
+    ComputeTriangleBounds();
+    mBvh.Refit(mTriangleBounds.data());
+}
+
+void TriangleBvh::ComputeTriangleBounds() {
+    mTriangleBounds.resize(mTriangleCount);
+    for (uint32_t t = 0; t < mTriangleCount; ++t) {
+        BoundingBox box;
+        Grow(box, mPositions[mIndices[3 * t + 0]]);
+        Grow(box, mPositions[mIndices[3 * t + 1]]);
+        Grow(box, mPositions[mIndices[3 * t + 2]]);
+        mTriangleBounds[t] = box;
+    }
+}
+
+bool TriangleBvh::IntersectRay(const Ray& R, RayHit& OutHit, float MaxT) const {
+    RayHit hit;
+    float maxT = MaxT;
+    uint32_t triangle = mBvh.Intersect(R, maxT, [&](uint32_t Triangle, float& InOutMaxT) {
+        const uint32_t* index = mIndices + 3 * Triangle;
+        float t, u, v;
+        if (!IntersectTriangle(R, mPositions[index[0]], mPositions[index[1]],
+                               mPositions[index[2]], InOutMaxT, t, u, v)) {
+            return false;
+        }
+        InOutMaxT = t;
+        hit.U = u;
+        hit.V = v;
+        return true;
+    });
+    if (triangle == INVALID_BVH_INDEX) {
+        return false;
+    }
+    hit.T = maxT;
+    hit.Triangle = triangle;
+    OutHit = hit;
+    return true;
+}
@@ -0,0 +1,219 @@
+﻿// src/Scene/Bvh.h
+// Bounding volume hierarchy for ray queries. Built as a binary SAH tree, then collapsed into a
+// 4-wide tree whose child boxes are stored as SoA so one node test covers four boxes.
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Math/Bounds.h"
+#include "Math/Simd.h"
+
+class ThreadPool;
+
+constexpr uint32_t INVALID_BVH_INDEX = 0xFFFFFFFFu;
+
+// Binary tree node. Interior nodes have Count == 0 and their children at LeftFirst and
+// LeftFirst + 1; leaves cover Count entries of the primitive index list from LeftFirst.
+struct BvhNode {
+    BoundingBox Bounds;
+    uint32_t LeftFirst = 0;
+    uint32_t Count = 0;
+};
+
+// Traversal node: four child boxes, one component per array. A slot is a leaf when Count is
+// non-zero (Child is then the first primitive index entry), an interior node when Child is valid
+// and Count is zero, and unused when Child is INVALID_BVH_INDEX.
+struct alignas(16) BvhWideNode {
+    float MinX[4];
+    float MinY[4];
+    float MinZ[4];
+    float MaxX[4];
+    float MaxY[4];
+    float MaxZ[4];
+    uint32_t Child[4];
+    uint32_t Count[4];
+};
+
+class Bvh {
+  public:
+    Bvh();
+    ~Bvh();
+
+    // Builds over Count primitive boxes with binned SAH. Large nodes near the root bin in
+    // parallel, then the subtrees below them are built on Pool's threads. Returns false for
+    // Count == 0.
+    bool Build(const BoundingBox* Bounds, uint32_t Count, ThreadPool* Pool = nullptr);
+
+    // Recomputes node boxes after primitives moved, keeping the topology. Much cheaper than a
+    // rebuild, but quality degrades as primitives drift far from where they were at build time.
+    // Bounds must hold the same primitives, in the same order, as the Build call.
+    void Refit(const BoundingBox* Bounds);
+
+    // Finds the closest primitive along R within (0, InOutMaxT]. TestPrimitive(Primitive,
+    // InOutMaxT) must return true and shrink InOutMaxT when it finds a closer hit. Returns the
+    // closest primitive or INVALID_BVH_INDEX.
+    template <typename PrimitiveFn>
+    uint32_t Intersect(const Ray& R, float& InOutMaxT, PrimitiveFn&& TestPrimitive) const;
+
+    uint32_t GetNodeCount() const {
+        return static_cast<uint32_t>(mNodes.size());
+    }
+    uint32_t GetWideNodeCount() const {
+        return static_cast<uint32_t>(mWideNodes.size());
+    }
+    const BoundingBox& GetBounds() const {
+        return mNodes.empty() ? mEmptyBounds : mNodes[0].Bounds;
+    }
+
+  private:
+    friend class BvhBuilder;
+
+    uint32_t Collapse(uint32_t Node);
+
+    std::vector<BvhNode> mNodes;
+    std::vector<BvhWideNode> mWideNodes;
+    // Binary node behind each wide slot, so refits can update the wide copy.
+    std::vector<uint32_t> mWideSource;
+    std::vector<uint32_t> mPrimitiveIndices;
+    BoundingBox mEmptyBounds;
+};
+
+struct RayHit {
+    float T = std::numeric_limits<float>::max();
+    uint32_t Triangle = INVALID_BVH_INDEX;
+    // Barycentrics of the hit: P = (1 - U - V) * P0 + U * P1 + V * P2.
+    float U = 0.0f;
+    float V = 0.0f;
+};
+
+// BVH over an indexed triangle list. The position and index arrays are referenced, not copied,
+// and must stay alive and unchanged in size for as long as the BVH is used.
+class TriangleBvh {
+  public:
+    bool Build(const Vector3* Positions,
+               const uint32_t* Indices,
+               uint32_t TriangleCount,
+               ThreadPool* Pool = nullptr);
+
+    // Positions moved but the triangles are the same, e.g. after skinning or morphing.
+    void Refit(const Vector3* Positions);
+
+    // Closest hit within (0, MaxT], both faces counted.
+    bool IntersectRay(const Ray& R,
+                      RayHit& OutHit,
+                      float MaxT = std::numeric_limits<float>::max()) const;
+
+    const Bvh& GetBvh() const {
+        return mBvh;
+    }
+
+  private:
+    void ComputeTriangleBounds();
+
+    Bvh mBvh;
+    const Vector3* mPositions = nullptr;
+    const uint32_t* mIndices = nullptr;
+    uint32_t mTriangleCount = 0;
+    std::vector<BoundingBox> mTriangleBounds;
+};
+
+// Möller–Trumbore. Returns true and fills OutT, OutU, OutV when R hits the triangle within
+// (0, MaxT].
+bool IntersectTriangle(const Ray& R,
+                       const Vector3& P0,
+                       const Vector3& P1,
+                       const Vector3& P2,
+                       float MaxT,
+                       float& OutT,
+                       float& OutU,
+                       float& OutV);
+
+template <typename PrimitiveFn>
+uint32_t Bvh::Intersect(const Ray& R, float& InOutMaxT, PrimitiveFn&& TestPrimitive) const {
+    using namespace Simd;
+    if (mWideNodes.empty()) {
+        return INVALID_BVH_INDEX;
+    }
+
+    // Axis-parallel rays would divide by zero; a huge reciprocal gives the same slab result.
+    auto reciprocal = [](float D) {
+        return std::fabs(D) > 1e-30f ? 1.0f / D : (D < 0.0f ? -1e30f : 1e30f);
+    };
+    const Float4 originX = Splat(R.Origin.X);
+    const Float4 originY = Splat(R.Origin.Y);
+    const Float4 originZ = Splat(R.Origin.Z);
+    const Float4 invX = Splat(reciprocal(R.Direction.X));
+    const Float4 invY = Splat(reciprocal(R.Direction.Y));
+    const Float4 invZ = Splat(reciprocal(R.Direction.Z));
+    const Float4 zero = Zero();
+
+    // Depth is capped at build time, so at most three siblings wait per level.
+    struct StackEntry {
+        uint32_t Node;
+        float Near;
+    };
+    StackEntry stack[256];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = {0, 0.0f};
+
+    uint32_t closest = INVALID_BVH_INDEX;
+    while (stackSize > 0) {
+        const StackEntry entry = stack[--stackSize];
+        if (entry.Near > InOutMaxT) {
+            continue;
+        }
+
+        const BvhWideNode& node = mWideNodes[entry.Node];
+        const Float4 x0 = Mul(Sub(LoadAligned(node.MinX), originX), invX);
+        const Float4 x1 = Mul(Sub(LoadAligned(node.MaxX), originX), invX);
+        const Float4 y0 = Mul(Sub(LoadAligned(node.MinY), originY), invY);
+        const Float4 y1 = Mul(Sub(LoadAligned(node.MaxY), originY), invY);
+        const Float4 z0 = Mul(Sub(LoadAligned(node.MinZ), originZ), invZ);
+        const Float4 z1 = Mul(Sub(LoadAligned(node.MaxZ), originZ), invZ);
+        const Float4 nearT = Max(Max(Min(x0, x1), Min(y0, y1)), Max(Min(z0, z1), zero));
+        const Float4 farT =
+            Min(Min(Max(x0, x1), Max(y0, y1)), Min(Max(z0, z1), Splat(InOutMaxT)));
+        const int mask = MoveMask(CmpLe(nearT, farT));
+        if (mask == 0) {
+            continue;
+        }
+
+        alignas(16) float nearLanes[4];
+        StoreAligned(nearLanes, nearT);
+
+        // Leaves are tested right away; interior children are pushed far-to-near so the nearest
+        // one is visited next and tightens InOutMaxT for the rest.
+        StackEntry interior[4];
+        uint32_t interiorCount = 0;
+        for (int slot = 0; slot < 4; ++slot) {
+            if (!(mask & (1 << slot)) || node.Child[slot] == INVALID_BVH_INDEX) {
+                continue;
+            }
+            if (node.Count[slot] == 0) {
+                interior[interiorCount++] = {node.Child[slot], nearLanes[slot]};
+                continue;
+            }
+            const uint32_t first = node.Child[slot];
+            for (uint32_t i = first; i < first + node.Count[slot]; ++i) {
+                if (TestPrimitive(mPrimitiveIndices[i], InOutMaxT)) {
+                    closest = mPrimitiveIndices[i];
+                }
+            }
+        }
+        for (uint32_t a = 1; a < interiorCount; ++a) {
+            StackEntry key = interior[a];
+            uint32_t b = a;
+            for (; b > 0 && interior[b - 1].Near < key.Near; --b) {
+                interior[b] = interior[b - 1];
+            }
+            interior[b] = key;
+        }
+        for (uint32_t a = 0; a < interiorCount; ++a) {
+            stack[stackSize++] = interior[a];
+        }
+    }
+    return closest;
+}
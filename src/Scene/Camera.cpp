@@ -0,0 +1,156 @@
+﻿// src/Scene/Camera.cpp
+#include "Camera.h"
+
+#include <cmath>
+
+namespace {
+
+constexpr float DEFAULT_FOV_Y = 1.0471976f; // 60 degrees
+constexpr float DEFAULT_NEAR_Z = 0.1f;
+constexpr float DEFAULT_FAR_Z = 1000.0f;
+
+} // anonymous namespace
+
+Camera::Camera()
+    : mFovY(DEFAULT_FOV_Y), mAspectRatio(16.0f / 9.0f), mOrthoHeight(10.0f),
+      mNearZ(DEFAULT_NEAR_Z), mFarZ(DEFAULT_FAR_Z) {
+}
+
+void Camera::SetPosition(const Vector3& Position) {
+    mPosition = Position;
+    mViewDirty = true;
+}
+
+void Camera::SetOrientation(const Quaternion& Orientation) {
+    mOrientation = Normalize(Orientation);
+    mViewDirty = true;
+}
+
+void Camera::LookAt(const Vector3& Target, const Vector3& Up) {
+    Vector3 forward = Normalize(Target - mPosition);
+    Vector3 right = Cross(Up, forward);
+    if (Dot(right, right) < 1e-12f) {
+        // Looking straight along Up; any perpendicular right vector will do.
+        right = Cross(Vector3{0.0f, 0.0f, 1.0f}, forward);
+        if (Dot(right, right) < 1e-12f) {
+            right = Vector3{1.0f, 0.0f, 0.0f};
+        }
+    }
+    right = Normalize(right);
+    Vector3 up = Cross(forward, right);
+
+    // Rows of the camera's world rotation are its basis vectors.
+    Matrix4 rotation;
+    rotation.M[0][0] = right.X;
+    rotation.M[0][1] = right.Y;
+    rotation.M[0][2] = right.Z;
+    rotation.M[1][0] = up.X;
+    rotation.M[1][1] = up.Y;
+    rotation.M[1][2] = up.Z;
+    rotation.M[2][0] = forward.X;
+    rotation.M[2][1] = forward.Y;
+    rotation.M[2][2] = forward.Z;
+    SetOrientation(QuaternionFromMatrix(rotation));
+}
+
+void Camera::SetPerspective(float FovY, float AspectRatio, float NearZ, float FarZ) {
+    mProjectionType = ProjectionType::Perspective;
+    mFovY = FovY;
+    mAspectRatio = AspectRatio;
+    mNearZ = NearZ;
+    mFarZ = FarZ;
+    mProjectionDirty = true;
+}
+
+void Camera::SetOrthographic(float Width, float Height, float NearZ, float FarZ) {
+    mProjectionType = ProjectionType::Orthographic;
+    mOrthoHeight = Height;
+    mAspectRatio = Height > 0.0f ? Width / Height : 1.0f;
+    mNearZ = NearZ;
+    mFarZ = FarZ;
+    mProjectionDirty = true;
+}
+
+void Camera::SetAspectRatio(float AspectRatio) {
+    if (AspectRatio > 0.0f && AspectRatio != mAspectRatio) {
+        mAspectRatio = AspectRatio;
+        mProjectionDirty = true;
+    }
+}
+
+Vector3 Camera::GetForward() const {
+    return Rotate(mOrientation, Vector3{0.0f, 0.0f, 1.0f});
+}
+
+Vector3 Camera::GetRight() const {
+    return Rotate(mOrientation, Vector3{1.0f, 0.0f, 0.0f});
+}
+
+Vector3 Camera::GetUp() const {
+    return Rotate(mOrientation, Vector3{0.0f, 1.0f, 0.0f});
+}
+
+const Matrix4& Camera::GetView() const {
+    UpdateMatrices();
+    return mView;
+}
+
+const Matrix4& Camera::GetProjection() const {
+    UpdateMatrices();
+    return mProjection;
+}
+
+const Matrix4& Camera::GetViewProjection() const {
+    UpdateMatrices();
+    return mViewProjection;
+}
+
+const Frustum& Camera::GetFrustum() const {
+    UpdateMatrices();
+    return mFrustum;
+}
+
+Ray Camera::GetPickRay(float NdcX, float NdcY) const {
+    UpdateMatrices();
+    auto unproject = [this](float NdcX, float NdcY, float Depth) {
+        Vector4 p = TransformPoint(mInverseViewProjection, Vector3{NdcX, NdcY, Depth});
+        return Vector3{p.X / p.W, p.Y / p.W, p.Z / p.W};
+    };
+    Vector3 origin = unproject(NdcX, NdcY, 0.0f);
+    return Ray{origin, Normalize(unproject(NdcX, NdcY, 1.0f) - origin)};
+}
+
+uint32_t Camera::GetRevision() const {
+    UpdateMatrices();
+    return mRevision;
+}
+
+void Camera::UpdateMatrices() const {
+    if (!mViewDirty && !mProjectionDirty) {
+        return;
+    }
+
+    if (mViewDirty) {
+        // Inverse of the camera's rigid world transform: undo the translation, then the rotation.
+        Matrix4 inverseRotation = Transpose(MatrixRotation(mOrientation));
+        mView = Multiply(MatrixTranslation(-mPosition), inverseRotation);
+        mViewDirty = false;
+    }
+
+    if (mProjectionDirty) {
+        if (mProjectionType == ProjectionType::Perspective) {
+            mProjection = MatrixPerspectiveFov(mFovY, mAspectRatio, mNearZ, mFarZ);
+        } else {
+            mProjection =
+                MatrixOrthographic(mOrthoHeight * mAspectRatio, mOrthoHeight, mNearZ, mFarZ);
+        }
+        mProjectionDirty = false;
+    }
+
+    mViewProjection = Multiply(mView, mProjection);
+    mFrustum = ExtractFrustum(mViewProjection);
+    if (!Inverse(mViewProjection, mInverseViewProjection)) {
+        mInverseViewProjection = Matrix4::Identity();
+    }
+    ++mRevision;
+}
@@ -2,4 +2,94 @@
 // Created by dtcimbal on 27/06/2025.
 #pragma once
 
-class Camera {};
+#include <cstdint>
+
+#include "Frustum.h"
+#include "Math/Bounds.h"
+#include "Math/Matrix.h"
+#include "Math/Quaternion.h"
+#include "Math/Vector.h"
+
+enum class ProjectionType { Perspective, Orthographic };
+
+// A view into the scene: position/orientation plus a perspective or orthographic projection.
+// View, projection and view-projection matrices are cached and only rebuilt on first use after
+// a setter marked them dirty, so per-object code can query them freely.
+class Camera {
+  public:
+    Camera();
+
+    void SetPosition(const Vector3& Position);
+    void SetOrientation(const Quaternion& Orientation);
+    // Orients the camera so it looks at Target, keeping Up as close to up as possible.
+    void LookAt(const Vector3& Target, const Vector3& Up = Vector3{0.0f, 1.0f, 0.0f});
+
+    void SetPerspective(float FovY, float AspectRatio, float NearZ, float FarZ);
+    // Width and Height are the view-space extents of the view volume.
+    void SetOrthographic(float Width, float Height, float NearZ, float FarZ);
+    // Keeps the current projection type; for orthographic cameras the width follows the height.
+    void SetAspectRatio(float AspectRatio);
+
+    const Vector3& GetPosition() const {
+        return mPosition;
+    }
+    const Quaternion& GetOrientation() const {
+        return mOrientation;
+    }
+    ProjectionType GetProjectionType() const {
+        return mProjectionType;
+    }
+    float GetFovY() const {
+        return mFovY;
+    }
+    float GetAspectRatio() const {
+        return mAspectRatio;
+    }
+    float GetNearZ() const {
+        return mNearZ;
+    }
+    float GetFarZ() const {
+        return mFarZ;
+    }
+
+    // World-space basis of the camera (left-handed, looking down +Z in view space).
+    Vector3 GetForward() const;
+    Vector3 GetRight() const;
+    Vector3 GetUp() const;
+
+    const Matrix4& GetView() const;
+    const Matrix4& GetProjection() const;
+    const Matrix4& GetViewProjection() const;
+    // World-space planes of the view volume, rebuilt together with the matrices.
+    const Frustum& GetFrustum() const;
+
+    // World-space ray through a point given in normalized device coordinates (x right, y up,
+    // both in [-1, 1]), starting on the near plane. Used for picking.
+    Ray GetPickRay(float NdcX, float NdcY) const;
+
+    // Bumped whenever any cached matrix changes; lets consumers cache derived data per camera.
+    uint32_t GetRevision() const;
+
+  private:
+    void UpdateMatrices() const;
+
+    Vector3 mPosition;
+    Quaternion mOrientation;
+
+    ProjectionType mProjectionType = ProjectionType::Perspective;
+    float mFovY;
+    float mAspectRatio;
+    float mOrthoHeight;
+    float mNearZ;
+    float mFarZ;
+
+    // Lazily rebuilt cache.
+    mutable bool mViewDirty = true;
+    mutable bool mProjectionDirty = true;
+    mutable Matrix4 mView;
+    mutable Matrix4 mProjection;
+    mutable Matrix4 mViewProjection;
+    mutable Frustum mFrustum;
+    mutable Matrix4 mInverseViewProjection;
+    mutable uint32_t mRevision = 0;
+};
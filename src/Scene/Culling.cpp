@@ -0,0 +1,303 @@
+﻿// src/Scene/Culling.cpp
+#include "Culling.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "Common/Profiler.h"
+#include "Common/ThreadPool.h"
+#include "Math/Simd.h"
+
+#if defined(__AVX2__)
+#define CULL_KERNEL_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Objects per worker task. A multiple of CULL_BATCH_WIDTH.
+constexpr uint32_t CULL_CHUNK_SIZE = 4096;
+
+uint32_t PaddedCount(uint32_t Count) {
+    return (Count + CULL_BATCH_WIDTH - 1) / CULL_BATCH_WIDTH * CULL_BATCH_WIDTH;
+}
+
+// Fills the padding lanes of Array with Value.
+void ResizePadded(std::vector<float>& Array, uint32_t Count, float Value) {
+    Array.resize(PaddedCount(Count));
+    for (size_t i = Count; i < Array.size(); ++i) {
+        Array[i] = Value;
+    }
+}
+
+// The frustum in SoA form, one array per plane component, with the absolute normals the box
+// test projects extents onto.
+struct PlaneSet {
+    float NormalX[FRUSTUM_PLANE_COUNT];
+    float NormalY[FRUSTUM_PLANE_COUNT];
+    float NormalZ[FRUSTUM_PLANE_COUNT];
+    float AbsX[FRUSTUM_PLANE_COUNT];
+    float AbsY[FRUSTUM_PLANE_COUNT];
+    float AbsZ[FRUSTUM_PLANE_COUNT];
+    float D[FRUSTUM_PLANE_COUNT];
+};
+
+PlaneSet MakePlaneSet(const Frustum& Volume) {
+    PlaneSet set;
+    for (int p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+        const Plane& plane = Volume.Planes[p];
+        set.NormalX[p] = plane.Normal.X;
+        set.NormalY[p] = plane.Normal.Y;
+        set.NormalZ[p] = plane.Normal.Z;
+        set.AbsX[p] = std::fabs(plane.Normal.X);
+        set.AbsY[p] = std::fabs(plane.Normal.Y);
+        set.AbsZ[p] = std::fabs(plane.Normal.Z);
+        set.D[p] = plane.D;
+    }
+    return set;
+}
+
+// Appends Base + lane for every set bit of Mask without branching on the bits.
+inline uint32_t AppendLanes(uint32_t Mask, uint32_t Lanes, uint32_t Base, uint32_t* Out) {
+    uint32_t count = 0;
+    for (uint32_t lane = 0; lane < Lanes; ++lane) {
+        Out[count] = Base + lane;
+        count += (Mask >> lane) & 1u;
+    }
+    return count;
+}
+
+#if defined(CULL_KERNEL_AVX2)
+
+inline __m256 MulAdd8(__m256 A, __m256 B, __m256 C) {
+#if defined(__FMA__)
+    return _mm256_fmadd_ps(A, B, C);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(A, B), C);
+#endif
+}
+
+// Bounds in [Begin, End) must start and end on a batch boundary.
+uint32_t CullRange(const PlaneSet& Planes,
+                   const BoundingSphereSet& Bounds,
+                   uint32_t Begin,
+                   uint32_t End,
+                   uint32_t* Out) {
+    const __m256 zero = _mm256_setzero_ps();
+    uint32_t count = 0;
+    for (uint32_t i = Begin; i < End; i += 8) {
+        const __m256 cx = _mm256_loadu_ps(Bounds.GetCenterX() + i);
+        const __m256 cy = _mm256_loadu_ps(Bounds.GetCenterY() + i);
+        const __m256 cz = _mm256_loadu_ps(Bounds.GetCenterZ() + i);
+        const __m256 negRadius = _mm256_sub_ps(zero, _mm256_loadu_ps(Bounds.GetRadius() + i));
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+            __m256 distance = MulAdd8(cx, _mm256_set1_ps(Planes.NormalX[p]),
+                                      MulAdd8(cy, _mm256_set1_ps(Planes.NormalY[p]),
+                                              MulAdd8(cz, _mm256_set1_ps(Planes.NormalZ[p]),
+                                                      _mm256_set1_ps(Planes.D[p]))));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+        }
+        count += AppendLanes(static_cast<uint32_t>(_mm256_movemask_ps(inside)), 8, i, Out + count);
+    }
+    return count;
+}
+
+uint32_t CullRange(const PlaneSet& Planes,
+                   const BoundingBoxSet& Bounds,
+                   uint32_t Begin,
+                   uint32_t End,
+                   uint32_t* Out) {
+    const __m256 zero = _mm256_setzero_ps();
+    uint32_t count = 0;
+    for (uint32_t i = Begin; i < End; i += 8) {
+        const __m256 cx = _mm256_loadu_ps(Bounds.GetCenterX() + i);
+        const __m256 cy = _mm256_loadu_ps(Bounds.GetCenterY() + i);
+        const __m256 cz = _mm256_loadu_ps(Bounds.GetCenterZ() + i);
+        const __m256 ex = _mm256_loadu_ps(Bounds.GetExtentX() + i);
+        const __m256 ey = _mm256_loadu_ps(Bounds.GetExtentY() + i);
+        const __m256 ez = _mm256_loadu_ps(Bounds.GetExtentZ() + i);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+            // Outside only if the center is further out than the box's projected radius.
+            __m256 distance = MulAdd8(cx, _mm256_set1_ps(Planes.NormalX[p]),
+                                      MulAdd8(cy, _mm256_set1_ps(Planes.NormalY[p]),
+                                              MulAdd8(cz, _mm256_set1_ps(Planes.NormalZ[p]),
+                                                      _mm256_set1_ps(Planes.D[p]))));
+            __m256 radius = MulAdd8(ex, _mm256_set1_ps(Planes.AbsX[p]),
+                                    MulAdd8(ey, _mm256_set1_ps(Planes.AbsY[p]),
+                                            _mm256_mul_ps(ez, _mm256_set1_ps(Planes.AbsZ[p]))));
+            inside = _mm256_and_ps(
+                inside, _mm256_cmp_ps(distance, _mm256_sub_ps(zero, radius), _CMP_GE_OQ));
+        }
+        count += AppendLanes(static_cast<uint32_t>(_mm256_movemask_ps(inside)), 8, i, Out + count);
+    }
+    return count;
+}
+
+#else
+
+// 4-wide through the Simd layer, which also covers the scalar build.
+uint32_t CullRange(const PlaneSet& Planes,
+                   const BoundingSphereSet& Bounds,
+                   uint32_t Begin,
+                   uint32_t End,
+                   uint32_t* Out) {
+    using namespace Simd;
+    uint32_t count = 0;
+    for (uint32_t i = Begin; i < End; i += 4) {
+        const Float4 cx = Load(Bounds.GetCenterX() + i);
+        const Float4 cy = Load(Bounds.GetCenterY() + i);
+        const Float4 cz = Load(Bounds.GetCenterZ() + i);
+        const Float4 negRadius = Negate(Load(Bounds.GetRadius() + i));
+        int mask = 0xF;
+        for (int p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+            Float4 distance =
+                MulAdd(cx, Splat(Planes.NormalX[p]),
+                       MulAdd(cy, Splat(Planes.NormalY[p]),
+                              MulAdd(cz, Splat(Planes.NormalZ[p]), Splat(Planes.D[p]))));
+            mask &= MoveMask(CmpGe(distance, negRadius));
+        }
+        count += AppendLanes(static_cast<uint32_t>(mask), 4, i, Out + count);
+    }
+    return count;
+}
+
+uint32_t CullRange(const PlaneSet& Planes,
+                   const BoundingBoxSet& Bounds,
+                   uint32_t Begin,
+                   uint32_t End,
+                   uint32_t* Out) {
+    using namespace Simd;
+    uint32_t count = 0;
+    for (uint32_t i = Begin; i < End; i += 4) {
+        const Float4 cx = Load(Bounds.GetCenterX() + i);
+        const Float4 cy = Load(Bounds.GetCenterY() + i);
+        const Float4 cz = Load(Bounds.GetCenterZ() + i);
+        const Float4 ex = Load(Bounds.GetExtentX() + i);
+        const Float4 ey = Load(Bounds.GetExtentY() + i);
+        const Float4 ez = Load(Bounds.GetExtentZ() + i);
+        int mask = 0xF;
+        for (int p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+            // Outside only if the center is further out than the box's projected radius.
+            Float4 distance =
+                MulAdd(cx, Splat(Planes.NormalX[p]),
+                       MulAdd(cy, Splat(Planes.NormalY[p]),
+                              MulAdd(cz, Splat(Planes.NormalZ[p]), Splat(Planes.D[p]))));
+            Float4 radius =
+                MulAdd(ex, Splat(Planes.AbsX[p]),
+                       MulAdd(ey, Splat(Planes.AbsY[p]), Mul(ez, Splat(Planes.AbsZ[p]))));
+            mask &= MoveMask(CmpGe(distance, Negate(radius)));
+        }
+        count += AppendLanes(static_cast<uint32_t>(mask), 4, i, Out + count);
+    }
+    return count;
+}
+
+#endif
+
+} // anonymous namespace
+
+void BoundingSphereSet::Resize(uint32_t Count) {
+    // A negative radius larger than any plane distance: never visible.
+    const float never = -std::numeric_limits<float>::max();
+    mCount = Count;
+    ResizePadded(mCenterX, Count, 0.0f);
+    ResizePadded(mCenterY, Count, 0.0f);
+    ResizePadded(mCenterZ, Count, 0.0f);
+    ResizePadded(mRadius, Count, never);
+}
+
+void BoundingBoxSet::Resize(uint32_t Count) {
+    const float never = -std::numeric_limits<float>::max();
+    mCount = Count;
+    ResizePadded(mCenterX, Count, 0.0f);
+    ResizePadded(mCenterY, Count, 0.0f);
+    ResizePadded(mCenterZ, Count, 0.0f);
+    ResizePadded(mExtentX, Count, never);
+    ResizePadded(mExtentY, Count, never);
+    ResizePadded(mExtentZ, Count, never);
+}
+
+FrustumCuller::FrustumCuller() = default;
+
+FrustumCuller::~FrustumCuller() = default;
+
+uint32_t FrustumCuller::Cull(const Frustum& Volume,
+                             const BoundingSphereSet& Bounds,
+                             ThreadPool* Pool,
+                             std::vector<uint32_t>& OutVisible) {
+    return CullChunks(Volume, Bounds, Pool, OutVisible);
+}
+
+uint32_t FrustumCuller::Cull(const Frustum& Volume,
+                             const BoundingBoxSet& Bounds,
+                             ThreadPool* Pool,
+                             std::vector<uint32_t>& OutVisible) {
+    return CullChunks(Volume, Bounds, Pool, OutVisible);
+}
+
+template <typename BoundsT>
+uint32_t FrustumCuller::CullChunks(const Frustum& Volume,
+                                   const BoundsT& Bounds,
+                                   ThreadPool* Pool,
+                                   std::vector<uint32_t>& OutVisible) {
+    PROFILE_ZONE("FrustumCuller::Cull");
+    const Clock::time_point start = Clock::now();
+    const PlaneSet planes = MakePlaneSet(Volume);
+    const uint32_t padded = PaddedCount(Bounds.GetCount());
+    const uint32_t chunkCount = (padded + CULL_CHUNK_SIZE - 1) / CULL_CHUNK_SIZE;
+
+    uint32_t visible = 0;
+    if (Pool == nullptr || chunkCount < 2) {
+        OutVisible.resize(padded);
+        visible = CullRange(planes, Bounds, 0, padded, OutVisible.data());
+        mStats.ThreadCount = 1;
+    } else {
+        mChunkVisible.resize(static_cast<size_t>(chunkCount) * CULL_CHUNK_SIZE);
+        mChunkCounts.resize(chunkCount);
+        Pool->ParallelFor(chunkCount, [&](uint32_t Chunk, uint32_t) {
+            const uint32_t begin = Chunk * CULL_CHUNK_SIZE;
+            const uint32_t end =
+                begin + CULL_CHUNK_SIZE < padded ? begin + CULL_CHUNK_SIZE : padded;
+            mChunkCounts[Chunk] =
+                CullRange(planes, Bounds, begin, end, mChunkVisible.data() + begin);
+        });
+
+        // Chunk order is index order, so the compacted list stays sorted.
+        for (uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+            visible += mChunkCounts[chunk];
+        }
+        OutVisible.resize(visible);
+        uint32_t* out = OutVisible.data();
+        for (uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+            std::memcpy(out, mChunkVisible.data() + static_cast<size_t>(chunk) * CULL_CHUNK_SIZE,
+                        mChunkCounts[chunk] * sizeof(uint32_t));
+            out += mChunkCounts[chunk];
+        }
+        mStats.ThreadCount = Pool->GetThreadCount();
+    }
+    OutVisible.resize(visible);
+
+    mStats.Tested = Bounds.GetCount();
+    mStats.Visible = visible;
+    mStats.Culled = Bounds.GetCount() - visible;
+    mStats.CullMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return visible;
+}
+
+const char* GetCullKernelName() {
+#if defined(CULL_KERNEL_AVX2)
+    return "AVX2";
+#elif defined(MATH_SIMD_SSE2)
+    return "SSE2";
+#elif defined(MATH_SIMD_NEON)
+    return "NEON";
+#else
+    return "Scalar";
+#endif
+}
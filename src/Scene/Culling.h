@@ -0,0 +1,142 @@
+﻿// src/Scene/Culling.h
+// Bulk frustum culling over structure-of-arrays bounds. Produces a compact list of the indices
+// that survive, in ascending order, so submission only ever touches visible objects.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Frustum.h"
+#include "Math/Vector.h"
+
+class ThreadPool;
+
+// Bounds arrays are padded to this many entries with bounds no frustum can contain, so the
+// kernels never need a scalar tail loop.
+constexpr uint32_t CULL_BATCH_WIDTH = 8;
+
+// World-space bounding spheres, one float array per component.
+class BoundingSphereSet {
+  public:
+    void Resize(uint32_t Count);
+    void Set(uint32_t Index, const Vector3& Center, float Radius) {
+        mCenterX[Index] = Center.X;
+        mCenterY[Index] = Center.Y;
+        mCenterZ[Index] = Center.Z;
+        mRadius[Index] = Radius;
+    }
+
+    uint32_t GetCount() const {
+        return mCount;
+    }
+    const float* GetCenterX() const {
+        return mCenterX.data();
+    }
+    const float* GetCenterY() const {
+        return mCenterY.data();
+    }
+    const float* GetCenterZ() const {
+        return mCenterZ.data();
+    }
+    const float* GetRadius() const {
+        return mRadius.data();
+    }
+
+  private:
+    std::vector<float> mCenterX;
+    std::vector<float> mCenterY;
+    std::vector<float> mCenterZ;
+    std::vector<float> mRadius;
+    uint32_t mCount = 0;
+};
+
+// World-space axis-aligned boxes, stored as center and half extents.
+class BoundingBoxSet {
+  public:
+    void Resize(uint32_t Count);
+    void Set(uint32_t Index, const Vector3& Min, const Vector3& Max) {
+        mCenterX[Index] = (Min.X + Max.X) * 0.5f;
+        mCenterY[Index] = (Min.Y + Max.Y) * 0.5f;
+        mCenterZ[Index] = (Min.Z + Max.Z) * 0.5f;
+        mExtentX[Index] = (Max.X - Min.X) * 0.5f;
+        mExtentY[Index] = (Max.Y - Min.Y) * 0.5f;
+        mExtentZ[Index] = (Max.Z - Min.Z) * 0.5f;
+    }
+
+    uint32_t GetCount() const {
+        return mCount;
+    }
+    const float* GetCenterX() const {
+        return mCenterX.data();
+    }
+    const float* GetCenterY() const {
+        return mCenterY.data();
+    }
+    const float* GetCenterZ() const {
+        return mCenterZ.data();
+    }
+    const float* GetExtentX() const {
+        return mExtentX.data();
+    }
+    const float* GetExtentY() const {
+        return mExtentY.data();
+    }
+    const float* GetExtentZ() const {
+        return mExtentZ.data();
+    }
+
+  private:
+    std::vector<float> mCenterX;
+    std::vector<float> mCenterY;
+    std::vector<float> mCenterZ;
+    std::vector<float> mExtentX;
+    std::vector<float> mExtentY;
+    std::vector<float> mExtentZ;
+    uint32_t mCount = 0;
+};
+
+struct CullStats {
+    uint32_t Tested = 0;
+    uint32_t Visible = 0;
+    uint32_t Culled = 0;
+    uint32_t ThreadCount = 0;
+    double CullMs = 0.0;
+};
+
+class FrustumCuller {
+  public:
+    FrustumCuller();
+    ~FrustumCuller();
+
+    // Writes the indices of all bounds intersecting Volume to OutVisible, replacing its contents,
+    // and returns their count. Large sets are split into chunks across Pool; with no pool the
+    // caller does all the work. The tests are conservative: nothing visible is ever culled.
+    uint32_t Cull(const Frustum& Volume,
+                  const BoundingSphereSet& Bounds,
+                  ThreadPool* Pool,
+                  std::vector<uint32_t>& OutVisible);
+    uint32_t Cull(const Frustum& Volume,
+                  const BoundingBoxSet& Bounds,
+                  ThreadPool* Pool,
+                  std::vector<uint32_t>& OutVisible);
+
+    // Counts from the most recent Cull call.
+    const CullStats& GetStats() const {
+        return mStats;
+    }
+
+  private:
+    template <typename BoundsT>
+    uint32_t CullChunks(const Frustum& Volume,
+                        const BoundsT& Bounds,
+                        ThreadPool* Pool,
+                        std::vector<uint32_t>& OutVisible);
+
+    // Per-chunk results, compacted into the caller's list once every chunk is done.
+    std::vector<uint32_t> mChunkVisible;
+    std::vector<uint32_t> mChunkCounts;
+    CullStats mStats;
+};
+
+// Name of the culling kernel compiled into this build ("AVX2", "SSE2", "NEON" or "Scalar").
+const char* GetCullKernelName();
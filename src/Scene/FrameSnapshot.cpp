@@ -0,0 +1,176 @@
+﻿// src/Scene/FrameSnapshot.cpp
+#include "FrameSnapshot.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Common/ThreadPool.h"
+#include "LodSelection.h"
+#include "MeshletCulling.h"
+#include "Scene.h"
+
+namespace {
+
+// Instances one job of a parallel AddSceneDraws takes on.
+constexpr uint32_t SNAPSHOT_INSTANCES_PER_JOB = 64;
+
+// Points Draw at the indices of the visible meshlets of Mesh, as seen from View. Returns false
+// if none are visible.
+bool CullDrawMeshlets(const MeshView& Mesh,
+                      const Camera& View,
+                      LinearArena& Arena,
+                      MeshletCullStats* Stats,
+                      DrawItem& Draw) {
+    const Span<const Meshlet> meshlets = Mesh.Meshlets;
+    const MeshletViewer viewer = MakeMeshletViewer(View, Draw.World);
+    uint32_t* visible = Arena.AllocateArray<uint32_t>(meshlets.GetSize());
+    const uint32_t visibleCount = CullMeshlets(meshlets, viewer, visible, Stats);
+    if (visibleCount == 0) {
+        return false;
+    }
+    if (visibleCount == meshlets.GetSize()) {
+        return true;
+    }
+
+    uint32_t indexCount = 0;
+    for (uint32_t i = 0; i < visibleCount; ++i) {
+        indexCount += meshlets[visible[i]].TriangleCount * 3u;
+    }
+    // Neighboring meshlets are neighbors in the index list, so runs of them copy as one.
+    uint32_t* indices = Arena.AllocateArray<uint32_t>(indexCount);
+    uint32_t written = 0;
+    for (uint32_t i = 0; i < visibleCount;) {
+        const uint32_t first = meshlets[visible[i]].FirstIndex;
+        uint32_t end = first;
+        for (; i < visibleCount && meshlets[visible[i]].FirstIndex == end; ++i) {
+            end += meshlets[visible[i]].TriangleCount * 3u;
+        }
+        std::memcpy(indices + written, Mesh.Indices.GetData() + first,
+                    (end - first) * sizeof(uint32_t));
+        written += end - first;
+    }
+    Draw.Indices = indices;
+    Draw.IndexCount = indexCount;
+    return true;
+}
+
+// Fills Draw for one instance at the LOD picked for View. Returns false if nothing of it is
+// in view. Gathered meshlet indices come from Arena.
+bool BuildInstanceDraw(const Scene& Source,
+                       const MeshInstance& Instance,
+                       const Camera& View,
+                       const SceneDrawSettings& Settings,
+                       LinearArena& Arena,
+                       SceneDrawStats* Stats,
+                       DrawItem& Draw) {
+    const SceneHierarchy& hierarchy = Source.GetHierarchy();
+    if (!hierarchy.IsValid(Instance.Node)) {
+        return false;
+    }
+    const MeshView& mesh = Source.GetMesh(Instance.MeshIndex);
+    const Matrix4& world = hierarchy.GetWorldMatrix(Instance.Node);
+    // The box is tested in the mesh's own space, so it is never transformed.
+    const Frustum volume = ExtractFrustum(world * View.GetViewProjection());
+    const bool inView = IntersectsBox(volume, mesh.Bounds.Min, mesh.Bounds.Max);
+    if (Stats != nullptr) {
+        ++Stats->InstancesTested;
+        Stats->InstancesCulled += inView ? 0 : 1;
+    }
+    if (!inView) {
+        return false;
+    }
+
+    Draw.Positions = mesh.Positions.GetData();
+    Draw.VertexCount = mesh.GetVertexCount();
+    Draw.Indices = mesh.Indices.GetData();
+    Draw.IndexCount = mesh.GetIndexCount();
+    Draw.World = world;
+    Draw.Color = Instance.Color;
+
+    uint32_t lod = 0;
+    if (Settings.ViewportHeight > 0 && !mesh.Lods.IsEmpty()) {
+        const float scale =
+            GetLodPixelScale(View, Draw.World, mesh.Bounds, Settings.ViewportHeight);
+        lod = SelectMeshLod(mesh.Lods, scale, Settings.MaxLodPixelError);
+    }
+    if (lod > 0) {
+        const MeshLod& selected = mesh.Lods[lod - 1];
+        Draw.Indices = mesh.LodIndices.GetData() + selected.FirstIndex;
+        Draw.IndexCount = selected.IndexCount;
+    } else if (Settings.CullMeshlets && !mesh.Meshlets.IsEmpty() &&
+               !CullDrawMeshlets(mesh, View, Arena, Stats != nullptr ? &Stats->Meshlets : nullptr,
+                                 Draw)) {
+        return false;
+    }
+    if (Stats != nullptr) {
+        ++Stats->LodDraws[lod];
+        Stats->Triangles += Draw.IndexCount / 3;
+    }
+    Draw.Owner = mesh.Owner;
+    return true;
+}
+
+void AddDrawStats(const SceneDrawStats& From, SceneDrawStats& To) {
+    To.InstancesTested += From.InstancesTested;
+    To.InstancesCulled += From.InstancesCulled;
+    To.Meshlets.Tested += From.Meshlets.Tested;
+    To.Meshlets.Visible += From.Meshlets.Visible;
+    To.Meshlets.FrustumCulled += From.Meshlets.FrustumCulled;
+    To.Meshlets.BackfaceCulled += From.Meshlets.BackfaceCulled;
+    To.Meshlets.CullMs += From.Meshlets.CullMs;
+    for (uint32_t lod = 0; lod <= MAX_MESH_LOD_COUNT; ++lod) {
+        To.LodDraws[lod] += From.LodDraws[lod];
+    }
+    To.Triangles += From.Triangles;
+}
+
+} // anonymous namespace
+
+void AddSceneDraws(const Scene& Source,
+                   FrameSnapshot& Out,
+                   const SceneDrawSettings& Settings,
+                   SceneDrawStats* Stats,
+                   ThreadPool* Pool) {
+    const std::vector<MeshInstance>& instances = Source.GetInstances();
+    const uint32_t instanceCount = static_cast<uint32_t>(instances.size());
+    const uint32_t jobCount = (instanceCount + SNAPSHOT_INSTANCES_PER_JOB - 1) /
+                              SNAPSHOT_INSTANCES_PER_JOB;
+    Out.Draws.reserve(Out.Draws.size() + instanceCount);
+    if (Pool == nullptr || jobCount < 2) {
+        for (const MeshInstance& instance : instances) {
+            DrawItem draw;
+            if (BuildInstanceDraw(Source, instance, Out.View, Settings, Out.Arena, Stats, draw)) {
+                Out.Draws.push_back(std::move(draw));
+            }
+        }
+        return;
+    }
+
+    // Every instance gets a draw slot of its own and every thread its own arena and stats, so
+    // the jobs share nothing. The kept draws are then moved over in instance order.
+    const uint32_t threadCount = Pool->GetThreadCount();
+    Out.WorkerArenas.Resize(threadCount);
+    ArenaVector<DrawItem> draws(instanceCount, ArenaAllocator<DrawItem>(Out.Arena));
+    ArenaVector<uint8_t> kept(instanceCount, 0, ArenaAllocator<uint8_t>(Out.Arena));
+    ArenaVector<SceneDrawStats> threadStats(Stats != nullptr ? threadCount : 0,
+                                            ArenaAllocator<SceneDrawStats>(Out.Arena));
+    Pool->ParallelFor(jobCount, [&](uint32_t Job, uint32_t ThreadIndex) {
+        LinearArena& arena = Out.WorkerArenas.Get(ThreadIndex);
+        SceneDrawStats* stats = Stats != nullptr ? &threadStats[ThreadIndex] : nullptr;
+        const uint32_t begin = Job * SNAPSHOT_INSTANCES_PER_JOB;
+        const uint32_t end = std::min(begin + SNAPSHOT_INSTANCES_PER_JOB, instanceCount);
+        for (uint32_t i = begin; i < end; ++i) {
+            kept[i] = BuildInstanceDraw(Source, instances[i], Out.View, Settings, arena, stats,
+                                        draws[i]);
+        }
+    });
+
+    for (uint32_t i = 0; i < instanceCount; ++i) {
+        if (kept[i]) {
+            Out.Draws.push_back(std::move(draws[i]));
+        }
+    }
+    for (const SceneDrawStats& stats : threadStats) {
+        AddDrawStats(stats, *Stats);
+    }
+}
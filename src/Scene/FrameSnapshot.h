@@ -0,0 +1,88 @@
+﻿// src/Scene/FrameSnapshot.h
+// Everything needed to draw one frame, copied out of the scene by the update thread. Once
+// submitted, a snapshot is never changed, so the render thread can draw it while the update
+// thread builds the next frame.
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Assets/Mesh.h"
+#include "Camera.h"
+#include "Common/FrameArena.h"
+#include "Math/Matrix.h"
+#include "Math/Vector.h"
+#include "MeshletCulling.h"
+
+class Scene;
+class ThreadPool;
+
+// One indexed mesh drawn with one world transform.
+struct DrawItem {
+    const Vector3* Positions = nullptr;
+    uint32_t VertexCount = 0;
+    const uint32_t* Indices = nullptr;
+    uint32_t IndexCount = 0;
+    Matrix4 World;
+    uint32_t Color = 0xFFFFFFFF;
+    std::shared_ptr<const void> Owner; // Keeps the arrays alive; null for static data
+};
+
+struct FrameSnapshot {
+    FrameSnapshot() : Draws(ArenaAllocator<DrawItem>(Arena)) {
+    }
+
+    uint64_t FrameIndex = 0;
+    uint32_t Width = 0; // Viewport size; 0 keeps the renderer's current size
+    uint32_t Height = 0;
+    Camera View;
+    // Per-frame lists come from the snapshot's own arenas. Snapshots are recycled only after the
+    // render thread is done with them, so the arenas need no other frame-in-flight tracking.
+    LinearArena Arena;
+    ThreadArenas WorkerArenas; // For jobs filling the snapshot, by ThreadIndex
+    ArenaVector<DrawItem> Draws;
+
+    // Empties the snapshot and rewinds its arena.
+    void Reset() {
+        FrameIndex = 0;
+        Width = 0;
+        Height = 0;
+        Draws.clear();
+        ArenaVector<DrawItem>(Draws.get_allocator()).swap(Draws);
+        Arena.Reset();
+        WorkerArenas.Reset();
+    }
+};
+
+struct SceneDrawSettings {
+    // Cull meshes that have meshlets against the view meshlet by meshlet.
+    bool CullMeshlets = true;
+    // Draw the coarsest LOD whose error stays under this many pixels.
+    float MaxLodPixelError = 1.0f;
+    uint32_t ViewportHeight = 0; // Pixels; 0 always draws the full meshes
+};
+
+struct SceneDrawStats {
+    uint32_t InstancesTested = 0; // Live instances
+    uint32_t InstancesCulled = 0; // Outside the frustum, so never drawn
+    MeshletCullStats Meshlets;
+    uint32_t LodDraws[MAX_MESH_LOD_COUNT + 1] = {}; // By LOD; 0 is the full mesh
+    uint64_t Triangles = 0;
+};
+
+// Appends one draw per live instance of Source that touches the view, in instance order. World
+// transforms must be up to date.
+//
+// Every instance's bounds are tested against Out.View's frustum first, and only the ones in
+// view go on to pick an LOD. Full meshes with meshlets are then culled meshlet by meshlet and
+// drawn with only the visible ones, their indices gathered in the snapshot's arenas. Instances
+// left with nothing visible are not drawn at all. Stats, if given, are added to.
+//
+// Large scenes are split across Pool, each job allocating from Out.WorkerArenas; with no pool
+// the caller does all the work.
+void AddSceneDraws(const Scene& Source,
+                   FrameSnapshot& Out,
+                   const SceneDrawSettings& Settings = SceneDrawSettings{},
+                   SceneDrawStats* Stats = nullptr,
+                   ThreadPool* Pool = nullptr);
@@ -0,0 +1,56 @@
+﻿// src/Scene/Frustum.cpp
+#include "Frustum.h"
+
+#include <cmath>
+
+namespace {
+
+Plane MakePlane(float A, float B, float C, float D) {
+    float length = std::sqrt(A * A + B * B + C * C);
+    float inv = length > 1e-20f ? 1.0f / length : 0.0f;
+    return Plane{Vector3{A * inv, B * inv, C * inv}, D * inv};
+}
+
+} // anonymous namespace
+
+Frustum ExtractFrustum(const Matrix4& ViewProjection) {
+    // With clip = p * M, each clip coordinate is p dotted with a column of M, so the planes
+    // -w <= x <= w, -w <= y <= w and 0 <= z <= w are sums and differences of columns.
+    const float(&m)[4][4] = ViewProjection.M;
+    auto column = [&m](int C, int Row) { return m[Row][C]; };
+    auto combine = [&column](int A, float Sign, int B) {
+        return MakePlane(column(A, 0) + Sign * column(B, 0), column(A, 1) + Sign * column(B, 1),
+                         column(A, 2) + Sign * column(B, 2), column(A, 3) + Sign * column(B, 3));
+    };
+
+    Frustum frustum;
+    frustum.Planes[0] = combine(3, 1.0f, 0);
+    frustum.Planes[1] = combine(3, -1.0f, 0);
+    frustum.Planes[2] = combine(3, 1.0f, 1);
+    frustum.Planes[3] = combine(3, -1.0f, 1);
+    frustum.Planes[4] = MakePlane(column(2, 0), column(2, 1), column(2, 2), column(2, 3));
+    frustum.Planes[5] = combine(3, -1.0f, 2);
+    return frustum;
+}
+
+bool IntersectsSphere(const Frustum& Volume, const Vector3& Center, float Radius) {
+    for (const Plane& plane : Volume.Planes) {
+        if (Dot(plane.Normal, Center) + plane.D < -Radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool IntersectsBox(const Frustum& Volume, const Vector3& Min, const Vector3& Max) {
+    const Vector3 center = (Min + Max) * 0.5f;
+    const Vector3 extent = (Max - Min) * 0.5f;
+    for (const Plane& plane : Volume.Planes) {
+        float radius = extent.X * std::fabs(plane.Normal.X) + extent.Y * std::fabs(plane.Normal.Y) +
+                       extent.Z * std::fabs(plane.Normal.Z);
+        if (Dot(plane.Normal, center) + plane.D < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
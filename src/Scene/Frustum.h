@@ -0,0 +1,29 @@
+﻿// src/Scene/Frustum.h
+// View frustum as six world-space planes, extracted from a view-projection matrix.
+#pragma once
+
+#include "Math/Matrix.h"
+#include "Math/Vector.h"
+
+// Points with Dot(Normal, P) + D >= 0 are on the inner side. Normals are unit length, so the
+// same expression is a signed distance.
+struct Plane {
+    Vector3 Normal;
+    float D = 0.0f;
+};
+
+constexpr int FRUSTUM_PLANE_COUNT = 6;
+
+struct Frustum {
+    // Left, right, bottom, top, near, far.
+    Plane Planes[FRUSTUM_PLANE_COUNT];
+};
+
+// Gribb/Hartmann extraction for row-vector matrices with clip depth in [0, 1]. Works for both
+// perspective and orthographic projections; with a world matrix folded in, the planes come out
+// in that object's space instead.
+Frustum ExtractFrustum(const Matrix4& ViewProjection);
+
+// Conservative scalar tests, for single objects. Bulk tests go through FrustumCuller.
+bool IntersectsSphere(const Frustum& Volume, const Vector3& Center, float Radius);
+bool IntersectsBox(const Frustum& Volume, const Vector3& Min, const Vector3& Max);
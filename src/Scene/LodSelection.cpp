@@ -0,0 +1,39 @@
+﻿// src/Scene/LodSelection.cpp
+#include "LodSelection.h"
+
+#include <algorithm>
+#include <cmath>
+
+float GetLodPixelScale(const Camera& View,
+                       const Matrix4& World,
+                       const BoundingBox& Bounds,
+                       uint32_t ViewportHeight) {
+    // The largest stretch of World, so errors are never projected too small.
+    const float scale = std::max({Length(TransformDirection(World, Vector3{1.0f, 0.0f, 0.0f})),
+                                  Length(TransformDirection(World, Vector3{0.0f, 1.0f, 0.0f})),
+                                  Length(TransformDirection(World, Vector3{0.0f, 0.0f, 1.0f}))});
+    // M[1][1] maps view-space height to clip space, and clip space is 2 units high.
+    const float pixels =
+        View.GetProjection().M[1][1] * static_cast<float>(ViewportHeight) * 0.5f * scale;
+    if (View.GetProjectionType() == ProjectionType::Orthographic) {
+        return pixels;
+    }
+    const Vector3 center = (Bounds.Min + Bounds.Max) * 0.5f;
+    const float radius = Length(Bounds.Max - Bounds.Min) * 0.5f * scale;
+    const Vector4 position = TransformPoint(World, center);
+    const Vector3 offset = Vector3{position.X, position.Y, position.Z} - View.GetPosition();
+    const float depth = std::max(Dot(offset, View.GetForward()) - radius, View.GetNearZ());
+    return pixels / depth;
+}
+
+uint32_t SelectMeshLod(Span<const MeshLod> Lods, float PixelScale, float MaxPixelError) {
+    // Errors only grow down the chain.
+    uint32_t selected = 0;
+    for (uint32_t i = 0; i < Lods.GetSize(); ++i) {
+        if (Lods[i].Error * PixelScale > MaxPixelError) {
+            break;
+        }
+        selected = i + 1;
+    }
+    return selected;
+}
@@ -0,0 +1,22 @@
+﻿// src/Scene/LodSelection.h
+// Picks the LOD of one mesh instance for a frame: each LOD's recorded error, a distance in mesh
+// space, is projected through the camera to pixels, and the coarsest LOD that stays under the
+// allowed pixel error is drawn.
+#pragma once
+
+#include <cstdint>
+
+#include "Assets/Mesh.h"
+#include "Camera.h"
+#include "Common/Span.h"
+#include "Math/Matrix.h"
+
+// Pixels on screen per unit of mesh space at the nearest point of the instance's bounds, for a
+// viewport ViewportHeight pixels high. Inside the bounds the near plane is used.
+float GetLodPixelScale(const Camera& View,
+                       const Matrix4& World,
+                       const BoundingBox& Bounds,
+                       uint32_t ViewportHeight);
+
+// Returns 0 to draw the full mesh, or k to draw Lods[k - 1].
+uint32_t SelectMeshLod(Span<const MeshLod> Lods, float PixelScale, float MaxPixelError);
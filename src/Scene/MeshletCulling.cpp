@@ -0,0 +1,90 @@
+﻿// src/Scene/MeshletCulling.cpp
+#include "MeshletCulling.h"
+
+#include <chrono>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class MeshletCullResult { Visible, OutsideFrustum, Backfacing };
+
+// Whether the eye sees only the back of every triangle: the angle between the view direction
+// and the cone axis, widened by the cone and by the sphere as seen from the eye, stays below
+// 90 degrees. Being behind a triangle's plane survives any affine transform, and the renderer
+// flips mirrored meshes back, so testing in object space is exact.
+bool IsBackfacing(const Meshlet& Target, const MeshletViewer& Viewer) {
+    if (Target.ConeCutoff >= 1.0f) {
+        return false;
+    }
+    if (Viewer.Orthographic) {
+        return Dot(Viewer.Direction, Target.ConeAxis) >= Target.ConeCutoff;
+    }
+    const Vector3 toCenter = Target.Center - Viewer.Position;
+    return Dot(toCenter, Target.ConeAxis) >=
+           Target.ConeCutoff * Length(toCenter) + Target.Radius;
+}
+
+MeshletCullResult TestMeshlet(const Meshlet& Target, const MeshletViewer& Viewer) {
+    if (!IntersectsSphere(Viewer.Volume, Target.Center, Target.Radius)) {
+        return MeshletCullResult::OutsideFrustum;
+    }
+    if (Viewer.CullBackfaces && IsBackfacing(Target, Viewer)) {
+        return MeshletCullResult::Backfacing;
+    }
+    return MeshletCullResult::Visible;
+}
+
+} // anonymous namespace
+
+MeshletViewer MakeMeshletViewer(const Camera& View, const Matrix4& World) {
+    MeshletViewer viewer;
+    viewer.Volume = ExtractFrustum(World * View.GetViewProjection());
+    viewer.Orthographic = View.GetProjectionType() == ProjectionType::Orthographic;
+    Matrix4 inverse;
+    if (!Inverse(World, inverse)) {
+        viewer.CullBackfaces = false;
+        return viewer;
+    }
+    const Vector4 eye = TransformPoint(inverse, View.GetPosition());
+    viewer.Position = Vector3{eye.X, eye.Y, eye.Z} * (1.0f / eye.W);
+    viewer.Direction = Normalize(TransformDirection(inverse, View.GetForward()));
+    return viewer;
+}
+
+bool IsMeshletVisible(const Meshlet& Target, const MeshletViewer& Viewer) {
+    return TestMeshlet(Target, Viewer) == MeshletCullResult::Visible;
+}
+
+uint32_t CullMeshlets(Span<const Meshlet> Meshlets,
+                      const MeshletViewer& Viewer,
+                      uint32_t* OutVisible,
+                      MeshletCullStats* Stats) {
+    const Clock::time_point start = Clock::now();
+    const uint32_t count = static_cast<uint32_t>(Meshlets.GetSize());
+    uint32_t visible = 0;
+    uint32_t outside = 0;
+    uint32_t backfacing = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        switch (TestMeshlet(Meshlets[i], Viewer)) {
+        case MeshletCullResult::Visible:
+            OutVisible[visible++] = i;
+            break;
+        case MeshletCullResult::OutsideFrustum:
+            ++outside;
+            break;
+        case MeshletCullResult::Backfacing:
+            ++backfacing;
+            break;
+        }
+    }
+    if (Stats != nullptr) {
+        Stats->Tested += count;
+        Stats->Visible += visible;
+        Stats->FrustumCulled += outside;
+        Stats->BackfaceCulled += backfacing;
+        Stats->CullMs +=
+            std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+    return visible;
+}
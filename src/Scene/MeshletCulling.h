@@ -0,0 +1,43 @@
+﻿// src/Scene/MeshletCulling.h
+// Per-meshlet culling of one mesh instance: each meshlet's bounding sphere against the view
+// frustum, and its normal cone against the eye to drop meshlets that only hold back faces.
+// Both tests run in the mesh's own space, so no meshlet bounds are transformed.
+#pragma once
+
+#include <cstdint>
+
+#include "Assets/Mesh.h"
+#include "Camera.h"
+#include "Common/Span.h"
+#include "Frustum.h"
+#include "Math/Matrix.h"
+
+// The camera as seen from one mesh instance.
+struct MeshletViewer {
+    Frustum Volume;     // Object space
+    Vector3 Position;   // Eye in object space; perspective only
+    Vector3 Direction;  // View direction in object space; orthographic only
+    bool Orthographic = false;
+    bool CullBackfaces = true;
+};
+
+struct MeshletCullStats {
+    uint32_t Tested = 0;
+    uint32_t Visible = 0;
+    uint32_t FrustumCulled = 0;
+    uint32_t BackfaceCulled = 0;
+    double CullMs = 0.0;
+};
+
+// Backface culling is left off for a World that cannot be inverted.
+MeshletViewer MakeMeshletViewer(const Camera& View, const Matrix4& World);
+
+// Both tests are conservative: a meshlet with any triangle in view and facing the eye is kept.
+bool IsMeshletVisible(const Meshlet& Target, const MeshletViewer& Viewer);
+
+// Writes the indices of the visible meshlets to OutVisible, which has room for all of them, in
+// ascending order, and returns their count. Stats, if given, are added to.
+uint32_t CullMeshlets(Span<const Meshlet> Meshlets,
+                      const MeshletViewer& Viewer,
+                      uint32_t* OutVisible,
+                      MeshletCullStats* Stats = nullptr);
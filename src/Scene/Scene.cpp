@@ -0,0 +1,39 @@
+﻿// src/Scene/Scene.cpp
+#include "Scene.h"
+
+#include <algorithm>
+
+Scene::Scene() {
+    mRoot = mHierarchy.CreateNode("Scene");
+}
+
+Scene::~Scene() = default;
+
+uint32_t Scene::AddMesh(MeshView NewMesh) {
+    mMeshes.push_back(std::move(NewMesh));
+    return static_cast<uint32_t>(mMeshes.size() - 1);
+}
+
+void Scene::AddInstance(SceneNodeId Node, uint32_t MeshIndex, uint32_t Color) {
+    mInstances.push_back({Node, MeshIndex, Color});
+}
+
+void Scene::RemoveDeadInstances() {
+    mInstances.erase(std::remove_if(mInstances.begin(), mInstances.end(),
+                                    [this](const MeshInstance& Instance) {
+                                        return !mHierarchy.IsValid(Instance.Node);
+                                    }),
+                     mInstances.end());
+}
+
+BoundingBox Scene::ComputeWorldBounds() const {
+    BoundingBox bounds;
+    for (const MeshInstance& instance : mInstances) {
+        const MeshView& mesh = mMeshes[instance.MeshIndex];
+        if (!mHierarchy.IsValid(instance.Node) || IsEmpty(mesh.Bounds)) {
+            continue;
+        }
+        Grow(bounds, TransformBounds(mesh.Bounds, mHierarchy.GetWorldMatrix(instance.Node)));
+    }
+    return bounds;
+}
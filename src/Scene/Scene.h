@@ -0,0 +1,63 @@
+﻿// src/Scene/Scene.h
+// Scene content: the node hierarchy plus the meshes placed at its nodes. Importers add to it,
+// the SceneTree shows its hierarchy and the SceneView draws its instances.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Assets/Mesh.h"
+#include "SceneHierarchy.h"
+
+// One mesh drawn with the world transform of one node.
+struct MeshInstance {
+    SceneNodeId Node = INVALID_SCENE_NODE;
+    uint32_t MeshIndex = 0;
+    uint32_t Color = 0xFFFFFFFF;
+};
+
+class Scene {
+  public:
+    // Creates the hierarchy with a single root node, "Scene", that imports attach under.
+    Scene();
+    ~Scene();
+
+    Scene(const Scene&) = delete;
+    Scene& operator=(const Scene&) = delete;
+
+    SceneHierarchy& GetHierarchy() {
+        return mHierarchy;
+    }
+    const SceneHierarchy& GetHierarchy() const {
+        return mHierarchy;
+    }
+    SceneNodeId GetRoot() const {
+        return mRoot;
+    }
+
+    // Meshes are shared, so one import can be placed at many nodes. Returns the mesh index.
+    uint32_t AddMesh(MeshView NewMesh);
+    const MeshView& GetMesh(uint32_t MeshIndex) const {
+        return mMeshes[MeshIndex];
+    }
+    uint32_t GetMeshCount() const {
+        return static_cast<uint32_t>(mMeshes.size());
+    }
+
+    void AddInstance(SceneNodeId Node, uint32_t MeshIndex, uint32_t Color);
+    // Instances whose node has been destroyed stay listed until RemoveDeadInstances; check
+    // GetHierarchy().IsValid(Node) before using one.
+    const std::vector<MeshInstance>& GetInstances() const {
+        return mInstances;
+    }
+    void RemoveDeadInstances();
+
+    // World-space box around every live instance. World transforms must be up to date.
+    BoundingBox ComputeWorldBounds() const;
+
+  private:
+    SceneHierarchy mHierarchy;
+    SceneNodeId mRoot = INVALID_SCENE_NODE;
+    std::vector<MeshView> mMeshes;
+    std::vector<MeshInstance> mInstances;
+};
@@ -0,0 +1,239 @@
+﻿// src/Scene/SceneHierarchy.cpp
+#include "SceneHierarchy.h"
+
+#include <algorithm>
+
+#include "Common/Profiler.h"
+#include "Common/ThreadPool.h"
+
+namespace {
+
+// Subtrees up to this many nodes are updated as one unit on one thread.
+constexpr uint32_t UPDATE_BATCH_NODES = 1024;
+
+// Below this many dirty nodes, waking the workers costs more than the update itself.
+constexpr uint32_t PARALLEL_UPDATE_MIN_NODES = 4 * UPDATE_BATCH_NODES;
+
+template <typename T> void InsertAt(std::vector<T>& Array, uint32_t Index, const T& Value) {
+    Array.insert(Array.begin() + Index, Value);
+}
+
+template <typename T> void EraseRange(std::vector<T>& Array, uint32_t Begin, uint32_t Count) {
+    Array.erase(Array.begin() + Begin, Array.begin() + Begin + Count);
+}
+
+} // anonymous namespace
+
+SceneHierarchy::SceneHierarchy() = default;
+
+SceneHierarchy::~SceneHierarchy() = default;
+
+SceneNodeId SceneHierarchy::CreateNode(const std::string& Name,
+                                       SceneNodeId Parent,
+                                       const Transform& Local) {
+    uint32_t parentIndex = IsValid(Parent) ? mIndexOfId[Parent] : INVALID_SCENE_NODE;
+    uint32_t index = parentIndex != INVALID_SCENE_NODE ? parentIndex + mSubtreeSize[parentIndex]
+                                                       : GetNodeCount();
+
+    SceneNodeId id;
+    if (!mFreeIds.empty()) {
+        id = mFreeIds.back();
+        mFreeIds.pop_back();
+    } else {
+        id = static_cast<SceneNodeId>(mIndexOfId.size());
+        mIndexOfId.push_back(INVALID_SCENE_NODE);
+    }
+
+    if (index != GetNodeCount()) {
+        // Everything from the insertion point on moves up by one.
+        for (uint32_t& p : mParent) {
+            if (p != INVALID_SCENE_NODE && p >= index) {
+                ++p;
+            }
+        }
+        for (uint32_t& i : mIndexOfId) {
+            if (i != INVALID_SCENE_NODE && i >= index) {
+                ++i;
+            }
+        }
+    }
+
+    InsertAt(mParent, index, parentIndex);
+    InsertAt(mSubtreeSize, index, 1u);
+    InsertAt(mLocal, index, Local);
+    InsertAt(mWorld, index, Matrix4{});
+    InsertAt(mDirty, index, uint8_t{0});
+    InsertAt(mIdOfIndex, index, id);
+    InsertAt(mNames, index, Name);
+    mIndexOfId[id] = index;
+
+    for (uint32_t a = parentIndex; a != INVALID_SCENE_NODE; a = mParent[a]) {
+        ++mSubtreeSize[a];
+    }
+
+    MarkDirty(id, index);
+    ++mRevision;
+    return id;
+}
+
+void SceneHierarchy::DestroyNode(SceneNodeId Id) {
+    if (!IsValid(Id)) {
+        return;
+    }
+
+    const uint32_t index = mIndexOfId[Id];
+    const uint32_t count = mSubtreeSize[index];
+
+    for (uint32_t a = mParent[index]; a != INVALID_SCENE_NODE; a = mParent[a]) {
+        mSubtreeSize[a] -= count;
+    }
+    for (uint32_t i = index; i < index + count; ++i) {
+        mIndexOfId[mIdOfIndex[i]] = INVALID_SCENE_NODE;
+        mFreeIds.push_back(mIdOfIndex[i]);
+    }
+
+    EraseRange(mParent, index, count);
+    EraseRange(mSubtreeSize, index, count);
+    EraseRange(mLocal, index, count);
+    EraseRange(mWorld, index, count);
+    EraseRange(mDirty, index, count);
+    EraseRange(mIdOfIndex, index, count);
+    EraseRange(mNames, index, count);
+
+    // Everything behind the removed range moves down by count.
+    for (uint32_t& p : mParent) {
+        if (p != INVALID_SCENE_NODE && p > index) {
+            p -= count;
+        }
+    }
+    for (uint32_t& i : mIndexOfId) {
+        if (i != INVALID_SCENE_NODE && i > index) {
+            i -= count;
+        }
+    }
+
+    mDirtyNodes.erase(std::remove_if(mDirtyNodes.begin(), mDirtyNodes.end(),
+                                     [this](SceneNodeId Dirty) { return !IsValid(Dirty); }),
+                      mDirtyNodes.end());
+    ++mRevision;
+}
+
+void SceneHierarchy::SetLocalTransform(SceneNodeId Id, const Transform& Local) {
+    const uint32_t index = mIndexOfId[Id];
+    mLocal[index] = Local;
+    MarkDirty(Id, index);
+}
+
+SceneNodeId SceneHierarchy::GetParent(SceneNodeId Id) const {
+    uint32_t parentIndex = mParent[mIndexOfId[Id]];
+    return parentIndex != INVALID_SCENE_NODE ? mIdOfIndex[parentIndex] : INVALID_SCENE_NODE;
+}
+
+void SceneHierarchy::MarkDirty(SceneNodeId Id, uint32_t Index) {
+    if (!mDirty[Index]) {
+        mDirty[Index] = 1;
+        mDirtyNodes.push_back(Id);
+    }
+}
+
+void SceneHierarchy::UpdateNode(uint32_t Index) {
+    const Transform& local = mLocal[Index];
+    Matrix4 matrix = MatrixCompose(local.Translation, local.Rotation, local.Scale);
+    const uint32_t parent = mParent[Index];
+    mWorld[Index] = parent != INVALID_SCENE_NODE ? Multiply(matrix, mWorld[parent]) : matrix;
+}
+
+void SceneHierarchy::AddUpdateRange(uint32_t Begin, uint32_t End) {
+    // Back-to-back ranges can share a batch: a range only depends on nodes before it that are
+    // either clean or already updated, so walking both in order stays correct.
+    if (!mUpdateRanges.empty()) {
+        UpdateRange& last = mUpdateRanges.back();
+        if (last.End == Begin && End - last.Begin <= UPDATE_BATCH_NODES) {
+            last.End = End;
+            return;
+        }
+    }
+    mUpdateRanges.push_back({Begin, End});
+}
+
+uint32_t SceneHierarchy::SplitDirtySubtree(uint32_t Root) {
+    // Oversized subtrees are peeled one level at a time: the root is updated right here, which
+    // makes each of its child subtrees independent of the others. Iterative, since hierarchies
+    // can be deep chains.
+    uint32_t updated = 0;
+    mSplitStack.clear();
+    mSplitStack.push_back(Root);
+    while (!mSplitStack.empty()) {
+        const uint32_t node = mSplitStack.back();
+        mSplitStack.pop_back();
+
+        const uint32_t end = node + mSubtreeSize[node];
+        if (end - node <= UPDATE_BATCH_NODES) {
+            AddUpdateRange(node, end);
+            continue;
+        }
+
+        UpdateNode(node);
+        ++updated;
+        for (uint32_t child = node + 1; child < end; child += mSubtreeSize[child]) {
+            if (mSubtreeSize[child] > UPDATE_BATCH_NODES) {
+                mSplitStack.push_back(child);
+            } else {
+                AddUpdateRange(child, child + mSubtreeSize[child]);
+            }
+        }
+    }
+    return updated;
+}
+
+uint32_t SceneHierarchy::UpdateWorldTransforms(ThreadPool* Pool) {
+    PROFILE_ZONE("UpdateWorldTransforms");
+    if (mDirtyNodes.empty()) {
+        return 0;
+    }
+
+    mDirtyIndices.clear();
+    for (SceneNodeId id : mDirtyNodes) {
+        const uint32_t index = mIndexOfId[id];
+        mDirty[index] = 0;
+        mDirtyIndices.push_back(index);
+    }
+    mDirtyNodes.clear();
+    std::sort(mDirtyIndices.begin(), mDirtyIndices.end());
+
+    // In pre-order a dirty node inside an earlier dirty subtree is already covered by it, so one
+    // forward pass keeps only the topmost dirty roots.
+    mUpdateRanges.clear();
+    uint32_t updated = 0;
+    uint32_t coveredEnd = 0;
+    for (uint32_t index : mDirtyIndices) {
+        if (index < coveredEnd) {
+            continue;
+        }
+        coveredEnd = index + mSubtreeSize[index];
+        updated += SplitDirtySubtree(index);
+    }
+
+    uint32_t rangeNodes = 0;
+    for (const UpdateRange& range : mUpdateRanges) {
+        rangeNodes += range.End - range.Begin;
+    }
+
+    auto updateRange = [this](uint32_t RangeIndex, uint32_t) {
+        const UpdateRange& range = mUpdateRanges[RangeIndex];
+        for (uint32_t i = range.Begin; i < range.End; ++i) {
+            UpdateNode(i);
+        }
+    };
+
+    const uint32_t rangeCount = static_cast<uint32_t>(mUpdateRanges.size());
+    if (Pool && rangeCount > 1 && rangeNodes >= PARALLEL_UPDATE_MIN_NODES) {
+        Pool->ParallelFor(rangeCount, updateRange);
+    } else {
+        for (uint32_t r = 0; r < rangeCount; ++r) {
+            updateRange(r, 0);
+        }
+    }
+
+    return updated + rangeNodes;
+}
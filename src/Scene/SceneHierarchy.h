@@ -0,0 +1,129 @@
+﻿// src/Scene/SceneHierarchy.h
+// Data-oriented transform hierarchy. Nodes live in flat arrays kept in depth-first pre-order, so
+// every parent precedes its children and every subtree is one contiguous index range.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Math/Matrix.h"
+#include "Math/Quaternion.h"
+#include "Math/Vector.h"
+
+class ThreadPool;
+
+// Stable node handle. Array indices move when nodes are inserted or removed; ids do not.
+using SceneNodeId = uint32_t;
+constexpr SceneNodeId INVALID_SCENE_NODE = 0xFFFFFFFFu;
+
+// Local transform relative to the parent: scale, then rotate, then translate.
+struct Transform {
+    Vector3 Translation;
+    Quaternion Rotation;
+    Vector3 Scale{1.0f, 1.0f, 1.0f};
+};
+
+class SceneHierarchy {
+  public:
+    SceneHierarchy();
+    ~SceneHierarchy();
+
+    SceneHierarchy(const SceneHierarchy&) = delete;
+    SceneHierarchy& operator=(const SceneHierarchy&) = delete;
+
+    // Adds a node as the last child of Parent, or as a new root when Parent is invalid.
+    // Appending to the most recently added subtree is O(depth); inserting into an earlier subtree
+    // shifts the arrays behind it.
+    SceneNodeId CreateNode(const std::string& Name,
+                           SceneNodeId Parent = INVALID_SCENE_NODE,
+                           const Transform& Local = Transform{});
+
+    // Removes Id together with its whole subtree.
+    void DestroyNode(SceneNodeId Id);
+
+    // Replaces the local transform and marks the node's subtree for the next update.
+    void SetLocalTransform(SceneNodeId Id, const Transform& Local);
+
+    bool IsValid(SceneNodeId Id) const {
+        return Id < mIndexOfId.size() && mIndexOfId[Id] != INVALID_SCENE_NODE;
+    }
+
+    const std::string& GetName(SceneNodeId Id) const {
+        return mNames[mIndexOfId[Id]];
+    }
+    SceneNodeId GetParent(SceneNodeId Id) const;
+    const Transform& GetLocalTransform(SceneNodeId Id) const {
+        return mLocal[mIndexOfId[Id]];
+    }
+    // Valid as of the last UpdateWorldTransforms call.
+    const Matrix4& GetWorldMatrix(SceneNodeId Id) const {
+        return mWorld[mIndexOfId[Id]];
+    }
+
+    // Recomputes world matrices of every dirty subtree and nothing else. Subtrees larger than a
+    // batch are split at their children so independent branches run on Pool's threads; with no
+    // pool everything runs on the caller. Returns the number of nodes recomputed.
+    uint32_t UpdateWorldTransforms(ThreadPool* Pool = nullptr);
+
+    // --- Flat pre-order access for views and bulk systems ---
+    uint32_t GetNodeCount() const {
+        return static_cast<uint32_t>(mParent.size());
+    }
+    uint32_t GetIndex(SceneNodeId Id) const {
+        return mIndexOfId[Id];
+    }
+    SceneNodeId GetNodeAt(uint32_t Index) const {
+        return mIdOfIndex[Index];
+    }
+    // INVALID_SCENE_NODE for roots.
+    uint32_t GetParentIndex(uint32_t Index) const {
+        return mParent[Index];
+    }
+    // Node count of the subtree rooted at Index, itself included.
+    uint32_t GetSubtreeSize(uint32_t Index) const {
+        return mSubtreeSize[Index];
+    }
+    const Matrix4* GetWorldMatrices() const {
+        return mWorld.data();
+    }
+
+    // Bumped by every structural change (create, destroy) so views know when to rebuild.
+    uint32_t GetRevision() const {
+        return mRevision;
+    }
+
+  private:
+    struct UpdateRange {
+        uint32_t Begin;
+        uint32_t End;
+    };
+
+    void MarkDirty(SceneNodeId Id, uint32_t Index);
+    void UpdateNode(uint32_t Index);
+    void AddUpdateRange(uint32_t Begin, uint32_t End);
+    uint32_t SplitDirtySubtree(uint32_t Root);
+
+    // Per node, indexed by pre-order position.
+    std::vector<uint32_t> mParent;
+    std::vector<uint32_t> mSubtreeSize;
+    std::vector<Transform> mLocal;
+    std::vector<Matrix4> mWorld;
+    std::vector<uint8_t> mDirty;
+    std::vector<SceneNodeId> mIdOfIndex;
+    std::vector<std::string> mNames;
+
+    // Per id.
+    std::vector<uint32_t> mIndexOfId;
+    std::vector<SceneNodeId> mFreeIds;
+
+    // Nodes whose local transform changed since the last update.
+    std::vector<SceneNodeId> mDirtyNodes;
+
+    // Update scratch, kept to avoid reallocating every frame.
+    std::vector<uint32_t> mDirtyIndices;
+    std::vector<UpdateRange> mUpdateRanges;
+    std::vector<uint32_t> mSplitStack;
+
+    uint32_t mRevision = 0;
+};
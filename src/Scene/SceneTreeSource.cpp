@@ -0,0 +1,33 @@
+﻿// src/Scene/SceneTreeSource.cpp
+#include "SceneTreeSource.h"
+
+bool SceneTreeSource::ListChildren(TreeKey Parent,
+                                   TreeKey After,
+                                   uint32_t MaxCount,
+                                   std::vector<TreeKey>& Out) const {
+    // The children of a node are the subtrees that tile its own range, one after another.
+    uint32_t end = mHierarchy.GetNodeCount();
+    uint32_t index = 0;
+    if (Parent != INVALID_TREE_KEY) {
+        const uint32_t parent = mHierarchy.GetIndex(Parent);
+        end = parent + mHierarchy.GetSubtreeSize(parent);
+        index = parent + 1;
+    }
+    if (After != INVALID_TREE_KEY) {
+        const uint32_t after = mHierarchy.GetIndex(After);
+        index = after + mHierarchy.GetSubtreeSize(after);
+    }
+    for (; index < end && MaxCount > 0; --MaxCount) {
+        Out.push_back(mHierarchy.GetNodeAt(index));
+        index += mHierarchy.GetSubtreeSize(index);
+    }
+    return index < end;
+}
+
+bool SceneTreeSource::HasChildren(TreeKey Key) const {
+    return mHierarchy.GetSubtreeSize(mHierarchy.GetIndex(Key)) > 1;
+}
+
+TreeKey SceneTreeSource::GetParent(TreeKey Key) const {
+    return mHierarchy.GetParent(Key);
+}
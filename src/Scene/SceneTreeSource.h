@@ -0,0 +1,23 @@
+﻿// src/Scene/SceneTreeSource.h
+// Presents a SceneHierarchy to a TreeModel. Keys are node ids; children are found through the
+// pre-order subtree sizes, so nothing is stored per node.
+#pragma once
+
+#include "Common/TreeModel.h"
+#include "Scene/SceneHierarchy.h"
+
+class SceneTreeSource : public TreeSource {
+  public:
+    explicit SceneTreeSource(const SceneHierarchy& Hierarchy) : mHierarchy(Hierarchy) {
+    }
+
+    bool ListChildren(TreeKey Parent,
+                      TreeKey After,
+                      uint32_t MaxCount,
+                      std::vector<TreeKey>& Out) const override;
+    bool HasChildren(TreeKey Key) const override;
+    TreeKey GetParent(TreeKey Key) const override;
+
+  private:
+    const SceneHierarchy& mHierarchy;
+};
@@ -3,13 +3,17 @@
 #include "FileView.h"
 #include <commctrl.h> // Required for ListView functions (e.g., ListView_InsertItem)
 #include <filesystem>
-#include "Common/Debug.h"
+#include <vector>
+#include "Common/Log.h"
+#include "Files/FileTreeSource.h"
 #include "Files/WorkingDirFileProvider.h"
 
 // Link with Comctl32.lib for common controls
 #pragma comment(lib, "Comctl32.lib")
 
-FileView::FileView(BaseFileProvider& fileProvider) : mFileProvider(fileProvider) {
+FileView::FileView(BaseFileProvider& fileProvider)
+    : VirtualTreeView(std::make_unique<FileTreeSource>(fileProvider)),
+      mFileProvider(fileProvider) {
 }
 
 FileView::~FileView() = default;
@@ -36,7 +40,7 @@ bool FileView::OnCreate(HWND hParent, UINT id) {
                            GetModuleHandle(nullptr), nullptr);
 
     if (mHWnd == nullptr) {
-        DEBUGPRINT(L"Failed to create FileView TreeView.\n");
+        LOG_ERROR(Window, "Failed to create FileView TreeView");
         return false;
     }
 
@@ -47,53 +51,18 @@ bool FileView::OnCreate(HWND hParent, UINT id) {
 
 // Populates the file view control with the files within the same dir.
 void FileView::PopulateFileView() {
-    // Clear any existing items in the tree view before populating
-    TreeView_DeleteAllItems(mHWnd);
-
     try {
-        // Get the current directory as a FileEntry directly from the file provider
-        FileEntry rootEntry = mFileProvider.getCurrentDirectory();
-        std::wstring rootDisplayName = rootEntry.name;
-
-        // Structure to insert the root item (current folder)
-        TVITEMW tvItem{};
-        tvItem.mask = TVIF_TEXT;
-        tvItem.pszText = const_cast<LPWSTR>(rootDisplayName.c_str());
-
-        TVINSERTSTRUCTW tvInsert{};
-        tvInsert.hParent = TVI_ROOT;      // This item is a root item
-        tvInsert.hInsertAfter = TVI_LAST; // Insert at the end
-        tvInsert.item = tvItem;           // Assign the TVITEMW structure
-
-        // Insert the root item and get its handle
-        HTREEITEM hRoot = TreeView_InsertItem(mHWnd, &tvInsert);
-
-        if (hRoot == nullptr) {
-            MessageBoxW(nullptr, L"Failed to insert root item into TreeView.", L"Error",
-                        MB_OK | MB_ICONERROR);
-            return;
-        }
-
-        // Iterate through the directory to add files as children of the root node
-        for (const auto& entry : mFileProvider) {
-            // Structure to insert a child item (file)
-            TVITEMW tvChildItem{}; // Explicitly use TVITEMW for wide characters
-            tvChildItem.mask = TVIF_TEXT;
-            tvChildItem.pszText = const_cast<LPWSTR>(entry.name.c_str());
-
-            TVINSERTSTRUCTW
-            tvChildInsert{};               // Explicitly use TVINSERTSTRUCTW for wide characters
-            tvChildInsert.hParent = hRoot; // This item is a child of the root folder
-            tvChildInsert.hInsertAfter = TVI_LAST; // Insert at the end
-            tvChildInsert.item = tvChildItem;      // Assign the TVITEMW structure
-
-            // Insert the file item
-            TreeView_InsertItem(mHWnd, &tvChildInsert);
-        }
-
-        // Explicitly expand the root node using SendMessage
-        // This is often more reliable than just TreeView_Expand macro
-        SendMessage(mHWnd, TVM_EXPAND, TVE_EXPAND, (LPARAM)hRoot);
+        // Reads the directory tree on first use.
+        mFileProvider.begin();
+
+        // The model lists the root folder item; its entries come in on expansion, like any
+        // folder's. Reset clears the tree view's items through the applied changes.
+        SendMessage(mHWnd, WM_SETREDRAW, FALSE, 0);
+        mTreeModel.Reset();
+        mTreeModel.Expand(mTreeModel.FindNode(FILE_TREE_ROOT_KEY));
+        ApplyModelChanges();
+        SendMessage(mHWnd, WM_SETREDRAW, TRUE, 0);
+        UpdateVisibleRows();
 
         // Force a redraw of the TreeView to ensure expansion is visible immediately
         UpdateWindow(mHWnd);
@@ -121,4 +90,47 @@ void FileView::PopulateFileView() {
         }
         MessageBoxW(nullptr, errorMsg.c_str(), L"Error", MB_OK | MB_ICONERROR);
     }
-}
\ No newline at end of file
+}
+
+void FileView::ApplyChanges(const std::vector<FileDelta>& Changes) {
+    if (mHWnd == nullptr) {
+        return;
+    }
+    for (const FileDelta& change : Changes) {
+        switch (change.Type) {
+        case FileChangeType::Overflow:
+            // The entries were read again and the indices changed: start over.
+            PopulateFileView();
+            return;
+        case FileChangeType::Added: {
+            // Only shows up if its folder's entries are listed already.
+            const uint32_t parent = mFileProvider.getEntry(change.Index).Parent;
+            mTreeModel.OnInserted(parent != INVALID_FILE_INDEX ? parent : FILE_TREE_ROOT_KEY,
+                                  change.Index);
+            break;
+        }
+        case FileChangeType::Removed:
+            mTreeModel.OnRemoved(change.Index);
+            break;
+        case FileChangeType::Modified:
+            break; // Name and place are unchanged
+        }
+    }
+    ApplyModelChanges();
+}
+
+const wchar_t* FileView::GetItemText(TreeKey Key) {
+    if (Key == FILE_TREE_ROOT_KEY) {
+        return mFileProvider.getCurrentDirectory().Name;
+    }
+    return mFileProvider.getEntry(Key).Name;
+}
+
+std::filesystem::path FileView::GetItemPath(HTREEITEM Item) const {
+    // The root folder item and placeholders have no entry.
+    const TreeKey key = GetItemKey(Item);
+    if (key == FILE_TREE_ROOT_KEY || key == INVALID_TREE_KEY) {
+        return {};
+    }
+    return mFileProvider.getEntryPath(key);
+}
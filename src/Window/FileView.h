@@ -2,10 +2,12 @@
 // Created by dtcimbal on 26/05/2025.
 #pragma once
 
-#include "BaseView.h"
+#include "VirtualTreeView.h"
+#include <filesystem>
+#include <vector>
 #include "Files/BaseFileProvider.h"
 
-class FileView : public BaseView {
+class FileView : public VirtualTreeView {
   public:
     FileView(BaseFileProvider& fileProvider);
     ~FileView() override;
@@ -13,9 +15,21 @@ class FileView : public BaseView {
     // Overrides BaseView::Create to create the ListView control.
     bool OnCreate(HWND hParent, UINT id) override;
 
-    // Specific logic for populating the file list.
+    // Specific logic for populating the file list. Only the root folder and its entries get
+    // items; a folder's entries are inserted when it is first expanded, in batches as they are
+    // scrolled to.
     void PopulateFileView();
 
+    // Inserts and deletes the items of the entries that changed, as reported by
+    // BaseFileProvider::pollChanges, leaving the rest of the tree and its expansion as it is.
+    void ApplyChanges(const std::vector<FileDelta>& Changes);
+
+    // Full path of the file or folder shown by Item, or an empty path for the root folder item.
+    std::filesystem::path GetItemPath(HTREEITEM Item) const;
+
   private:
+    // Names stay in the provider's scan; items keep none of their own.
+    const wchar_t* GetItemText(TreeKey Key) override;
+
     BaseFileProvider& mFileProvider;
 };
\ No newline at end of file
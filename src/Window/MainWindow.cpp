@@ -3,38 +3,48 @@
 #include <Windows.h>  // Core Windows API functions (e.g., CreateWindowEx, DefWindowProc)
 #include <CommCtrl.h> // Common Controls (e.g., InitCommonControlsEx, WC_TREEVIEW)
 #include <stdexcept>  // For std::runtime_error, useful for more robust error handling
-#include <string>     // For std::wstring and std::to_wstring (for debug output)
 
 #include "FileView.h" // Include definitions for view component classes
 #include "MainWindow.h"
 
+#include <algorithm>
 #include <sstream>
 
-#include "Common/Debug.h"
+#include "Assets/SceneImport.h"
+#include "Common/Log.h"
+#include "Common/Profiler.h"
+#include "Common/ThreadPool.h"
 #include "Files/WorkingDirFileProvider.h"
+#include "Scene/Scene.h"
 #include "SceneTree.h"
 #include "SceneView.h"
 
 // Anonymous namespace for constants internal to this compilation unit
 namespace {
 const int SPLITTER_WIDTH = 5; // Thickness of the splitter bars in pixels
+// Colors handed out to imported meshes in turn, so neighbouring imports stay distinguishable.
+const uint32_t IMPORT_PALETTE[4] = {0xFFE08030, 0xFF3080E0, 0xFF40C060, 0xFFD0D040};
+// Files the user opened load ahead of anything streamed in by position.
+constexpr float OPEN_ASSET_PRIORITY = 1.0e6f;
+constexpr uint32_t STREAMER_THREAD_COUNT = 2;
+constexpr uint64_t STREAMER_BUDGET_BYTES = 1024ull * 1024 * 1024;
 } // anonymous namespace
 
 // Constructor: Initializes members and performs window class registration and main window creation.
 MainWindow::MainWindow()
     : mHWnd(nullptr), mHwndSplitter1(nullptr), mHwndSplitter2(nullptr),
-      mHInstance(GetModuleHandle(nullptr)) {
+      mHInstance(GetModuleHandle(nullptr)), mPacer(mFrameClock, FramePacingSettings{}) {
     // No pane proportions needed for fixed splitters; layout will be hardcoded.
 
     // Register the main window class. If registration fails, an error is logged.
     if (!RegisterWindowClass()) {
-        DEBUGPRINT(L"ERROR: Failed to register main window class!\n");
+        LOG_ERROR(Window, "Failed to register main window class");
         return;
     }
 
     // Create the main application window. If creation fails, an error is logged.
     if (!CreateMainWindow()) {
-        DEBUGPRINT(L"ERROR: Failed to create main window!\n");
+        LOG_ERROR(Window, "Failed to create main window");
         return;
     }
 }
@@ -59,8 +69,8 @@ ATOM MainWindow::RegisterWindowClass() {
 
     ATOM atom = RegisterClassEx(&wc);
     if (atom == 0) {
-        DEBUGPRINT(L"RegisterClassEx failed for %s. Error: %s", MAIN_CLASS_NAME,
-                   std::to_wstring(GetLastError()).c_str());
+        LOG_ERROR(Window, "RegisterClassEx failed for %s. Error: %lu", MAIN_CLASS_NAME,
+                  GetLastError());
     }
     return atom;
 }
@@ -72,8 +82,8 @@ bool MainWindow::CreateMainWindow() {
     WNDCLASSEX wcInfo = {};
     wcInfo.cbSize = sizeof(WNDCLASSEX);
     if (!GetClassInfoEx(mHInstance, MAIN_CLASS_NAME, &wcInfo)) {
-        DEBUGPRINT(L"CreateMainWindow: Class '%s' is NOT registered! Error: %s", MAIN_CLASS_NAME,
-                   std::to_wstring(GetLastError()).c_str());
+        LOG_ERROR(Window, "CreateMainWindow: Class '%s' is NOT registered! Error: %lu",
+                  MAIN_CLASS_NAME, GetLastError());
         return false;
     }
 
@@ -92,7 +102,7 @@ bool MainWindow::CreateMainWindow() {
     );
 
     if (mHWnd == nullptr) {
-        DEBUGPRINT(L"CreateWindowEx failed. Error: %s", std::to_wstring(GetLastError()).c_str());
+        LOG_ERROR(Window, "CreateWindowEx failed. Error: %lu", GetLastError());
         return false;
     }
 
@@ -154,8 +164,19 @@ LRESULT MainWindow::HandleMessage(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lP
     }
     case WM_NOTIFY: {
         LPNMHDR lpnmh = reinterpret_cast<LPNMHDR>(lParam);
+        // Both trees fill in item text and children on demand.
+        LRESULT result = 0;
+        if (mFileView && lpnmh->hwndFrom == mFileView->GetHWND() &&
+            mFileView->OnNotify(lpnmh, result)) {
+            return result;
+        }
+        if (mSceneTree && lpnmh->hwndFrom == mSceneTree->GetHWND() &&
+            mSceneTree->OnNotify(lpnmh, result)) {
+            return result;
+        }
         if (mFileView && lpnmh->hwndFrom == mFileView->GetHWND() && lpnmh->code == TVN_SELCHANGED) {
-            // Placeholder for file selection logic.
+            const NMTREEVIEWW* pnmtv = reinterpret_cast<const NMTREEVIEWW*>(lParam);
+            OpenAsset(mFileView->GetItemPath(pnmtv->itemNew.hItem));
         }
         return 0;
     }
@@ -180,13 +201,13 @@ void MainWindow::OnCreate(HWND hWnd, LPCREATESTRUCT pcs) {
     // --- Create the Menu Bar ---
     HMENU hMenuBar = CreateMenu();
     if (hMenuBar == nullptr) {
-        DEBUGPRINT(L"ERROR: Failed to create menu bar!\n");
+        LOG_ERROR(Window, "Failed to create menu bar");
         return;
     }
 
     HMENU hSceneMenu = CreatePopupMenu();
     if (hSceneMenu == nullptr) {
-        DEBUGPRINT(L"ERROR: Failed to create scene menu!\n");
+        LOG_ERROR(Window, "Failed to create scene menu");
         DestroyMenu(hMenuBar);
         return;
     }
@@ -195,18 +216,34 @@ void MainWindow::OnCreate(HWND hWnd, LPCREATESTRUCT pcs) {
     AppendMenuW(hMenuBar, MF_POPUP, reinterpret_cast<UINT_PTR>(hSceneMenu), L"&Scene");
     SetMenu(hWnd, hMenuBar);
 
-    // Create instances of our view components
-    mFileProvider = std::make_unique<WorkingDirFileProvider>();
+    // The UI thread and the scene view's render thread take part in jobs too, so the workers
+    // get the remaining cores.
+    const uint32_t cores = std::thread::hardware_concurrency();
+    mThreadPool = std::make_unique<ThreadPool>(cores > 3 ? cores - 2 : 1, false, 1);
+    // Import workers sleep unless a file is being parsed; half the cores leaves the frame room.
+    mImportPool = std::make_unique<ThreadPool>(std::max(cores / 2, 1u));
+
+    // Create instances of our view components. The file view lists what OpenAsset can load.
+    DirectoryScanSettings scanSettings;
+    scanSettings.Extensions = GetSceneImportExtensions();
+    scanSettings.ExcludedDirectories = GetSceneImportExcludedDirectories();
+    mFileProvider = std::make_unique<WorkingDirFileProvider>(mThreadPool.get(), scanSettings);
+    // Changes are noticed on the watcher thread; an empty message wakes an idle Run to apply them.
+    mFileProvider->setChangeListener([hWnd] { PostMessageW(hWnd, WM_NULL, 0, 0); });
 
     mFileView = std::make_unique<FileView>(*mFileProvider);
     if (mFileView)
         mFileView->Create(hWnd, static_cast<UINT>(ChildWindowIDs::FileView));
 
-    mSceneView = std::make_unique<SceneView>();
+    // Loaded content gets attached under the scene's root node.
+    mScene = std::make_unique<Scene>();
+    mStreamer = std::make_unique<AssetStreamer>(STREAMER_THREAD_COUNT, STREAMER_BUDGET_BYTES);
+
+    mSceneView = std::make_unique<SceneView>(*mScene, *mThreadPool);
     if (mSceneView)
         mSceneView->Create(hWnd, static_cast<UINT>(ChildWindowIDs::SceneView));
 
-    mSceneTree = std::make_unique<SceneTree>();
+    mSceneTree = std::make_unique<SceneTree>(mScene->GetHierarchy());
     if (mSceneTree)
         mSceneTree->Create(hWnd, static_cast<UINT>(ChildWindowIDs::SceneTree));
 
@@ -216,13 +253,13 @@ void MainWindow::OnCreate(HWND hWnd, LPCREATESTRUCT pcs) {
     mHwndSplitter1 = CreateWindowEx(0, L"STATIC", L"", WS_CHILD | WS_VISIBLE | SS_GRAYRECT, 0, 0, 0,
                                     0, hWnd, splitter1Id, mHInstance, nullptr);
     if (!mHwndSplitter1)
-        DEBUGPRINT(L"ERROR: Failed to create m_hwndSplitter1!\n");
+        LOG_ERROR(Window, "Failed to create m_hwndSplitter1");
 
     HMENU splitter2Id = reinterpret_cast<HMENU>(static_cast<UINT_PTR>(ChildWindowIDs::Splitter2));
     mHwndSplitter2 = CreateWindowEx(0, L"STATIC", L"", WS_CHILD | WS_VISIBLE | SS_GRAYRECT, 0, 0, 0,
                                     0, hWnd, splitter2Id, mHInstance, nullptr);
     if (!mHwndSplitter2)
-        DEBUGPRINT(L"ERROR: Failed to create m_hwndSplitter2!\n");
+        LOG_ERROR(Window, "Failed to create m_hwndSplitter2");
 
     // Perform initial layout after all controls are created.
     RECT rcClient;
@@ -231,31 +268,242 @@ void MainWindow::OnCreate(HWND hWnd, LPCREATESTRUCT pcs) {
 }
 
 int MainWindow::Run() {
+    PROFILE_THREAD("Main");
     MSG msg = {};
-    while (msg.message != WM_QUIT && OnUpdate()) {
+    while (msg.message != WM_QUIT) {
+        // A static scene needs no frames: sleep in the message queue instead of spinning.
+        if (mPacer.ShouldIdle()) {
+            WaitMessage();
+        }
         while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
             if (msg.message == WM_QUIT) {
                 break;
             }
             TranslateMessage(&msg);
             DispatchMessage(&msg);
+            // Input, resizes and file selections can all change what the scene view shows.
+            mPacer.RequestFrame();
         }
+        if (msg.message == WM_QUIT || !OnUpdate()) {
+            break;
+        }
+        mPacer.EndFrame();
     }
     return (msg.message == WM_QUIT) ? static_cast<int>(msg.wParam) : 0;
 }
 
 bool MainWindow::OnUpdate() {
+    PROFILE_ZONE("MainWindow::OnUpdate");
+    // Nothing runs fixed simulation steps yet; the pacer still needs to see each frame begin.
+    mPacer.BeginFrame();
     // TODO Handle user input
     // TODO update the state/camera
 
-    // Draw the scene
+    // Files changed on disk are reloaded here, so the new loads start before the streamer update.
+    ApplyFileChanges();
+    if (mFileView) {
+        mFileView->UpdateVisibleRows();
+    }
+
+    // Finished loads join the scene here, before transforms are updated for the frame.
+    if (mStreamer) {
+        // Loads finish on I/O threads without a window message, so keep polling while any are
+        // in flight. Read before Update, which then hands over every load this saw finish.
+        const AssetStreamerStats streamerStats = mStreamer->GetStats();
+        if (streamerStats.Queued > 0 || streamerStats.Loading > 0) {
+            mPacer.RequestFrame();
+        }
+        if (mSceneView) {
+            mStreamer->SetViewerPosition(mSceneView->GetCamera().GetPosition());
+        }
+        mStreamer->Update();
+    }
+    if (mScene) {
+        mScene->GetHierarchy().UpdateWorldTransforms(mThreadPool.get());
+    }
+    if (mSceneTree) {
+        mSceneTree->PopulateSceneTree();
+    }
+
+    // Snapshot the scene for the render thread, which draws it while the next frame updates.
     if (mSceneView) {
         mSceneView->OnUpdate();
     }
 
+    PROFILE_FRAME();
     return true;
 }
 
+void MainWindow::OpenAsset(const std::filesystem::path& Path) {
+    if (!IsSceneImportFile(Path)) {
+        return;
+    }
+    // Clicking through the file view only loads the file that ends up selected.
+    if (mPendingOpen.IsValid()) {
+        mPendingOpen.Cancel();
+    }
+
+    AssetRequest request;
+    request.Path = Path;
+    request.Loader = MakeSceneImportLoader(SceneImportSettings{}, mImportPool.get());
+    request.OnComplete = [this](const AssetHandle& Handle) { OnAssetLoaded(Handle); };
+    request.Priority = OPEN_ASSET_PRIORITY;
+    mPendingOpen = mStreamer->Request(std::move(request));
+}
+
+void MainWindow::OnAssetLoaded(const AssetHandle& Handle) {
+    const std::filesystem::path& path = Handle.GetPath();
+    if (Handle.GetStatus() != AssetStatus::Ready) {
+        if (Handle.GetStatus() == AssetStatus::Failed) {
+            LOG_ERROR(Assets, "Failed to load %s", path.c_str());
+        }
+        return;
+    }
+
+    const auto import = Handle.Get<SceneImport>();
+    const uint32_t color = IMPORT_PALETTE[mScene->GetInstances().size() % 4];
+    GltfImportStats gltfStats;
+    SceneNodeId node = AddSceneImport(import, path.filename().u8string(), *mScene,
+                                      mScene->GetRoot(), color, &gltfStats);
+    if (node == INVALID_SCENE_NODE) {
+        LOG_WARNING(Assets, "%s has no nodes to show", path.filename().c_str());
+        return;
+    }
+    std::error_code error;
+    mLoadedFiles.push_back({path, node, color, std::filesystem::last_write_time(path, error)});
+
+    const MeshCacheStats& stats = import->MeshStats;
+    if (import->Gltf) {
+        LOG_INFO(Assets,
+                 "Loaded %s in %.1f ms: %u nodes, %u primitives, %u streams mapped (%.1f MB), "
+                 "%u copied",
+                 path.filename().c_str(), import->LoadMs, gltfStats.NodeCount,
+                 gltfStats.PrimitiveCount, gltfStats.MappedStreams,
+                 gltfStats.MappedBytes / (1024.0 * 1024.0), gltfStats.CopiedStreams);
+    } else if (stats.Hit) {
+        LOG_INFO(Assets, "Loaded %s from its cooked copy: %u vertices, %u triangles in %.2f ms",
+                 path.filename().c_str(), import->Mesh.GetVertexCount(),
+                 import->Mesh.GetIndexCount() / 3, stats.LoadMs);
+    } else {
+        const MeshOptimizeStats& optimize = stats.Import.Optimize;
+        LOG_INFO(Assets,
+                 "Loaded %s: %u vertices, %u triangles in %.1f ms (%u chunks, %u threads), "
+                 "cooked in %.1f ms",
+                 path.filename().c_str(), stats.Import.VertexCount, stats.Import.TriangleCount,
+                 stats.Import.TotalMs, stats.Import.ChunkCount, stats.Import.ThreadCount,
+                 stats.CookMs);
+        LOG_INFO(Assets,
+                 "Optimized %s in %.1f ms: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, %u meshlets, "
+                 "%u LODs",
+                 path.filename().c_str(),
+                 stats.Import.OptimizeMs + stats.Import.MeshletMs + stats.Import.LodMs,
+                 optimize.Before.Acmr, optimize.After.Acmr, optimize.Before.Atvr,
+                 optimize.After.Atvr, stats.Import.Meshlets.MeshletCount,
+                 stats.Import.Lods.LodCount);
+    }
+
+    // Framing needs the new nodes' world transforms.
+    mScene->GetHierarchy().UpdateWorldTransforms(mThreadPool.get());
+    if (mSceneView) {
+        mSceneView->FrameBounds(mScene->ComputeWorldBounds());
+    }
+    if (mSceneTree) {
+        mSceneTree->SelectNode(node);
+    }
+}
+
+void MainWindow::ApplyFileChanges() {
+    if (!mFileProvider || !mFileProvider->pollChanges(mFileChanges)) {
+        return;
+    }
+    if (mFileView) {
+        mFileView->ApplyChanges(mFileChanges);
+    }
+
+    if (!mStreamer) {
+        return;
+    }
+    if (mFileChanges.size() == 1 && mFileChanges[0].Type == FileChangeType::Overflow) {
+        // Which files changed is unknown, so compare each opened file's time with its load's.
+        std::vector<std::filesystem::path> changed;
+        for (const LoadedFile& loaded : mLoadedFiles) {
+            std::error_code error;
+            const auto time = std::filesystem::last_write_time(loaded.Path, error);
+            if (!error && time != loaded.ModifiedTime &&
+                std::find(changed.begin(), changed.end(), loaded.Path) == changed.end()) {
+                changed.push_back(loaded.Path);
+            }
+        }
+        for (const std::filesystem::path& path : changed) {
+            ReloadFile(path);
+        }
+        return;
+    }
+
+    for (const FileDelta& change : mFileChanges) {
+        if (change.Type != FileChangeType::Modified) {
+            continue;
+        }
+        const std::filesystem::path path = mFileProvider->getEntryPath(change.Index);
+        for (const LoadedFile& loaded : mLoadedFiles) {
+            if (loaded.Path == path) {
+                ReloadFile(path);
+                break;
+            }
+        }
+    }
+}
+
+void MainWindow::ReloadFile(const std::filesystem::path& Path) {
+    // Only this file is imported again; the cached copy is stale.
+    mStreamer->Invalidate(Path);
+    AssetRequest request;
+    request.Path = Path;
+    request.Loader = MakeSceneImportLoader(SceneImportSettings{}, mImportPool.get());
+    request.OnComplete = [this](const AssetHandle& Handle) { OnAssetReloaded(Handle); };
+    request.Priority = OPEN_ASSET_PRIORITY;
+    mStreamer->Request(std::move(request));
+}
+
+void MainWindow::OnAssetReloaded(const AssetHandle& Handle) {
+    const std::filesystem::path& path = Handle.GetPath();
+    if (Handle.GetStatus() != AssetStatus::Ready) {
+        // Keep showing the old contents; a save still in progress fails here and the next
+        // change loads it again.
+        if (Handle.GetStatus() == AssetStatus::Failed) {
+            LOG_WARNING(Assets, "Failed to reload %s", path.c_str());
+        }
+        return;
+    }
+
+    // Swap the nodes of every time the file was opened, in place; the camera stays where the
+    // user put it.
+    const auto import = Handle.Get<SceneImport>();
+    SceneHierarchy& hierarchy = mScene->GetHierarchy();
+    std::error_code error;
+    const auto modifiedTime = std::filesystem::last_write_time(path, error);
+    for (LoadedFile& loaded : mLoadedFiles) {
+        if (loaded.Path != path) {
+            continue;
+        }
+        loaded.ModifiedTime = modifiedTime;
+        SceneNodeId parent = mScene->GetRoot();
+        if (hierarchy.IsValid(loaded.Node)) {
+            parent = hierarchy.GetParent(loaded.Node);
+            hierarchy.DestroyNode(loaded.Node);
+        }
+        loaded.Node =
+            AddSceneImport(import, path.filename().u8string(), *mScene, parent, loaded.Color);
+    }
+    mScene->RemoveDeadInstances();
+    mLoadedFiles.erase(std::remove_if(mLoadedFiles.begin(), mLoadedFiles.end(),
+                                      [](const LoadedFile& File) {
+                                          return File.Node == INVALID_SCENE_NODE;
+                                      }),
+                       mLoadedFiles.end());
+    LOG_INFO(Assets, "Reloaded %s in %.1f ms", path.filename().c_str(), import->LoadMs);
+}
+
 // Handles the WM_SIZE message to resize child views and update splitter positions.
 void MainWindow::OnSize(int clientWidth, int clientHeight) {
     // Delegate to the layout helper function.
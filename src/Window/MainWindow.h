@@ -3,17 +3,24 @@
 #pragma once
 
 #include <Windows.h>
+#include <filesystem>
 #include <memory> // For std::unique_ptr
 #include <string> // For std::wstring
+#include <vector>
 
+#include "Assets/AssetStreamer.h"
+#include "Common/FramePacer.h"
 #include "Files/BaseFileProvider.h"
 #include "Scene/Camera.h"
+#include "Scene/SceneHierarchy.h"
 
 // Forward declarations for view component classes
 // This is a good practice to avoid circular dependencies and speed up compilation.
 class FileView;
+class Scene;
 class SceneTree;
 class SceneView;
+class ThreadPool;
 
 // Define unique IDs for child windows and menu items using an enum class for strong typing.
 // These IDs are shared between MainWindow and the views.
@@ -65,6 +72,18 @@ class MainWindow {
   private:
     // Internal application update call
     bool OnUpdate();
+    // Starts loading a scene file in the background; it is added under the scene root and
+    // framed once loaded. Replaces an open still in flight. Files of other types are ignored.
+    void OpenAsset(const std::filesystem::path& Path);
+    // Completion of an OpenAsset request, on the UI thread.
+    void OnAssetLoaded(const AssetHandle& Handle);
+    // Applies the changes the file provider saw on disk to the file view, and loads the opened
+    // files among them again. After lost events, every opened file whose time changed.
+    void ApplyFileChanges();
+    // Imports an opened file again, replacing its nodes once loaded.
+    void ReloadFile(const std::filesystem::path& Path);
+    // Completion of a reload started by ApplyFileChanges: swaps the file's nodes for the new ones.
+    void OnAssetReloaded(const AssetHandle& Handle);
 
     // Main application window handle
     HWND mHWnd;
@@ -72,10 +91,31 @@ class MainWindow {
     HINSTANCE mHInstance;
 
     // Smart pointers to manage the lifetime of our view components.
+    std::unique_ptr<Scene> mScene; // Scene data; SceneTree and SceneView are views of it
+    // Frame work: transforms and directory scans on the UI thread, rendering on the scene
+    // view's render thread.
+    std::unique_ptr<ThreadPool> mThreadPool;
+    // Parsing on the streamer's I/O threads. Threads waiting on a pool run whatever it has
+    // queued, so a shared pool would hand whole imports to the UI and render threads.
+    std::unique_ptr<ThreadPool> mImportPool;
+    std::unique_ptr<AssetStreamer> mStreamer; // Declared after the pool its loaders use
+    AssetHandle mPendingOpen;
+    // A file shown in the scene, so changes on disk can replace its nodes.
+    struct LoadedFile {
+        std::filesystem::path Path;
+        SceneNodeId Node;
+        uint32_t Color;
+        std::filesystem::file_time_type ModifiedTime; // When it was last loaded
+    };
+    std::vector<LoadedFile> mLoadedFiles;
+    std::vector<FileDelta> mFileChanges; // Reused by ApplyFileChanges
     std::unique_ptr<FileView> mFileView;
     std::unique_ptr<SceneTree> mSceneTree;
     std::unique_ptr<SceneView> mSceneView;
     std::unique_ptr<BaseFileProvider> mFileProvider;
+    // Paces Run: frames are capped at the target rate, and none run while nothing changes.
+    SystemFrameClock mFrameClock;
+    FramePacer mPacer;
 
     // --- Private helper methods for window management ---
     // Registers the window class for the main application window.
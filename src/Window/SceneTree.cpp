@@ -2,9 +2,15 @@
 // Created by dtcimbal on 2/06/2025.
 #include "SceneTree.h"
 #include <commctrl.h> // Required for TreeView functions (e.g., TreeView_InsertItem)
-#include "Common/Debug.h"
+#include <vector>
+#include "Common/Log.h"
+#include "Scene/SceneHierarchy.h"
+#include "Scene/SceneTreeSource.h"
 
-SceneTree::SceneTree() = default;
+SceneTree::SceneTree(SceneHierarchy& sceneHierarchy)
+    : VirtualTreeView(std::make_unique<SceneTreeSource>(sceneHierarchy)),
+      mSceneHierarchy(sceneHierarchy) {
+}
 
 SceneTree::~SceneTree() = default;
 
@@ -24,40 +30,66 @@ bool SceneTree::OnCreate(HWND hParent, UINT id) {
                        hParent, (HMENU)(INT_PTR)id, GetModuleHandle(nullptr), nullptr);
 
     if (mHWnd == nullptr) {
-        DEBUGPRINT(L"Failed to create SceneTree TreeView.\n");
+        LOG_ERROR(Window, "Failed to create SceneTree TreeView");
         return false;
     }
 
-    AddDummyNodes(); // Populate with some dummy data
+    PopulateSceneTree();
 
     return true;
 }
 
-void SceneTree::AddDummyNodes() {
+// Mirrors the hierarchy into the TreeView. Node ids are stable, so the expansion carries over a
+// rebuild of the model, and only the nodes it materializes get items again.
+void SceneTree::PopulateSceneTree() {
     if (mHWnd == nullptr)
         return;
 
-    TVINSERTSTRUCT tvInsert;
-    tvInsert.hParent = TVI_ROOT;
-    tvInsert.hInsertAfter = TVI_LAST;
-    tvInsert.item.mask = TVIF_TEXT;
+    if (mPopulatedRevision != mSceneHierarchy.GetRevision()) {
+        mPopulatedRevision = mSceneHierarchy.GetRevision();
+        std::vector<TreeKey> expanded;
+        mTreeModel.GetExpandedKeys(expanded);
 
-    tvInsert.item.pszText = (LPWSTR)L"Root Node";
-    HTREEITEM hRoot = TreeView_InsertItem(mHWnd, &tvInsert);
+        SendMessage(mHWnd, WM_SETREDRAW, FALSE, 0);
+        mTreeModel.Reset();
+        for (TreeKey key : expanded) {
+            if (mSceneHierarchy.IsValid(key)) {
+                const uint32_t node = mTreeModel.Reveal(key);
+                if (node != INVALID_TREE_NODE) {
+                    mTreeModel.Expand(node);
+                }
+            }
+        }
+        ApplyModelChanges();
+        SendMessage(mHWnd, WM_SETREDRAW, TRUE, 0);
+    }
+    UpdateVisibleRows();
+}
 
-    if (hRoot) {
-        tvInsert.hParent = hRoot;
-        tvInsert.item.pszText = (LPWSTR)L"Child Node 1";
-        HTREEITEM hChild1 = TreeView_InsertItem(mHWnd, &tvInsert);
+void SceneTree::SelectNode(SceneNodeId Id) {
+    if (mHWnd == nullptr || !mSceneHierarchy.IsValid(Id))
+        return;
 
-        if (hChild1) {
-            tvInsert.hParent = hChild1;
-            tvInsert.item.pszText = (LPWSTR)L"Grandchild Node A";
-            TreeView_InsertItem(mHWnd, &tvInsert);
-        }
+    PopulateSceneTree(); // No-op unless the structure changed
+    const uint32_t node = mTreeModel.Reveal(Id);
+    ApplyModelChanges();
+    HTREEITEM item = node != INVALID_TREE_NODE ? GetItem(node) : nullptr;
+    if (item != nullptr) {
+        TreeView_SelectItem(mHWnd, item);
+        TreeView_EnsureVisible(mHWnd, item);
+    }
+}
 
-        tvInsert.hParent = hRoot;
-        tvInsert.item.pszText = (LPWSTR)L"Child Node 2";
-        TreeView_InsertItem(mHWnd, &tvInsert);
+const wchar_t* SceneTree::GetItemText(TreeKey Key) {
+    // Items of destroyed nodes linger until the next PopulateSceneTree.
+    if (!mSceneHierarchy.IsValid(Key)) {
+        return L"";
     }
-}
\ No newline at end of file
+    const std::string& name = mSceneHierarchy.GetName(Key);
+    int length =
+        MultiByteToWideChar(CP_UTF8, 0, name.data(), static_cast<int>(name.size()), nullptr, 0);
+    mItemText.resize(static_cast<size_t>(length));
+    MultiByteToWideChar(CP_UTF8, 0, name.data(), static_cast<int>(name.size()), mItemText.data(),
+                        length);
+    return mItemText.c_str();
+}
@@ -2,17 +2,36 @@
 // Created by dtcimbal on 2/06/2025.
 #pragma once
 
+#include <cstdint>
 #include <string>
-#include "BaseView.h"
+#include <vector>
+#include "VirtualTreeView.h"
+#include "Scene/SceneHierarchy.h"
 
-class SceneTree : public BaseView {
+// TreeView over a SceneHierarchy owned elsewhere. Items exist for the nodes of expanded parents
+// only; each item's lParam holds its TreeModel node, whose key is the SceneNodeId.
+class SceneTree : public VirtualTreeView {
   public:
-    SceneTree();
+    SceneTree(SceneHierarchy& sceneHierarchy);
     ~SceneTree() override;
 
     // Overrides BaseView::Create to create the TreeView control.
     bool OnCreate(HWND hParent, UINT id) override;
 
-    // TODO: Add methods for managing the tree (e.g., AddNode(), RemoveNode(), GetSelectedNode())
-    void AddDummyNodes();
-};
\ No newline at end of file
+    // Rebuilds the model when the hierarchy's structure changed since the last call, keeping
+    // what was expanded, then inserts the rows scrolled into view. Call once per frame. The
+    // work is bounded by the expanded rows, however many nodes the scene has.
+    void PopulateSceneTree();
+
+    // Selects and scrolls to the item of Id, e.g. after picking it in the SceneView. Its
+    // ancestors are expanded as needed.
+    void SelectNode(SceneNodeId Id);
+
+  private:
+    // Names are converted from the hierarchy's UTF-8 as items are drawn.
+    const wchar_t* GetItemText(TreeKey Key) override;
+
+    SceneHierarchy& mSceneHierarchy;
+    std::wstring mItemText; // Backs GetItemText
+    uint32_t mPopulatedRevision = 0xFFFFFFFFu; // Nothing shown yet
+};
@@ -1,15 +1,29 @@
 ﻿// src/Window/SceneView.cpp
 // Created by dtcimbal on 26/05/2025.
 #include "SceneView.h"
+#include <algorithm> // For std::max
+#include <cmath>     // For std::sin
 #include <sstream> // For std::wostringstream
-#include <string>  // For std::to_wstring
 
-#include "Common/Debug.h" // For DEBUGPRINT
+#include "Common/Log.h"
+#include "Common/Profiler.h"
 #include "Graphics/Device.h"
+#include "Graphics/FramePipeline.h"
 #include "Graphics/Renderer.h"
+#include "Math/Bounds.h"
 #include "Scene/Camera.h"
+#include "Scene/FrameSnapshot.h"
+#include "Scene/Scene.h"
 
-SceneView::SceneView() = default;
+namespace {
+
+// Two snapshots: the UI thread fills one while the render thread draws the other.
+constexpr uint32_t FRAME_SNAPSHOT_COUNT = 2;
+
+} // anonymous namespace
+
+SceneView::SceneView(Scene& scene, ThreadPool& Pool) : mScene(scene), mThreadPool(Pool) {
+}
 
 SceneView::~SceneView() = default;
 
@@ -26,8 +40,8 @@ ATOM SceneView::RegisterWindowClass() {
 
     ATOM atom = RegisterClassEx(&wc);
     if (atom == 0) {
-        DEBUGPRINT(L"ERROR: RegisterClassEx failed for %s. Error: %s", SCENE_VIEW_CLASS_NAME,
-                   std::to_wstring(GetLastError()).c_str());
+        LOG_ERROR(Window, "RegisterClassEx failed for %s. Error: %lu", SCENE_VIEW_CLASS_NAME,
+                  GetLastError());
     }
     return atom;
 }
@@ -80,7 +94,7 @@ LRESULT SceneView::HandleMessage(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPa
 bool SceneView::OnCreate(HWND hParent, UINT id) {
     // Register the custom window class for SceneView
     if (!RegisterWindowClass()) {
-        DEBUGPRINT(L"ERROR: Failed to register SceneView window class!\n");
+        LOG_ERROR(Window, "Failed to register SceneView window class");
         return false;
     }
 
@@ -98,16 +112,15 @@ bool SceneView::OnCreate(HWND hParent, UINT id) {
     );
 
     if (mHWnd == nullptr) {
-        DEBUGPRINT(L"ERROR: Failed to create SceneView window. Error: %s",
-                   std::to_wstring(GetLastError()).c_str());
+        LOG_ERROR(Window, "Failed to create SceneView window. Error: %lu", GetLastError());
         return false;
     }
 
     // 3. Get initial client area dimensions
     RECT clientRect;
     if (!GetClientRect(mHWnd, &clientRect)) {
-        DEBUGPRINT(L"ERROR: Failed to get client rect for SceneView window! Error: %s",
-                   std::to_wstring(GetLastError()).c_str());
+        LOG_ERROR(Window, "Failed to get client rect for SceneView window. Error: %lu",
+                  GetLastError());
         DestroyWindow(mHWnd); // Clean up partially created window
         return false;
     }
@@ -117,26 +130,78 @@ bool SceneView::OnCreate(HWND hParent, UINT id) {
 
     mCamera = std::make_unique<Camera>();
     mDevice = std::make_unique<Device>(mHWnd);
-    if (!mDevice->CreateRenderer(mRenderer)) {
-        DEBUGPRINT(L"Failed to initialize a Device.\n");
+    if (!mDevice->CreateRenderer(mRenderer, RendererBackend::Software, &mThreadPool)) {
+        LOG_ERROR(Graphics, "Failed to initialize a Device");
         // Consider destroying the window here if device creation is critical
         DestroyWindow(mHWnd);
         return false;
     }
 
     mRenderer->OnResize(width, height);
+    mWidth = mRenderWidth = static_cast<uint32_t>(width);
+    mHeight = mRenderHeight = static_cast<uint32_t>(height);
+    mPipeline = std::make_unique<FramePipeline>(
+        [this](const FrameSnapshot& Snapshot) { return RenderFrame(Snapshot); },
+        FRAME_SNAPSHOT_COUNT, &mThreadPool);
     return true;
 }
 
 // Handles WM_SIZE messages for the SceneView window.
 void SceneView::OnResize(int Width, int Height) {
-    if (mRenderer && Width > 0 && Height > 0) {
-        mRenderer->OnResize(Width, Height);
+    // The render thread owns the renderer; it picks the new size up with the next snapshot.
+    if (Width > 0 && Height > 0) {
+        mWidth = static_cast<uint32_t>(Width);
+        mHeight = static_cast<uint32_t>(Height);
+    }
+    if (mCamera && Width > 0 && Height > 0) {
+        mCamera->SetAspectRatio(static_cast<float>(Width) / static_cast<float>(Height));
     }
 }
 
 void SceneView::OnUpdate() {
-    if (mRenderer && mCamera) {
-        mRenderer->Draw(*mCamera);
+    PROFILE_ZONE("SceneView::OnUpdate");
+    if (mPipeline && mCamera) {
+        // World transforms are updated by the owner before the view takes its snapshot.
+        FrameSnapshot& snapshot = mPipeline->BeginFrame();
+        snapshot.FrameIndex = mFrameIndex++;
+        snapshot.Width = mWidth;
+        snapshot.Height = mHeight;
+        snapshot.View = *mCamera;
+        SceneDrawSettings drawSettings;
+        drawSettings.ViewportHeight = mHeight;
+        AddSceneDraws(mScene, snapshot, drawSettings, nullptr, &mThreadPool);
+        mPipeline->SubmitFrame();
+    }
+}
+
+bool SceneView::RenderFrame(const FrameSnapshot& Snapshot) {
+    PROFILE_ZONE("SceneView::RenderFrame");
+    if (Snapshot.Width != mRenderWidth || Snapshot.Height != mRenderHeight) {
+        if (!mRenderer->OnResize(Snapshot.Width, Snapshot.Height)) {
+            return false;
+        }
+        mRenderWidth = Snapshot.Width;
+        mRenderHeight = Snapshot.Height;
+    }
+    for (const DrawItem& draw : Snapshot.Draws) {
+        mRenderer->SubmitMesh(draw.Positions, draw.VertexCount, draw.Indices, draw.IndexCount,
+                              draw.World, draw.Color);
+    }
+    Camera camera = Snapshot.View;
+    return mRenderer->Draw(camera);
+}
+
+void SceneView::FrameBounds(const BoundingBox& Bounds) {
+    if (!mCamera || IsEmpty(Bounds)) {
+        return;
     }
+    const Vector3 center = GetCenter(Bounds);
+    const float radius = std::max(Length(GetExtent(Bounds)), 1e-3f);
+    // Far enough for the bounding sphere to fit the vertical field of view.
+    const float distance = radius / std::sin(mCamera->GetFovY() * 0.5f);
+    const Vector3 direction = Normalize(Vector3{0.0f, 0.5f, -1.0f});
+    mCamera->SetPerspective(mCamera->GetFovY(), mCamera->GetAspectRatio(), distance * 0.01f,
+                            distance + radius * 2.0f);
+    mCamera->SetPosition(center + direction * distance);
+    mCamera->LookAt(center);
 }
@@ -4,29 +4,57 @@
 
 #include "BaseView.h"
 
+#include <cstdint>
 #include <memory>
 
 class Camera;
 class Device;
+class FramePipeline;
 class Renderer;
+class Scene;
+class ThreadPool;
+struct BoundingBox;
+struct FrameSnapshot;
 
 // Define a unique class name for the SceneView window
 const static LPCWSTR SCENE_VIEW_CLASS_NAME = L"DXMiniAppSceneView";
 
 class SceneView : public BaseView {
   public:
-    SceneView();
+    // The renderer draws on Pool, shared with the rest of the application.
+    SceneView(Scene& scene, ThreadPool& Pool);
     ~SceneView() override;
 
     // Overrides BaseView::Create to create a custom window for the scene.
     bool OnCreate(HWND hParent, UINT id) override;
     void OnResize(int Width, int Height);
+    // Snapshots the scene and camera for the render thread, which draws while the caller moves
+    // on to the next frame. Waits only when the render thread is a whole frame behind.
     void OnUpdate();
 
+    // Moves the camera back until Bounds fills the view, looking at its center.
+    void FrameBounds(const BoundingBox& Bounds);
+
+    const Camera& GetCamera() const {
+        return *mCamera;
+    }
+
   private:
+    Scene& mScene;
+    ThreadPool& mThreadPool;
     std::unique_ptr<Device> mDevice;
     std::unique_ptr<Renderer> mRenderer;
     std::unique_ptr<Camera> mCamera;
+    uint32_t mWidth = 0;
+    uint32_t mHeight = 0;
+    uint64_t mFrameIndex = 0;
+    uint32_t mRenderWidth = 0; // Render thread only
+    uint32_t mRenderHeight = 0;
+    // Declared last so the render thread stops before anything it uses goes away.
+    std::unique_ptr<FramePipeline> mPipeline;
+
+    // Render thread: resizes the renderer to the snapshot's viewport and draws it.
+    bool RenderFrame(const FrameSnapshot& Snapshot);
 
     // --- Private helper methods for window management ---
     // Registers the window class for the SceneView window.
@@ -0,0 +1,120 @@
+﻿// src/Window/VirtualTreeView.cpp
+#include "VirtualTreeView.h"
+#include <algorithm>
+
+namespace {
+// Shown for the children of an item that are not listed yet.
+const wchar_t PLACEHOLDER_TEXT[] = L"...";
+} // anonymous namespace
+
+VirtualTreeView::VirtualTreeView(std::unique_ptr<TreeSource> Source)
+    : mTreeSource(std::move(Source)), mTreeModel(*mTreeSource) {
+}
+
+VirtualTreeView::~VirtualTreeView() = default;
+
+void VirtualTreeView::UpdateVisibleRows() {
+    if (mHWnd == nullptr) {
+        return;
+    }
+    // The model's rows are the control's expanded items in order, so the scroll position, in
+    // items, is the first row shown.
+    SCROLLINFO scrollInfo{};
+    scrollInfo.cbSize = sizeof(scrollInfo);
+    scrollInfo.fMask = SIF_POS;
+    const uint32_t first = GetScrollInfo(mHWnd, SB_VERT, &scrollInfo)
+                               ? static_cast<uint32_t>(scrollInfo.nPos)
+                               : 0;
+    mTreeModel.GetRows(first, TreeView_GetVisibleCount(mHWnd) + 1, mVisibleRows);
+    ApplyModelChanges();
+}
+
+bool VirtualTreeView::OnNotify(const NMHDR* Header, LRESULT& Result) {
+    switch (Header->code) {
+    case TVN_GETDISPINFOW: {
+        NMTVDISPINFOW* info = reinterpret_cast<NMTVDISPINFOW*>(const_cast<NMHDR*>(Header));
+        if (info->item.mask & TVIF_TEXT) {
+            const TreeKey key = mTreeModel.GetNode(static_cast<uint32_t>(info->item.lParam)).Key;
+            info->item.pszText =
+                const_cast<LPWSTR>(key != INVALID_TREE_KEY ? GetItemText(key) : PLACEHOLDER_TEXT);
+        }
+        Result = 0;
+        return true;
+    }
+    case TVN_ITEMEXPANDINGW: {
+        // An item's children are inserted the first time it opens.
+        const NMTREEVIEWW* treeView = reinterpret_cast<const NMTREEVIEWW*>(Header);
+        const uint32_t node = static_cast<uint32_t>(treeView->itemNew.lParam);
+        Result = FALSE;
+        if (treeView->action & TVE_EXPAND) {
+            mExpandingNode = node;
+            Result = mTreeModel.Expand(node) ? FALSE : TRUE; // TRUE keeps it closed
+        } else if (treeView->action & TVE_COLLAPSE) {
+            mTreeModel.Collapse(node);
+        }
+        ApplyModelChanges();
+        mExpandingNode = INVALID_TREE_NODE;
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+void VirtualTreeView::ApplyModelChanges() {
+    // Expanding an item re-enters through TVN_ITEMEXPANDING, so the list is a local one.
+    std::vector<TreeChange> changes;
+    mTreeModel.TakeChanges(changes);
+    for (const TreeChange& change : changes) {
+        switch (change.Type) {
+        case TreeChangeType::Reset:
+            TreeView_DeleteAllItems(mHWnd);
+            mItems.clear();
+            break;
+        case TreeChangeType::Inserted: {
+            const TreeNode& node = mTreeModel.GetNode(change.Node);
+            TVINSERTSTRUCTW tvInsert{};
+            tvInsert.hParent = node.Parent != INVALID_TREE_NODE ? mItems[node.Parent] : TVI_ROOT;
+            tvInsert.hInsertAfter =
+                node.PrevSibling != INVALID_TREE_NODE ? mItems[node.PrevSibling] : TVI_FIRST;
+            tvInsert.item.mask = TVIF_TEXT | TVIF_PARAM | TVIF_CHILDREN;
+            tvInsert.item.pszText = LPSTR_TEXTCALLBACKW; // Asked for with TVN_GETDISPINFO
+            tvInsert.item.cChildren = node.HasChildren ? 1 : 0;
+            tvInsert.item.lParam = static_cast<LPARAM>(change.Node);
+            mItems.resize(std::max<size_t>(mItems.size(), change.Node + 1), nullptr);
+            mItems[change.Node] = TreeView_InsertItem(mHWnd, &tvInsert);
+            break;
+        }
+        case TreeChangeType::Removed:
+            // Deleting an item deletes its children with it, and their nodes are gone too.
+            if (mItems[change.Node] != nullptr) {
+                TreeView_DeleteItem(mHWnd, mItems[change.Node]);
+                mItems[change.Node] = nullptr;
+            }
+            break;
+        case TreeChangeType::Updated: {
+            TVITEMW tvItem{};
+            tvItem.mask = TVIF_CHILDREN;
+            tvItem.hItem = mItems[change.Node];
+            tvItem.cChildren = mTreeModel.GetNode(change.Node).HasChildren ? 1 : 0;
+            TreeView_SetItem(mHWnd, &tvItem);
+            break;
+        }
+        case TreeChangeType::Expanded:
+            if (change.Node != mExpandingNode) {
+                TreeView_Expand(mHWnd, mItems[change.Node], TVE_EXPAND);
+            }
+            break;
+        }
+    }
+}
+
+TreeKey VirtualTreeView::GetItemKey(HTREEITEM Item) const {
+    TVITEMW tvItem{};
+    tvItem.mask = TVIF_PARAM;
+    tvItem.hItem = Item;
+    if (Item == nullptr || !TreeView_GetItem(mHWnd, &tvItem)) {
+        return INVALID_TREE_KEY;
+    }
+    return mTreeModel.GetNode(static_cast<uint32_t>(tvItem.lParam)).Key;
+}
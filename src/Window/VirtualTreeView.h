@@ -0,0 +1,46 @@
+﻿// src/Window/VirtualTreeView.h
+// TreeView control over a TreeModel: items exist only for the nodes the model materialized, as
+// folders are expanded and rows scrolled to, and carry no text of their own; the control asks
+// for it when an item is drawn.
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "BaseView.h"
+#include <commctrl.h> // HTREEITEM; needs Windows.h from BaseView.h first
+#include "Common/TreeModel.h"
+
+class VirtualTreeView : public BaseView {
+  public:
+    ~VirtualTreeView() override;
+
+    // Inserts the items of the rows scrolled into view that are still placeholders. Call once
+    // per frame.
+    void UpdateVisibleRows();
+
+    // Handles the tree's WM_NOTIFY codes for item text and expansion. Returns false for the
+    // codes it leaves to the caller.
+    bool OnNotify(const NMHDR* Header, LRESULT& Result);
+
+  protected:
+    explicit VirtualTreeView(std::unique_ptr<TreeSource> Source);
+
+    // Text of the item of Key, valid until the next call.
+    virtual const wchar_t* GetItemText(TreeKey Key) = 0;
+
+    // Mirrors the model's changes into the control.
+    void ApplyModelChanges();
+    HTREEITEM GetItem(uint32_t Node) const {
+        return Node < mItems.size() ? mItems[Node] : nullptr;
+    }
+    // The key of Item, or INVALID_TREE_KEY for placeholders.
+    TreeKey GetItemKey(HTREEITEM Item) const;
+
+    std::unique_ptr<TreeSource> mTreeSource;
+    TreeModel mTreeModel;
+
+  private:
+    std::vector<HTREEITEM> mItems; // By model node; null once removed
+    std::vector<uint32_t> mVisibleRows;
+    uint32_t mExpandingNode = INVALID_TREE_NODE; // Expanded by the user, in TVN_ITEMEXPANDING
+};
@@ -0,0 +1,123 @@
+﻿// tests/DescriptorAllocatorTests.cpp
+#include <cstdint>
+
+#include "Graphics/DescriptorAllocator.h"
+#include "TestFramework.h"
+
+namespace {
+
+constexpr uint32_t STALE_INDEX = ~0u;
+
+} // anonymous namespace
+
+TEST(DescriptorAllocator, DetectsStaleHandlesThroughGenerations) {
+    DescriptorAllocator allocator(4, 0);
+    DescriptorHandle handle;
+    REQUIRE(allocator.Allocate(handle));
+    CHECK(handle.Index == 0);
+    CHECK(allocator.IsLive(handle));
+    CHECK(allocator.Resolve(handle) == 0);
+
+    REQUIRE(allocator.Free(handle));
+    CHECK(!allocator.IsLive(handle));
+    CHECK(allocator.Resolve(handle) == STALE_INDEX);
+    CHECK(!allocator.Free(handle));
+    CHECK(!allocator.Free(DescriptorHandle{}));
+    CHECK(allocator.GetStats().StaleCount == 3);
+
+    // Once the slot is reused, the old handle still names the old generation.
+    allocator.EndFrame(1);
+    allocator.Reclaim(1);
+    DescriptorHandle reused;
+    REQUIRE(allocator.Allocate(reused));
+    CHECK(reused.Index == handle.Index);
+    CHECK(reused.Generation != handle.Generation);
+    CHECK(allocator.IsLive(reused));
+    CHECK(!allocator.IsLive(handle));
+    CHECK(allocator.Resolve(handle) == STALE_INDEX);
+}
+
+TEST(DescriptorAllocator, ReusesFreedSlotsOnlyAfterTheirFence) {
+    DescriptorAllocator allocator(2, 0);
+    DescriptorHandle first;
+    DescriptorHandle second;
+    REQUIRE(allocator.Allocate(first));
+    REQUIRE(allocator.Allocate(second));
+    DescriptorHandle handle;
+    CHECK(!allocator.Allocate(handle));
+    CHECK(allocator.GetStats().FullCount == 1);
+
+    // The GPU may still read the descriptor of the frame that freed it.
+    REQUIRE(allocator.Free(first));
+    CHECK(allocator.GetStats().PersistentUsed == 2);
+    allocator.Reclaim(100); // Not tagged with a fence yet
+    CHECK(!allocator.Allocate(handle));
+
+    allocator.EndFrame(1);
+    REQUIRE(allocator.Free(second)); // Belongs to frame 2
+    allocator.EndFrame(2);
+    allocator.Reclaim(0);
+    CHECK(!allocator.Allocate(handle));
+
+    allocator.Reclaim(1);
+    CHECK(allocator.GetStats().PersistentUsed == 1);
+    REQUIRE(allocator.Allocate(handle));
+    CHECK(handle.Index == first.Index);
+    CHECK(!allocator.Allocate(handle));
+
+    allocator.Reclaim(2);
+    REQUIRE(allocator.Allocate(handle));
+    CHECK(handle.Index == second.Index);
+    CHECK(allocator.GetStats().PersistentPeak == 2);
+}
+
+TEST(DescriptorAllocator, WrapsTheTransientRing) {
+    constexpr uint32_t PERSISTENT_COUNT = 4;
+    DescriptorAllocator allocator(PERSISTENT_COUNT, 10);
+    uint32_t first = 0;
+
+    REQUIRE(allocator.AllocateTransient(4, first));
+    CHECK(first == PERSISTENT_COUNT);
+    REQUIRE(allocator.AllocateTransient(4, first));
+    CHECK(first == PERSISTENT_COUNT + 4);
+    CHECK(!allocator.AllocateTransient(4, first));
+    allocator.EndFrame(1);
+
+    // Nothing comes back until the frame's fence completes.
+    allocator.Reclaim(0);
+    CHECK(!allocator.AllocateTransient(4, first));
+    allocator.Reclaim(1);
+    CHECK(allocator.GetStats().TransientUsed == 0);
+
+    // Two slots left before the end: a table of four skips them and starts over.
+    REQUIRE(allocator.AllocateTransient(4, first));
+    CHECK(first == PERSISTENT_COUNT);
+    CHECK(allocator.GetStats().TransientUsed == 2 + 4);
+    REQUIRE(allocator.AllocateTransient(4, first));
+    CHECK(first == PERSISTENT_COUNT + 4);
+    // The skipped slots stay taken until the frame that skipped them is reclaimed.
+    CHECK(!allocator.AllocateTransient(1, first));
+    CHECK(allocator.GetStats().TransientPeak == 10);
+
+    allocator.EndFrame(2);
+    allocator.Reclaim(2);
+    REQUIRE(allocator.AllocateTransient(2, first));
+    CHECK(first == PERSISTENT_COUNT + 8);
+    CHECK(!allocator.AllocateTransient(11, first));
+}
+
+TEST(DescriptorAllocator, KeepsTransientSlotsOutOfThePersistentRange) {
+    DescriptorAllocator allocator(3, 6);
+    DescriptorHandle handle;
+    uint32_t first = 0;
+    for (uint64_t frame = 1; frame <= 20; ++frame) {
+        REQUIRE(allocator.AllocateTransient(static_cast<uint32_t>(1 + frame % 3), first));
+        CHECK(first >= 3);
+        CHECK(first + 1 + frame % 3 <= 3 + 6);
+        allocator.EndFrame(frame);
+        allocator.Reclaim(frame - 1);
+    }
+    CHECK(allocator.GetStats().TransientPeak <= 6);
+    REQUIRE(allocator.Allocate(handle));
+    CHECK(handle.Index < 3);
+}
@@ -0,0 +1,152 @@
+﻿// tests/FramePacerTests.cpp
+#include <cstdint>
+
+#include "Common/FramePacer.h"
+#include "TestFramework.h"
+
+namespace {
+
+constexpr uint64_t MILLISECOND = 1000000;
+
+// Time moves only when the pacer waits or the test says so.
+class FakeFrameClock : public FrameClock {
+  public:
+    uint64_t Time = 0;
+    uint64_t Oversleep = 0; // Added to every Sleep, as real sleeps wake late
+    uint64_t PauseNanoseconds = 1000;
+    uint32_t SleepCount = 0;
+
+    uint64_t Now() override {
+        return Time;
+    }
+    void Sleep(uint64_t Nanoseconds) override {
+        Time += Nanoseconds + Oversleep;
+        ++SleepCount;
+    }
+    void Pause() override {
+        Time += PauseNanoseconds;
+    }
+};
+
+FramePacingSettings MakeSettings(FramePacingMode Mode) {
+    FramePacingSettings settings;
+    settings.Mode = Mode;
+    settings.TargetFps = 50.0; // 20 ms periods
+    settings.FixedStepSeconds = 0.01;
+    settings.MaxStepsPerFrame = 5;
+    settings.MaxFrameSeconds = 0.25;
+    return settings;
+}
+
+} // anonymous namespace
+
+TEST(FramePacer, ClampsCatchUpSteps) {
+    FakeFrameClock clock;
+    FramePacer pacer(clock, MakeSettings(FramePacingMode::Unlimited));
+
+    FrameTiming timing = pacer.BeginFrame();
+    CHECK(timing.FrameIndex == 0);
+    CHECK(timing.StepCount == 0);
+
+    clock.Time += 35 * MILLISECOND;
+    timing = pacer.BeginFrame();
+    CHECK(timing.StepCount == 3);
+    CHECK(timing.StepSeconds == 0.01);
+    CHECK(timing.Alpha > 0.49 && timing.Alpha < 0.51);
+
+    // 80 ms plus the 5 left over is eight steps, three more than a frame may run.
+    clock.Time += 80 * MILLISECOND;
+    timing = pacer.BeginFrame();
+    CHECK(timing.StepCount == 5);
+    CHECK(pacer.GetStats().DroppedSteps == 3);
+    CHECK(timing.Alpha > 0.49 && timing.Alpha < 0.51);
+
+    // A debugger break counts as MaxFrameSeconds.
+    clock.Time += 10000 * MILLISECOND;
+    timing = pacer.BeginFrame();
+    CHECK(timing.DeltaSeconds == 0.25);
+    CHECK(timing.StepCount == 5);
+    CHECK(pacer.GetStats().DroppedSteps == 3 + 20);
+    CHECK(timing.FrameIndex == 3);
+}
+
+TEST(FramePacer, WaitsOutTheRestOfThePeriod) {
+    FakeFrameClock clock;
+    clock.Oversleep = 200000;
+    FramePacingSettings settings = MakeSettings(FramePacingMode::Limited);
+    settings.SpinNanoseconds = 2 * MILLISECOND;
+    FramePacer pacer(clock, settings);
+
+    pacer.BeginFrame();
+    clock.Time += 5 * MILLISECOND;
+    pacer.EndFrame();
+    // Slept up to the spin margin, then spun to the deadline.
+    CHECK(clock.SleepCount == 1);
+    CHECK(clock.Time >= 20 * MILLISECOND);
+    CHECK(clock.Time < 20 * MILLISECOND + clock.PauseNanoseconds);
+    CHECK(pacer.GetStats().SleptMs > 13.0);
+    CHECK(pacer.GetStats().SpunMs > 1.0);
+
+    // Deadlines advance by whole periods, so the next frame ends on 40 ms whatever its start.
+    pacer.BeginFrame();
+    clock.Time += 1 * MILLISECOND;
+    pacer.EndFrame();
+    CHECK(clock.Time >= 40 * MILLISECOND);
+    CHECK(clock.Time < 40 * MILLISECOND + clock.PauseNanoseconds);
+
+    // A frame whose work overruns does not wait, and the schedule restarts from its end.
+    pacer.BeginFrame();
+    clock.Time += 30 * MILLISECOND;
+    const uint32_t sleepsBefore = clock.SleepCount;
+    pacer.EndFrame();
+    CHECK(clock.SleepCount == sleepsBefore);
+    CHECK(pacer.GetStats().LateFrames == 1);
+    pacer.BeginFrame();
+    pacer.EndFrame();
+    CHECK(clock.Time >= 90 * MILLISECOND);
+}
+
+TEST(FramePacer, IdlesUntilAFrameIsRequested) {
+    FakeFrameClock clock;
+    FramePacer pacer(clock, MakeSettings(FramePacingMode::OnDemand));
+
+    // The first frame always runs.
+    CHECK(!pacer.ShouldIdle());
+    pacer.BeginFrame();
+    pacer.EndFrame();
+    CHECK(pacer.ShouldIdle());
+    CHECK(pacer.ShouldIdle());
+    CHECK(pacer.GetStats().IdleCount == 2);
+
+    // Ten seconds blocked on input: the frame that wakes up is not asked to catch up on them.
+    clock.Time += 10000 * MILLISECOND;
+    pacer.RequestFrame();
+    CHECK(!pacer.ShouldIdle());
+    const FrameTiming timing = pacer.BeginFrame();
+    CHECK(timing.DeltaSeconds == 0.02);
+    CHECK(timing.StepCount == 2);
+    CHECK(pacer.GetStats().DroppedSteps == 0);
+
+    // Requests last until the next frame begins.
+    pacer.RequestFrame();
+    pacer.EndFrame();
+    CHECK(!pacer.ShouldIdle());
+    pacer.BeginFrame();
+    pacer.EndFrame();
+    CHECK(pacer.ShouldIdle());
+}
+
+TEST(FramePacer, NeverIdlesWhenNotOnDemand) {
+    FakeFrameClock clock;
+    FramePacer limited(clock, MakeSettings(FramePacingMode::Limited));
+    FramePacer unlimited(clock, MakeSettings(FramePacingMode::Unlimited));
+    limited.BeginFrame();
+    unlimited.BeginFrame();
+    CHECK(!limited.ShouldIdle());
+    CHECK(!unlimited.ShouldIdle());
+
+    // Unlimited frames never wait.
+    const uint64_t before = clock.Time;
+    unlimited.EndFrame();
+    CHECK(clock.Time == before);
+}
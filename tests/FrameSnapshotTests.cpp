@@ -0,0 +1,169 @@
+﻿// tests/FrameSnapshotTests.cpp
+#include <cstdint>
+#include <memory>
+
+#include "Common/ThreadPool.h"
+#include "Math/Bounds.h"
+#include "Scene/FrameSnapshot.h"
+#include "Scene/Scene.h"
+#include "TestFramework.h"
+
+namespace {
+
+constexpr float RIGHT_ANGLE = 1.5707964f;
+
+// At the origin looking down +Z with a 90 degree square view.
+Camera MakeCamera() {
+    Camera camera;
+    camera.SetPerspective(RIGHT_ANGLE, 1.0f, 0.1f, 100.0f);
+    camera.SetPosition(Vector3{0.0f, 0.0f, 0.0f});
+    camera.LookAt(Vector3{0.0f, 0.0f, 1.0f});
+    return camera;
+}
+
+// A unit quad facing the camera, as two triangles; with a meshlet over both if asked.
+std::shared_ptr<const Mesh> MakeQuad(bool WithMeshlet) {
+    auto quad = std::make_shared<Mesh>();
+    quad->Positions = {Vector3{-0.5f, -0.5f, 0.0f}, Vector3{-0.5f, 0.5f, 0.0f},
+                       Vector3{0.5f, 0.5f, 0.0f}, Vector3{0.5f, -0.5f, 0.0f}};
+    quad->Indices = {0, 1, 2, 0, 2, 3};
+    for (const Vector3& position : quad->Positions) {
+        Grow(quad->Bounds, position);
+    }
+    if (WithMeshlet) {
+        Meshlet meshlet{};
+        meshlet.TriangleCount = 2;
+        meshlet.VertexCount = 4;
+        meshlet.Center = Vector3{0.0f, 0.0f, 0.0f};
+        meshlet.Radius = 0.75f;
+        meshlet.ConeAxis = Vector3{0.0f, 0.0f, -1.0f};
+        meshlet.ConeCutoff = 1.0f;
+        quad->Meshlets.push_back(meshlet);
+    }
+    return quad;
+}
+
+// The quad with one meshlet per triangle: the first facing the camera, the second away from it.
+std::shared_ptr<const Mesh> MakeSplitQuad() {
+    auto quad = std::make_shared<Mesh>(*MakeQuad(false));
+    for (uint32_t i = 0; i < 2; ++i) {
+        Meshlet meshlet{};
+        meshlet.FirstIndex = i * 3;
+        meshlet.TriangleCount = 1;
+        meshlet.VertexCount = 3;
+        meshlet.Radius = 0.75f;
+        meshlet.ConeAxis = Vector3{0.0f, 0.0f, i == 0 ? -1.0f : 1.0f};
+        meshlet.ConeCutoff = 0.5f;
+        quad->Meshlets.push_back(meshlet);
+    }
+    return quad;
+}
+
+SceneNodeId AddQuadAt(Scene& Target, uint32_t MeshIndex, const Vector3& Position) {
+    Transform local;
+    local.Translation = Position;
+    const SceneNodeId node = Target.GetHierarchy().CreateNode("Quad", Target.GetRoot(), local);
+    Target.AddInstance(node, MeshIndex, 0xFFFFFFFF);
+    return node;
+}
+
+} // anonymous namespace
+
+TEST(FrameSnapshot, OffscreenFullMeshIsNotDrawn) {
+    Scene scene;
+    const uint32_t mesh = scene.AddMesh(MakeMeshView(MakeQuad(false)));
+    const SceneNodeId inView = AddQuadAt(scene, mesh, Vector3{0.0f, 0.0f, 10.0f});
+    AddQuadAt(scene, mesh, Vector3{50.0f, 0.0f, 10.0f});  // Far right of x = z
+    AddQuadAt(scene, mesh, Vector3{0.0f, 0.0f, -10.0f}); // Behind the camera
+    scene.GetHierarchy().UpdateWorldTransforms();
+
+    FrameSnapshot snapshot;
+    snapshot.View = MakeCamera();
+    SceneDrawStats stats;
+    AddSceneDraws(scene, snapshot, SceneDrawSettings{}, &stats);
+
+    REQUIRE(snapshot.Draws.size() == 1);
+    const Vector3 drawn = GetTranslation(snapshot.Draws[0].World);
+    const Vector3 expected = GetTranslation(scene.GetHierarchy().GetWorldMatrix(inView));
+    CHECK(drawn.X == expected.X && drawn.Y == expected.Y && drawn.Z == expected.Z);
+    CHECK(snapshot.Draws[0].IndexCount == 6);
+    CHECK(stats.InstancesTested == 3);
+    CHECK(stats.InstancesCulled == 2);
+    CHECK(stats.LodDraws[0] == 1);
+    CHECK(stats.Triangles == 2);
+}
+
+TEST(FrameSnapshot, OffscreenMeshletsAreNotTested) {
+    Scene scene;
+    const uint32_t mesh = scene.AddMesh(MakeMeshView(MakeQuad(true)));
+    AddQuadAt(scene, mesh, Vector3{0.0f, 0.0f, 10.0f});
+    AddQuadAt(scene, mesh, Vector3{0.0f, 50.0f, 10.0f});
+    scene.GetHierarchy().UpdateWorldTransforms();
+
+    FrameSnapshot snapshot;
+    snapshot.View = MakeCamera();
+    SceneDrawStats stats;
+    AddSceneDraws(scene, snapshot, SceneDrawSettings{}, &stats);
+
+    CHECK(snapshot.Draws.size() == 1);
+    CHECK(stats.InstancesCulled == 1);
+    // Only the instance in view gets as far as its meshlets.
+    CHECK(stats.Meshlets.Tested == 1);
+    CHECK(stats.Meshlets.Visible == 1);
+}
+
+TEST(FrameSnapshot, DeadInstancesAreSkipped) {
+    Scene scene;
+    const uint32_t mesh = scene.AddMesh(MakeMeshView(MakeQuad(false)));
+    const SceneNodeId node = AddQuadAt(scene, mesh, Vector3{0.0f, 0.0f, 10.0f});
+    scene.GetHierarchy().UpdateWorldTransforms();
+    scene.GetHierarchy().DestroyNode(node);
+
+    FrameSnapshot snapshot;
+    snapshot.View = MakeCamera();
+    SceneDrawStats stats;
+    AddSceneDraws(scene, snapshot, SceneDrawSettings{}, &stats);
+    CHECK(snapshot.Draws.empty());
+    CHECK(stats.InstancesTested == 0);
+}
+
+TEST(FrameSnapshot, ParallelBuildMatchesSerial) {
+    Scene scene;
+    const uint32_t plain = scene.AddMesh(MakeMeshView(MakeQuad(false)));
+    const uint32_t split = scene.AddMesh(MakeMeshView(MakeSplitQuad()));
+    // A row sweeping from well left of the view to well right of it.
+    for (uint32_t i = 0; i < 500; ++i) {
+        const float x = static_cast<float>(i) * 0.2f - 50.0f;
+        AddQuadAt(scene, i % 2 == 0 ? plain : split, Vector3{x, 0.0f, 20.0f});
+    }
+    scene.GetHierarchy().UpdateWorldTransforms();
+
+    FrameSnapshot serial;
+    serial.View = MakeCamera();
+    SceneDrawStats serialStats;
+    AddSceneDraws(scene, serial, SceneDrawSettings{}, &serialStats);
+
+    ThreadPool pool(3);
+    FrameSnapshot parallel;
+    parallel.View = MakeCamera();
+    SceneDrawStats parallelStats;
+    AddSceneDraws(scene, parallel, SceneDrawSettings{}, &parallelStats, &pool);
+
+    REQUIRE(serial.Draws.size() == parallel.Draws.size());
+    CHECK(serial.Draws.size() > 0 && serial.Draws.size() < 500);
+    for (size_t i = 0; i < serial.Draws.size(); ++i) {
+        CHECK(GetTranslation(serial.Draws[i].World).X ==
+              GetTranslation(parallel.Draws[i].World).X);
+        CHECK(serial.Draws[i].IndexCount == parallel.Draws[i].IndexCount);
+    }
+    CHECK(parallelStats.InstancesTested == 500);
+    CHECK(parallelStats.InstancesCulled == serialStats.InstancesCulled);
+    CHECK(parallelStats.Meshlets.BackfaceCulled == serialStats.Meshlets.BackfaceCulled);
+    CHECK(parallelStats.Meshlets.BackfaceCulled > 0);
+    CHECK(parallelStats.Triangles == serialStats.Triangles);
+
+    // Gathered meshlet indices came from the jobs' own arenas, and go with the snapshot.
+    CHECK(parallel.WorkerArenas.GetStats().UsedBytes > 0);
+    parallel.Reset();
+    CHECK(parallel.WorkerArenas.GetStats().UsedBytes == 0);
+}
@@ -0,0 +1,167 @@
+﻿// tests/MeshCacheTests.cpp
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Assets/MeshCache.h"
+#include "TestFramework.h"
+
+namespace {
+
+constexpr uint64_t TEST_KEY = 0x1234;
+
+// A directory of its own under the system temporary folder, removed with everything in it.
+class ScratchDirectory {
+  public:
+    explicit ScratchDirectory(const char* Name)
+        : mPath(std::filesystem::temp_directory_path() / ("DXMiniTests-" + std::string(Name))) {
+        std::error_code ec;
+        std::filesystem::remove_all(mPath, ec);
+        std::filesystem::create_directories(mPath, ec);
+    }
+    ~ScratchDirectory() {
+        std::error_code ec;
+        std::filesystem::remove_all(mPath, ec);
+    }
+
+    const std::filesystem::path& GetPath() const {
+        return mPath;
+    }
+
+  private:
+    std::filesystem::path mPath;
+};
+
+// Two triangles, one meshlet over both and one LOD of a single triangle.
+Mesh MakeQuad() {
+    Mesh quad;
+    quad.Positions = {Vector3{0.0f, 0.0f, 0.0f}, Vector3{0.0f, 1.0f, 0.0f},
+                      Vector3{1.0f, 1.0f, 0.0f}, Vector3{1.0f, 0.0f, 0.0f}};
+    quad.Indices = {0, 1, 2, 0, 2, 3};
+    Meshlet meshlet{};
+    meshlet.FirstIndex = 0;
+    meshlet.TriangleCount = 2;
+    meshlet.VertexCount = 4;
+    meshlet.ConeCutoff = 1.0f;
+    quad.Meshlets.push_back(meshlet);
+    quad.LodIndices = {0, 1, 2};
+    quad.Lods.push_back(MeshLod{0, 3, 0.5f});
+    for (const Vector3& position : quad.Positions) {
+        Grow(quad.Bounds, position);
+    }
+    return quad;
+}
+
+bool WriteAndLoad(const std::filesystem::path& Path, const Mesh& Source) {
+    if (!WriteCookedMesh(Path, Source, TEST_KEY)) {
+        return false;
+    }
+    MeshView view;
+    return LoadCookedMesh(Path, TEST_KEY, view);
+}
+
+} // anonymous namespace
+
+TEST(MeshCache, RoundTrip) {
+    ScratchDirectory scratch("RoundTrip");
+    const std::filesystem::path path = scratch.GetPath() / "quad.dxmesh";
+    const Mesh quad = MakeQuad();
+    REQUIRE(WriteCookedMesh(path, quad, TEST_KEY));
+
+    MeshView view;
+    REQUIRE(LoadCookedMesh(path, TEST_KEY, view));
+    CHECK(view.GetVertexCount() == 4);
+    CHECK(view.GetIndexCount() == 6);
+    CHECK(view.Indices[5] == 3);
+    CHECK(view.Meshlets.GetSize() == 1);
+    CHECK(view.Lods.GetSize() == 1);
+    CHECK(view.LodIndices.GetSize() == 3);
+
+    MeshView other;
+    CHECK(!LoadCookedMesh(path, TEST_KEY + 1, other));
+}
+
+TEST(MeshCache, DamagedRangesAreRejected) {
+    ScratchDirectory scratch("DamagedRanges");
+    const std::filesystem::path path = scratch.GetPath() / "quad.dxmesh";
+    REQUIRE(WriteAndLoad(path, MakeQuad()));
+
+    Mesh badIndex = MakeQuad();
+    badIndex.Indices[4] = 4;
+    CHECK(!WriteAndLoad(path, badIndex));
+
+    Mesh badLodIndex = MakeQuad();
+    badLodIndex.LodIndices[0] = 100;
+    CHECK(!WriteAndLoad(path, badLodIndex));
+
+    Mesh badMeshlet = MakeQuad();
+    badMeshlet.Meshlets[0].FirstIndex = 3;
+    CHECK(!WriteAndLoad(path, badMeshlet));
+
+    Mesh badLod = MakeQuad();
+    badLod.Lods[0].IndexCount = 6;
+    CHECK(!WriteAndLoad(path, badLod));
+}
+
+TEST(MeshCache, TruncatedFileIsRejected) {
+    ScratchDirectory scratch("Truncated");
+    const std::filesystem::path path = scratch.GetPath() / "quad.dxmesh";
+    REQUIRE(WriteCookedMesh(path, MakeQuad(), TEST_KEY));
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+
+    MeshView view;
+    CHECK(!LoadCookedMesh(path, TEST_KEY, view));
+}
+
+TEST(MeshCache, DamagedCopyIsCookedAgain) {
+    ScratchDirectory scratch("CookedAgain");
+    const std::filesystem::path source = scratch.GetPath() / "quad.obj";
+    {
+        std::ofstream obj(source);
+        obj << "v 0 0 0\nv 0 1 0\nv 1 1 0\nv 1 0 0\nf 1 2 3\nf 1 3 4\n";
+    }
+    ObjImportSettings settings;
+    Mesh damaged = MakeQuad();
+    damaged.Indices[0] = 1000;
+    REQUIRE(WriteCookedMesh(GetCookedMeshPath(source), damaged,
+                            ComputeCookedMeshKey(source, settings)));
+
+    MeshView view;
+    MeshCacheStats stats;
+    REQUIRE(LoadObjCached(source, settings, nullptr, view, &stats));
+    CHECK(!stats.Hit);
+    CHECK(view.GetIndexCount() == 6);
+
+    REQUIRE(LoadObjCached(source, settings, nullptr, view, &stats));
+    CHECK(stats.Hit);
+}
+
+TEST(MeshCache, ConcurrentWritersLeaveOneWholeFile) {
+    ScratchDirectory scratch("ConcurrentWriters");
+    const std::filesystem::path path = scratch.GetPath() / "quad.dxmesh";
+    const Mesh quad = MakeQuad();
+
+    std::vector<std::thread> writers;
+    for (uint32_t t = 0; t < 4; ++t) {
+        writers.emplace_back([&] {
+            for (uint32_t i = 0; i < 25; ++i) {
+                WriteCookedMesh(path, quad, TEST_KEY);
+            }
+        });
+    }
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+
+    MeshView view;
+    CHECK(LoadCookedMesh(path, TEST_KEY, view));
+    uint32_t fileCount = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(scratch.GetPath())) {
+        CHECK(entry.path().extension() != ".tmp");
+        ++fileCount;
+    }
+    CHECK(fileCount == 1);
+}
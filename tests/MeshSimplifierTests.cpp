@@ -0,0 +1,87 @@
+﻿// tests/MeshSimplifierTests.cpp
+#include <cstdint>
+
+#include "Assets/MeshSimplifier.h"
+#include "Math/Bounds.h"
+#include "TestFramework.h"
+
+namespace {
+
+// Quads along each edge of every cube face.
+constexpr uint32_t FACE_GRID = 12;
+
+// A unit cube whose faces are FACE_GRID x FACE_GRID grids with vertices of their own, each
+// carrying its face's normal. Vertices on the cube's edges are shared by position only, so the
+// edges are normal seams.
+Mesh MakeSeamedCube() {
+    Mesh cube;
+    const Vector3 normals[6] = {Vector3{1.0f, 0.0f, 0.0f},  Vector3{-1.0f, 0.0f, 0.0f},
+                                Vector3{0.0f, 1.0f, 0.0f},  Vector3{0.0f, -1.0f, 0.0f},
+                                Vector3{0.0f, 0.0f, 1.0f},  Vector3{0.0f, 0.0f, -1.0f}};
+    for (const Vector3& normal : normals) {
+        // Two axes across the face.
+        const Vector3 u{normal.Y + normal.Z != 0.0f ? 1.0f : 0.0f, normal.X != 0.0f ? 1.0f : 0.0f,
+                        0.0f};
+        const Vector3 v = Cross(normal, u);
+        const uint32_t first = cube.GetVertexCount();
+        for (uint32_t y = 0; y <= FACE_GRID; ++y) {
+            for (uint32_t x = 0; x <= FACE_GRID; ++x) {
+                const float s = static_cast<float>(x) / FACE_GRID - 0.5f;
+                const float t = static_cast<float>(y) / FACE_GRID - 0.5f;
+                cube.Positions.push_back(normal * 0.5f + u * s + v * t);
+                cube.Normals.push_back(normal);
+            }
+        }
+        for (uint32_t y = 0; y < FACE_GRID; ++y) {
+            for (uint32_t x = 0; x < FACE_GRID; ++x) {
+                const uint32_t a = first + y * (FACE_GRID + 1) + x;
+                const uint32_t b = a + 1;
+                const uint32_t c = a + FACE_GRID + 1;
+                const uint32_t d = c + 1;
+                cube.Indices.insert(cube.Indices.end(), {a, c, b, b, c, d});
+            }
+        }
+    }
+    for (const Vector3& position : cube.Positions) {
+        Grow(cube.Bounds, position);
+    }
+    return cube;
+}
+
+bool SameVector(const Vector3& A, const Vector3& B) {
+    return A.X == B.X && A.Y == B.Y && A.Z == B.Z;
+}
+
+// Positive if the triangle's winding agrees with its first corner's normal.
+float GetFacing(const Mesh& Source, const uint32_t* Corners) {
+    const Vector3& a = Source.Positions[Corners[0]];
+    const Vector3 normal =
+        Cross(Source.Positions[Corners[1]] - a, Source.Positions[Corners[2]] - a);
+    return Dot(normal, Source.Normals[Corners[0]]);
+}
+
+} // anonymous namespace
+
+TEST(MeshSimplifier, SeamsKeepTheirSides) {
+    Mesh cube = MakeSeamedCube();
+    MeshLodSettings settings;
+    settings.MaxLodCount = 2;
+    settings.MinTriangles = 64;
+    settings.MaxRelativeError = 0.01f;
+    BuildLodChain(cube, settings, nullptr);
+    REQUIRE(!cube.Lods.empty());
+    CHECK(cube.Lods[0].IndexCount < cube.Indices.size());
+
+    // Every face stays flat, so each LOD triangle's corners must all be copies from one face,
+    // and it must still face the way that face's triangles did.
+    const float winding = GetFacing(cube, cube.Indices.data());
+    for (const MeshLod& lod : cube.Lods) {
+        for (uint32_t i = lod.FirstIndex; i + 2 < lod.FirstIndex + lod.IndexCount; i += 3) {
+            const uint32_t* corners = &cube.LodIndices[i];
+            const Vector3& normal = cube.Normals[corners[0]];
+            CHECK(SameVector(normal, cube.Normals[corners[1]]));
+            CHECK(SameVector(normal, cube.Normals[corners[2]]));
+            CHECK(GetFacing(cube, corners) * winding > 0.0f);
+        }
+    }
+}
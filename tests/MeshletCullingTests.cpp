@@ -0,0 +1,114 @@
+﻿// tests/MeshletCullingTests.cpp
+#include <cstdint>
+
+#include "Scene/Camera.h"
+#include "Scene/MeshletCulling.h"
+#include "TestFramework.h"
+
+namespace {
+
+constexpr float RIGHT_ANGLE = 1.5707964f;
+
+// At the origin looking down +Z with a 90 degree square view, so the side planes are x = +-z
+// and y = +-z.
+Camera MakeCamera() {
+    Camera camera;
+    camera.SetPerspective(RIGHT_ANGLE, 1.0f, 0.1f, 100.0f);
+    camera.SetPosition(Vector3{0.0f, 0.0f, 0.0f});
+    camera.LookAt(Vector3{0.0f, 0.0f, 1.0f});
+    return camera;
+}
+
+Meshlet MakeMeshlet(const Vector3& Center, float Radius, const Vector3& ConeAxis,
+                    float ConeCutoff) {
+    Meshlet meshlet{};
+    meshlet.TriangleCount = 1;
+    meshlet.VertexCount = 3;
+    meshlet.Center = Center;
+    meshlet.Radius = Radius;
+    meshlet.ConeAxis = ConeAxis;
+    meshlet.ConeCutoff = ConeCutoff;
+    return meshlet;
+}
+
+} // anonymous namespace
+
+TEST(MeshletCulling, ConeFacingAwayIsCulled) {
+    const MeshletViewer viewer = MakeMeshletViewer(MakeCamera(), Matrix4::Identity());
+    REQUIRE(viewer.CullBackfaces);
+
+    // Every normal within 30 degrees of +Z: the eye sees only back faces.
+    const Meshlet away = MakeMeshlet(Vector3{0.0f, 0.0f, 10.0f}, 1.0f,
+                                     Vector3{0.0f, 0.0f, 1.0f}, 0.5f);
+    CHECK(!IsMeshletVisible(away, viewer));
+
+    MeshletViewer noBackfaces = viewer;
+    noBackfaces.CullBackfaces = false;
+    CHECK(IsMeshletVisible(away, noBackfaces));
+
+    uint32_t visible[1];
+    MeshletCullStats stats;
+    CHECK(CullMeshlets(Span<const Meshlet>(&away, 1), viewer, visible, &stats) == 0);
+    CHECK(stats.Tested == 1);
+    CHECK(stats.BackfaceCulled == 1);
+    CHECK(stats.FrustumCulled == 0);
+}
+
+TEST(MeshletCulling, ConeFacingCameraIsKept) {
+    const MeshletViewer viewer = MakeMeshletViewer(MakeCamera(), Matrix4::Identity());
+
+    const Meshlet facing = MakeMeshlet(Vector3{0.0f, 0.0f, 10.0f}, 1.0f,
+                                       Vector3{0.0f, 0.0f, -1.0f}, 0.5f);
+    CHECK(IsMeshletVisible(facing, viewer));
+
+    // Normals spread too far for the cone to say anything.
+    const Meshlet wide = MakeMeshlet(Vector3{0.0f, 0.0f, 10.0f}, 1.0f,
+                                     Vector3{0.0f, 0.0f, 1.0f}, 1.0f);
+    CHECK(IsMeshletVisible(wide, viewer));
+
+    // Facing away, but so close that the eye sees part of the sphere from the front side.
+    const Meshlet near = MakeMeshlet(Vector3{0.0f, 0.0f, 2.0f}, 1.5f,
+                                     Vector3{0.0f, 0.0f, 1.0f}, 0.5f);
+    CHECK(IsMeshletVisible(near, viewer));
+}
+
+TEST(MeshletCulling, SphereStraddlingPlaneIsKept) {
+    const MeshletViewer viewer = MakeMeshletViewer(MakeCamera(), Matrix4::Identity());
+    const Vector3 towardEye{0.0f, 0.0f, -1.0f};
+
+    // Centered on the right plane x = z, half inside.
+    const Meshlet straddling = MakeMeshlet(Vector3{10.0f, 0.0f, 10.0f}, 1.0f, towardEye, 0.5f);
+    CHECK(IsMeshletVisible(straddling, viewer));
+
+    // Over a unit past the right plane, and wholly behind the near plane.
+    const Meshlet outside = MakeMeshlet(Vector3{13.0f, 0.0f, 10.0f}, 1.0f, towardEye, 0.5f);
+    const Meshlet behind = MakeMeshlet(Vector3{0.0f, 0.0f, -5.0f}, 1.0f, towardEye, 0.5f);
+    CHECK(!IsMeshletVisible(outside, viewer));
+    CHECK(!IsMeshletVisible(behind, viewer));
+
+    const Meshlet meshlets[] = {outside, straddling, behind};
+    uint32_t visible[3] = {};
+    MeshletCullStats stats;
+    REQUIRE(CullMeshlets(Span<const Meshlet>(meshlets, 3), viewer, visible, &stats) == 1);
+    CHECK(visible[0] == 1);
+    CHECK(stats.FrustumCulled == 2);
+    CHECK(stats.Visible == 1);
+}
+
+TEST(MeshletCulling, WorldTransformMovesTheTests) {
+    // The instance sits 20 units ahead, so a meshlet at its origin is in view and the eye is at
+    // z = -20 in object space.
+    const Matrix4 world = MatrixTranslation(Vector3{0.0f, 0.0f, 20.0f});
+    const MeshletViewer viewer = MakeMeshletViewer(MakeCamera(), world);
+    REQUIRE(viewer.CullBackfaces);
+
+    const Meshlet away = MakeMeshlet(Vector3{0.0f, 0.0f, 0.0f}, 1.0f,
+                                     Vector3{0.0f, 0.0f, 1.0f}, 0.5f);
+    const Meshlet facing = MakeMeshlet(Vector3{0.0f, 0.0f, 0.0f}, 1.0f,
+                                       Vector3{0.0f, 0.0f, -1.0f}, 0.5f);
+    const Meshlet outside = MakeMeshlet(Vector3{0.0f, 0.0f, -25.0f}, 1.0f,
+                                        Vector3{0.0f, 0.0f, -1.0f}, 0.5f);
+    CHECK(!IsMeshletVisible(away, viewer));
+    CHECK(IsMeshletVisible(facing, viewer));
+    CHECK(!IsMeshletVisible(outside, viewer));
+}
@@ -0,0 +1,275 @@
+﻿// tests/RenderGraphTests.cpp
+#include <vector>
+
+#include "Graphics/RenderGraph.h"
+#include "TestFramework.h"
+
+namespace {
+
+const RenderResourceDesc TARGET_DESC{256, 256, RenderFormat::Rgba8}; // One 256 KB placement
+
+RenderHandle ImportBackBuffer(RenderGraph& Graph) {
+    return Graph.Import("BackBuffer", TARGET_DESC, RenderResourceState::Present,
+                       RenderResourceState::Present);
+}
+
+bool HasBarrier(Span<const RenderBarrier> Barriers,
+                uint32_t Resource,
+                RenderResourceState Before,
+                RenderResourceState After) {
+    for (const RenderBarrier& barrier : Barriers) {
+        if (barrier.Resource == Resource && barrier.Before == Before && barrier.After == After) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+TEST(RenderGraph, CullsPassesNobodyNeeds) {
+    RenderGraph graph;
+    RenderHandle backBuffer = ImportBackBuffer(graph);
+    const uint32_t unused = graph.AddPass(
+        "Unused",
+        [](RenderPassBuilder& Builder) {
+            Builder.Write(Builder.Create("Scratch", TARGET_DESC));
+        },
+        nullptr);
+    const uint32_t readback = graph.AddPass(
+        "Readback", [](RenderPassBuilder& Builder) { Builder.SetSideEffects(); }, nullptr);
+    const uint32_t draw = graph.AddPass(
+        "Draw", [&](RenderPassBuilder& Builder) { backBuffer = Builder.Write(backBuffer); },
+        nullptr);
+    graph.MarkOutput(backBuffer);
+
+    REQUIRE(graph.Compile());
+    CHECK(graph.IsPassCulled(unused));
+    CHECK(!graph.IsPassCulled(readback));
+    CHECK(!graph.IsPassCulled(draw));
+    CHECK(graph.GetPassOrder().size() == 2);
+    CHECK(graph.GetStats().CulledPassCount == 1);
+    CHECK(graph.GetStats().TransientCount == 0);
+}
+
+TEST(RenderGraph, OrdersProducersBeforeConsumers) {
+    RenderGraph graph;
+    RenderHandle backBuffer = ImportBackBuffer(graph);
+    RenderHandle history = graph.Import("History", TARGET_DESC, RenderResourceState::ShaderRead,
+                                        RenderResourceState::ShaderRead);
+    const RenderHandle oldHistory = history;
+    RenderHandle lit = INVALID_RENDER_HANDLE;
+
+    // Declared first, but it overwrites what Composite reads, so it runs after it.
+    const uint32_t update = graph.AddPass(
+        "UpdateHistory",
+        [&](RenderPassBuilder& Builder) {
+            history = Builder.Write(history, RenderResourceState::RenderTarget);
+        },
+        nullptr);
+    const uint32_t light = graph.AddPass(
+        "Light",
+        [&](RenderPassBuilder& Builder) {
+            lit = Builder.Write(Builder.Create("Lit", TARGET_DESC));
+        },
+        nullptr);
+    const uint32_t composite = graph.AddPass(
+        "Composite",
+        [&](RenderPassBuilder& Builder) {
+            Builder.Read(lit);
+            Builder.Read(oldHistory);
+            backBuffer = Builder.Write(backBuffer);
+        },
+        nullptr);
+    graph.MarkOutput(backBuffer);
+    graph.MarkOutput(history);
+
+    REQUIRE(graph.Compile());
+    const std::vector<uint32_t> expected = {light, composite, update};
+    CHECK(graph.GetPassOrder() == expected);
+}
+
+TEST(RenderGraph, RejectsCyclesAndUnwrittenReads) {
+    RenderGraph graph;
+    graph.AddPass(
+        "ReadsNothing",
+        [](RenderPassBuilder& Builder) {
+            Builder.Read(Builder.Create("Never written", TARGET_DESC));
+            Builder.SetSideEffects();
+        },
+        nullptr);
+    CHECK(!graph.Compile());
+
+    // A reads what B overwrites, so A runs first; B writes what A reads, so B runs first.
+    graph.Reset();
+    RenderHandle a = ImportBackBuffer(graph);
+    RenderHandle b = INVALID_RENDER_HANDLE;
+    graph.AddPass(
+        "B",
+        [&](RenderPassBuilder& Builder) {
+            b = Builder.Write(a);
+            Builder.SetSideEffects();
+        },
+        nullptr);
+    graph.AddPass(
+        "A",
+        [&](RenderPassBuilder& Builder) {
+            Builder.Read(b);
+            Builder.Read(a);
+            Builder.SetSideEffects();
+        },
+        nullptr);
+    CHECK(!graph.Compile());
+}
+
+TEST(RenderGraph, AliasesTransientsWithDisjointLifetimes) {
+    RenderGraph graph;
+    RenderHandle backBuffer = ImportBackBuffer(graph);
+    RenderHandle first = INVALID_RENDER_HANDLE;
+    RenderHandle second = INVALID_RENDER_HANDLE;
+    RenderHandle third = INVALID_RENDER_HANDLE;
+    graph.AddPass(
+        "First",
+        [&](RenderPassBuilder& Builder) {
+            first = Builder.Write(Builder.Create("T1", TARGET_DESC));
+        },
+        nullptr);
+    graph.AddPass(
+        "Second",
+        [&](RenderPassBuilder& Builder) {
+            Builder.Read(first);
+            second = Builder.Write(Builder.Create("T2", TARGET_DESC));
+        },
+        nullptr);
+    graph.AddPass(
+        "Third",
+        [&](RenderPassBuilder& Builder) {
+            Builder.Read(second);
+            third = Builder.Write(Builder.Create("T3", TARGET_DESC));
+        },
+        nullptr);
+    graph.AddPass(
+        "Present",
+        [&](RenderPassBuilder& Builder) {
+            Builder.Read(third);
+            backBuffer = Builder.Write(backBuffer);
+        },
+        nullptr);
+    graph.MarkOutput(backBuffer);
+
+    REQUIRE(graph.Compile());
+    const uint32_t t1 = graph.GetResource(first);
+    const uint32_t t2 = graph.GetResource(second);
+    const uint32_t t3 = graph.GetResource(third);
+    const uint64_t size = TARGET_DESC.GetBytes();
+    CHECK(size % RenderGraph::RESOURCE_ALIGNMENT == 0);
+
+    // T1 is dead once Second has run, so T3 takes its bytes; T2 overlaps both.
+    CHECK(graph.GetHeapOffset(t1) == 0);
+    CHECK(graph.GetHeapOffset(t2) == size);
+    CHECK(graph.GetHeapOffset(t3) == 0);
+    CHECK(graph.GetStats().TransientCount == 3);
+    CHECK(graph.GetStats().TransientBytes == 3 * size);
+    CHECK(graph.GetHeapSize() == 2 * size);
+
+    // Only T3 reuses memory, and says so on its first use.
+    const uint32_t thirdPass = graph.GetPassOrder()[2];
+    bool aliased = false;
+    for (const RenderBarrier& barrier : graph.GetPassBarriers(thirdPass)) {
+        aliased = aliased || (barrier.Resource == t3 && barrier.Aliasing);
+    }
+    CHECK(aliased);
+    for (uint32_t pass : graph.GetPassOrder()) {
+        for (const RenderBarrier& barrier : graph.GetPassBarriers(pass)) {
+            CHECK(!barrier.Aliasing || barrier.Resource == t3);
+        }
+    }
+}
+
+TEST(RenderGraph, GeneratesStateTransitions) {
+    RenderGraph graph;
+    RenderHandle backBuffer = ImportBackBuffer(graph);
+    RenderHandle depth = INVALID_RENDER_HANDLE;
+    RenderHandle color = INVALID_RENDER_HANDLE;
+    const uint32_t prepass = graph.AddPass(
+        "DepthPrepass",
+        [&](RenderPassBuilder& Builder) {
+            depth = Builder.Write(
+                Builder.Create("Depth", RenderResourceDesc{256, 256, RenderFormat::Depth32F}),
+                RenderResourceState::DepthWrite);
+        },
+        nullptr);
+    const uint32_t opaque = graph.AddPass(
+        "Opaque",
+        [&](RenderPassBuilder& Builder) {
+            Builder.Read(depth, RenderResourceState::DepthRead);
+            color = Builder.Write(Builder.Create("Color", TARGET_DESC));
+        },
+        nullptr);
+    const uint32_t present = graph.AddPass(
+        "Present",
+        [&](RenderPassBuilder& Builder) {
+            Builder.Read(color, RenderResourceState::CopySource);
+            backBuffer = Builder.Write(backBuffer, RenderResourceState::CopyDest);
+        },
+        nullptr);
+    graph.MarkOutput(backBuffer);
+
+    REQUIRE(graph.Compile());
+    const uint32_t depthResource = graph.GetResource(depth);
+    const uint32_t colorResource = graph.GetResource(color);
+    const uint32_t backResource = graph.GetResource(backBuffer);
+
+    CHECK(graph.GetPassBarriers(prepass).GetSize() == 1);
+    CHECK(HasBarrier(graph.GetPassBarriers(prepass), depthResource,
+                     RenderResourceState::Undefined, RenderResourceState::DepthWrite));
+    CHECK(graph.GetPassBarriers(opaque).GetSize() == 2);
+    CHECK(HasBarrier(graph.GetPassBarriers(opaque), depthResource,
+                     RenderResourceState::DepthWrite, RenderResourceState::DepthRead));
+    CHECK(HasBarrier(graph.GetPassBarriers(opaque), colorResource,
+                     RenderResourceState::Undefined, RenderResourceState::RenderTarget));
+    CHECK(graph.GetPassBarriers(present).GetSize() == 2);
+    CHECK(HasBarrier(graph.GetPassBarriers(present), colorResource,
+                     RenderResourceState::RenderTarget, RenderResourceState::CopySource));
+    CHECK(HasBarrier(graph.GetPassBarriers(present), backResource,
+                     RenderResourceState::Present, RenderResourceState::CopyDest));
+
+    const std::vector<RenderBarrier>& final = graph.GetFinalBarriers();
+    REQUIRE(final.size() == 1);
+    CHECK(final[0].Resource == backResource);
+    CHECK(final[0].Before == RenderResourceState::CopyDest);
+    CHECK(final[0].After == RenderResourceState::Present);
+
+    // Execute reports each pass's barriers right before it, then the final ones.
+    std::vector<RenderBarrier> reported;
+    graph.Execute([&](const RenderBarrier& Barrier) { reported.push_back(Barrier); });
+    CHECK(reported.size() == graph.GetStats().BarrierCount);
+    CHECK(reported.back().After == RenderResourceState::Present);
+}
+
+TEST(RenderGraph, FencesUnorderedAccessChains) {
+    RenderGraph graph;
+    RenderHandle buffer = INVALID_RENDER_HANDLE;
+    const RenderResourceDesc bufferDesc{4096, 1, RenderFormat::Raw8};
+    graph.AddPass(
+        "Clear",
+        [&](RenderPassBuilder& Builder) {
+            buffer = Builder.Write(Builder.Create("Counters", bufferDesc),
+                                   RenderResourceState::UnorderedAccess);
+        },
+        nullptr);
+    const uint32_t accumulate = graph.AddPass(
+        "Accumulate",
+        [&](RenderPassBuilder& Builder) {
+            buffer = Builder.Write(buffer, RenderResourceState::UnorderedAccess);
+            Builder.SetSideEffects();
+        },
+        nullptr);
+
+    REQUIRE(graph.Compile());
+    // Same state on both sides, but the second pass must wait for the first one's writes.
+    const Span<const RenderBarrier> barriers = graph.GetPassBarriers(accumulate);
+    REQUIRE(barriers.GetSize() == 1);
+    CHECK(barriers[0].Before == RenderResourceState::UnorderedAccess);
+    CHECK(barriers[0].After == RenderResourceState::UnorderedAccess);
+}
@@ -0,0 +1,42 @@
+﻿// tests/TestFramework.h
+// Self-registering test cases for the CPU unit tests, with nothing beyond the standard library.
+// TEST(Suite, Name) defines a case. CHECK records a failure and carries on; REQUIRE also ends the
+// case, for checks the rest of it depends on.
+#pragma once
+
+#include <vector>
+
+struct TestCase {
+    const char* Suite;
+    const char* Name;
+    void (*Function)();
+};
+
+std::vector<TestCase>& GetTestCases();
+void ReportTestFailure(const char* File, int Line, const char* Expression);
+
+struct TestRegistrar {
+    TestRegistrar(const char* Suite, const char* Name, void (*Function)()) {
+        GetTestCases().push_back({Suite, Name, Function});
+    }
+};
+
+#define TEST(Suite, Name)                                                                          \
+    static void Suite##_##Name();                                                                  \
+    static const TestRegistrar Suite##_##Name##_Registrar(#Suite, #Name, &Suite##_##Name);         \
+    static void Suite##_##Name()
+
+#define CHECK(Expression)                                                                          \
+    do {                                                                                           \
+        if (!(Expression)) {                                                                       \
+            ReportTestFailure(__FILE__, __LINE__, #Expression);                                    \
+        }                                                                                          \
+    } while (false)
+
+#define REQUIRE(Expression)                                                                        \
+    do {                                                                                           \
+        if (!(Expression)) {                                                                       \
+            ReportTestFailure(__FILE__, __LINE__, #Expression);                                    \
+            return;                                                                                \
+        }                                                                                          \
+    } while (false)
@@ -0,0 +1,46 @@
+﻿// tests/TestMain.cpp
+// Runs every registered test case, or only those of the suite named on the command line.
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "TestFramework.h"
+
+namespace {
+
+uint32_t gFailureCount = 0;
+
+} // anonymous namespace
+
+std::vector<TestCase>& GetTestCases() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+void ReportTestFailure(const char* File, int Line, const char* Expression) {
+    std::printf("  %s:%d: CHECK(%s) failed\n", File, Line, Expression);
+    ++gFailureCount;
+}
+
+int main(int argc, char** argv) {
+    const char* suite = argc > 1 ? argv[1] : nullptr;
+    uint32_t runCount = 0;
+    uint32_t failedCount = 0;
+    for (const TestCase& test : GetTestCases()) {
+        if (suite != nullptr && std::strcmp(suite, test.Suite) != 0) {
+            continue;
+        }
+        const uint32_t failuresBefore = gFailureCount;
+        test.Function();
+        const bool passed = gFailureCount == failuresBefore;
+        std::printf("[%s] %s.%s\n", passed ? "  OK  " : " FAIL ", test.Suite, test.Name);
+        ++runCount;
+        failedCount += passed ? 0 : 1;
+    }
+    if (runCount == 0) {
+        std::printf("No tests match %s\n", suite != nullptr ? suite : "(all)");
+        return 1;
+    }
+    std::printf("%u of %u tests passed\n", runCount - failedCount, runCount);
+    return failedCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,258 @@
+﻿// tests/TreeModelTests.cpp
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/TreeModel.h"
+#include "TestFramework.h"
+
+namespace {
+
+// Children kept in plain lists, counting how often the model asks for them.
+class FakeTreeSource : public TreeSource {
+  public:
+    // Adds Count keys under Parent, numbered on from the last key added.
+    void AddChildren(TreeKey Parent, uint32_t Count) {
+        for (uint32_t i = 0; i < Count; ++i) {
+            Insert(Parent, mNextKey++);
+        }
+    }
+    void Insert(TreeKey Parent, TreeKey Key) {
+        mChildren[Parent].push_back(Key);
+        mParents[Key] = Parent;
+    }
+    void Remove(TreeKey Key) {
+        std::vector<TreeKey>& siblings = mChildren[mParents[Key]];
+        siblings.erase(std::find(siblings.begin(), siblings.end(), Key));
+        mParents.erase(Key);
+    }
+    const std::vector<TreeKey>& GetChildren(TreeKey Parent) {
+        return mChildren[Parent];
+    }
+
+    bool ListChildren(TreeKey Parent,
+                      TreeKey After,
+                      uint32_t MaxCount,
+                      std::vector<TreeKey>& Out) const override {
+        ++ListCount;
+        auto children = mChildren.find(Parent);
+        if (children == mChildren.end()) {
+            return false;
+        }
+        const std::vector<TreeKey>& keys = children->second;
+        size_t next = 0;
+        if (After != INVALID_TREE_KEY) {
+            next = std::find(keys.begin(), keys.end(), After) - keys.begin() + 1;
+        }
+        for (uint32_t count = 0; next < keys.size() && count < MaxCount; ++count) {
+            Out.push_back(keys[next++]);
+        }
+        return next < keys.size();
+    }
+    bool HasChildren(TreeKey Key) const override {
+        auto children = mChildren.find(Key);
+        return children != mChildren.end() && !children->second.empty();
+    }
+    TreeKey GetParent(TreeKey Key) const override {
+        auto parent = mParents.find(Key);
+        return parent != mParents.end() ? parent->second : INVALID_TREE_KEY;
+    }
+
+    mutable uint32_t ListCount = 0;
+
+  private:
+    std::unordered_map<TreeKey, std::vector<TreeKey>> mChildren;
+    std::unordered_map<TreeKey, TreeKey> mParents;
+    TreeKey mNextKey = 0;
+};
+
+// Keys of every row, placeholders resolved.
+std::vector<TreeKey> GetRowKeys(TreeModel& Model) {
+    std::vector<uint32_t> rows;
+    Model.GetRows(0, ~0u, rows);
+    std::vector<TreeKey> keys;
+    for (uint32_t node : rows) {
+        keys.push_back(Model.GetNode(node).Key);
+    }
+    return keys;
+}
+
+// What the rows should be: the source's tree, walked through the expanded nodes.
+void AppendExpectedKeys(const TreeModel& Model,
+                        FakeTreeSource& Source,
+                        TreeKey Parent,
+                        std::vector<TreeKey>& Out) {
+    for (TreeKey key : Source.GetChildren(Parent)) {
+        Out.push_back(key);
+        const uint32_t node = Model.FindNode(key);
+        if (node != INVALID_TREE_NODE && Model.GetNode(node).Expanded) {
+            AppendExpectedKeys(Model, Source, key, Out);
+        }
+    }
+}
+
+bool RowsMatchSource(TreeModel& Model, FakeTreeSource& Source) {
+    const std::vector<TreeKey> rows = GetRowKeys(Model);
+    std::vector<TreeKey> expected;
+    AppendExpectedKeys(Model, Source, INVALID_TREE_KEY, expected);
+    return rows == expected;
+}
+
+} // anonymous namespace
+
+TEST(TreeModel, MaterializesChildrenInBatches) {
+    FakeTreeSource source;
+    source.AddChildren(INVALID_TREE_KEY, 10); // Keys 0-9
+    source.AddChildren(0, 3);                 // Keys 10-12
+    TreeModel model(source, 4);
+    model.Reset();
+
+    // The first batch and a placeholder for the rest; nothing below the top level yet.
+    TreeModelStats stats = model.GetStats();
+    CHECK(stats.NodeCount == 5);
+    CHECK(stats.PlaceholderCount == 1);
+    CHECK(stats.RowCount == 5);
+    CHECK(source.ListCount == 1);
+    const uint32_t first = model.FindNode(0);
+    REQUIRE(first != INVALID_TREE_NODE);
+    CHECK(model.GetNode(first).HasChildren);
+    CHECK(!model.GetNode(first).Listed);
+    CHECK(model.FindNode(10) == INVALID_TREE_NODE);
+    CHECK(model.FindNode(4) == INVALID_TREE_NODE);
+
+    // Asking for the rows the placeholder stands in lists one more batch, no more.
+    std::vector<uint32_t> rows;
+    model.GetRows(0, 5, rows);
+    REQUIRE(rows.size() == 5);
+    CHECK(model.GetNode(rows[4]).Key == 4);
+    CHECK(model.FindNode(7) != INVALID_TREE_NODE);
+    CHECK(model.FindNode(8) == INVALID_TREE_NODE);
+    CHECK(model.GetStats().RowCount == 9);
+    CHECK(source.ListCount == 2);
+
+    const std::vector<TreeKey> expected = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    CHECK(GetRowKeys(model) == expected);
+    stats = model.GetStats();
+    CHECK(stats.NodeCount == 10);
+    CHECK(stats.PlaceholderCount == 0);
+}
+
+TEST(TreeModel, ReplacesPlaceholdersInPlace) {
+    FakeTreeSource source;
+    source.AddChildren(INVALID_TREE_KEY, 3); // Keys 0-2
+    source.AddChildren(1, 6);                // Keys 3-8
+    TreeModel model(source, 2);
+    model.Reset();
+    std::vector<TreeChange> changes;
+    model.TakeChanges(changes);
+
+    const uint32_t parent = model.FindNode(1);
+    REQUIRE(model.Expand(parent));
+    const uint32_t placeholder = model.GetNode(parent).LastChild;
+    REQUIRE(model.IsPlaceholder(placeholder));
+    CHECK(model.GetNode(placeholder).ResumeAfter == 4);
+
+    // The batch goes in front of the placeholder, which moves on to the next one.
+    std::vector<uint32_t> rows;
+    model.GetRows(4, 2, rows);
+    REQUIRE(rows.size() == 2);
+    CHECK(model.GetNode(rows[0]).Key == 5);
+    CHECK(model.GetNode(rows[1]).Key == 6);
+    CHECK(model.GetNode(placeholder).ResumeAfter == 6);
+    CHECK(model.GetNode(parent).LastChild == placeholder);
+
+    // Removing the last key listed makes the placeholder resume from the one before.
+    source.Remove(6);
+    model.OnRemoved(6);
+    CHECK(model.GetNode(placeholder).ResumeAfter == 5);
+    // Inserted past the listed part: the placeholder lists it when it gets there.
+    source.Insert(1, 100);
+    model.OnInserted(1, 100);
+    CHECK(model.FindNode(100) == INVALID_TREE_NODE);
+
+    // The last batch removes the placeholder and the rows close up around it.
+    CHECK(RowsMatchSource(model, source));
+    CHECK(model.GetNode(placeholder).Removed);
+    CHECK(model.GetNode(model.GetNode(parent).LastChild).Key == 100);
+    CHECK(model.GetStats().PlaceholderCount == 0);
+    model.TakeChanges(changes);
+    CHECK(std::any_of(changes.begin(), changes.end(), [&](const TreeChange& Change) {
+        return Change.Type == TreeChangeType::Removed && Change.Node == placeholder;
+    }));
+}
+
+TEST(TreeModel, RevealsDeepKeys) {
+    FakeTreeSource source;
+    source.AddChildren(INVALID_TREE_KEY, 20); // Keys 0-19
+    source.AddChildren(17, 20);               // Keys 20-39
+    source.AddChildren(35, 5);                // Keys 40-44
+    TreeModel model(source, 4);
+    model.Reset();
+
+    // Key 43 is in the fifth batch of 17's children, which is in the fifth batch of the top.
+    const uint32_t node = model.Reveal(43);
+    REQUIRE(node != INVALID_TREE_NODE);
+    CHECK(model.GetNode(node).Key == 43);
+    CHECK(model.GetNode(node).Depth == 2);
+    CHECK(model.GetNode(model.FindNode(17)).Expanded);
+    CHECK(model.GetNode(model.FindNode(35)).Expanded);
+    CHECK(model.FindNode(44) == INVALID_TREE_NODE); // In the batch after
+    CHECK(model.Reveal(1000) == INVALID_TREE_NODE);
+
+    // Rows of the revealed chain come right after their parents.
+    std::vector<uint32_t> rows;
+    model.GetRows(0, model.GetRowCount(), rows);
+    const auto row = std::find(rows.begin(), rows.end(), node) - rows.begin();
+    CHECK(row == 18 + 16 + 3);
+    CHECK(RowsMatchSource(model, source));
+}
+
+TEST(TreeModel, KeepsRowsInStepWithEdits) {
+    FakeTreeSource source;
+    source.AddChildren(INVALID_TREE_KEY, 30); // Keys 0-29
+    for (TreeKey parent = 0; parent < 30; parent += 3) {
+        source.AddChildren(parent, 7);
+    }
+    TreeModel model(source, 5);
+    model.Reset();
+
+    // Every edit below looks rows up, mostly right after others moved.
+    uint32_t seed = 7;
+    TreeKey nextKey = 1000;
+    for (uint32_t step = 0; step < 400; ++step) {
+        seed = seed * 1664525u + 1013904223u;
+        const TreeKey key = (seed >> 8) % 100;
+        const uint32_t node = model.FindNode(key);
+        switch ((seed >> 4) % 4) {
+        case 0:
+            model.Reveal(key);
+            break;
+        case 1:
+            if (node != INVALID_TREE_NODE) {
+                model.Expand(node);
+            }
+            break;
+        case 2:
+            if (node != INVALID_TREE_NODE) {
+                model.Collapse(node);
+            }
+            break;
+        default:
+            source.Insert(key, nextKey);
+            model.OnInserted(key, nextKey);
+            ++nextKey;
+            break;
+        }
+        if (step % 50 == 0) {
+            CHECK(RowsMatchSource(model, source));
+        }
+    }
+    CHECK(RowsMatchSource(model, source));
+
+    // Removing a subtree takes its rows along.
+    source.Remove(3);
+    model.OnRemoved(3);
+    CHECK(model.FindNode(3) == INVALID_TREE_NODE);
+    CHECK(RowsMatchSource(model, source));
+}
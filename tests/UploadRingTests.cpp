@@ -0,0 +1,209 @@
+﻿// tests/UploadRingTests.cpp
+#include <cstdint>
+#include <vector>
+
+#include "Graphics/UploadRing.h"
+#include "TestFramework.h"
+
+namespace {
+
+// Stands in for a GPU fence: frames are signalled in order and complete when told to.
+struct FakeFence {
+    uint64_t NextValue = 1;
+    uint64_t CompletedValue = 0;
+
+    uint64_t Signal() {
+        return NextValue++;
+    }
+    // The consumer finishes everything but the newest FramesInFlight frames.
+    uint64_t CompleteAllBut(uint64_t FramesInFlight) {
+        const uint64_t signalled = NextValue - 1;
+        if (signalled > FramesInFlight) {
+            CompletedValue = signalled - FramesInFlight;
+        }
+        return CompletedValue;
+    }
+};
+
+struct LiveRange {
+    uint64_t Offset;
+    uint64_t Size;
+    uint64_t FenceValue; // 0 until the frame ends
+};
+
+bool Overlaps(const LiveRange& Range, const UploadAllocation& Allocation) {
+    return Allocation.Offset < Range.Offset + Range.Size &&
+           Range.Offset < Allocation.Offset + Allocation.Size;
+}
+
+} // anonymous namespace
+
+TEST(UploadRing, ReclaimsFramesOnceTheirFenceCompletes) {
+    UploadRing ring(4096);
+    FakeFence fence;
+    UploadAllocation allocation;
+
+    for (uint64_t i = 0; i < 3; ++i) {
+        REQUIRE(ring.Allocate(1024, UploadRing::CONSTANT_ALIGNMENT, allocation));
+        CHECK(allocation.Offset == i * 1024);
+        CHECK(!allocation.Dedicated);
+    }
+    const uint64_t firstFrame = fence.Signal();
+    ring.EndFrame(firstFrame);
+
+    REQUIRE(ring.Allocate(1024, UploadRing::CONSTANT_ALIGNMENT, allocation));
+    CHECK(!ring.Allocate(1024, UploadRing::CONSTANT_ALIGNMENT, allocation));
+    CHECK(ring.GetStats().FullCount == 1);
+    CHECK(ring.GetStats().UsedBytes == 4096);
+
+    // Nothing comes back before the fence passes the frame.
+    ring.Reclaim(fence.CompletedValue);
+    CHECK(ring.GetStats().UsedBytes == 4096);
+    fence.CompletedValue = firstFrame;
+    ring.Reclaim(fence.CompletedValue);
+    CHECK(ring.GetStats().UsedBytes == 1024);
+    CHECK(ring.GetStats().PeakBytes == 4096);
+
+    REQUIRE(ring.Allocate(1024, UploadRing::CONSTANT_ALIGNMENT, allocation));
+    CHECK(allocation.Offset == 0);
+}
+
+TEST(UploadRing, WrapsInsteadOfStraddlingTheEnd) {
+    UploadRing ring(4096);
+    ring.SetDedicatedThreshold(4096);
+    FakeFence fence;
+    UploadAllocation allocation;
+
+    REQUIRE(ring.Allocate(3000, 16, allocation));
+    ring.EndFrame(fence.Signal());
+    fence.CompletedValue = 1;
+    ring.Reclaim(fence.CompletedValue);
+    CHECK(ring.GetStats().UsedBytes == 0);
+
+    // Aligned to 3072, it would run past the end: it starts over at 0 and the tail is padding.
+    REQUIRE(ring.Allocate(2000, 256, allocation));
+    CHECK(allocation.Offset == 0);
+    CHECK(ring.GetStats().UsedBytes == (4096 - 3000) + 2000);
+    REQUIRE(ring.Allocate(900, 256, allocation));
+    CHECK(allocation.Offset == 2048);
+    // The padding counts as used until the frame is reclaimed.
+    CHECK(!ring.Allocate(256, 256, allocation));
+
+    ring.EndFrame(fence.Signal());
+    fence.CompletedValue = 2;
+    ring.Reclaim(fence.CompletedValue);
+    CHECK(ring.GetStats().UsedBytes == 0);
+    REQUIRE(ring.Allocate(256, 256, allocation));
+    CHECK(allocation.Offset == 3072);
+}
+
+TEST(UploadRing, NeverHandsOutBytesTheConsumerMayStillRead) {
+    constexpr uint64_t FRAMES_IN_FLIGHT = 2;
+    UploadRing ring(64 * 1024);
+    FakeFence fence;
+    std::vector<LiveRange> live;
+    uint32_t seed = 1;
+
+    for (uint32_t frame = 0; frame < 500; ++frame) {
+        const uint64_t completed = fence.CompleteAllBut(FRAMES_IN_FLIGHT);
+        ring.Reclaim(completed);
+        std::vector<LiveRange> stillLive;
+        for (const LiveRange& range : live) {
+            if (range.FenceValue > completed) {
+                stillLive.push_back(range);
+            }
+        }
+        live.swap(stillLive);
+
+        const uint32_t count = 1 + frame % 7;
+        for (uint32_t i = 0; i < count; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            const uint64_t size = 1 + (seed >> 8) % 6000;
+            UploadAllocation allocation;
+            if (!ring.Allocate(size, UploadRing::CONSTANT_ALIGNMENT, allocation)) {
+                continue;
+            }
+            REQUIRE(!allocation.Dedicated);
+            CHECK(allocation.Offset % UploadRing::CONSTANT_ALIGNMENT == 0);
+            CHECK(allocation.Offset + allocation.Size <= 64 * 1024);
+            for (const LiveRange& range : live) {
+                CHECK(!Overlaps(range, allocation));
+            }
+            live.push_back({allocation.Offset, allocation.Size, 0});
+        }
+
+        const uint64_t fenceValue = fence.Signal();
+        ring.EndFrame(fenceValue);
+        for (LiveRange& range : live) {
+            range.FenceValue = range.FenceValue == 0 ? fenceValue : range.FenceValue;
+        }
+    }
+    CHECK(ring.GetStats().PeakBytes <= 64 * 1024);
+}
+
+TEST(UploadRing, SendsLargeRequestsToDedicatedAllocations) {
+    std::vector<void*> allocated;
+    std::vector<void*> released;
+    {
+        UploadRing ring(4096);
+        ring.SetDedicatedFunctions(
+            [&](uint64_t Size) -> void* {
+                allocated.push_back(::operator new(Size));
+                return allocated.back();
+            },
+            [&](void* Memory) {
+                released.push_back(Memory);
+                ::operator delete(Memory);
+            });
+        FakeFence fence;
+        UploadAllocation allocation;
+
+        // Above a quarter of the capacity by default.
+        REQUIRE(ring.Allocate(1025, 16, allocation));
+        CHECK(allocation.Dedicated);
+        CHECK(allocation.CpuAddress == allocated.back());
+        CHECK(ring.GetStats().UsedBytes == 0);
+        CHECK(ring.GetStats().DedicatedBytes == 1025);
+        ring.EndFrame(fence.Signal());
+
+        REQUIRE(ring.Allocate(8192, 16, allocation));
+        CHECK(allocation.Dedicated);
+        ring.EndFrame(fence.Signal());
+
+        // Released in fence order, like the ring's own bytes.
+        ring.Reclaim(0);
+        CHECK(released.empty());
+        ring.Reclaim(1);
+        REQUIRE(released.size() == 1);
+        CHECK(released[0] == allocated[0]);
+        CHECK(ring.GetStats().DedicatedBytes == 8192);
+        CHECK(ring.GetStats().DedicatedCount == 2);
+
+        REQUIRE(ring.Allocate(2000, 16, allocation));
+        CHECK(allocation.Dedicated);
+    }
+    // The destructor releases what was never reclaimed.
+    CHECK(released.size() == 3);
+}
+
+TEST(UploadRing, ReportsFailedDedicatedAllocations) {
+    UploadRing ring(4096);
+    ring.SetDedicatedFunctions([](uint64_t) -> void* { return nullptr; }, [](void*) {});
+    UploadAllocation allocation;
+    CHECK(!ring.Allocate(2048, 16, allocation));
+    CHECK(ring.GetStats().DedicatedCount == 0);
+    CHECK(ring.Allocate(1024, 16, allocation));
+}
+
+TEST(UploadRing, EmptyRingMakesEveryAllocationDedicated) {
+    UploadRing ring(0);
+    UploadAllocation allocation;
+    REQUIRE(ring.Allocate(16, 16, allocation));
+    CHECK(allocation.Dedicated);
+    REQUIRE(ring.Allocate(0, 16, allocation));
+    CHECK(allocation.Dedicated);
+    ring.EndFrame(1);
+    ring.Reclaim(1);
+    CHECK(ring.GetStats().DedicatedBytes == 0);
+    CHECK(ring.GetStats().UsedBytes == 0);
+}